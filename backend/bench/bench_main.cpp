@@ -0,0 +1,583 @@
+// DnDApp_bench: Routen und Hilfsfunktionen des Servers im selben Prozess messen (ohne Socket).
+//
+//   DnDApp_bench generate --out=<dir> [--reference=../data] [--monsters=10000] [--spells=5000]
+//                         [--templates=1000] [--encounters=2000] [--seed=42]
+//   DnDApp_bench run [--data=../data] [--iterations=2000] [--threads=1] [--filter=<teil>] [--json=<datei>]
+//   DnDApp_bench compare <baseline.json> <aktuell.json> [--threshold=10]
+//   DnDApp_bench formats [--data=../data] [--iterations=2000] [--json=<datei>]
+//
+// run misst auf einer Kopie des Datenbaums (--data) in einem temporären Verzeichnis, die schreibenden Routen (PUT, PATCH,
+// DELETE, POST von Templates) verändern das Original also nicht.
+// formats vergleicht pro Kategorie des Datenbaums JSON, MessagePack und CBOR (Größe, Kodieren, Dekodieren).
+// compare meldet Benchmarks, deren p50 oder Durchsatz um mehr als threshold Prozent schlechter ist (Exit-Code 1).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "crow.h"
+#include "nlohmann/json.hpp"
+
+#include "catalog_generator.h"
+#include "content_negotiation.h"
+#include "logger.h"
+#include "server.h"
+
+using json = nlohmann::json;
+
+// --- Allokationen zählen (alle Threads, daher nur als Durchschnitt pro Operation aussagekräftig) ---
+
+namespace {
+std::atomic<std::uint64_t> allocation_count{0};
+std::atomic<std::uint64_t> allocation_bytes{0};
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+// noinline: eingebettet hält GCC free() auf einem Zeiger aus operator new für einen Fehler (-Wmismatched-new-delete)
+[[gnu::noinline]] void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+// --- Messung ---
+
+struct BenchResult {
+    std::string name;
+    std::size_t iterations = 0;
+    std::size_t errors = 0;
+    double total_ms = 0.0;
+    double ops_per_sec = 0.0;
+    double p50_us = 0.0;
+    double p90_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+    double allocs_per_op = 0.0;
+    double alloc_bytes_per_op = 0.0;
+
+    json to_json() const {
+        return {{"name", name}, {"iterations", iterations}, {"errors", errors}, {"total_ms", total_ms}, {"ops_per_sec", ops_per_sec},
+                {"p50_us", p50_us}, {"p90_us", p90_us}, {"p99_us", p99_us}, {"max_us", max_us},
+                {"allocs_per_op", allocs_per_op}, {"alloc_bytes_per_op", alloc_bytes_per_op}};
+    }
+};
+
+// fn(i) liefert false bei einem Fehler (z.B. HTTP-Status >= 400); i läuft über [0, iterations)
+using BenchFn = std::function<bool(std::size_t)>;
+
+// Ungemessene Aufrufe vor der Messung (Caches, Indizes)
+std::size_t warmup_calls(std::size_t iterations) {
+    return std::min<std::size_t>(iterations / 10 + 1, 100);
+}
+
+BenchResult measure(const std::string& name, std::size_t iterations, std::size_t threads, const BenchFn& fn) {
+    for (std::size_t i = 0; i < warmup_calls(iterations); ++i) fn(i);
+
+    std::vector<double> latencies(iterations);
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> errors{0};
+    auto worker = [&]() {
+        for (std::size_t i = next.fetch_add(1); i < iterations; i = next.fetch_add(1)) {
+            const auto start = std::chrono::steady_clock::now();
+            const bool ok = fn(i);
+            latencies[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            if (!ok) errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    const std::uint64_t allocations_before = allocation_count.load();
+    const std::uint64_t bytes_before = allocation_bytes.load();
+    const auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (std::size_t t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& thread : pool) thread.join();
+    const double total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.errors = errors.load();
+    result.total_ms = total_ms;
+    result.ops_per_sec = total_ms > 0 ? iterations / (total_ms / 1000.0) : 0.0;
+    result.allocs_per_op = static_cast<double>(allocation_count.load() - allocations_before) / std::max<std::size_t>(1, iterations);
+    result.alloc_bytes_per_op = static_cast<double>(allocation_bytes.load() - bytes_before) / std::max<std::size_t>(1, iterations);
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) { return latencies.empty() ? 0.0 : latencies[static_cast<std::size_t>(p * (latencies.size() - 1))]; };
+    result.p50_us = percentile(0.50);
+    result.p90_us = percentile(0.90);
+    result.p99_us = percentile(0.99);
+    result.max_us = latencies.empty() ? 0.0 : latencies.back();
+    return result;
+}
+
+// --- Routen ohne Socket ---
+
+crow::response call(DnDServer& app, crow::HTTPMethod method, const std::string& url, const std::string& body = "",
+                    const std::string& content_type = "") {
+    crow::request req;
+    req.method = method;
+    req.raw_url = url;
+    req.url = url.substr(0, url.find('?'));
+    req.url_params = crow::query_string(url);
+    req.body = body;
+    if (!content_type.empty()) req.headers.emplace("Content-Type", content_type);
+    crow::response res;
+    app.handle(req, res);
+    return res;
+}
+
+bool wait_until_warm(DnDServer& app, std::chrono::seconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        const json status = json::parse(call(app, crow::HTTPMethod::Get, "/api/status").body, nullptr, false);
+        if (status.is_object() && status.value("warm", false)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+}
+
+std::vector<std::string> collect_ids(const json& list, std::size_t limit) {
+    std::vector<std::string> ids;
+    for (const json& item : list) {
+        if (ids.size() >= limit) break;
+        if (item.is_object() && item.contains("id") && item["id"].is_string()) ids.push_back(item["id"].get<std::string>());
+    }
+    return ids;
+}
+
+struct BenchCase {
+    std::string name;
+    std::size_t divisor = 1; // Teure Fälle laufen mit iterations / divisor
+    BenchFn fn;
+    std::function<void(std::size_t)> prepare = nullptr; // Optional, vor der Messung mit der Zahl der Aufrufe (inkl. Aufwärmen)
+};
+
+std::string option_value(const std::string& arg, const std::string& name) {
+    return arg.rfind(name + "=", 0) == 0 ? arg.substr(name.size() + 1) : std::string();
+}
+
+void print_result(const BenchResult& r) {
+    std::printf("%-42s %8zu %11.0f %10.1f %10.1f %10.1f %9.1f %12.0f%s\n", r.name.c_str(), r.iterations, r.ops_per_sec, r.p50_us,
+                r.p90_us, r.p99_us, r.allocs_per_op, r.alloc_bytes_per_op, r.errors ? "  (Fehler!)" : "");
+}
+
+// --- Subkommandos ---
+
+int run_generate(const std::vector<std::string>& args) {
+    GeneratorOptions options;
+    try {
+        for (const std::string& arg : args) {
+            if (!option_value(arg, "--out").empty()) options.out_dir = option_value(arg, "--out");
+            else if (!option_value(arg, "--reference").empty()) options.reference_dir = option_value(arg, "--reference");
+            else if (!option_value(arg, "--monsters").empty()) options.monsters = std::stoull(option_value(arg, "--monsters"));
+            else if (!option_value(arg, "--spells").empty()) options.spells = std::stoull(option_value(arg, "--spells"));
+            else if (!option_value(arg, "--templates").empty()) options.templates_per_type = std::stoull(option_value(arg, "--templates"));
+            else if (!option_value(arg, "--encounters").empty()) options.encounters = std::stoull(option_value(arg, "--encounters"));
+            else if (!option_value(arg, "--seed").empty()) options.seed = std::stoull(option_value(arg, "--seed"));
+            else throw std::invalid_argument("Unknown option " + arg);
+        }
+        if (options.out_dir.empty()) throw std::invalid_argument("--out is required");
+    } catch (const std::exception& e) {
+        std::cerr << "generate: " << e.what() << "\n";
+        return 2;
+    }
+    try {
+        const GeneratorStats stats = generate_catalog(options);
+        std::printf("%zu Dateien, %.1f MB in %.0f ms nach %s/data\n", stats.files, stats.bytes / 1048576.0, stats.elapsed_ms,
+                    options.out_dir.string().c_str());
+    } catch (const std::exception& e) {
+        std::cerr << "generate: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Kopiert den Datenbaum nach <tmp>/dndapp_bench_<pid>/data und startet "run" dort neu (Arbeitsverzeichnis .../build). Der
+// Server löst seine Pfade (../data) schon beim Programmstart auf, daher ein eigener Prozess statt chdir().
+int run_in_copy(const std::filesystem::path& data_dir, const std::vector<std::string>& args) {
+    namespace fs = std::filesystem;
+    const fs::path root = fs::temp_directory_path() / ("dndapp_bench_" + std::to_string(::getpid()));
+    try {
+        if (!fs::is_directory(data_dir)) throw std::runtime_error(data_dir.string() + " ist kein Verzeichnis");
+        fs::remove_all(root);
+        fs::create_directories(root / "build");
+        fs::copy(data_dir, root / "data", fs::copy_options::recursive);
+    } catch (const std::exception& e) {
+        std::cerr << "run: Datenbaum nicht kopiert: " << e.what() << "\n";
+        std::error_code ec;
+        fs::remove_all(root, ec);
+        return 1;
+    }
+
+    std::vector<std::string> child_args = {"DnDApp_bench", "run", "--in-copy"};
+    for (const std::string& arg : args) {
+        // Relativ zum ursprünglichen Arbeitsverzeichnis angegeben
+        child_args.push_back(option_value(arg, "--json").empty() ? arg : "--json=" + fs::absolute(option_value(arg, "--json")).string());
+    }
+    std::vector<char*> argv;
+    for (std::string& arg : child_args) argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    std::cout.flush();
+    const pid_t pid = ::fork();
+    if (pid == 0) {
+        if (::chdir((root / "build").c_str()) == 0) ::execv("/proc/self/exe", argv.data());
+        std::perror("run: Neustart in der Kopie fehlgeschlagen");
+        ::_exit(127);
+    }
+    int status = 0;
+    const bool waited = pid > 0 && ::waitpid(pid, &status, 0) == pid;
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    if (!waited) {
+        std::cerr << "run: Konnte Benchmark-Prozess nicht starten\n";
+        return 1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+int run_benchmarks(const std::vector<std::string>& args) {
+    std::filesystem::path data_dir = "../data";
+    bool in_copy = false;
+    std::vector<std::string> forwarded;
+    std::size_t iterations = 2000;
+    std::size_t threads = 1;
+    std::string filter;
+    std::string json_path;
+    try {
+        for (const std::string& arg : args) {
+            if (arg == "--in-copy") in_copy = true;
+            else if (!option_value(arg, "--data").empty()) data_dir = option_value(arg, "--data");
+            else if (!option_value(arg, "--iterations").empty()) iterations = std::max<std::size_t>(1, std::stoull(option_value(arg, "--iterations")));
+            else if (!option_value(arg, "--threads").empty()) threads = std::max<std::size_t>(1, std::stoull(option_value(arg, "--threads")));
+            else if (!option_value(arg, "--filter").empty()) filter = option_value(arg, "--filter");
+            else if (!option_value(arg, "--json").empty()) json_path = option_value(arg, "--json");
+            else throw std::invalid_argument("Unknown option " + arg);
+            if (arg != "--in-copy" && option_value(arg, "--data").empty()) forwarded.push_back(arg);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "run: " << e.what() << "\n";
+        return 2;
+    }
+    if (!in_copy) return run_in_copy(data_dir, forwarded);
+
+    DnDServer app;
+    start_services();
+    register_routes(app, false);
+    app.validate();
+    if (!wait_until_warm(app, std::chrono::minutes(10))) {
+        std::cerr << "run: Warm-Start nicht abgeschlossen\n";
+        stop_services();
+        return 1;
+    }
+
+    const json summary = json::parse(call(app, crow::HTTPMethod::Get, "/api/monsters/summary").body, nullptr, false);
+    const std::vector<std::string> monster_ids = collect_ids(summary, 100000);
+    const std::vector<std::string> encounter_ids = collect_ids(json::parse(call(app, crow::HTTPMethod::Get, "/api/encounters").body, nullptr, false), 10000);
+    const std::vector<std::string> trait_ids = collect_ids(list_templates_by_type("trait"), 10000);
+    if (monster_ids.empty() || encounter_ids.empty() || trait_ids.empty()) {
+        std::cerr << "run: Keine Monster, Encounter oder Trait-Templates unter " << data_dir.string() << " (erst 'generate' ausführen)\n";
+        stop_services();
+        return 1;
+    }
+
+    // Zufällige, aber feste Reihenfolge der IDs (Zugriffe sollen nicht nur die ersten Einträge treffen)
+    std::vector<std::size_t> order(std::max({monster_ids.size(), encounter_ids.size(), trait_ids.size()}));
+    std::mt19937_64 rng(7);
+    for (std::size_t& value : order) value = rng();
+    auto monster_id = [&](std::size_t i) -> const std::string& { return monster_ids[order[i % order.size()] % monster_ids.size()]; };
+    auto encounter_id = [&](std::size_t i) -> const std::string& { return encounter_ids[order[i % order.size()] % encounter_ids.size()]; };
+    auto trait_id = [&](std::size_t i) -> const std::string& { return trait_ids[order[i % order.size()] % trait_ids.size()]; };
+    auto get = [&](const std::string& url) { return call(app, crow::HTTPMethod::Get, url).code < 400; };
+    auto post = [&](const std::string& url, const std::string& body) { return call(app, crow::HTTPMethod::Post, url, body).code < 400; };
+    auto patch = [&](const std::string& url, const std::string& body) {
+        return call(app, crow::HTTPMethod::Patch, url, body, "application/merge-patch+json").code < 400;
+    };
+    auto remove = [&](const std::string& url) { return call(app, crow::HTTPMethod::Delete, url).code < 400; };
+
+    json batch_body = {{"ids", json::array()}};
+    for (std::size_t i = 0; i < 50; ++i) batch_body["ids"].push_back(monster_id(i));
+    const std::string batch = batch_body.dump();
+    const std::string evaluate_body = json::parse(call(app, crow::HTTPMethod::Get, "/api/encounters/" + encounter_ids.front()).body, nullptr, false).dump();
+    const std::string roll_body = json{{"seed", 42}, {"rolls", {"1d20+5", {{"expr", "8d6"}, {"times", 10}}}}}.dump();
+
+    // Login mit dem ersten Benutzer aus users.json (Passwörter stehen dort im Klartext)
+    std::string login_body;
+    {
+        std::ifstream in("../data/users.json");
+        const json users = json::parse(in, nullptr, false);
+        if (users.is_object() && !users.empty() && users.begin()->is_object()) {
+            login_body = json{{"username", users.begin().key()}, {"password", users.begin()->value("password", "")}}.dump();
+        }
+    }
+
+    // Statblöcke für PUT (gleicher Inhalt, also Update statt Neuanlage)
+    std::vector<std::pair<std::string, std::string>> put_bodies;
+    for (std::size_t i = 0; i < 64; ++i) put_bodies.emplace_back(monster_id(i), load_monster_statblock(monster_id(i)).dump());
+
+    // Template-Namen müssen eindeutig sein, auch über das Aufwärmen hinweg
+    std::atomic<std::size_t> template_counter{0};
+    auto template_body = [&](const std::string& prefix) {
+        return json{{"name", prefix + " " + std::to_string(template_counter.fetch_add(1))}, {"description", "bench"}};
+    };
+
+    // DELETE braucht pro Aufruf ein eigenes Dokument: vorab anlegen (ungemessen), dann der Reihe nach löschen
+    std::vector<std::string> deletable_templates, deletable_monsters;
+    std::atomic<std::size_t> next_delete{0};
+    auto prepare_template_deletes = [&](std::size_t calls) {
+        deletable_templates.clear();
+        next_delete = 0;
+        for (std::size_t i = 0; i < calls; ++i) deletable_templates.push_back(save_template_by_type("trait", template_body("Bench Delete")).value("id", ""));
+    };
+    auto prepare_monster_deletes = [&](std::size_t calls) {
+        deletable_monsters.clear();
+        next_delete = 0;
+        for (std::size_t i = 0; i < calls; ++i) {
+            const std::string id = "bench-delete-" + std::to_string(i);
+            call(app, crow::HTTPMethod::Put, "/api/monsters/" + id, put_bodies[i % put_bodies.size()].second);
+            deletable_monsters.push_back(id);
+        }
+    };
+    auto delete_next = [&](const std::vector<std::string>& ids, const std::string& prefix) {
+        const std::size_t k = next_delete.fetch_add(1);
+        return k < ids.size() && remove(prefix + ids[k]);
+    };
+
+    std::vector<BenchCase> cases = {
+        // Hilfsfunktionen
+        {"helper/load_monster_statblock", 1, [&](std::size_t i) { return !load_monster_statblock(monster_id(i)).is_null(); }},
+        {"helper/list_templates_by_type", 1, [&](std::size_t) { return !list_templates_by_type("trait").empty(); }},
+        {"helper/list_templates_by_type?prefix", 1, [&](std::size_t) { return list_templates_by_type("trait", "bench trait 1").is_array(); }},
+        {"helper/save_template_by_type", 4, [&](std::size_t) { return save_template_by_type("trait", template_body("Bench Save")).contains("id"); }},
+        // Routen
+        {"POST /api/login", 1, [&](std::size_t) { return !login_body.empty() && post("/api/login", login_body); }},
+        {"GET /api/users/list", 1, [&](std::size_t) { return get("/api/users/list"); }},
+        {"GET /api/status", 1, [&](std::size_t) { return get("/api/status"); }},
+        {"GET /api/metrics", 1, [&](std::size_t) { return get("/api/metrics"); }},
+        {"GET /api/monsters/<id>", 1, [&](std::size_t i) { return get("/api/monsters/" + monster_id(i)); }},
+        {"PUT /api/monsters/<id>", 4, [&](std::size_t i) {
+             const auto& [id, body] = put_bodies[i % put_bodies.size()];
+             return call(app, crow::HTTPMethod::Put, "/api/monsters/" + id, body).code < 400;
+         }},
+        {"PATCH /api/monsters/<id>", 4, [&](std::size_t i) {
+             return patch("/api/monsters/" + monster_id(i), json{{"benchRevision", i}}.dump());
+         }},
+        {"DELETE /api/monsters/<id>", 4, [&](std::size_t) { return delete_next(deletable_monsters, "/api/monsters/"); }, prepare_monster_deletes},
+        {"GET /api/monsters/summary", 10, [&](std::size_t) { return get("/api/monsters/summary"); }},
+        {"GET /api/monsters/summary?limit=100", 1, [&](std::size_t) { return get("/api/monsters/summary?limit=100&sort=cr"); }},
+        {"GET /api/monsters/query", 1, [&](std::size_t) { return get("/api/monsters/query?cr_min=1&cr_max=10&size=Large,Huge&resist=fire"); }},
+        {"POST /api/monsters/batch (50)", 4, [&](std::size_t) { return post("/api/monsters/batch", batch); }},
+        {"GET /api/monsters/<id>/dpr", 4, [&](std::size_t i) { return get("/api/monsters/" + monster_id(i) + "/dpr?pmf=false"); }},
+        {"GET /api/monsters/dpr?ac=15", 50, [&](std::size_t) { return get("/api/monsters/dpr?ac=15"); }},
+        {"GET /api/encounters", 1, [&](std::size_t) { return get("/api/encounters"); }},
+        {"GET /api/encounters?limit=50", 1, [&](std::size_t) { return get("/api/encounters?limit=50"); }},
+        {"GET /api/encounters/<id>", 1, [&](std::size_t i) { return get("/api/encounters/" + encounter_id(i)); }},
+        {"GET /api/encounters/<id>?hydrate=true", 2, [&](std::size_t i) { return get("/api/encounters/" + encounter_id(i) + "?hydrate=true"); }},
+        {"POST /api/encounters/evaluate", 1, [&](std::size_t) { return post("/api/encounters/evaluate", evaluate_body); }},
+        {"POST /api/encounters/<id>/simulate", 20, [&](std::size_t i) { return post("/api/encounters/" + encounter_id(i) + "/simulate", "{\"trials\": 200}"); }},
+        {"GET /api/templates/trait", 1, [&](std::size_t) { return get("/api/templates/trait"); }},
+        {"GET /api/templates/trait/<id>", 1, [&](std::size_t i) { return get("/api/templates/trait/" + trait_id(i)); }},
+        {"POST /api/templates/trait", 4, [&](std::size_t) { return post("/api/templates/trait", template_body("Bench Post").dump()); }},
+        {"PATCH /api/templates/trait/<id>", 4, [&](std::size_t i) {
+             return patch("/api/templates/trait/" + trait_id(i), json{{"description", "bench " + std::to_string(i)}}.dump());
+         }},
+        {"DELETE /api/templates/trait/<id>", 4, [&](std::size_t) { return delete_next(deletable_templates, "/api/templates/trait/"); },
+         prepare_template_deletes},
+        {"GET /api/spells", 1, [&](std::size_t) { return get("/api/spells"); }},
+        {"GET /api/spells?class=Wizard&level_max=3", 1, [&](std::size_t) { return get("/api/spells?class=Wizard&level_max=3"); }},
+        {"GET /api/dnddata/crData.json", 1, [&](std::size_t) { return get("/api/dnddata/crData.json"); }},
+        {"POST /api/roll", 1, [&](std::size_t) { return post("/api/roll", roll_body); }},
+    };
+
+    std::printf("%zu Monster, %zu Encounter, %zu Trait-Templates; %zu Iterationen, %zu Thread(s)\n\n", monster_ids.size(),
+                encounter_ids.size(), trait_ids.size(), iterations, threads);
+    std::printf("%-42s %8s %11s %10s %10s %10s %9s %12s\n", "Benchmark", "Iter.", "Ops/s", "p50 us", "p90 us", "p99 us", "Allocs", "Alloc-Bytes");
+    std::vector<BenchResult> results;
+    for (const BenchCase& bench : cases) {
+        if (!filter.empty() && bench.name.find(filter) == std::string::npos) continue;
+        const std::size_t bench_iterations = std::max<std::size_t>(1, iterations / bench.divisor);
+        BenchResult result;
+        try {
+            if (bench.prepare) bench.prepare(bench_iterations + warmup_calls(bench_iterations));
+            result = measure(bench.name, bench_iterations, threads, bench.fn);
+        } catch (const std::exception& e) {
+            std::cerr << bench.name << ": " << e.what() << "\n";
+            continue;
+        }
+        print_result(result);
+        results.push_back(std::move(result));
+    }
+    stop_services();
+
+    if (!json_path.empty()) {
+        json output = {{"config", {{"iterations", iterations}, {"threads", threads}, {"filter", filter}, {"monsters", monster_ids.size()},
+                                   {"encounters", encounter_ids.size()}, {"hardware_threads", std::thread::hardware_concurrency()}}},
+                       {"benchmarks", json::array()}};
+        for (const BenchResult& result : results) output["benchmarks"].push_back(result.to_json());
+        std::ofstream out(json_path);
+        out << output.dump(2) << "\n";
+        if (!out) {
+            std::cerr << "run: Konnte " << json_path << " nicht schreiben\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int run_formats(const std::vector<std::string>& args) {
+    namespace fs = std::filesystem;
+    fs::path data_dir = "../data";
+    std::size_t iterations = 2000;
+    std::string json_path;
+    try {
+        for (const std::string& arg : args) {
+            if (!option_value(arg, "--data").empty()) data_dir = option_value(arg, "--data");
+            else if (!option_value(arg, "--iterations").empty()) iterations = std::stoull(option_value(arg, "--iterations"));
+            else if (!option_value(arg, "--json").empty()) json_path = option_value(arg, "--json");
+            else throw std::invalid_argument("Unknown option " + arg);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "formats: " << e.what() << "\n";
+        return 2;
+    }
+
+    // Dokumente pro Kategorie (erste Verzeichnisebene unter data/)
+    std::map<std::string, std::vector<json>> categories;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(data_dir, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file() || it->path().extension() != ".json") continue;
+        std::ifstream in(it->path(), std::ios::binary);
+        json document = json::parse(in, nullptr, false);
+        if (document.is_discarded()) continue;
+        categories[it->path().lexically_relative(data_dir).begin()->string()].push_back(std::move(document));
+    }
+    if (categories.empty()) {
+        std::cerr << "formats: Keine JSON-Dateien unter " << data_dir.string() << "\n";
+        return 1;
+    }
+
+    const std::vector<std::pair<std::string, BodyFormat>> formats = {{"json", BodyFormat::json}, {"msgpack", BodyFormat::msgpack}, {"cbor", BodyFormat::cbor}};
+    json output = {{"config", {{"iterations", iterations}, {"data", data_dir.string()}}}, {"sizes", json::object()}, {"benchmarks", json::array()}};
+
+    std::printf("%-20s %7s %12s %12s %12s\n", "Kategorie", "Dateien", "JSON", "MessagePack", "CBOR");
+    for (const auto& [category, documents] : categories) {
+        json& sizes = output["sizes"][category];
+        for (const auto& [label, format] : formats) {
+            std::size_t bytes = 0;
+            for (const json& document : documents) bytes += encode_body(document, format).size();
+            sizes[label] = bytes;
+        }
+        std::printf("%-20s %7zu %12zu %12zu %12zu\n", category.c_str(), documents.size(), sizes["json"].get<std::size_t>(),
+                    sizes["msgpack"].get<std::size_t>(), sizes["cbor"].get<std::size_t>());
+    }
+
+    std::printf("\n%-42s %8s %11s %10s %10s %10s %9s %12s\n", "Benchmark", "Iter.", "Ops/s", "p50 us", "p90 us", "p99 us", "Allocs", "Alloc-Bytes");
+    for (const auto& [category, documents] : categories) {
+        for (const auto& [label, format] : formats) {
+            std::vector<std::string> encoded;
+            for (const json& document : documents) encoded.push_back(encode_body(document, format));
+            const BenchFn encode = [&, format = format](std::size_t i) { return !encode_body(documents[i % documents.size()], format).empty(); };
+            const BenchFn decode = [&, format = format](std::size_t i) { return !decode_body(encoded[i % encoded.size()], format).is_discarded(); };
+            for (BenchResult result : {measure(category + " encode " + label, iterations, 1, encode), measure(category + " decode " + label, iterations, 1, decode)}) {
+                print_result(result);
+                output["benchmarks"].push_back(result.to_json());
+            }
+        }
+    }
+
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        out << output.dump(2) << "\n";
+        if (!out) {
+            std::cerr << "formats: Konnte " << json_path << " nicht schreiben\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int run_compare(const std::vector<std::string>& args) {
+    std::vector<std::string> files;
+    double threshold = 10.0;
+    for (const std::string& arg : args) {
+        if (!option_value(arg, "--threshold").empty()) threshold = std::stod(option_value(arg, "--threshold"));
+        else files.push_back(arg);
+    }
+    if (files.size() != 2) {
+        std::cerr << "compare: <baseline.json> <aktuell.json> erwartet\n";
+        return 2;
+    }
+    auto load = [](const std::string& path) {
+        std::ifstream in(path);
+        json data = json::parse(in, nullptr, false);
+        std::map<std::string, json> by_name;
+        if (data.is_object() && data.contains("benchmarks")) {
+            for (const json& bench : data["benchmarks"]) by_name[bench.value("name", "")] = bench;
+        }
+        return by_name;
+    };
+    const std::map<std::string, json> baseline = load(files[0]);
+    const std::map<std::string, json> current = load(files[1]);
+
+    int regressions = 0;
+    std::printf("%-42s %12s %12s %9s %12s %12s %9s\n", "Benchmark", "p50 alt", "p50 neu", "Delta", "Ops/s alt", "Ops/s neu", "Delta");
+    for (const auto& [name, now] : current) {
+        auto before = baseline.find(name);
+        if (before == baseline.end()) continue;
+        const double p50_old = before->second.value("p50_us", 0.0), p50_new = now.value("p50_us", 0.0);
+        const double ops_old = before->second.value("ops_per_sec", 0.0), ops_new = now.value("ops_per_sec", 0.0);
+        const double p50_delta = p50_old > 0 ? (p50_new - p50_old) / p50_old * 100.0 : 0.0;
+        const double ops_delta = ops_old > 0 ? (ops_new - ops_old) / ops_old * 100.0 : 0.0;
+        const bool regressed = p50_delta > threshold || ops_delta < -threshold;
+        if (regressed) ++regressions;
+        std::printf("%-42s %12.1f %12.1f %+8.1f%% %12.0f %12.0f %+8.1f%%%s\n", name.c_str(), p50_old, p50_new, p50_delta, ops_old, ops_new,
+                    ops_delta, regressed ? "  REGRESSION" : "");
+    }
+    std::printf("\n%d Regression(en) über %.1f%%\n", regressions, threshold);
+    return regressions > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    logger().set_min_level(LogLevel::Warn);
+    const std::string command = argc > 1 ? argv[1] : "";
+    const std::vector<std::string> args(argv + std::min(argc, 2), argv + argc);
+    int code = 2;
+    if (command == "generate") code = run_generate(args);
+    else if (command == "run") code = run_benchmarks(args);
+    else if (command == "compare") code = run_compare(args);
+    else if (command == "formats") code = run_formats(args);
+    else std::cerr << "Aufruf: DnDApp_bench generate|run|compare|formats [Optionen] (siehe bench/bench_main.cpp)\n";
+    logger().shutdown();
+    return code;
+}
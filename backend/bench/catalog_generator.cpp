@@ -0,0 +1,350 @@
+#include "catalog_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "logger.h"
+#include "parallel.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+const std::array<double, 34> cr_values = {0, 0.125, 0.25, 0.5, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                                          14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30};
+const std::vector<std::string> sizes = {"Tiny", "Small", "Medium", "Large", "Huge", "Gargantuan"};
+const std::vector<int> hit_dice = {4, 6, 8, 10, 12, 20};
+const std::vector<std::string> types = {"Aberration", "Beast", "Celestial", "Construct", "Dragon", "Elemental", "Fey",
+                                        "Fiend", "Giant", "Humanoid", "Monstrosity", "Ooze", "Plant", "Undead"};
+const std::vector<std::string> alignments = {"Lawful Good", "Neutral Good", "Chaotic Good", "Lawful Neutral", "Neutral",
+                                             "Chaotic Neutral", "Lawful Evil", "Neutral Evil", "Chaotic Evil", "Unaligned"};
+const std::vector<std::string> damage_types = {"Acid", "Bludgeoning", "Cold", "Fire", "Force", "Lightning", "Necrotic",
+                                               "Piercing", "Poison", "Psychic", "Radiant", "Slashing", "Thunder"};
+const std::vector<std::string> conditions = {"Blinded", "Charmed", "Deafened", "Exhaustion", "Frightened", "Grappled",
+                                             "Paralyzed", "Petrified", "Poisoned", "Prone", "Restrained", "Stunned"};
+const std::vector<std::string> languages = {"Common", "Dwarvish", "Elvish", "Giant", "Gnomish", "Goblin", "Orc",
+                                            "Abyssal", "Celestial", "Draconic", "Infernal", "Sylvan", "Undercommon"};
+const std::vector<std::string> speed_types = {"walk", "swimming", "flying", "climbing", "burrowing"};
+const std::vector<std::string> stat_names = {"STR", "DEX", "CON", "INT", "WIS", "CHA"};
+const std::vector<std::string> classes = {"Bard", "Cleric", "Druid", "Paladin", "Ranger", "Sorcerer", "Warlock", "Wizard"};
+const std::vector<std::string> name_parts = {"ash", "bone", "cinder", "dusk", "ember", "frost", "gloom", "hollow", "iron",
+                                             "moss", "night", "rot", "storm", "thorn", "venom", "wraith"};
+const std::vector<std::string> name_kinds = {"wyrm", "hound", "stalker", "golem", "hag", "knight", "shade", "drake",
+                                             "crawler", "priest", "brute", "wisp"};
+
+template <typename T>
+const T& pick(std::mt19937_64& rng, const std::vector<T>& values) {
+    return values[std::uniform_int_distribution<std::size_t>(0, values.size() - 1)(rng)];
+}
+
+int roll(std::mt19937_64& rng, int low, int high) {
+    return std::uniform_int_distribution<int>(low, high)(rng);
+}
+
+// Teilmenge (0..max_count Einträge, ohne Doppelte)
+json pick_some(std::mt19937_64& rng, const std::vector<std::string>& values, int max_count) {
+    json out = json::array();
+    const int count = roll(rng, 0, max_count);
+    std::vector<std::string> pool = values;
+    std::shuffle(pool.begin(), pool.end(), rng);
+    for (int i = 0; i < count && i < static_cast<int>(pool.size()); ++i) out.push_back(pool[i]);
+    return out;
+}
+
+int proficiency_for(double cr) {
+    return cr < 5 ? 2 : 2 + static_cast<int>((cr - 1) / 4);
+}
+
+// Eher niedrige CRs, wie in echten Katalogen
+double pick_cr(std::mt19937_64& rng) {
+    std::geometric_distribution<int> distribution(0.12);
+    return cr_values[std::min<std::size_t>(cr_values.size() - 1, static_cast<std::size_t>(distribution(rng)))];
+}
+
+std::string cr_label(double cr) {
+    if (cr == 0.125) return "1-8";
+    if (cr == 0.25) return "1-4";
+    if (cr == 0.5) return "1-2";
+    return std::to_string(static_cast<int>(cr));
+}
+
+json damage_terms(std::mt19937_64& rng, double cr) {
+    json damage = json::array();
+    const int terms = roll(rng, 1, 2);
+    for (int t = 0; t < terms; ++t) {
+        damage.push_back({{"count", std::max(1, static_cast<int>(std::ceil(cr / 2.0)) + roll(rng, 0, 2))},
+                          {"size", pick(rng, std::vector<int>{4, 6, 8, 10, 12})},
+                          {"modifier", roll(rng, 0, 5)},
+                          {"type", pick(rng, damage_types)}});
+    }
+    return damage;
+}
+
+json limited_use(std::mt19937_64& rng) {
+    if (roll(rng, 0, 3) == 0) return {{"count", roll(rng, 1, 3)}, {"rate", "day"}};
+    return {{"count", nullptr}, {"rate", nullptr}};
+}
+
+json make_monster(std::mt19937_64& rng, const std::string& id, const std::string& name, double cr, bool complete) {
+    const int pb = proficiency_for(cr);
+    const std::size_t size_index = std::uniform_int_distribution<std::size_t>(0, sizes.size() - 1)(rng);
+
+    json stats = json::object();
+    json saves = json::object();
+    for (const std::string& stat : stat_names) {
+        const int score = std::clamp(roll(rng, 6, 14) + static_cast<int>(cr / 2), 1, 30);
+        stats[stat] = score;
+        const bool proficient = roll(rng, 0, 3) == 0;
+        saves[stat] = {{"defaultValue", (score - 10) / 2 + (proficient ? pb : 0)}, {"overrideValue", nullptr}, {"proficient", proficient}};
+    }
+
+    json attacks = json::array();
+    for (int i = 0, count = roll(rng, 1, 3); i < count; ++i) {
+        const bool melee = roll(rng, 0, 2) != 0;
+        attacks.push_back({{"name", (melee ? "Claw " : "Spit ") + std::to_string(i + 1)},
+                           {"attackMod", pb + roll(rng, 2, 5)},
+                           {"damage", damage_terms(rng, cr)},
+                           {"notes", ""},
+                           {"rangeType", melee ? "melee" : "ranged"},
+                           {"reachDisadvantage", melee ? json(nullptr) : json(120)},
+                           {"reachMelee", melee ? json(5) : json(nullptr)},
+                           {"reachRanged", melee ? json(nullptr) : json(30)}});
+    }
+    json saving_throws = json::array();
+    for (int i = 0, count = roll(rng, 0, 2); i < count; ++i) {
+        saving_throws.push_back({{"name", "Breath " + std::to_string(i + 1)},
+                                 {"damage", damage_terms(rng, cr)},
+                                 {"limitedUse", limited_use(rng)},
+                                 {"notes", ""},
+                                 {"recharge", pick(rng, std::vector<std::string>{"", "(5-6)", "(6-6)"})},
+                                 {"safeDC", {{"defaultValue", 8 + pb + roll(rng, 1, 5)}, {"overrideValue", nullptr}}},
+                                 {"saveStat", pick(rng, stat_names)},
+                                 {"succesOrFailNotes", ""},
+                                 {"successNotes", "Half damage."}});
+    }
+    json other = json::array();
+    if (roll(rng, 0, 2) == 0) {
+        other.push_back({{"description", "The creature moves up to its speed without provoking opportunity attacks."},
+                         {"limitedUse", limited_use(rng)}, {"name", "Skitter"}, {"recharge", ""}});
+    }
+
+    json speeds = json::array({{{"note", ""}, {"speed", 30}, {"type", "walk"}}});
+    for (const json& extra : pick_some(rng, std::vector<std::string>(speed_types.begin() + 1, speed_types.end()), 2)) {
+        speeds.push_back({{"note", ""}, {"speed", 10 * roll(rng, 2, 8)}, {"type", extra}});
+    }
+
+    std::string language_list;
+    for (const json& language : pick_some(rng, languages, 3)) {
+        language_list += (language_list.empty() ? "" : ", ") + language.get<std::string>();
+    }
+
+    json traits = json::array();
+    for (int i = 0, count = roll(rng, 0, 3); i < count; ++i) {
+        traits.push_back({{"description", "A synthetic trait used for benchmarking, with a sentence of flavour text."},
+                          {"limitedUse", limited_use(rng)}, {"name", "Trait " + std::to_string(i + 1)}});
+    }
+
+    return {
+        {"actions", {{"attackRoll", attacks}, {"other", other}, {"savingThrow", saving_throws}}},
+        {"basics",
+         {{"AC", 12 + static_cast<int>(cr / 3) + roll(rng, 0, 3)},
+          {"ACType", pick(rng, std::vector<std::string>{"Natural Armor", "Chain Shirt", "Plate", ""})},
+          {"CR", cr},
+          {"HP", {{"HDAmount", std::max(1, static_cast<int>(cr * 2.5) + roll(rng, 1, 4))}, {"HPmodifier", roll(rng, 0, 20)},
+                  {"defaultDie", hit_dice[size_index]}, {"overrideDie", hit_dice[size_index]}}},
+          {"Initiative", {{"initDefaultValue", roll(rng, -1, 5)}, {"initExpertise", false}, {"initOverrideValue", nullptr},
+                          {"initProficiency", roll(rng, 0, 1) == 1}}},
+          {"PB", pb},
+          {"alignment", pick(rng, alignments)},
+          {"id", id},
+          {"languages", language_list},
+          {"name", name},
+          {"size", sizes[size_index]},
+          {"stats", stats},
+          {"type", pick(rng, types)}}},
+        {"bonusAction", {{"attackRoll", json::array()}, {"other", json::array()}, {"savingThrow", json::array()}}},
+        {"complete", complete},
+        {"conditionImmunities", pick_some(rng, conditions, 2)},
+        {"immunities", pick_some(rng, damage_types, 2)},
+        {"inventory", ""},
+        {"lairActions", json::array()},
+        {"legendaryActions", {{"LegendaryResistanceUses", 0}, {"legendaryAction", json::array()}, {"legendaryResistanceType", ""},
+                              {"uses", cr >= 10 ? 3 : 0}, {"usesInLair", 0}}},
+        {"multiattacks", attacks.size() > 1 ? "The creature makes two attacks." : ""},
+        {"reactions", json::array()},
+        {"resistances", pick_some(rng, damage_types, 3)},
+        {"saves", saves},
+        {"senses", {{"blindsight", 0}, {"darkvision", roll(rng, 0, 1) * 60},
+                    {"passiveInsight", {{"defaultValue", 10 + (stats["WIS"].get<int>() - 10) / 2}, {"overrideValue", nullptr}}},
+                    {"passivePerception", {{"defaultValue", 10 + (stats["WIS"].get<int>() - 10) / 2}, {"overrideValue", nullptr}}},
+                    {"sensesNotes", ""}, {"tremorsense", 0}, {"truesight", 0}}},
+        {"skills", json::array()},
+        {"speeds", speeds},
+        {"spellcasting", {{"atWill", json::array()}, {"bonus", {{"defaultValue", pb + 3}, {"overrideValue", nullptr}}},
+                          {"dc", {{"defaultValue", 11 + pb}, {"overrideValue", nullptr}}}, {"hasAttackrolls", false},
+                          {"once", json::array()}, {"requiresSComponents", false}, {"stat", "INT"}, {"thrice", json::array()},
+                          {"twice", json::array()}}},
+        {"traits", traits},
+        {"vulnerabilities", pick_some(rng, damage_types, 1)},
+    };
+}
+
+json make_template(std::mt19937_64& rng, const std::string& type, const std::string& name) {
+    if (type == "trait") {
+        return {{"description", "Synthetic trait template."}, {"limitedUse", limited_use(rng)}, {"name", name}};
+    }
+    if (type == "attackRoll") {
+        return {{"attackMod", roll(rng, 3, 12)}, {"damage", damage_terms(rng, roll(rng, 0, 20))}, {"name", name}, {"notes", ""},
+                {"originalIndex", 0}, {"originalType", type}, {"rangeType", "melee"}, {"reachDisadvantage", nullptr},
+                {"reachMelee", 5}, {"reachRanged", nullptr}};
+    }
+    if (type == "savingThrow") {
+        return {{"damage", damage_terms(rng, roll(rng, 0, 20))}, {"limitedUse", limited_use(rng)}, {"name", name}, {"notes", ""},
+                {"originalIndex", 0}, {"originalType", type}, {"recharge", "(5-6)"},
+                {"safeDC", {{"defaultValue", roll(rng, 10, 20)}, {"overrideValue", nullptr}}}, {"saveStat", pick(rng, stat_names)},
+                {"succesOrFailNotes", ""}, {"successNotes", "Half damage."}};
+    }
+    return {{"description", "Synthetic template."}, {"limitedUse", limited_use(rng)}, {"name", name}, {"originalIndex", 0},
+            {"originalType", type}, {"recharge", ""}};
+}
+
+// Wird aus parallel_for-Workern benutzt: Fehler werden gemerkt statt geworfen (check() wirft danach)
+class FileWriter {
+public:
+    void write(const std::filesystem::path& path, const std::string& content) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << content;
+        if (!out) {
+            failures_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        files_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(content.size(), std::memory_order_relaxed);
+    }
+
+    void check(const std::filesystem::path& dir) const {
+        if (failures_.load() > 0) {
+            throw std::runtime_error("Could not write " + std::to_string(failures_.load()) + " files below " + dir.string());
+        }
+    }
+
+    std::size_t files() const { return files_.load(); }
+    std::uintmax_t bytes() const { return bytes_.load(); }
+
+private:
+    std::atomic<std::size_t> files_{0};
+    std::atomic<std::uintmax_t> bytes_{0};
+    std::atomic<std::size_t> failures_{0};
+};
+
+// Pro Index ein eigener Generator, damit das Ergebnis nicht von der Thread-Aufteilung abhängt
+std::mt19937_64 rng_for(std::uint64_t seed, std::uint64_t stream, std::size_t index) {
+    std::seed_seq sequence{seed, stream, static_cast<std::uint64_t>(index)};
+    return std::mt19937_64(sequence);
+}
+
+struct MonsterRef {
+    std::string id;
+    std::string name;
+    double cr = 0.0;
+};
+
+MonsterRef monster_ref(const GeneratorOptions& options, std::size_t index) {
+    std::mt19937_64 rng = rng_for(options.seed, 1, index);
+    MonsterRef ref;
+    ref.cr = pick_cr(rng);
+    const std::string part = pick(rng, name_parts);
+    const std::string kind = pick(rng, name_kinds);
+    ref.name = std::string(1, static_cast<char>(std::toupper(part[0]))) + part.substr(1) + " " + kind + " " + std::to_string(index);
+    ref.id = part + "_" + kind + "_" + std::to_string(index) + "_cr" + cr_label(ref.cr);
+    return ref;
+}
+
+} // namespace
+
+GeneratorStats generate_catalog(const GeneratorOptions& options) {
+    const auto started = std::chrono::steady_clock::now();
+    const std::filesystem::path data = options.out_dir / "data";
+    for (const char* dir : {"monsters/completed", "monsters/uncompleted", "spells", "encounters", "templates/trait",
+                            "templates/attackRoll", "templates/savingThrow", "templates/other"}) {
+        std::error_code ec;
+        std::filesystem::create_directories(data / dir, ec);
+        if (ec) throw std::runtime_error("Could not create " + (data / dir).string() + ": " + ec.message());
+    }
+    // Arbeitsverzeichnis für DnDApp_bench run (die Server-Pfade sind relativ: ../data)
+    std::filesystem::create_directories(options.out_dir / "build");
+
+    // Referenzdaten unverändert übernehmen
+    for (const char* entry : {"DnDData", "classes", "subclasses", "features", "items", "users.json"}) {
+        std::error_code ec;
+        const std::filesystem::path source = options.reference_dir / entry;
+        if (!std::filesystem::exists(source, ec)) {
+            log_warn("Referenzdaten fehlen, werden nicht kopiert", {{"path", source.string()}});
+            continue;
+        }
+        std::filesystem::copy(source, data / entry, std::filesystem::copy_options::recursive | std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) throw std::runtime_error("Could not copy " + source.string() + ": " + ec.message());
+    }
+
+    FileWriter writer;
+
+    parallel_for(options.monsters, [&](std::size_t i) {
+        const MonsterRef ref = monster_ref(options, i);
+        std::mt19937_64 rng = rng_for(options.seed, 2, i);
+        const bool complete = std::uniform_real_distribution<double>(0.0, 1.0)(rng) >= options.uncompleted_share;
+        const json monster = make_monster(rng, ref.id, ref.name, ref.cr, complete);
+        writer.write(data / "monsters" / (complete ? "completed" : "uncompleted") / (ref.id + ".json"), monster.dump(4));
+    }, 64);
+
+    json spells = json::object();
+    for (std::size_t i = 0; i < options.spells; ++i) {
+        std::mt19937_64 rng = rng_for(options.seed, 3, i);
+        const int level = roll(rng, 0, 9);
+        const std::string name = "Synthetic Spell " + std::to_string(i);
+        spells[name] = {{"name", name}, {"damage", roll(rng, 0, 1) * roll(rng, 1, 60)}, {"multitarget", roll(rng, 0, 3) == 0},
+                        {"level", level}, {"levelDisplay", level == 0 ? "Cantrip" : std::to_string(level) + " level"},
+                        {"class", pick_some(rng, classes, 3)}, {"srd", roll(rng, 0, 1) == 1}, {"custom", false}};
+    }
+    writer.write(data / "spells" / "spells.json", spells.dump(4));
+
+    const std::vector<std::string> template_types = {"trait", "attackRoll", "savingThrow", "other"};
+    parallel_for(template_types.size() * options.templates_per_type, [&](std::size_t i) {
+        const std::string& type = template_types[i / options.templates_per_type];
+        const std::size_t index = i % options.templates_per_type;
+        std::mt19937_64 rng = rng_for(options.seed, 4, i);
+        const std::string id = "bench_" + std::to_string(index);
+        writer.write(data / "templates" / type / (id + ".json"), make_template(rng, type, "Bench " + type + " " + std::to_string(index)).dump(4));
+    }, 64);
+
+    parallel_for(options.monsters == 0 ? 0 : options.encounters, [&](std::size_t i) {
+        std::mt19937_64 rng = rng_for(options.seed, 5, i);
+        json monsters = json::array();
+        for (int m = 0, count = roll(rng, 1, 4); m < count; ++m) {
+            const MonsterRef ref = monster_ref(options, std::uniform_int_distribution<std::size_t>(0, options.monsters - 1)(rng));
+            monsters.push_back({{"AC", 12 + static_cast<int>(ref.cr / 3)}, {"CR", ref.cr}, {"averageHp", std::max(1, static_cast<int>(ref.cr * 15) + 5)},
+                                {"count", roll(rng, 1, 6)}, {"initiativeBonus", roll(rng, 0, 4)}, {"monsterId", ref.id}, {"name", ref.name}});
+        }
+        const std::string id = "bench_encounter_" + std::to_string(i);
+        const json encounter = {{"calculatedDifficulty", "Medium"}, {"description", "Synthetic encounter"}, {"id", id},
+                                {"monsters", monsters}, {"name", "Bench Encounter " + std::to_string(i)},
+                                {"party", {{"averageLevel", roll(rng, 1, 20)}, {"playerCount", roll(rng, 3, 6)}}}};
+        writer.write(data / "encounters" / (id + ".json"), encounter.dump(4));
+    }, 64);
+
+    writer.check(data);
+
+    GeneratorStats stats;
+    stats.files = writer.files();
+    stats.bytes = writer.bytes();
+    stats.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return stats;
+}
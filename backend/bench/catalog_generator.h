@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// --- Synthetische Datenbestände für DnDApp_bench ---
+// Erzeugt unter out_dir/data die gleiche Struktur wie backend/data: Monster (wie t_cr5.json aufgebaut,
+// Werte passend zum CR), spells/spells.json, Templates pro Typ und Encounter, die auf erzeugte Monster
+// verweisen. Referenzdaten (DnDData, classes, subclasses, features, items, users.json) werden aus
+// reference_dir kopiert. Gleicher seed = gleiche Daten.
+
+struct GeneratorOptions {
+    std::filesystem::path out_dir;
+    std::filesystem::path reference_dir = "../data"; // backend/data, relativ zu backend/build
+    std::size_t monsters = 10000;
+    double uncompleted_share = 0.1;                  // Anteil in monsters/uncompleted
+    std::size_t spells = 5000;
+    std::size_t templates_per_type = 1000;
+    std::size_t encounters = 2000;
+    std::uint64_t seed = 42;
+};
+
+struct GeneratorStats {
+    std::size_t files = 0;
+    std::uintmax_t bytes = 0;
+    double elapsed_ms = 0.0;
+};
+
+// Wirft std::runtime_error, wenn out_dir/data nicht angelegt oder beschrieben werden kann
+GeneratorStats generate_catalog(const GeneratorOptions& options);
+// --- Ende synthetische Datenbestände ---
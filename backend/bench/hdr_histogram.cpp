@@ -0,0 +1,101 @@
+#include "hdr_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+constexpr std::uint64_t sub_bucket_count = std::uint64_t{1} << HdrHistogram::sub_bucket_bits;
+constexpr std::size_t bucket_count = sub_bucket_count * (HdrHistogram::max_value_bits - HdrHistogram::sub_bucket_bits + 1);
+constexpr std::uint64_t max_trackable = (std::uint64_t{1} << HdrHistogram::max_value_bits) - 1;
+
+unsigned highest_bit(std::uint64_t value) {
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+}
+} // namespace
+
+HdrHistogram::HdrHistogram() : counts_(bucket_count, 0) {}
+
+// Index 0..S-1: exakt; danach pro Exponent e >= 0 je S Buckets der Breite 2^e
+std::size_t HdrHistogram::index_of(std::uint64_t value) {
+    value = std::min(value, max_trackable);
+    if (value < sub_bucket_count) return static_cast<std::size_t>(value);
+    const unsigned exponent = highest_bit(value) - sub_bucket_bits;
+    return static_cast<std::size_t>(sub_bucket_count * (exponent + 1) + ((value >> exponent) - sub_bucket_count));
+}
+
+std::uint64_t HdrHistogram::highest_equivalent(std::size_t index) {
+    if (index < sub_bucket_count) return index;
+    const std::uint64_t exponent = index / sub_bucket_count - 1;
+    const std::uint64_t sub = index % sub_bucket_count;
+    return ((sub_bucket_count + sub) << exponent) + (std::uint64_t{1} << exponent) - 1;
+}
+
+void HdrHistogram::record(std::uint64_t micros) {
+    ++counts_[index_of(micros)];
+    ++count_;
+    sum_ += micros;
+    min_ = std::min(min_, micros);
+    max_ = std::max(max_, micros);
+}
+
+void HdrHistogram::merge(const HdrHistogram& other) {
+    for (std::size_t i = 0; i < counts_.size(); ++i) counts_[i] += other.counts_[i];
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+std::uint64_t HdrHistogram::value_at_percentile(double percentile) const {
+    if (count_ == 0) return 0;
+    const double clamped = std::clamp(percentile, 0.0, 100.0);
+    const std::uint64_t target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * count_)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= target) return std::min(highest_equivalent(i), max_);
+    }
+    return max_;
+}
+
+// Wie HdrHistogram::outputPercentileDistribution: Perzentil-Schritte halbieren den Rest jeweils
+void HdrHistogram::write_percentile_distribution(std::ostream& out, int ticks_per_half) const {
+    char line[128];
+    out << "       Value     Percentile TotalCount 1/(1-Percentile)\n\n";
+    if (count_ > 0) {
+        double percentile = 0.0;
+        double step = 100.0 / (2.0 * ticks_per_half);
+        int ticks = 0;
+        std::uint64_t last_value = UINT64_MAX;
+        while (percentile < 100.0) {
+            const std::uint64_t value = value_at_percentile(percentile);
+            if (value != last_value || percentile == 0.0) {
+                std::uint64_t total = 0;
+                for (std::size_t i = 0; i < counts_.size() && highest_equivalent(i) <= value; ++i) total += counts_[i];
+                std::snprintf(line, sizeof(line), "%12llu %14.12f %10llu %14.2f\n", static_cast<unsigned long long>(value),
+                              percentile / 100.0, static_cast<unsigned long long>(total), 1.0 / (1.0 - percentile / 100.0));
+                out << line;
+                last_value = value;
+            }
+            percentile += step;
+            if (++ticks == ticks_per_half) {
+                ticks = 0;
+                step /= 2.0;
+            }
+            if (step < 1e-9) break;
+        }
+        std::snprintf(line, sizeof(line), "%12llu %14.12f %10llu\n", static_cast<unsigned long long>(max_), 1.0,
+                      static_cast<unsigned long long>(count_));
+        out << line;
+    }
+    std::snprintf(line, sizeof(line), "#[Mean    = %12.3f, StdDeviation   = n/a]\n#[Max     = %12llu, Total count    = %12llu]\n",
+                  mean(), static_cast<unsigned long long>(max_), static_cast<unsigned long long>(count_));
+    out << line;
+}
+
+nlohmann::json HdrHistogram::summary() const {
+    return {{"count", count_}, {"mean_us", mean()}, {"min_us", min()}, {"p50_us", value_at_percentile(50)},
+            {"p90_us", value_at_percentile(90)}, {"p99_us", value_at_percentile(99)}, {"p99_9_us", value_at_percentile(99.9)},
+            {"p99_99_us", value_at_percentile(99.99)}, {"max_us", max_}};
+}
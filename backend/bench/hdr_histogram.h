@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+// --- Latenz-Histogramm für DnDApp_loadgen (HDR-artig) ---
+// Wie LatencyHistogram aus metrics.h log-linear in Mikrosekunden, aber mit 2^sub_bucket_bits Unterteilungen
+// pro Zweierpotenz (relative Abweichung < 1% statt 12.5%) und ohne Atomics: ein Histogramm pro Worker und
+// Route, am Ende per merge() zusammengeführt. record() allokiert nicht.
+
+class HdrHistogram {
+public:
+    static constexpr unsigned sub_bucket_bits = 7;
+    static constexpr unsigned max_value_bits = 36; // ca. 19 Stunden; größere Werte landen im letzten Bucket
+
+    HdrHistogram();
+
+    void record(std::uint64_t micros);
+    void merge(const HdrHistogram& other);
+
+    std::uint64_t count() const { return count_; }
+    std::uint64_t min() const { return count_ ? min_ : 0; }
+    std::uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+    // Höchster Wert, der im Bucket des Perzentils liegt (p in [0, 100])
+    std::uint64_t value_at_percentile(double percentile) const;
+
+    // Perzentil-Verteilung im Textformat von HdrHistogram (Value, Percentile, TotalCount, 1/(1-Percentile))
+    void write_percentile_distribution(std::ostream& out, int ticks_per_half = 5) const;
+    // {"count", "mean_us", "min_us", "p50_us", "p90_us", "p99_us", "p99_9_us", "p99_99_us", "max_us"}
+    nlohmann::json summary() const;
+
+private:
+    static std::size_t index_of(std::uint64_t value);
+    static std::uint64_t highest_equivalent(std::size_t index);
+
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t min_ = UINT64_MAX;
+    std::uint64_t max_ = 0;
+};
+// --- Ende HDR-Histogramm ---
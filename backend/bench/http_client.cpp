@@ -0,0 +1,183 @@
+#include "http_client.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+} // namespace
+
+HttpClient::HttpClient(const std::string& target) {
+    std::string rest = target;
+    if (rest.rfind("http://", 0) == 0) rest = rest.substr(7);
+    rest = rest.substr(0, rest.find('/'));
+    const std::size_t colon = rest.rfind(':');
+    host_ = colon == std::string::npos ? rest : rest.substr(0, colon);
+    port_ = colon == std::string::npos ? "80" : rest.substr(colon + 1);
+    if (host_.empty() || port_.empty() || !std::all_of(port_.begin(), port_.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        throw std::invalid_argument("Invalid target '" + target + "' (expected http://host:port)");
+    }
+}
+
+HttpClient::~HttpClient() {
+    close_socket();
+}
+
+bool HttpClient::connect_socket(std::string& error) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    if (const int rc = getaddrinfo(host_.c_str(), port_.c_str(), &hints, &addresses); rc != 0) {
+        error = gai_strerror(rc);
+        return false;
+    }
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+        fd_ = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd_ < 0) continue;
+        if (connect(fd_, address->ai_addr, address->ai_addrlen) == 0) break;
+        close(fd_);
+        fd_ = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd_ < 0) {
+        error = std::string("connect: ") + std::strerror(errno);
+        return false;
+    }
+    const int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    buffer_.clear();
+    return true;
+}
+
+void HttpClient::close_socket() {
+    if (fd_ >= 0) close(fd_);
+    fd_ = -1;
+    buffer_.clear();
+}
+
+bool HttpClient::send_all(const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        const ssize_t n = send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool HttpClient::read_response(HttpResult& result, bool& keep_alive) {
+    char chunk[16384];
+    auto fill = [&]() {
+        for (;;) {
+            const ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer_.append(chunk, static_cast<std::size_t>(n));
+            return true;
+        }
+    };
+
+    std::size_t header_end;
+    while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+        if (!fill()) {
+            result.error = "connection closed before response header";
+            return false;
+        }
+    }
+
+    // Statuszeile: "HTTP/1.1 200 OK"
+    const std::size_t first_line_end = buffer_.find("\r\n");
+    const std::size_t space = buffer_.find(' ');
+    if (space == std::string::npos || space > first_line_end) {
+        result.error = "malformed status line";
+        return false;
+    }
+    result.status = std::atoi(buffer_.c_str() + space + 1);
+
+    std::size_t content_length = 0;
+    bool has_length = false;
+    keep_alive = buffer_.compare(0, 8, "HTTP/1.0") != 0;
+    std::size_t line_start = first_line_end + 2;
+    while (line_start < header_end) {
+        const std::size_t line_end = buffer_.find("\r\n", line_start);
+        const std::size_t colon = buffer_.find(':', line_start);
+        if (colon != std::string::npos && colon < line_end) {
+            const std::string name = lowercase(buffer_.substr(line_start, colon - line_start));
+            std::size_t value_start = colon + 1;
+            while (value_start < line_end && buffer_[value_start] == ' ') ++value_start;
+            const std::string value = buffer_.substr(value_start, line_end - value_start);
+            if (name == "content-length") {
+                content_length = std::strtoull(value.c_str(), nullptr, 10);
+                has_length = true;
+            } else if (name == "connection") {
+                keep_alive = lowercase(value) != "close";
+            } else if (name == "transfer-encoding" && lowercase(value) != "identity") {
+                result.error = "unsupported transfer-encoding " + value;
+                return false;
+            }
+        }
+        line_start = line_end + 2;
+    }
+    if (!has_length) {
+        // Ohne Content-Length endet der Body mit der Verbindung
+        while (fill()) {}
+        content_length = buffer_.size() - (header_end + 4);
+        keep_alive = false;
+    }
+    while (buffer_.size() < header_end + 4 + content_length) {
+        if (!fill()) {
+            result.error = "connection closed before end of body";
+            return false;
+        }
+    }
+    result.body.assign(buffer_, header_end + 4, content_length);
+    buffer_.erase(0, header_end + 4 + content_length);
+    return true;
+}
+
+HttpResult HttpClient::request(const std::string& method, const std::string& path, const std::string& body) {
+    std::string message = method + " " + path + " HTTP/1.1\r\nHost: " + host_ + ":" + port_ + "\r\nConnection: keep-alive\r\n";
+    if (!body.empty() || method == "POST" || method == "PUT" || method == "PATCH") {
+        message += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    message += "\r\n";
+    message += body;
+
+    // Eine gerade geschlossene Keep-Alive-Verbindung (Server-Timeout) fällt erst beim Senden/Lesen auf:
+    // dann genau einmal neu verbinden
+    HttpResult result;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        const bool fresh = fd_ < 0;
+        if (fresh) {
+            if (!connect_socket(result.error)) return result;
+            ++connections_;
+        }
+        result = HttpResult{};
+        bool keep_alive = true;
+        if (send_all(message) && read_response(result, keep_alive)) {
+            if (!keep_alive) close_socket();
+            return result;
+        }
+        if (result.error.empty()) result.error = std::string("send: ") + std::strerror(errno);
+        close_socket();
+        if (fresh) break;
+    }
+    result.status = 0;
+    return result;
+}
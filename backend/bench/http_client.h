@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+// --- Minimaler HTTP/1.1-Client für DnDApp_loadgen ---
+// Eine blockierende Keep-Alive-Verbindung (POSIX-Sockets, TCP_NODELAY). Antworten müssen Content-Length
+// tragen (wie alle Antworten von Crow ohne Streaming). Nach Fehlern oder "Connection: close" wird beim
+// nächsten request() neu verbunden. Nicht thread-sicher: eine Instanz pro Worker.
+
+struct HttpResult {
+    int status = 0;         // 0 = Verbindungs-/Protokollfehler (siehe error)
+    std::string body;
+    std::string error;
+};
+
+class HttpClient {
+public:
+    // target: "http://host:port" oder "host:port"; wirft std::invalid_argument bei ungültigem Ziel
+    explicit HttpClient(const std::string& target);
+    ~HttpClient();
+    HttpClient(const HttpClient&) = delete;
+    HttpClient& operator=(const HttpClient&) = delete;
+
+    HttpResult request(const std::string& method, const std::string& path, const std::string& body = "");
+    // Anzahl aufgebauter Verbindungen (1 = Keep-Alive hat durchgehend gehalten)
+    std::size_t connections() const { return connections_; }
+
+private:
+    bool connect_socket(std::string& error);
+    void close_socket();
+    bool send_all(const std::string& data);
+    bool read_response(HttpResult& result, bool& keep_alive);
+
+    std::string host_;
+    std::string port_;
+    int fd_ = -1;
+    std::size_t connections_ = 0;
+    std::string buffer_; // Bereits empfangene, noch nicht verarbeitete Bytes
+};
+// --- Ende HTTP-Client ---
@@ -0,0 +1,559 @@
+// DnDApp_loadgen: HTTP-Last gegen einen laufenden Server oder eine Instanz im selben Prozess.
+//
+//   DnDApp_loadgen [--target=http://127.0.0.1:8080 | --inprocess[=18080] [--server-threads=<n>]]
+//                  [--mix=session-night|<mix.json> | --replay=<datei>] [--connections=16] [--rate=0]
+//                  [--duration=30] [--warmup=5] [--seed=1] [--json=<datei>] [--hdr-dir=<verz>] [--print-mix]
+//
+// --connections: parallele Keep-Alive-Verbindungen, je ein Thread.
+// --rate: 0 = geschlossene Schleife (jede Verbindung sendet sofort die nächste Anfrage). Sonst Anfragen pro
+//   Sekunde insgesamt mit festem Sendeplan (offene Schleife): die Latenz zählt ab dem geplanten Sendezeitpunkt,
+//   Wartezeit hinter einer langsamen Antwort geht also mit ein (keine "coordinated omission").
+// --inprocess: startet die Routen von DnDApp auf 127.0.0.1 (aus backend/build bzw. <generate-out>/build starten);
+//   --server-threads setzt Crows concurrency(), Standard wie DnDApp multithreaded() = alle Kerne.
+// --hdr-dir: Perzentil-Verteilung pro Route im HdrHistogram-Textformat (<route>.hgrm, zum Plotten).
+//
+// Mix-Datei (--print-mix gibt den eingebauten "session-night"-Mix als Vorlage aus):
+//   {"name": "...", "requests": [{"name": "statblock", "weight": 80, "method": "GET", "path": "/api/monsters/{monster}"}, ...]}
+//   Platzhalter im Pfad: {monster}, {encounter}, {trait} (zufällige vorhandene IDs). "body" ist ein JSON-Wert
+//   oder "@statblock": der aktuelle Statblock von {monster} (aus einem festen Pool), unverändert zurückgeschrieben.
+// Replay-Datei: Zeilen "METHODE /pfad [json-body]" oder Log-Zeilen von DnDApp mit --log-level=debug
+//   (msg=Anfrage method=... url=...; ohne Query-String und Body, schreibende Anfragen ohne Body werden übersprungen).
+//   Die Zeilen werden reihum von allen Verbindungen abgearbeitet, bis --duration abgelaufen ist.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "crow.h"
+#include "nlohmann/json.hpp"
+
+#include "hdr_histogram.h"
+#include "http_client.h"
+#include "logger.h"
+#include "server.h"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+const char* session_night_mix = R"({
+    "name": "session-night",
+    "requests": [
+        {"name": "statblock", "weight": 80, "method": "GET", "path": "/api/monsters/{monster}"},
+        {"name": "encounter", "weight": 10, "method": "GET", "path": "/api/encounters/{encounter}?hydrate=true"},
+        {"name": "summary", "weight": 5, "method": "GET", "path": "/api/monsters/summary"},
+        {"name": "save statblock", "weight": 5, "method": "PUT", "path": "/api/monsters/{monster}", "body": "@statblock"}
+    ]
+})";
+
+constexpr std::size_t statblock_pool_size = 32; // Monster, die "@statblock"-Anfragen zurückschreiben
+
+struct Options {
+    std::string target = "http://127.0.0.1:8080";
+    bool inprocess = false;
+    std::uint16_t inprocess_port = 18080;
+    std::size_t server_threads = 0; // 0 = multithreaded()
+    std::string mix = "session-night";
+    std::string replay;
+    std::size_t connections = 16;
+    double rate = 0.0;
+    double duration_s = 30.0;
+    double warmup_s = 5.0;
+    std::uint64_t seed = 1;
+    std::string json_path;
+    std::string hdr_dir;
+};
+
+// Eine Anfrage-Art: Eintrag eines Mixes oder eine Routen-Gruppe beim Replay
+struct Route {
+    std::string name;
+    std::string method;
+    std::string path;
+    double weight = 0.0;
+    std::string body;
+    bool statblock_body = false;
+};
+
+struct ReplayEntry {
+    std::size_t route;
+    std::string method;
+    std::string path;
+    std::string body;
+};
+
+// Zufällige IDs für die Platzhalter
+struct Pools {
+    std::vector<std::string> monsters;
+    std::vector<std::string> encounters;
+    std::vector<std::string> traits;
+    std::vector<std::string> statblock_ids;
+    std::vector<std::string> statblock_bodies;
+};
+
+struct WorkerStats {
+    std::vector<HdrHistogram> latency;               // Index = Route
+    std::vector<std::array<std::uint64_t, 6>> status; // 0 = Verbindungsfehler, 1..5 = 1xx..5xx
+    std::size_t connections = 0;
+    std::uint64_t unsent = 0; // Offene Schleife: geplant, aber bis zum Ende nicht mehr gesendet
+    std::string last_error;
+};
+
+std::string option_value(const std::string& arg, const std::string& name) {
+    return arg.rfind(name + "=", 0) == 0 ? arg.substr(name.size() + 1) : std::string();
+}
+
+// Feld aus einer logfmt-Zeile (Werte ggf. in Anführungszeichen)
+std::string logfmt_field(const std::string& line, const std::string& key) {
+    const std::size_t start = line.find(" " + key + "=");
+    if (start == std::string::npos) return "";
+    std::size_t pos = start + key.size() + 2;
+    std::string value;
+    if (pos < line.size() && line[pos] == '"') {
+        for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+            if (line[pos] == '\\' && pos + 1 < line.size()) ++pos;
+            value += line[pos];
+        }
+        return value;
+    }
+    const std::size_t end = line.find(' ', pos);
+    return line.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
+
+// Gruppiert URLs wie /api/metrics nach CROW_ROUTE-Muster (spezifischstes Muster gewinnt)
+std::string route_group(const std::string& method, const std::string& url) {
+    auto split = [](const std::string& path) {
+        std::vector<std::string> segments;
+        std::stringstream stream(path.substr(0, path.find('?')));
+        for (std::string segment; std::getline(stream, segment, '/');) {
+            if (!segment.empty()) segments.push_back(segment);
+        }
+        return segments;
+    };
+    const std::vector<std::string> segments = split(url);
+    const std::string* best = nullptr;
+    std::size_t best_literals = 0;
+    for (const std::string& pattern : route_patterns()) {
+        const std::vector<std::string> parts = split(pattern);
+        if (parts.size() != segments.size()) continue;
+        std::size_t literals = 0;
+        bool matches = true;
+        for (std::size_t i = 0; i < parts.size() && matches; ++i) {
+            const bool placeholder = parts[i].front() == '<';
+            matches = placeholder || parts[i] == segments[i];
+            if (!placeholder) ++literals;
+        }
+        if (matches && (!best || literals > best_literals)) {
+            best = &pattern;
+            best_literals = literals;
+        }
+    }
+    return method + " " + (best ? *best : std::string("other"));
+}
+
+std::vector<Route> load_mix(const std::string& mix) {
+    json data;
+    if (mix == "session-night") {
+        data = json::parse(session_night_mix);
+    } else {
+        std::ifstream in(mix);
+        if (!in) throw std::runtime_error("Cannot open mix file " + mix);
+        data = json::parse(in);
+    }
+    std::vector<Route> routes;
+    for (const json& entry : data.at("requests")) {
+        Route route;
+        route.method = entry.value("method", "GET");
+        route.path = entry.at("path").get<std::string>();
+        route.name = entry.value("name", route.method + " " + route.path);
+        route.weight = entry.value("weight", 1.0);
+        if (entry.contains("body")) {
+            const json& body = entry["body"];
+            route.statblock_body = body.is_string() && body.get<std::string>() == "@statblock";
+            route.body = route.statblock_body ? "" : (body.is_string() ? body.get<std::string>() : body.dump());
+        }
+        if (route.weight <= 0.0) continue;
+        routes.push_back(std::move(route));
+    }
+    if (routes.empty()) throw std::runtime_error("Mix has no requests with weight > 0");
+    return routes;
+}
+
+std::vector<ReplayEntry> load_replay(const std::string& path, std::vector<Route>& routes, std::size_t& skipped) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Cannot open replay file " + path);
+    std::vector<ReplayEntry> entries;
+    std::map<std::string, std::size_t> route_index;
+    for (std::string line; std::getline(in, line);) {
+        ReplayEntry entry;
+        if (line.find(" msg=Anfrage ") != std::string::npos) {
+            entry.method = logfmt_field(line, "method");
+            entry.path = logfmt_field(line, "url");
+        } else {
+            std::istringstream stream(line);
+            stream >> entry.method >> entry.path;
+            std::getline(stream >> std::ws, entry.body);
+        }
+        if (entry.method.empty() || entry.path.empty() || entry.path.front() != '/' || entry.method == "OPTIONS") continue;
+        if ((entry.method == "POST" || entry.method == "PUT" || entry.method == "PATCH") && entry.body.empty()) {
+            ++skipped;
+            continue;
+        }
+        const std::string group = route_group(entry.method, entry.path);
+        auto [it, inserted] = route_index.emplace(group, routes.size());
+        if (inserted) routes.push_back(Route{group, entry.method, "", 0.0, "", false});
+        entry.route = it->second;
+        entries.push_back(std::move(entry));
+    }
+    if (entries.empty()) throw std::runtime_error("Replay file contains no requests");
+    return entries;
+}
+
+std::vector<std::string> fetch_ids(HttpClient& client, const std::string& path) {
+    const HttpResult result = client.request("GET", path);
+    if (result.status != 200) throw std::runtime_error("GET " + path + " failed: " + (result.error.empty() ? std::to_string(result.status) : result.error));
+    std::vector<std::string> ids;
+    for (const json& item : json::parse(result.body)) {
+        if (item.is_object() && item.contains("id") && item["id"].is_string()) ids.push_back(item["id"].get<std::string>());
+    }
+    return ids;
+}
+
+Pools prepare_pools(HttpClient& client, const std::vector<Route>& routes) {
+    Pools pools;
+    auto uses = [&](const char* placeholder) {
+        return std::any_of(routes.begin(), routes.end(), [&](const Route& r) { return r.path.find(placeholder) != std::string::npos; });
+    };
+    const bool statblocks = std::any_of(routes.begin(), routes.end(), [](const Route& r) { return r.statblock_body; });
+    if (uses("{monster}") || statblocks) pools.monsters = fetch_ids(client, "/api/monsters/summary");
+    if (uses("{encounter}")) pools.encounters = fetch_ids(client, "/api/encounters");
+    if (uses("{trait}")) pools.traits = fetch_ids(client, "/api/templates/trait");
+    if ((uses("{monster}") && pools.monsters.empty()) || (uses("{encounter}") && pools.encounters.empty()) ||
+        (uses("{trait}") && pools.traits.empty())) {
+        throw std::runtime_error("Target has no monsters/encounters/trait templates for the mix placeholders");
+    }
+    if (statblocks) {
+        for (std::size_t i = 0; i < pools.monsters.size() && pools.statblock_ids.size() < statblock_pool_size; ++i) {
+            const HttpResult result = client.request("GET", "/api/monsters/" + pools.monsters[i]);
+            if (result.status != 200) continue;
+            pools.statblock_ids.push_back(pools.monsters[i]);
+            pools.statblock_bodies.push_back(result.body);
+        }
+        if (pools.statblock_ids.empty()) throw std::runtime_error("No statblocks available for @statblock bodies");
+    }
+    return pools;
+}
+
+void replace_all(std::string& text, const std::string& from, const std::string& to) {
+    for (std::size_t pos = text.find(from); pos != std::string::npos; pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+}
+
+// Nicht erreichbar: nach 30 s aufgeben; erreichbar, aber noch im Warm-Start: bis timeout warten
+bool wait_until_warm(HttpClient& client, std::chrono::seconds timeout) {
+    const auto started = Clock::now();
+    while (Clock::now() < started + timeout) {
+        const HttpResult result = client.request("GET", "/api/status");
+        if (result.status == 0 && Clock::now() > started + std::chrono::seconds(30)) {
+            std::cerr << "loadgen: " << result.error << "\n";
+            return false;
+        }
+        const json status = json::parse(result.body, nullptr, false);
+        if (status.is_object() && status.value("warm", false)) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return false;
+}
+
+void print_row(const std::string& name, const HdrHistogram& latency, const std::array<std::uint64_t, 6>& status, double seconds) {
+    const std::uint64_t failed = status[0] + status[4] + status[5];
+    std::printf("%-34s %9llu %9.1f %9.2f %9.2f %9.2f %9.2f %9.2f %8llu\n", name.c_str(), static_cast<unsigned long long>(latency.count()),
+                latency.count() / seconds, latency.value_at_percentile(50) / 1000.0, latency.value_at_percentile(90) / 1000.0,
+                latency.value_at_percentile(99) / 1000.0, latency.value_at_percentile(99.9) / 1000.0, latency.max() / 1000.0,
+                static_cast<unsigned long long>(failed));
+}
+
+json route_json(const std::string& name, const HdrHistogram& latency, const std::array<std::uint64_t, 6>& status, double seconds) {
+    return {{"name", name}, {"requests", latency.count()}, {"rps", latency.count() / seconds},
+            {"status", {{"errors", status[0]}, {"1xx", status[1]}, {"2xx", status[2]}, {"3xx", status[3]}, {"4xx", status[4]}, {"5xx", status[5]}}},
+            {"latency", latency.summary()}};
+}
+
+std::string file_name_for(const std::string& route) {
+    std::string name;
+    for (char c : route) name += std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+    return name + ".hgrm";
+}
+
+int run(const Options& options) {
+    // Anfrage-Arten laden
+    std::vector<Route> routes;
+    std::vector<ReplayEntry> replay;
+    std::size_t replay_skipped = 0;
+    if (!options.replay.empty()) {
+        replay = load_replay(options.replay, routes, replay_skipped);
+    } else {
+        routes = load_mix(options.mix);
+    }
+
+    // Server im selben Prozess
+    std::unique_ptr<DnDServer> server;
+    std::future<void> server_done;
+    std::string target = options.target;
+    if (options.inprocess) {
+        start_services();
+        server = std::make_unique<DnDServer>();
+        register_routes(*server, false);
+        server->loglevel(crow::LogLevel::Warning);
+        server->bindaddr("127.0.0.1").port(options.inprocess_port);
+        if (options.server_threads > 0) {
+            server->concurrency(static_cast<std::uint16_t>(options.server_threads));
+        } else {
+            server->multithreaded();
+        }
+        server_done = server->run_async();
+        server->wait_for_server_start();
+        target = "http://127.0.0.1:" + std::to_string(options.inprocess_port);
+    }
+    auto shutdown_server = [&]() {
+        if (!server) return;
+        server->stop();
+        server_done.wait();
+        stop_services();
+        server.reset();
+    };
+
+    Pools pools;
+    try {
+        HttpClient setup(target);
+        if (!wait_until_warm(setup, std::chrono::minutes(10))) throw std::runtime_error("Target " + target + " did not report warm:true");
+        if (replay.empty()) pools = prepare_pools(setup, routes);
+    } catch (const std::exception& e) {
+        std::cerr << "loadgen: " << e.what() << "\n";
+        shutdown_server();
+        return 1;
+    }
+
+    std::vector<double> cumulative;
+    double total_weight = 0.0;
+    for (const Route& route : routes) cumulative.push_back(total_weight += route.weight);
+
+    std::printf("Ziel %s, %s, %zu Verbindung(en), %s, %.0f s (+%.0f s Aufwärmen)\n", target.c_str(),
+                options.replay.empty() ? ("Mix " + options.mix).c_str() : ("Replay " + options.replay).c_str(), options.connections,
+                options.rate > 0 ? (std::to_string(static_cast<long long>(options.rate)) + " Anfragen/s (offene Schleife)").c_str()
+                                 : "geschlossene Schleife",
+                options.duration_s, options.warmup_s);
+    if (replay_skipped > 0) std::printf("%zu schreibende Replay-Anfragen ohne Body übersprungen\n", replay_skipped);
+
+    const auto start = Clock::now();
+    const auto measure_start = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmup_s));
+    const auto end = measure_start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration_s));
+    // Abstand zwischen zwei geplanten Anfragen einer Verbindung; Verbindungen sind um 1/rate versetzt
+    const auto interval = options.rate > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.connections / options.rate))
+                                           : Clock::duration::zero();
+    std::atomic<std::size_t> replay_cursor{0};
+    std::vector<WorkerStats> stats(options.connections);
+
+    auto worker = [&](std::size_t index) {
+        WorkerStats& own = stats[index];
+        own.latency.resize(routes.size());
+        own.status.assign(routes.size(), {});
+        std::mt19937_64 rng(options.seed * 1000003u + index);
+        std::uniform_real_distribution<double> pick(0.0, total_weight);
+        HttpClient client(target);
+        auto next = start + interval / static_cast<Clock::duration::rep>(options.connections) * static_cast<Clock::duration::rep>(index);
+
+        while (true) {
+            const auto now = Clock::now();
+            auto intended = now;
+            if (now >= end) {
+                // Rückstand der offenen Schleife (Rate für die Verbindungen zu hoch) zählen statt nachholen
+                for (; interval != Clock::duration::zero() && next < end; next += interval) {
+                    if (next >= measure_start) ++own.unsent;
+                }
+                break;
+            }
+            if (interval != Clock::duration::zero()) {
+                intended = next;
+                next += interval;
+                if (intended >= end) break;
+                std::this_thread::sleep_until(intended); // Liegt der Plan zurück, sofort senden
+            }
+
+            std::size_t route_index;
+            std::string path;
+            const std::string* body;
+            std::string method;
+            if (!replay.empty()) {
+                const ReplayEntry& entry = replay[replay_cursor.fetch_add(1, std::memory_order_relaxed) % replay.size()];
+                route_index = entry.route;
+                method = entry.method;
+                path = entry.path;
+                body = &entry.body;
+            } else {
+                route_index = static_cast<std::size_t>(std::upper_bound(cumulative.begin(), cumulative.end(), pick(rng)) - cumulative.begin());
+                route_index = std::min(route_index, routes.size() - 1);
+                const Route& route = routes[route_index];
+                method = route.method;
+                path = route.path;
+                body = &route.body;
+                if (route.statblock_body) {
+                    const std::size_t k = rng() % pools.statblock_ids.size();
+                    replace_all(path, "{monster}", pools.statblock_ids[k]);
+                    body = &pools.statblock_bodies[k];
+                }
+                if (!pools.monsters.empty()) replace_all(path, "{monster}", pools.monsters[rng() % pools.monsters.size()]);
+                if (!pools.encounters.empty()) replace_all(path, "{encounter}", pools.encounters[rng() % pools.encounters.size()]);
+                if (!pools.traits.empty()) replace_all(path, "{trait}", pools.traits[rng() % pools.traits.size()]);
+            }
+
+            const HttpResult result = client.request(method, path, *body);
+            const auto done = Clock::now();
+            if (intended < measure_start) continue;
+            own.latency[route_index].record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(done - intended).count()));
+            own.status[route_index][result.status >= 100 && result.status < 600 ? result.status / 100 : 0]++;
+            if (result.status == 0) own.last_error = result.error;
+        }
+        own.connections = client.connections();
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < options.connections; ++i) threads.emplace_back(worker, i);
+    for (std::thread& thread : threads) thread.join();
+    const double seconds = std::chrono::duration<double>(std::max(Clock::now(), end) - measure_start).count();
+    shutdown_server();
+
+    // Zusammenführen und ausgeben
+    std::vector<HdrHistogram> latency(routes.size());
+    std::vector<std::array<std::uint64_t, 6>> status(routes.size(), std::array<std::uint64_t, 6>{});
+    HdrHistogram total_latency;
+    std::array<std::uint64_t, 6> total_status{};
+    std::size_t connections = 0;
+    std::uint64_t unsent = 0;
+    std::string last_error;
+    for (const WorkerStats& own : stats) {
+        for (std::size_t r = 0; r < routes.size(); ++r) {
+            latency[r].merge(own.latency[r]);
+            total_latency.merge(own.latency[r]);
+            for (std::size_t s = 0; s < 6; ++s) {
+                status[r][s] += own.status[r][s];
+                total_status[s] += own.status[r][s];
+            }
+        }
+        connections += own.connections;
+        unsent += own.unsent;
+        if (!own.last_error.empty()) last_error = own.last_error;
+    }
+
+    std::printf("\n%-34s %9s %9s %9s %9s %9s %9s %9s %8s\n", "Route", "Anfragen", "Req/s", "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms", "Fehler");
+    for (std::size_t r = 0; r < routes.size(); ++r) print_row(routes[r].name, latency[r], status[r], seconds);
+    print_row("gesamt", total_latency, total_status, seconds);
+    if (unsent > 0) {
+        std::printf("\n%llu geplante Anfragen nicht gesendet (Rate mit %zu Verbindungen nicht erreichbar)\n",
+                    static_cast<unsigned long long>(unsent), options.connections);
+    }
+    if (connections > options.connections) std::printf("\n%zu Verbindungen aufgebaut (Keep-Alive unterbrochen)\n", connections);
+    if (!last_error.empty()) std::printf("Letzter Verbindungsfehler: %s\n", last_error.c_str());
+
+    if (!options.hdr_dir.empty()) {
+        std::filesystem::create_directories(options.hdr_dir);
+        for (std::size_t r = 0; r <= routes.size(); ++r) {
+            const bool total = r == routes.size();
+            std::ofstream out(std::filesystem::path(options.hdr_dir) / file_name_for(total ? "total" : routes[r].name));
+            (total ? total_latency : latency[r]).write_percentile_distribution(out);
+        }
+    }
+    if (!options.json_path.empty()) {
+        json output = {{"config", {{"target", options.inprocess ? "inprocess" : target}, {"mix", options.replay.empty() ? options.mix : options.replay},
+                                   {"connections", options.connections}, {"rate", options.rate}, {"duration_s", options.duration_s},
+                                   {"warmup_s", options.warmup_s}, {"server_threads", options.server_threads},
+                                   {"hardware_threads", std::thread::hardware_concurrency()}}},
+                       {"routes", json::array()},
+                       {"total", route_json("total", total_latency, total_status, seconds)},
+                       {"unsent", unsent}};
+        for (std::size_t r = 0; r < routes.size(); ++r) output["routes"].push_back(route_json(routes[r].name, latency[r], status[r], seconds));
+        std::ofstream out(options.json_path);
+        out << output.dump(2) << "\n";
+        if (!out) {
+            std::cerr << "loadgen: Konnte " << options.json_path << " nicht schreiben\n";
+            return 1;
+        }
+    }
+    return total_status[0] > 0 || total_status[5] > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    logger().set_min_level(LogLevel::Warn);
+    Options options;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            if (arg == "--print-mix") {
+                std::cout << json::parse(session_night_mix).dump(4) << "\n";
+                return 0;
+            } else if (arg == "--inprocess") {
+                options.inprocess = true;
+            } else if (!option_value(arg, "--inprocess").empty()) {
+                options.inprocess = true;
+                options.inprocess_port = static_cast<std::uint16_t>(std::stoul(option_value(arg, "--inprocess")));
+            } else if (!option_value(arg, "--target").empty()) {
+                options.target = option_value(arg, "--target");
+            } else if (!option_value(arg, "--server-threads").empty()) {
+                options.server_threads = std::stoull(option_value(arg, "--server-threads"));
+            } else if (!option_value(arg, "--mix").empty()) {
+                options.mix = option_value(arg, "--mix");
+            } else if (!option_value(arg, "--replay").empty()) {
+                options.replay = option_value(arg, "--replay");
+            } else if (!option_value(arg, "--connections").empty()) {
+                options.connections = std::max<std::size_t>(1, std::stoull(option_value(arg, "--connections")));
+            } else if (!option_value(arg, "--rate").empty()) {
+                options.rate = std::stod(option_value(arg, "--rate"));
+            } else if (!option_value(arg, "--duration").empty()) {
+                options.duration_s = std::stod(option_value(arg, "--duration"));
+            } else if (!option_value(arg, "--warmup").empty()) {
+                options.warmup_s = std::stod(option_value(arg, "--warmup"));
+            } else if (!option_value(arg, "--seed").empty()) {
+                options.seed = std::stoull(option_value(arg, "--seed"));
+            } else if (!option_value(arg, "--json").empty()) {
+                options.json_path = option_value(arg, "--json");
+            } else if (!option_value(arg, "--hdr-dir").empty()) {
+                options.hdr_dir = option_value(arg, "--hdr-dir");
+            } else if (!option_value(arg, "--log-level").empty()) {
+                logger().set_min_level(parse_log_level(option_value(arg, "--log-level")));
+            } else {
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        }
+        if (options.duration_s <= 0 || options.warmup_s < 0 || options.rate < 0) throw std::invalid_argument("duration, warmup and rate must not be negative");
+        HttpClient check(options.target); // Zielformat früh prüfen
+    } catch (const std::exception& e) {
+        std::cerr << "loadgen: " << e.what() << " (Optionen siehe bench/loadgen_main.cpp)\n";
+        return 2;
+    }
+
+    int code = 1;
+    try {
+        code = run(options);
+    } catch (const std::exception& e) {
+        std::cerr << "loadgen: " << e.what() << "\n";
+    }
+    logger().shutdown();
+    return code;
+}
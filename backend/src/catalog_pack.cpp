@@ -0,0 +1,591 @@
+#include "catalog_pack.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "nlohmann/json.hpp"
+
+#include "logger.h"
+#include "parallel.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// --- Dateiformat (Version 1) ---
+// [FileHeader][Strings][Records][Categories][Monsters][Lists][Payload], Abschnitte auf 8 Byte ausgerichtet,
+// alle Offsets ab Dateianfang. Strings werden über StringRef (Offset in die String-Tabelle, Länge) referenziert.
+// Die Prüfsumme (CRC32) läuft über alles nach dem Header.
+
+constexpr char pack_magic[8] = {'D', 'N', 'D', 'P', 'A', 'C', 'K', '\0'};
+constexpr std::uint32_t byte_order_mark = 0x01020304;
+constexpr std::uint32_t no_monster = 0xffffffffu;
+constexpr std::size_t monster_list_count = 6; // languages, movement, resistances, immunities, vulnerabilities, condition_immunities
+
+struct Section {
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t file_size;
+    std::uint32_t checksum;
+    std::uint32_t record_count;
+    std::uint32_t category_count;
+    std::uint32_t monster_count;
+    std::int64_t created_unix;
+    Section strings;
+    Section records;
+    Section categories;
+    Section monsters;
+    Section lists;
+    Section payload;
+};
+
+struct StringRef {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+struct RecordEntry {
+    StringRef category;
+    StringRef key;
+    std::int64_t mtime_ns;
+    std::uint64_t source_size;
+    std::uint64_t body_offset; // Innerhalb von Payload
+    std::uint64_t body_length;
+    std::uint32_t monster;     // Index in Monsters oder no_monster
+    std::uint32_t reserved;
+};
+
+struct CategoryEntry {
+    StringRef name;
+    std::uint32_t first_record;
+    std::uint32_t record_count;
+};
+
+struct ListRef {
+    std::uint32_t first; // Index in Lists (StringRef-Array)
+    std::uint32_t count;
+};
+
+struct MonsterEntry {
+    StringRef id;
+    StringRef name;
+    StringRef size;
+    StringRef type;
+    StringRef alignment;
+    double cr;
+    std::uint32_t record;
+    std::uint32_t complete;
+    ListRef lists[monster_list_count];
+};
+
+static_assert(sizeof(FileHeader) == 144, "Pack-Header hat sich geändert, format_version erhöhen");
+static_assert(sizeof(RecordEntry) == 56, "Pack-Datensatz hat sich geändert, format_version erhöhen");
+static_assert(sizeof(CategoryEntry) == 16, "Pack-Kategorie hat sich geändert, format_version erhöhen");
+static_assert(sizeof(MonsterEntry) == 104, "Pack-Monster hat sich geändert, format_version erhöhen");
+
+std::uint32_t checksum(const char* data, std::size_t size) {
+    uLong crc = crc32(0L, Z_NULL, 0);
+    while (size > 0) {
+        const uInt chunk = static_cast<uInt>(std::min<std::size_t>(size, 1u << 30));
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(data), chunk);
+        data += chunk;
+        size -= chunk;
+    }
+    return static_cast<std::uint32_t>(crc);
+}
+
+std::int64_t mtime_ns(std::filesystem::file_time_type time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+// Vergleich (Kategorie, Schlüssel) wie die Sortierung der Datensätze
+int compare_key(std::string_view category_a, std::string_view key_a, std::string_view category_b, std::string_view key_b) {
+    if (int c = category_a.compare(category_b)) return c;
+    return key_a.compare(key_b);
+}
+
+std::size_t align8(std::size_t value) {
+    return (value + 7) & ~std::size_t(7);
+}
+
+// --- Schreiben ---
+
+struct SourceFile {
+    std::string category;
+    std::string key;
+    std::filesystem::path path;
+    std::int64_t mtime_ns = 0;
+    std::uint64_t source_size = 0;
+    std::string body;                      // Kompaktes JSON, leer = Fehler
+    std::optional<MonsterSummary> monster; // Nur Kategorie "monsters"
+};
+
+class StringTable {
+public:
+    StringRef add(const std::string& value) {
+        auto it = offsets_.find(value);
+        if (it == offsets_.end()) {
+            if (data_.size() + value.size() > UINT32_MAX) throw std::runtime_error("String table exceeds 4 GB");
+            it = offsets_.emplace(value, static_cast<std::uint32_t>(data_.size())).first;
+            data_ += value;
+        }
+        return StringRef{it->second, static_cast<std::uint32_t>(value.size())};
+    }
+    const std::string& data() const { return data_; }
+
+private:
+    std::string data_;
+    std::unordered_map<std::string, std::uint32_t> offsets_;
+};
+
+template <typename T>
+void append_pod(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void pad8(std::string& out) {
+    out.resize(align8(out.size()), '\0');
+}
+
+} // namespace
+
+// --- Lesen ---
+
+std::shared_ptr<const CatalogPack> CatalogPack::open(const std::filesystem::path& file) {
+    const int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open catalog pack: " + std::string(std::strerror(errno)));
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        throw std::runtime_error("Catalog pack is truncated.");
+    }
+    const std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // Das Mapping bleibt gültig
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Could not map catalog pack: " + std::string(std::strerror(errno)));
+    }
+
+    std::shared_ptr<CatalogPack> pack(new CatalogPack());
+    pack->file_ = file;
+    pack->data_ = static_cast<const char*>(mapping);
+    pack->size_ = size;
+
+    const auto* header = reinterpret_cast<const FileHeader*>(pack->data_);
+    if (std::memcmp(header->magic, pack_magic, sizeof(pack_magic)) != 0) {
+        throw std::runtime_error("Not a catalog pack.");
+    }
+    if (header->byte_order != byte_order_mark) {
+        throw std::runtime_error("Catalog pack was written on a machine with different byte order.");
+    }
+    if (header->version != format_version) {
+        throw std::runtime_error("Unsupported catalog pack version " + std::to_string(header->version) + " (expected " +
+                                 std::to_string(format_version) + ").");
+    }
+    if (header->file_size != size) {
+        throw std::runtime_error("Catalog pack is truncated.");
+    }
+    if (checksum(pack->data_ + sizeof(FileHeader), size - sizeof(FileHeader)) != header->checksum) {
+        throw std::runtime_error("Catalog pack checksum mismatch.");
+    }
+
+    auto section = [&](const Section& s, std::size_t element_size, std::size_t count) -> const char* {
+        if (s.offset % 8 != 0 || s.offset < sizeof(FileHeader) || s.offset > size || s.size > size - s.offset ||
+            (element_size > 0 && s.size != element_size * count)) {
+            throw std::runtime_error("Catalog pack has an invalid section.");
+        }
+        return pack->data_ + s.offset;
+    };
+    pack->record_count_ = header->record_count;
+    pack->category_count_ = header->category_count;
+    pack->monster_count_ = header->monster_count;
+    pack->created_unix_ = header->created_unix;
+    pack->strings_ = section(header->strings, 0, 0);
+    pack->strings_size_ = header->strings.size;
+    pack->records_ = section(header->records, sizeof(RecordEntry), header->record_count);
+    pack->categories_ = section(header->categories, sizeof(CategoryEntry), header->category_count);
+    pack->monsters_ = section(header->monsters, sizeof(MonsterEntry), header->monster_count);
+    if (header->lists.size % sizeof(StringRef) != 0) {
+        throw std::runtime_error("Catalog pack has an invalid section.");
+    }
+    pack->lists_ = section(header->lists, 0, 0);
+    pack->lists_count_ = header->lists.size / sizeof(StringRef);
+    pack->payload_ = section(header->payload, 0, 0);
+    pack->payload_size_ = header->payload.size;
+
+    // Alle Referenzen einmal prüfen, danach greifen die Zugriffe ungeprüft zu
+    auto check_string = [&](const StringRef& ref) {
+        if (ref.offset > pack->strings_size_ || ref.length > pack->strings_size_ - ref.offset) {
+            throw std::runtime_error("Catalog pack has an invalid string reference.");
+        }
+    };
+    const auto* records = static_cast<const RecordEntry*>(pack->records_);
+    for (std::size_t i = 0; i < pack->record_count_; ++i) {
+        check_string(records[i].category);
+        check_string(records[i].key);
+        if (records[i].body_offset > pack->payload_size_ || records[i].body_length > pack->payload_size_ - records[i].body_offset ||
+            (records[i].monster != no_monster && records[i].monster >= pack->monster_count_)) {
+            throw std::runtime_error("Catalog pack has an invalid record.");
+        }
+        if (i > 0 && compare_key(pack->string_at(records[i - 1].category.offset, records[i - 1].category.length),
+                                 pack->string_at(records[i - 1].key.offset, records[i - 1].key.length),
+                                 pack->string_at(records[i].category.offset, records[i].category.length),
+                                 pack->string_at(records[i].key.offset, records[i].key.length)) >= 0) {
+            throw std::runtime_error("Catalog pack records are not sorted.");
+        }
+    }
+    const auto* categories = static_cast<const CategoryEntry*>(pack->categories_);
+    for (std::size_t i = 0; i < pack->category_count_; ++i) {
+        check_string(categories[i].name);
+        if (categories[i].first_record > pack->record_count_ || categories[i].record_count > pack->record_count_ - categories[i].first_record) {
+            throw std::runtime_error("Catalog pack has an invalid category.");
+        }
+    }
+    const auto* lists = static_cast<const StringRef*>(pack->lists_);
+    for (std::size_t i = 0; i < pack->lists_count_; ++i) {
+        check_string(lists[i]);
+    }
+    const auto* monsters = static_cast<const MonsterEntry*>(pack->monsters_);
+    for (std::size_t i = 0; i < pack->monster_count_; ++i) {
+        for (const StringRef& ref : {monsters[i].id, monsters[i].name, monsters[i].size, monsters[i].type, monsters[i].alignment}) {
+            check_string(ref);
+        }
+        if (monsters[i].record >= pack->record_count_) {
+            throw std::runtime_error("Catalog pack has an invalid monster entry.");
+        }
+        for (const ListRef& list : monsters[i].lists) {
+            if (list.first > pack->lists_count_ || list.count > pack->lists_count_ - list.first) {
+                throw std::runtime_error("Catalog pack has an invalid monster entry.");
+            }
+        }
+    }
+    return pack;
+}
+
+CatalogPack::~CatalogPack() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+std::string_view CatalogPack::string_at(std::uint64_t offset, std::uint32_t length) const {
+    return std::string_view(static_cast<const char*>(strings_) + offset, length);
+}
+
+CatalogPack::Record CatalogPack::record_at(std::uint32_t index) const {
+    const RecordEntry& entry = static_cast<const RecordEntry*>(records_)[index];
+    Record record;
+    record.category = string_at(entry.category.offset, entry.category.length);
+    record.key = string_at(entry.key.offset, entry.key.length);
+    record.body = std::string_view(payload_ + entry.body_offset, entry.body_length);
+    record.mtime_ns = entry.mtime_ns;
+    record.source_size = entry.source_size;
+    record.index = index;
+    return record;
+}
+
+std::optional<std::uint32_t> CatalogPack::category_range(std::string_view category, std::uint32_t& count) const {
+    const auto* categories = static_cast<const CategoryEntry*>(categories_);
+    const auto* end = categories + category_count_;
+    const auto* it = std::lower_bound(categories, end, category, [&](const CategoryEntry& entry, std::string_view name) {
+        return string_at(entry.name.offset, entry.name.length) < name;
+    });
+    if (it == end || string_at(it->name.offset, it->name.length) != category) {
+        return std::nullopt;
+    }
+    count = it->record_count;
+    return it->first_record;
+}
+
+std::optional<CatalogPack::Record> CatalogPack::find(std::string_view category, std::string_view key) const {
+    std::uint32_t count = 0;
+    std::optional<std::uint32_t> first = category_range(category, count);
+    if (!first) {
+        return std::nullopt;
+    }
+    // Binäre Suche im Bereich der Kategorie
+    std::uint32_t low = *first;
+    std::uint32_t high = *first + count;
+    const auto* records = static_cast<const RecordEntry*>(records_);
+    while (low < high) {
+        const std::uint32_t mid = low + (high - low) / 2;
+        if (string_at(records[mid].key.offset, records[mid].key.length) < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == *first + count || string_at(records[low].key.offset, records[low].key.length) != key) {
+        return std::nullopt;
+    }
+    return record_at(low);
+}
+
+std::optional<CatalogPack::Record> CatalogPack::find_fresh(std::string_view category, std::string_view key, const std::filesystem::path& file) const {
+    std::optional<Record> record = find(category, key);
+    if (!record) {
+        missing_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    std::error_code ec;
+    const std::filesystem::file_time_type time = std::filesystem::last_write_time(file, ec);
+    const std::uintmax_t size = ec ? 0 : std::filesystem::file_size(file, ec);
+    if (ec || mtime_ns(time) != record->mtime_ns || size != record->source_size) {
+        stale_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return record;
+}
+
+std::optional<CatalogPack::Record> CatalogPack::find_fresh(const std::filesystem::path& relative, const std::filesystem::path& file) const {
+    auto it = relative.begin();
+    if (it == relative.end() || *it == "..") {
+        return std::nullopt;
+    }
+    const std::string category = it->string();
+    const std::string generic = relative.generic_string();
+    if (generic.size() <= category.size() + 1) {
+        return std::nullopt;
+    }
+    return find_fresh(category, std::string_view(generic).substr(category.size() + 1), file);
+}
+
+std::vector<CatalogPack::Record> CatalogPack::records(std::string_view category) const {
+    std::vector<Record> result;
+    std::uint32_t count = 0;
+    if (std::optional<std::uint32_t> first = category_range(category, count)) {
+        result.reserve(count);
+        for (std::uint32_t i = *first; i < *first + count; ++i) {
+            result.push_back(record_at(i));
+        }
+    }
+    return result;
+}
+
+std::optional<MonsterSummary> CatalogPack::monster_summary(const Record& record, const std::filesystem::path& path) const {
+    const RecordEntry& entry = static_cast<const RecordEntry*>(records_)[record.index];
+    if (entry.monster == no_monster) {
+        return std::nullopt;
+    }
+    const MonsterEntry& monster = static_cast<const MonsterEntry*>(monsters_)[entry.monster];
+    auto text = [&](const StringRef& ref) { return std::string(string_at(ref.offset, ref.length)); };
+    auto list = [&](const ListRef& ref) {
+        std::vector<std::string> values;
+        values.reserve(ref.count);
+        const auto* lists = static_cast<const StringRef*>(lists_);
+        for (std::uint32_t i = ref.first; i < ref.first + ref.count; ++i) {
+            values.push_back(text(lists[i]));
+        }
+        return values;
+    };
+
+    MonsterSummary summary;
+    summary.id = text(monster.id);
+    summary.name = text(monster.name);
+    summary.cr = monster.cr;
+    summary.size = text(monster.size);
+    summary.type = text(monster.type);
+    summary.complete = monster.complete != 0;
+    summary.path = path;
+    summary.alignment = text(monster.alignment);
+    summary.languages = list(monster.lists[0]);
+    summary.movement = list(monster.lists[1]);
+    summary.resistances = list(monster.lists[2]);
+    summary.immunities = list(monster.lists[3]);
+    summary.vulnerabilities = list(monster.lists[4]);
+    summary.condition_immunities = list(monster.lists[5]);
+    return summary;
+}
+
+CatalogPack::Stats CatalogPack::stats() const {
+    return Stats{hits_.load(std::memory_order_relaxed), stale_.load(std::memory_order_relaxed), missing_.load(std::memory_order_relaxed)};
+}
+
+// --- Schreiben ---
+
+const std::vector<std::string>& default_pack_categories() {
+    static const std::vector<std::string> categories = {"DnDData", "classes", "features", "items", "monsters", "spells", "subclasses", "templates"};
+    return categories;
+}
+
+PackBuildStats write_catalog_pack(const std::filesystem::path& data_dir, const std::vector<std::string>& categories, const std::filesystem::path& output) {
+    std::vector<SourceFile> files;
+    for (const std::string& category : categories) {
+        const std::filesystem::path category_dir = data_dir / category;
+        if (!std::filesystem::is_directory(category_dir)) {
+            log_warn("Kategorie fehlt, wird nicht gepackt", {{"path", category_dir.string()}});
+            continue;
+        }
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(category_dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".json") {
+                SourceFile file;
+                file.category = category;
+                file.key = entry.path().lexically_relative(category_dir).generic_string();
+                file.path = entry.path();
+                files.push_back(std::move(file));
+            }
+        }
+    }
+
+    // Lesen, validieren und kompakt serialisieren (parallel); mtime vor dem Lesen, damit eine während des
+    // Packens geänderte Datei als veraltet gilt
+    parallel_for(files.size(), [&](std::size_t i) {
+        SourceFile& file = files[i];
+        try {
+            file.mtime_ns = mtime_ns(std::filesystem::last_write_time(file.path));
+            std::ifstream in(file.path, std::ios::binary);
+            if (!in.is_open()) throw std::runtime_error("Could not open file.");
+            std::stringstream buffer;
+            buffer << in.rdbuf();
+            const std::string raw = buffer.str();
+            file.source_size = raw.size();
+            json document = json::parse(raw);
+            file.body = document.dump();
+            if (file.category == "monsters") {
+                file.monster = summarize_monster(file.path.stem().string(), document, file.path);
+            }
+        } catch (const std::exception& e) {
+            log_error("Datei kann nicht gepackt werden", {{"path", file.path.string()}, {"error", e.what()}});
+            file.body.clear();
+        }
+    }, 1);
+
+    PackBuildStats stats;
+    const std::size_t listed = files.size();
+    files.erase(std::remove_if(files.begin(), files.end(), [](const SourceFile& file) { return file.body.empty(); }), files.end());
+    stats.errors = listed - files.size();
+    std::sort(files.begin(), files.end(), [](const SourceFile& a, const SourceFile& b) {
+        return compare_key(a.category, a.key, b.category, b.key) < 0;
+    });
+    if (files.size() > UINT32_MAX) {
+        throw std::runtime_error("Too many files for a catalog pack.");
+    }
+
+    StringTable strings;
+    std::vector<RecordEntry> records;
+    std::vector<CategoryEntry> category_entries;
+    std::vector<MonsterEntry> monsters;
+    std::vector<StringRef> lists;
+    std::string payload;
+    records.reserve(files.size());
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const SourceFile& file = files[i];
+        RecordEntry record{};
+        record.category = strings.add(file.category);
+        record.key = strings.add(file.key);
+        record.mtime_ns = file.mtime_ns;
+        record.source_size = file.source_size;
+        record.body_offset = payload.size();
+        record.body_length = file.body.size();
+        record.monster = no_monster;
+        payload += file.body;
+        stats.source_bytes += file.source_size;
+
+        if (file.monster) {
+            const MonsterSummary& summary = *file.monster;
+            MonsterEntry monster{};
+            monster.id = strings.add(summary.id);
+            monster.name = strings.add(summary.name);
+            monster.size = strings.add(summary.size);
+            monster.type = strings.add(summary.type);
+            monster.alignment = strings.add(summary.alignment);
+            monster.cr = summary.cr;
+            monster.record = static_cast<std::uint32_t>(i);
+            monster.complete = summary.complete ? 1 : 0;
+            const std::vector<std::string>* values[monster_list_count] = {&summary.languages, &summary.movement, &summary.resistances,
+                                                                          &summary.immunities, &summary.vulnerabilities, &summary.condition_immunities};
+            for (std::size_t l = 0; l < monster_list_count; ++l) {
+                monster.lists[l] = ListRef{static_cast<std::uint32_t>(lists.size()), static_cast<std::uint32_t>(values[l]->size())};
+                for (const std::string& value : *values[l]) lists.push_back(strings.add(value));
+            }
+            record.monster = static_cast<std::uint32_t>(monsters.size());
+            monsters.push_back(monster);
+        }
+
+        if (i == 0 || files[i - 1].category != file.category) {
+            category_entries.push_back(CategoryEntry{strings.add(file.category), static_cast<std::uint32_t>(i), 0});
+        }
+        ++category_entries.back().record_count;
+        records.push_back(record);
+    }
+
+    // Abschnitte hintereinander, jeweils auf 8 Byte ausgerichtet
+    std::string out(sizeof(FileHeader), '\0');
+    FileHeader header{};
+    std::memcpy(header.magic, pack_magic, sizeof(pack_magic));
+    header.version = CatalogPack::format_version;
+    header.byte_order = byte_order_mark;
+    header.record_count = static_cast<std::uint32_t>(records.size());
+    header.category_count = static_cast<std::uint32_t>(category_entries.size());
+    header.monster_count = static_cast<std::uint32_t>(monsters.size());
+    header.created_unix = static_cast<std::int64_t>(std::time(nullptr));
+
+    auto begin_section = [&](Section& section) {
+        pad8(out);
+        section.offset = out.size();
+    };
+    begin_section(header.strings);
+    out += strings.data();
+    header.strings.size = strings.data().size();
+    begin_section(header.records);
+    for (const RecordEntry& record : records) append_pod(out, record);
+    header.records.size = records.size() * sizeof(RecordEntry);
+    begin_section(header.categories);
+    for (const CategoryEntry& category : category_entries) append_pod(out, category);
+    header.categories.size = category_entries.size() * sizeof(CategoryEntry);
+    begin_section(header.monsters);
+    for (const MonsterEntry& monster : monsters) append_pod(out, monster);
+    header.monsters.size = monsters.size() * sizeof(MonsterEntry);
+    begin_section(header.lists);
+    for (const StringRef& ref : lists) append_pod(out, ref);
+    header.lists.size = lists.size() * sizeof(StringRef);
+    begin_section(header.payload);
+    out += payload;
+    header.payload.size = payload.size();
+
+    header.file_size = out.size();
+    header.checksum = checksum(out.data() + sizeof(FileHeader), out.size() - sizeof(FileHeader));
+    std::memcpy(out.data(), &header, sizeof(FileHeader));
+
+    // Erst vollständig schreiben, dann umbenennen: ein laufender Server sieht nie einen halben Pack
+    const std::filesystem::path temp = output.string() + ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not create " + temp.string());
+        }
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+        if (!file) {
+            throw std::runtime_error("Could not write " + temp.string());
+        }
+    }
+    std::filesystem::rename(temp, output);
+
+    stats.records = records.size();
+    stats.monsters = monsters.size();
+    stats.pack_bytes = out.size();
+    stats.string_bytes = strings.data().size();
+    return stats;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "monster_catalog.h"
+
+// --- Catalog-Pack: der ganze Datenbaum als eine mmap-bare Binärdatei ---
+// DnDApp_pack (CMake-Target dndapp-pack) übersetzt data/ einmal in eine versionierte Datei:
+// Header, String-Tabelle (dedupliziert), Datensätze (Kategorie, Schlüssel, mtime, Größe, Offset des
+// kompakten JSON-Bodys), ein Kategorie-Verzeichnis und vorberechnete Monster-Zusammenfassungen.
+// Datensätze sind nach (Kategorie, Schlüssel) sortiert, jede Kategorie ist also ein zusammenhängender,
+// binär durchsuchbarer Bereich (Index für DnDData, spells, items, features, ... ohne weiteren Aufbau).
+//
+// Der Server mappt die Datei beim Start und liefert Bodies direkt aus dem Mapping; json-Bäume und
+// Monster-Zusammenfassungen entstehen ohne Parsen der Quelldateien. Ein Datensatz gilt nur, solange die
+// Quelldatei dieselbe mtime und Größe hat wie beim Packen (find_fresh); neuere Dateien kommen wie bisher
+// aus dem JSON-Baum.
+//
+// Format (Version 1, native Byte-Reihenfolge, geprüft über byte_order): siehe catalog_pack.cpp.
+
+class CatalogPack {
+public:
+    static constexpr std::uint32_t format_version = 1;
+
+    struct Record {
+        std::string_view category; // z.B. "DnDData" bzw. "monsters"
+        std::string_view key;      // Pfad relativ zur Kategorie, z.B. "crData.json" bzw. "completed/goblin.json"
+        std::string_view body;     // Kompaktes JSON, gültig solange der Pack lebt
+        std::int64_t mtime_ns = 0; // last_write_time der Quelldatei beim Packen
+        std::uint64_t source_size = 0;
+        std::uint32_t index = 0;
+    };
+
+    struct Stats {
+        std::uint64_t hits = 0;  // Datensatz benutzt
+        std::uint64_t stale = 0; // Quelldatei geändert -> JSON-Baum
+        std::uint64_t missing = 0;
+    };
+
+    // Mappt die Datei und prüft Header, Prüfsumme und alle Offsets; wirft std::runtime_error
+    static std::shared_ptr<const CatalogPack> open(const std::filesystem::path& file);
+    ~CatalogPack();
+
+    CatalogPack(const CatalogPack&) = delete;
+    CatalogPack& operator=(const CatalogPack&) = delete;
+
+    std::optional<Record> find(std::string_view category, std::string_view key) const;
+    // Wie find, aber nur wenn file (die Quelldatei auf der Platte) seit dem Packen unverändert ist.
+    // Kostet einen stat-Aufruf.
+    std::optional<Record> find_fresh(std::string_view category, std::string_view key, const std::filesystem::path& file) const;
+    // relative: Pfad unterhalb des Datenverzeichnisses ("monsters/completed/goblin.json")
+    std::optional<Record> find_fresh(const std::filesystem::path& relative, const std::filesystem::path& file) const;
+    // Alle Datensätze einer Kategorie, nach Schlüssel sortiert
+    std::vector<Record> records(std::string_view category) const;
+
+    // Vorberechnete Zusammenfassung (wie summarize_monster) für einen Datensatz der Kategorie "monsters"
+    std::optional<MonsterSummary> monster_summary(const Record& record, const std::filesystem::path& path) const;
+
+    const std::filesystem::path& file() const { return file_; }
+    std::size_t size() const { return record_count_; }
+    std::size_t monster_count() const { return monster_count_; }
+    std::size_t mapped_bytes() const { return size_; }
+    std::int64_t created_unix() const { return created_unix_; }
+    Stats stats() const;
+
+private:
+    CatalogPack() = default;
+
+    std::string_view string_at(std::uint64_t offset, std::uint32_t length) const;
+    Record record_at(std::uint32_t index) const;
+    std::optional<std::uint32_t> category_range(std::string_view category, std::uint32_t& count) const;
+
+    std::filesystem::path file_;
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t record_count_ = 0;
+    std::size_t category_count_ = 0;
+    std::size_t monster_count_ = 0;
+    std::int64_t created_unix_ = 0;
+    const void* strings_ = nullptr;
+    const void* records_ = nullptr;
+    const void* categories_ = nullptr;
+    const void* monsters_ = nullptr;
+    const void* lists_ = nullptr;
+    std::size_t strings_size_ = 0;
+    std::size_t lists_count_ = 0;
+    const char* payload_ = nullptr;
+    std::size_t payload_size_ = 0;
+
+    mutable std::atomic<std::uint64_t> hits_{0};
+    mutable std::atomic<std::uint64_t> stale_{0};
+    mutable std::atomic<std::uint64_t> missing_{0};
+};
+
+struct PackBuildStats {
+    std::size_t records = 0;
+    std::size_t monsters = 0;
+    std::size_t errors = 0;       // Nicht lesbare/parsbare Dateien (nicht im Pack)
+    std::size_t source_bytes = 0;
+    std::size_t pack_bytes = 0;
+    std::size_t string_bytes = 0;
+};
+
+// Packt alle .json-Dateien der Kategorien (Unterordner von data_dir) nach output (temporäre Datei + rename).
+// Wirft std::runtime_error bei Schreibfehlern.
+PackBuildStats write_catalog_pack(const std::filesystem::path& data_dir, const std::vector<std::string>& categories,
+                                  const std::filesystem::path& output);
+
+// Kategorien, die Server und DnDApp_pack standardmäßig packen
+const std::vector<std::string>& default_pack_categories();
+// --- Ende Catalog-Pack ---
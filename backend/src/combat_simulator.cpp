@@ -0,0 +1,420 @@
+#include "combat_simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "parallel.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr std::size_t trials_per_block = 256;
+
+// Kennzeichnet die Schadens-Ströme der Trials (Treffer-Ströme nutzen die Trial-Nummer direkt)
+constexpr std::uint64_t damage_stream_flag = std::uint64_t{1} << 63;
+
+// damage-Array eines Statblocks bzw. damage-Objekt einer Party; Einträge, die keine Objekte sind, werden
+// übersprungen, ungültige Würfel (z.B. über max_dice_per_term) zählen als kein Schaden
+DiceExpression damage_from_json(const json& damage) {
+    json entries = json::array();
+    if (damage.is_object()) {
+        entries.push_back(damage);
+    } else if (damage.is_array()) {
+        for (const auto& entry : damage) {
+            if (entry.is_object()) entries.push_back(entry);
+        }
+    }
+    try {
+        return compile_dice(entries);
+    } catch (const std::invalid_argument&) {
+        return {};
+    }
+}
+
+int number_or(const json& data, const char* key, int fallback) {
+    return data.contains(key) && data[key].is_number() ? data[key].get<int>() : fallback;
+}
+
+// {"defaultValue": x, "overrideValue": y|null} -> y falls gesetzt, sonst x
+int override_or_default(const json& data, int fallback) {
+    if (!data.is_object()) return fallback;
+    if (data.contains("overrideValue") && data["overrideValue"].is_number()) return data["overrideValue"].get<int>();
+    return number_or(data, "defaultValue", fallback);
+}
+
+int ability_index(const json& value) {
+    if (value.is_string()) {
+        for (std::size_t i = 0; i < ability_names.size(); ++i) {
+            if (value.get<std::string>() == ability_names[i]) return static_cast<int>(i);
+        }
+    }
+    return 1; // Unbekannt: DEX
+}
+
+int proficiency_for_cr(double cr) {
+    const int whole = std::max(1, static_cast<int>(std::ceil(cr)));
+    return 2 + (whole - 1) / 4;
+}
+
+// Perzentil aus einem Histogramm (Index = Wert)
+int histogram_percentile(const std::vector<std::size_t>& histogram, double fraction) {
+    const std::size_t total = std::accumulate(histogram.begin(), histogram.end(), std::size_t(0));
+    if (total == 0) return 0;
+    const auto wanted = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(total)));
+    std::size_t seen = 0;
+    for (std::size_t i = 0; i < histogram.size(); ++i) {
+        seen += histogram[i];
+        if (seen >= std::max<std::size_t>(wanted, 1)) return static_cast<int>(i);
+    }
+    return static_cast<int>(histogram.size()) - 1;
+}
+
+} // namespace
+
+double SimAttack::mean_damage() const {
+    return damage.mean();
+}
+
+double SimSave::mean_damage() const {
+    return damage.mean();
+}
+
+// --- Aufbau der Kämpfer ---
+
+SimCombatant combatant_from_statblock(const json& statblock) {
+    SimCombatant combatant;
+    const json basics = statblock.value("basics", json::object());
+    combatant.name = basics.value("name", "Unknown");
+    combatant.ac = number_or(basics, "AC", 10);
+
+    // HP wie im StatBlockRenderer: HDAmount * Durchschnitt(Würfel) + HPmodifier
+    try {
+        combatant.hp = std::max(1, static_cast<int>(std::floor(compile_dice(basics.value("HP", json::object())).mean())));
+    } catch (const std::invalid_argument&) {
+        combatant.hp = 1;
+    }
+
+    const json initiative = basics.value("Initiative", json::object());
+    combatant.initiative_bonus = initiative.contains("initOverrideValue") && initiative["initOverrideValue"].is_number()
+                                     ? initiative["initOverrideValue"].get<int>()
+                                     : number_or(initiative, "initDefaultValue", 0);
+
+    // Rettungswürfe: saves.<Attribut> (defaultValue enthält die Übung, overrideValue hat Vorrang),
+    // fehlt der Eintrag, nur der Attributsmodifikator
+    const json stats = basics.value("stats", json::object());
+    const json saves = statblock.value("saves", json::object());
+    for (std::size_t i = 0; i < ability_names.size(); ++i) {
+        const int score = number_or(stats, ability_names[i], 10);
+        const int modifier = static_cast<int>(std::floor((score - 10) / 2.0));
+        combatant.save_bonuses[i] = saves.is_object() ? override_or_default(saves.value(ability_names[i], json()), modifier) : modifier;
+    }
+
+    const json actions = statblock.value("actions", json::object());
+    for (const auto& attack_data : actions.value("attackRoll", json::array())) {
+        if (!attack_data.is_object()) continue;
+        SimAttack attack;
+        attack.name = attack_data.value("name", "Attack");
+        attack.attack_bonus = number_or(attack_data, "attackMod", 0);
+        attack.damage = damage_from_json(attack_data.value("damage", json::array()));
+        combatant.attacks.push_back(std::move(attack));
+    }
+    for (const auto& save_data : actions.value("savingThrow", json::array())) {
+        if (!save_data.is_object()) continue;
+        SimSave save;
+        save.name = save_data.value("name", "Saving Throw");
+        save.dc = override_or_default(save_data.value("safeDC", json::object()), 10);
+        save.damage = damage_from_json(save_data.value("damage", json::array()));
+        save.save_stat = ability_index(save_data.value("saveStat", json()));
+        save.recharge_min = recharge_threshold(save_data.value("recharge", json()));
+        combatant.saves.push_back(std::move(save));
+    }
+    return combatant;
+}
+
+SimCombatant combatant_from_encounter_entry(const json& entry) {
+    SimCombatant combatant;
+    const double cr = entry.contains("CR") && entry["CR"].is_number() ? entry["CR"].get<double>() : 0.0;
+    combatant.name = entry.value("name", entry.value("monsterId", "Unknown"));
+    combatant.ac = number_or(entry, "AC", 12);
+    combatant.hp = std::max(1, number_or(entry, "averageHp", 7));
+    combatant.initiative_bonus = number_or(entry, "initiativeBonus", 0);
+
+    // Grobe Schätzung: Angriffsbonus PB + 3, Schaden wächst mit dem CR
+    SimAttack attack;
+    attack.name = "Estimated Attack";
+    attack.attack_bonus = proficiency_for_cr(cr) + 3;
+    attack.damage.dice = {{std::clamp(static_cast<int>(std::ceil(cr)), 1, max_dice_per_term), 6}};
+    attack.damage.modifier = 3;
+    combatant.attacks.push_back(attack);
+    return combatant;
+}
+
+std::vector<SimCombatant> party_from_json(const json& party) {
+    std::vector<SimCombatant> members;
+    if (party.contains("members") && party["members"].is_array()) {
+        for (const auto& member : party["members"]) {
+            if (!member.is_object()) continue;
+            SimCombatant pc;
+            pc.party = true;
+            pc.name = member.value("name", "PC " + std::to_string(members.size() + 1));
+            pc.hp = std::max(1, number_or(member, "hp", 10));
+            pc.ac = number_or(member, "ac", 15);
+            pc.initiative_bonus = number_or(member, "initiativeBonus", 2);
+            pc.save_bonuses.fill(number_or(member, "saveBonus", 3));
+            const json saves = member.value("saves", json::object());
+            for (std::size_t i = 0; i < ability_names.size(); ++i) {
+                pc.save_bonuses[i] = number_or(saves, ability_names[i], pc.save_bonuses[i]);
+            }
+            pc.attacks_per_turn = std::clamp(number_or(member, "attacks", 1), 1, max_attacks_per_turn);
+            SimAttack attack;
+            attack.name = "Attack";
+            attack.attack_bonus = number_or(member, "attackBonus", 5);
+            attack.damage = damage_from_json(member.value("damage", json::object()));
+            pc.attacks.push_back(std::move(attack));
+            members.push_back(std::move(pc));
+        }
+        return members;
+    }
+
+    // Standard-Charakter pro Stufe (grob an einem Kämpfer orientiert)
+    const int level = std::clamp(party.value("averageLevel", 1), 1, 20);
+    const int count = std::clamp(party.value("playerCount", 4), 1, 12);
+    const int proficiency = 2 + (level - 1) / 4;
+    const int stat_mod = level >= 8 ? 5 : (level >= 4 ? 4 : 3);
+    for (int i = 0; i < count; ++i) {
+        SimCombatant pc;
+        pc.party = true;
+        pc.name = "PC " + std::to_string(i + 1);
+        pc.hp = 12 + (level - 1) * 8;
+        pc.ac = 16;
+        pc.initiative_bonus = 2;
+        // Zwei geübte Rettungswürfe (STR, CON), sonst nur ein kleiner Modifikator
+        pc.save_bonuses = {stat_mod + proficiency, 1, 2 + proficiency, 0, 1, 0};
+        pc.attacks_per_turn = level >= 20 ? 4 : (level >= 11 ? 3 : (level >= 5 ? 2 : 1));
+        SimAttack attack;
+        attack.name = "Weapon Attack";
+        attack.attack_bonus = proficiency + stat_mod;
+        attack.damage.dice = {{1, 8}};
+        attack.damage.modifier = stat_mod;
+        pc.attacks.push_back(std::move(attack));
+        members.push_back(std::move(pc));
+    }
+    return members;
+}
+
+// --- Simulation ---
+
+SimulationResult simulate_combat(const std::vector<SimCombatant>& combatants, const SimulationOptions& options) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t combatant_count = combatants.size();
+    const std::size_t trials = options.trials;
+    const int max_rounds = std::max(1, options.max_rounds);
+
+    // Zugreihenfolge nach Initiative-Bonus (bei Gleichstand zuerst die Party). Vereinfachung: Initiative wird nicht pro
+    // Trial gewürfelt, damit alle Trials eines Blocks denselben Zug gleichzeitig ausführen
+    std::vector<std::size_t> order(combatant_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        if (combatants[a].initiative_bonus != combatants[b].initiative_bonus) return combatants[a].initiative_bonus > combatants[b].initiative_bonus;
+        return combatants[a].party && !combatants[b].party;
+    });
+
+    // Aktionswahl pro Kämpfer vorab: bester Angriff (Durchschnittsschaden) und ggf. eine Recharge-Fähigkeit
+    std::vector<int> best_attack(combatant_count, -1), recharge_save(combatant_count, -1), plain_save(combatant_count, -1);
+    int party_size = 0, monster_count = 0, party_max_hp = 0;
+    for (std::size_t c = 0; c < combatant_count; ++c) {
+        const SimCombatant& combatant = combatants[c];
+        for (std::size_t a = 0; a < combatant.attacks.size(); ++a) {
+            if (best_attack[c] < 0 || combatant.attacks[a].mean_damage() > combatant.attacks[best_attack[c]].mean_damage()) best_attack[c] = static_cast<int>(a);
+        }
+        for (std::size_t s = 0; s < combatant.saves.size(); ++s) {
+            int& slot = combatant.saves[s].recharge_min > 0 ? recharge_save[c] : plain_save[c];
+            if (slot < 0 || combatant.saves[s].mean_damage() > combatant.saves[slot].mean_damage()) slot = static_cast<int>(s);
+        }
+        if (combatant.party) {
+            ++party_size;
+            party_max_hp += combatant.hp;
+        } else {
+            ++monster_count;
+        }
+    }
+
+    // Ergebnisse pro Trial (jeder Block schreibt nur seinen Bereich)
+    std::vector<std::int8_t> winner(trials, 0); // 1 = Party, -1 = Monster, 0 = Unentschieden
+    std::vector<std::uint16_t> rounds_taken(trials, 0);
+    std::vector<float> party_hp_fraction(trials, 0.0f);
+    std::vector<std::uint32_t> party_down(trials, 0);
+
+    const std::size_t block_count = (trials + trials_per_block - 1) / trials_per_block;
+    parallel_for(block_count, [&](std::size_t block) {
+        const std::size_t first = block * trials_per_block;
+        const std::size_t width = std::min(trials_per_block, trials - first);
+
+        // Struct-of-Arrays: Zeile = Kämpfer, Spalte = Trial
+        std::vector<int> hp(combatant_count * width);
+        std::vector<std::uint8_t> charged(combatant_count * width, 1);
+        std::vector<int> party_alive(width, party_size), monsters_alive(width, monster_count);
+        std::vector<std::uint8_t> finished(width, 0);
+        // Treffer/Ziele/Recharge und Schaden aus getrennten Strömen pro Trial: Ergebnisse eines Trials hängen nur
+        // von (seed, trial) ab, nicht davon, welche anderen Trials im Block noch kämpfen
+        std::vector<PhiloxStream> rng(width), damage_rng(width);
+        for (std::size_t t = 0; t < width; ++t) {
+            rng[t] = PhiloxStream(options.seed, first + t);
+            damage_rng[t] = PhiloxStream(options.seed, damage_stream_flag | (first + t));
+        }
+        // Schaden aller Angriffe eines Zuges, vorab in einem roll_many gewürfelt (Krits werden einzeln gewürfelt)
+        std::array<int, max_attacks_per_turn> attack_damage{};
+        for (std::size_t c = 0; c < combatant_count; ++c) {
+            std::fill_n(hp.begin() + c * width, width, combatants[c].hp);
+        }
+        if (party_size == 0 || monster_count == 0) {
+            std::fill(finished.begin(), finished.end(), 1);
+        }
+
+        auto apply_damage = [&](std::size_t target, std::size_t t, int damage, int round) {
+            int& target_hp = hp[target * width + t];
+            if (target_hp <= 0 || damage <= 0) return;
+            target_hp -= damage;
+            if (target_hp > 0) return;
+            int& side_alive = combatants[target].party ? party_alive[t] : monsters_alive[t];
+            if (--side_alive == 0) {
+                finished[t] = 1;
+                winner[first + t] = combatants[target].party ? -1 : 1;
+                rounds_taken[first + t] = static_cast<std::uint16_t>(round);
+            }
+        };
+
+        // Party: schwächstes lebendes Monster (Fokus-Feuer), Monster: zufälliger lebender Charakter
+        auto pick_target = [&](bool attacker_is_party, std::size_t t) -> std::size_t {
+            if (attacker_is_party) {
+                std::size_t best = combatant_count;
+                for (std::size_t c = 0; c < combatant_count; ++c) {
+                    const int target_hp = hp[c * width + t];
+                    if (!combatants[c].party && target_hp > 0 && (best == combatant_count || target_hp < hp[best * width + t])) best = c;
+                }
+                return best;
+            }
+            int pick = rng[t].roll(party_alive[t]);
+            for (std::size_t c = 0; c < combatant_count; ++c) {
+                if (combatants[c].party && hp[c * width + t] > 0 && --pick == 0) return c;
+            }
+            return combatant_count;
+        };
+
+        for (int round = 1; round <= max_rounds; ++round) {
+            for (std::size_t c : order) {
+                const SimCombatant& actor = combatants[c];
+                const int attacks_per_turn = std::clamp(actor.attacks_per_turn, 1, max_attacks_per_turn);
+                for (std::size_t t = 0; t < width; ++t) {
+                    if (finished[t] || hp[c * width + t] <= 0) continue;
+                    PhiloxStream& stream = rng[t];
+
+                    // Recharge zu Beginn des Zuges
+                    std::uint8_t& is_charged = charged[c * width + t];
+                    if (recharge_save[c] >= 0 && !is_charged) {
+                        is_charged = stream.roll(6) >= actor.saves[recharge_save[c]].recharge_min;
+                    }
+
+                    int save_index = -1;
+                    if (recharge_save[c] >= 0 && is_charged) save_index = recharge_save[c];
+                    else if (best_attack[c] < 0) save_index = plain_save[c];
+
+                    if (save_index >= 0) {
+                        const SimSave& save = actor.saves[save_index];
+                        const std::size_t target = pick_target(actor.party, t);
+                        if (target == combatant_count) continue;
+                        int damage = std::max(save.damage.roll(damage_rng[t]), 0);
+                        if (stream.roll(20) + combatants[target].save_bonuses[save.save_stat] >= save.dc) damage /= 2; // Erfolg: halber Schaden
+                        if (save.recharge_min > 0) is_charged = 0;
+                        apply_damage(target, t, damage, round);
+                        continue;
+                    }
+                    if (best_attack[c] < 0) continue;
+
+                    const SimAttack& attack = actor.attacks[best_attack[c]];
+                    attack.damage.roll_many(damage_rng[t], attack_damage.data(), static_cast<std::size_t>(attacks_per_turn));
+                    for (int k = 0; k < attacks_per_turn && !finished[t]; ++k) {
+                        const std::size_t target = pick_target(actor.party, t);
+                        if (target == combatant_count) break;
+                        const int d20 = stream.roll(20);
+                        if (d20 == 1) continue;
+                        const bool crit = d20 == 20;
+                        if (!crit && d20 + attack.attack_bonus < combatants[target].ac) continue;
+                        const int damage = crit ? attack.damage.roll(damage_rng[t], true) : attack_damage[static_cast<std::size_t>(k)];
+                        apply_damage(target, t, std::max(damage, 0), round);
+                    }
+                }
+            }
+        }
+
+        for (std::size_t t = 0; t < width; ++t) {
+            if (!finished[t]) rounds_taken[first + t] = static_cast<std::uint16_t>(max_rounds);
+            int remaining = 0, down = 0;
+            for (std::size_t c = 0; c < combatant_count; ++c) {
+                if (!combatants[c].party) continue;
+                const int value = hp[c * width + t];
+                remaining += std::max(value, 0);
+                if (value <= 0) ++down;
+            }
+            party_hp_fraction[first + t] = party_max_hp > 0 ? static_cast<float>(remaining) / static_cast<float>(party_max_hp) : 0.0f;
+            party_down[first + t] = static_cast<std::uint32_t>(down);
+        }
+    }, 1);
+
+    // --- Aggregation ---
+    SimulationResult result;
+    result.trials = trials;
+    result.rounds_histogram.assign(static_cast<std::size_t>(max_rounds) + 1, 0);
+    result.party_hp_histogram.assign(10, 0);
+    result.party_down_histogram.assign(static_cast<std::size_t>(party_size) + 1, 0);
+    double hp_sum = 0.0;
+    for (std::size_t t = 0; t < trials; ++t) {
+        if (winner[t] > 0) ++result.party_wins;
+        else if (winner[t] < 0) ++result.monster_wins;
+        else ++result.draws;
+        ++result.rounds_histogram[rounds_taken[t]];
+        ++result.party_hp_histogram[std::min<std::size_t>(9, static_cast<std::size_t>(party_hp_fraction[t] * 10.0f))];
+        ++result.party_down_histogram[party_down[t]];
+        hp_sum += party_hp_fraction[t];
+    }
+    result.party_hp_remaining_mean = trials > 0 ? hp_sum / static_cast<double>(trials) : 0.0;
+    result.party_hp_remaining = std::move(party_hp_fraction);
+    result.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+json SimulationResult::to_json() const {
+    const double n = trials > 0 ? static_cast<double>(trials) : 1.0;
+
+    std::vector<float> sorted = party_hp_remaining;
+    std::sort(sorted.begin(), sorted.end());
+    auto hp_percentile = [&](double fraction) -> double {
+        if (sorted.empty()) return 0.0;
+        return sorted[std::min(sorted.size() - 1, static_cast<std::size_t>(fraction * static_cast<double>(sorted.size())))];
+    };
+
+    double rounds_mean = 0.0;
+    for (std::size_t r = 0; r < rounds_histogram.size(); ++r) rounds_mean += static_cast<double>(r * rounds_histogram[r]);
+
+    json out;
+    out["trials"] = trials;
+    out["partyWinProbability"] = party_wins / n;
+    out["monsterWinProbability"] = monster_wins / n;
+    out["drawProbability"] = draws / n;
+    out["rounds"] = {{"mean", rounds_mean / n},
+                     {"p50", histogram_percentile(rounds_histogram, 0.5)},
+                     {"p90", histogram_percentile(rounds_histogram, 0.9)},
+                     {"histogram", rounds_histogram}};
+    out["partyHpRemaining"] = {{"mean", party_hp_remaining_mean},
+                               {"p10", hp_percentile(0.1)},
+                               {"p50", hp_percentile(0.5)},
+                               {"p90", hp_percentile(0.9)},
+                               {"histogram", party_hp_histogram}};
+    out["partyDown"] = {{"histogram", party_down_histogram}};
+    out["elapsedMs"] = elapsed_ms;
+    return out;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dice.h"
+#include "nlohmann/json.hpp"
+
+// --- Monte-Carlo-Kampfsimulation ---
+// Simuliert viele Kämpfe Party gegen Monster. Trials werden in Blöcken (Struct-of-Arrays: HP, Recharge
+// je Kämpfer x Trial) über alle Kerne verteilt. Jeder Trial hat seinen eigenen Philox-Strom (seed, trial) für
+// Treffer, Ziele und Recharge und einen zweiten für den Schaden (alle Angriffe eines Zuges mit einem
+// DiceExpression::roll_many). Beendete Trials würfeln nicht weiter; Ergebnisse sind daher bei gleichem Seed
+// unabhängig von Thread-Anzahl und Blockgröße reproduzierbar. Die Zugreihenfolge folgt dem Initiative-Bonus und
+// wird nicht pro Trial gewürfelt.
+
+// Reihenfolge der Attribute wie im Statblock (stats, saveStat)
+inline constexpr std::array<const char*, 6> ability_names = {"STR", "DEX", "CON", "INT", "WIS", "CHA"};
+
+struct SimAttack {
+    std::string name;
+    int attack_bonus = 0;
+    DiceExpression damage;
+    double mean_damage() const;
+};
+
+struct SimSave {
+    std::string name;
+    int dc = 10;
+    DiceExpression damage;
+    int save_stat = 0;    // Index in ability_names (saveStat)
+    int recharge_min = 0; // 0 = kein Recharge, sonst z.B. 5 für "(5-6)"
+    double mean_damage() const;
+};
+
+struct SimCombatant {
+    std::string name;
+    bool party = false;
+    int hp = 1;
+    int ac = 10;
+    int initiative_bonus = 0;
+    std::array<int, 6> save_bonuses{}; // Rettungswurf-Boni STR..CHA (Ziele von SimSave)
+    int attacks_per_turn = 1; // 1..max_attacks_per_turn
+    std::vector<SimAttack> attacks;
+    std::vector<SimSave> saves;
+};
+
+inline constexpr int max_attacks_per_turn = 8;
+// Größte Party, die simulate_combat annimmt (Routen antworten darüber mit 400)
+inline constexpr std::size_t max_party_size = 100;
+
+struct SimulationOptions {
+    std::size_t trials = 10000;
+    std::uint64_t seed = 0;
+    int max_rounds = 20;
+};
+
+struct SimulationResult {
+    std::size_t trials = 0;
+    std::size_t party_wins = 0;
+    std::size_t monster_wins = 0;
+    std::size_t draws = 0;                     // max_rounds erreicht
+    std::vector<std::size_t> rounds_histogram; // Index = Runden bis Kampfende (1..max_rounds)
+    std::vector<std::size_t> party_hp_histogram; // 10 Buckets: verbleibender Anteil der Party-HP
+    std::vector<std::size_t> party_down_histogram; // Index = Anzahl ausgefallener Charaktere
+    double party_hp_remaining_mean = 0.0;
+    std::vector<float> party_hp_remaining;     // Pro Trial (für Perzentile)
+    double elapsed_ms = 0.0;
+
+    nlohmann::json to_json() const;
+};
+
+// Statblock (Monster-Schema) -> Kämpfer; nutzt AC, HP (HDAmount/Die/HPmodifier), saves, actions.attackRoll/savingThrow
+SimCombatant combatant_from_statblock(const nlohmann::json& statblock);
+// Fallback ohne Statblock: Werte aus dem Encounter-Eintrag (AC, averageHp, CR, initiativeBonus) plus grobe CR-Schätzung
+SimCombatant combatant_from_encounter_entry(const nlohmann::json& entry);
+// Party-Beschreibung: {"members": [...]} oder {"averageLevel", "playerCount"} (Standard-Werte pro Stufe)
+std::vector<SimCombatant> party_from_json(const nlohmann::json& party);
+
+SimulationResult simulate_combat(const std::vector<SimCombatant>& combatants, const SimulationOptions& options);
+// --- Ende Kampfsimulation ---
@@ -0,0 +1,238 @@
+#include "content_negotiation.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "logger.h"
+#include "metrics.h"
+#include "response_cache.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string trim_lower(std::string_view value) {
+    const std::size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) return {};
+    const std::size_t end = value.find_last_not_of(" \t");
+    std::string result(value.substr(begin, end - begin + 1));
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+
+// Medientyp ohne Parameter -> Format; "*" für */* und application/*
+std::optional<BodyFormat> format_of_media_type(const std::string& media_type, bool& wildcard) {
+    wildcard = media_type == "*/*" || media_type == "application/*";
+    if (wildcard || media_type == "application/json") return BodyFormat::json;
+    if (media_type == "application/msgpack" || media_type == "application/x-msgpack" || media_type == "application/vnd.msgpack") return BodyFormat::msgpack;
+    if (media_type == "application/cbor") return BodyFormat::cbor;
+    return std::nullopt;
+}
+
+// Binäre Kodierungen beliebiger JSON-Bodies (Statblöcke, Listen, ...), Schlüssel ist der Inhalts-Hash.
+// Über dem Budget wird der Cache geleert; populäre Bodies sind danach schnell wieder drin.
+class EncodingCache {
+public:
+    static constexpr std::size_t budget_bytes = 32 * 1024 * 1024;
+
+    EncodingCache() : counters_(metrics().cache("binary_encoding")) {}
+
+    std::shared_ptr<const std::string> get(const std::string& json_text, BodyFormat format) {
+        const std::uint64_t key = fnv1a64(json_text) ^ (static_cast<std::uint64_t>(format) << 62);
+        {
+            std::lock_guard lock(mutex_);
+            auto it = entries_.find(key);
+            // FNV-1a ist nicht kollisionsfest und die Bodies kommen teils von Clients: Quelltext vergleichen
+            if (it != entries_.end() && it->second.source == json_text) {
+                counters_.hits.add();
+                return it->second.encoded;
+            }
+        }
+        counters_.misses.add();
+        json value;
+        {
+            auto timer = metrics().time_json_parse();
+            value = json::parse(json_text);
+        }
+        auto encoded = std::make_shared<const std::string>(encode_body(value, format));
+
+        const std::size_t entry_bytes = json_text.size() + encoded->size();
+        std::lock_guard lock(mutex_);
+        if (bytes_ + entry_bytes > budget_bytes) {
+            entries_.clear();
+            bytes_ = 0;
+        }
+        Entry& entry = entries_[key];
+        bytes_ -= entry.source.size() + (entry.encoded ? entry.encoded->size() : 0); // Kollision: ersetzen
+        entry = Entry{json_text, encoded};
+        bytes_ += entry_bytes;
+        return encoded;
+    }
+
+private:
+    struct Entry {
+        std::string source;
+        std::shared_ptr<const std::string> encoded;
+    };
+
+    CacheCounters& counters_;
+    std::mutex mutex_;
+    std::unordered_map<std::uint64_t, Entry> entries_;
+    std::size_t bytes_ = 0;
+};
+
+EncodingCache& encoding_cache() {
+    static EncodingCache cache;
+    return cache;
+}
+
+} // namespace
+
+BodyFormat negotiate_format(const std::string& accept) {
+    if (accept.empty()) return BodyFormat::json;
+    // Höchstes q pro Format; ausdrücklich genannte Typen schlagen Wildcards bei gleichem q, bei Gleichstand gewinnt JSON
+    double q_json = -1.0, q_any = -1.0, q_msgpack = -1.0, q_cbor = -1.0;
+    std::size_t start = 0;
+    while (start <= accept.size()) {
+        std::size_t comma = accept.find(',', start);
+        if (comma == std::string::npos) comma = accept.size();
+        const std::string_view item = std::string_view(accept).substr(start, comma - start);
+        start = comma + 1;
+
+        const std::size_t semicolon = item.find(';');
+        const std::string media_type = trim_lower(item.substr(0, semicolon));
+        double q = 1.0;
+        if (semicolon != std::string_view::npos) {
+            const std::string params = trim_lower(item.substr(semicolon + 1));
+            const std::size_t q_pos = params.find("q=");
+            if (q_pos != std::string::npos) {
+                try {
+                    q = std::stod(params.substr(q_pos + 2));
+                } catch (const std::exception&) {
+                    q = 0.0;
+                }
+            }
+        }
+        bool wildcard = false;
+        const std::optional<BodyFormat> format = format_of_media_type(media_type, wildcard);
+        if (!format) continue;
+        double& slot = wildcard ? q_any : *format == BodyFormat::json ? q_json : *format == BodyFormat::msgpack ? q_msgpack : q_cbor;
+        slot = std::max(slot, q);
+    }
+
+    BodyFormat best = BodyFormat::json;
+    double best_q = std::max(q_json, q_any);
+    bool best_explicit = q_json >= 0.0 && q_json >= q_any;
+    for (auto [format, q] : {std::pair{BodyFormat::msgpack, q_msgpack}, std::pair{BodyFormat::cbor, q_cbor}}) {
+        if (q > 0.0 && (q > best_q || (q == best_q && !best_explicit))) {
+            best = format;
+            best_q = q;
+            best_explicit = true;
+        }
+    }
+    return best;
+}
+
+std::optional<BodyFormat> body_format(const std::string& content_type) {
+    bool wildcard = false;
+    std::optional<BodyFormat> format = format_of_media_type(trim_lower(std::string_view(content_type).substr(0, content_type.find(';'))), wildcard);
+    if (wildcard) return std::nullopt;
+    return format;
+}
+
+const char* content_type_of(BodyFormat format) {
+    switch (format) {
+        case BodyFormat::msgpack: return "application/msgpack";
+        case BodyFormat::cbor: return "application/cbor";
+        default: return "application/json";
+    }
+}
+
+const char* etag_suffix(BodyFormat format) {
+    switch (format) {
+        case BodyFormat::msgpack: return "-msgpack";
+        case BodyFormat::cbor: return "-cbor";
+        default: return "";
+    }
+}
+
+std::string encode_body(const json& value, BodyFormat format) {
+    auto timer = metrics().time_json_dump();
+    std::string out;
+    switch (format) {
+        case BodyFormat::msgpack: json::to_msgpack(value, out); break;
+        case BodyFormat::cbor: json::to_cbor(value, out); break;
+        default: out = value.dump(); break;
+    }
+    return out;
+}
+
+json decode_body(std::string_view body, BodyFormat format) {
+    auto timer = metrics().time_json_parse();
+    switch (format) {
+        case BodyFormat::msgpack: return json::from_msgpack(body.begin(), body.end());
+        case BodyFormat::cbor: return json::from_cbor(body.begin(), body.end());
+        default: return json::parse(body.begin(), body.end());
+    }
+}
+
+std::string transcode_json(const std::string& json_text, BodyFormat format) {
+    if (format == BodyFormat::json) return json_text;
+    return *encoding_cache().get(json_text, format);
+}
+
+void ContentNegotiationMiddleware::before_handle(crow::request& req, crow::response& res, context& ctx) {
+    ctx.response_format = negotiate_format(req.get_header_value("Accept"));
+
+    const std::optional<BodyFormat> request_format = body_format(req.get_header_value("Content-Type"));
+    if (!request_format || *request_format == BodyFormat::json || req.body.empty()) {
+        return;
+    }
+    try {
+        const json value = decode_body(req.body, *request_format);
+        // Ungültiges UTF-8 in Strings fällt erst beim Serialisieren auf
+        req.body = value.dump();
+    } catch (const std::exception& e) {
+        res = crow::response(400, json{{"error", std::string("Invalid ") + content_type_of(*request_format) + " body."}, {"detail", e.what()}}.dump());
+        res.set_header("Content-Type", "application/json");
+        res.end();
+        return;
+    }
+    req.headers.erase("Content-Type");
+    req.headers.emplace("Content-Type", "application/json");
+}
+
+void ContentNegotiationMiddleware::after_handle(crow::request& /*req*/, crow::response& res, context& ctx) {
+    if (res.body.empty() || res.code == 204 || res.code == 304) {
+        return;
+    }
+    const std::string content_type = res.get_header_value("Content-Type");
+    const bool is_json = content_type.rfind("application/json", 0) == 0 ||
+                         (content_type.empty() && (res.body.front() == '{' || res.body.front() == '['));
+    if (!is_json) {
+        return; // Schon binär (CachedResponse) oder kein JSON (z.B. /api/metrics)
+    }
+    const std::string vary = res.get_header_value("Vary");
+    if (vary.find("Accept,") == std::string::npos && (vary.size() < 6 || vary.compare(vary.size() - 6, 6, "Accept") != 0)) {
+        res.set_header("Vary", vary.empty() ? "Accept" : vary + ", Accept");
+    }
+    if (ctx.response_format == BodyFormat::json || !res.get_header_value("Content-Encoding").empty()) {
+        return;
+    }
+    try {
+        res.body = transcode_json(res.body, ctx.response_format);
+    } catch (const std::exception& e) {
+        log_warn("Antwort konnte nicht umkodiert werden", {{"format", content_type_of(ctx.response_format)}, {"error", e.what()}});
+        return;
+    }
+    res.set_header("Content-Type", content_type_of(ctx.response_format));
+    const std::string etag = res.get_header_value("ETag");
+    if (etag.size() >= 2 && etag.back() == '"') {
+        res.set_header("ETag", etag.substr(0, etag.size() - 1) + etag_suffix(ctx.response_format) + "\"");
+    }
+}
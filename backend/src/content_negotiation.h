@@ -0,0 +1,42 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "crow.h"
+#include "nlohmann/json.hpp"
+
+// --- Content Negotiation: JSON, MessagePack und CBOR ---
+// Routen arbeiten intern weiter mit JSON-Text. ContentNegotiationMiddleware übersetzt an der Grenze:
+// - Request-Bodies mit Content-Type application/msgpack bzw. application/cbor werden vor dem Handler in
+//   JSON umgewandelt (ungültige Bodies: 400).
+// - JSON-Antworten werden nach Accept als MessagePack bzw. CBOR ausgeliefert (Vary: Accept, eigenes ETag).
+// Vorbereitete Antworten (send_cached_response) wählen das Format selbst, damit If-None-Match auch für die
+// binären ETags greift. Umkodierte Bodies landen in einem begrenzten Cache (Inhalts-Hash -> Kodierung),
+// populäre Statblöcke und Listen werden also nur einmal umgewandelt.
+
+enum class BodyFormat { json, msgpack, cbor };
+
+// Bevorzugtes Antwortformat laut Accept (q-Werte; fehlender Header, */* und Gleichstand = JSON)
+BodyFormat negotiate_format(const std::string& accept);
+// Format eines Request-Bodys laut Content-Type, nullopt für andere Typen
+std::optional<BodyFormat> body_format(const std::string& content_type);
+const char* content_type_of(BodyFormat format);
+// Anhang für das ETag einer binären Variante ("-msgpack", "-cbor", bei JSON leer)
+const char* etag_suffix(BodyFormat format);
+
+std::string encode_body(const nlohmann::json& value, BodyFormat format);
+// Wirft nlohmann::json::exception bei ungültigem Inhalt
+nlohmann::json decode_body(std::string_view body, BodyFormat format);
+// JSON-Text in format umkodieren (über den Kodierungs-Cache); wirft bei ungültigem JSON
+std::string transcode_json(const std::string& json_text, BodyFormat format);
+
+struct ContentNegotiationMiddleware {
+    struct context {
+        BodyFormat response_format = BodyFormat::json;
+    };
+    void before_handle(crow::request& req, crow::response& res, context& ctx);
+    void after_handle(crow::request& req, crow::response& res, context& ctx);
+};
+// --- Ende Content Negotiation ---
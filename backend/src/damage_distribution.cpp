@@ -0,0 +1,426 @@
+#include "damage_distribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Ab dieser Länge beider Faktoren lohnt sich die FFT gegenüber der direkten Faltung
+constexpr std::size_t fft_threshold = 64;
+// Speicher für gemerkte Würfelsummen (Statblöcke bestimmen Anzahl und Größe, bis etwa 1000d1000)
+constexpr std::size_t dice_sum_budget_bytes = 16u << 20;
+
+void fft(std::vector<std::complex<double>>& a, bool invert) {
+    const std::size_t n = a.size();
+    for (std::size_t i = 1, j = 0; i < n; ++i) {
+        std::size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+    for (std::size_t len = 2; len <= n; len <<= 1) {
+        const double angle = 2 * M_PI / static_cast<double>(len) * (invert ? -1 : 1);
+        const std::complex<double> step(std::cos(angle), std::sin(angle));
+        for (std::size_t i = 0; i < n; i += len) {
+            std::complex<double> w(1);
+            for (std::size_t k = 0; k < len / 2; ++k) {
+                const std::complex<double> u = a[i + k];
+                const std::complex<double> v = a[i + k + len / 2] * w;
+                a[i + k] = u + v;
+                a[i + k + len / 2] = u - v;
+                w *= step;
+            }
+        }
+    }
+    if (invert) {
+        for (auto& value : a) value /= static_cast<double>(n);
+    }
+}
+
+std::vector<double> convolve_direct(const std::vector<double>& a, const std::vector<double>& b) {
+    std::vector<double> out(a.size() + b.size() - 1, 0.0);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == 0.0) continue;
+        for (std::size_t j = 0; j < b.size(); ++j) out[i + j] += a[i] * b[j];
+    }
+    return out;
+}
+
+std::vector<double> convolve_fft(const std::vector<double>& a, const std::vector<double>& b) {
+    const std::size_t result_size = a.size() + b.size() - 1;
+    std::size_t n = 1;
+    while (n < result_size) n <<= 1;
+    std::vector<std::complex<double>> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+    fa.resize(n);
+    fb.resize(n);
+    fft(fa, false);
+    fft(fb, false);
+    for (std::size_t i = 0; i < n; ++i) fa[i] *= fb[i];
+    fft(fa, true);
+
+    // Rundungsfehler der FFT: kleine negative Werte abschneiden und neu normieren
+    std::vector<double> out(result_size);
+    double total = 0.0;
+    for (std::size_t i = 0; i < result_size; ++i) {
+        out[i] = std::max(0.0, fa[i].real());
+        total += out[i];
+    }
+    if (total > 0.0) {
+        for (double& value : out) value /= total;
+    }
+    return out;
+}
+
+Pmf reflect(const Pmf& pmf) {
+    Pmf out;
+    out.offset = -pmf.max_value();
+    out.probs.assign(pmf.probs.rbegin(), pmf.probs.rend());
+    return out;
+}
+
+int number_or(const json& data, const char* key, int fallback) {
+    return data.contains(key) && data[key].is_number() ? data[key].get<int>() : fallback;
+}
+
+// Eine Aktion mit ihren zwei Schadens-Ausgängen: Angriff (Treffer, Krit) bzw. Rettungswurf (misslungen, gelungen)
+struct ActionModel {
+    std::string name;
+    bool is_save = false;
+    int attack_bonus = 0;
+    int dc = 10;
+    std::string save_stat;
+    int recharge_min = 0;
+    DiceExpression damage;
+    Pmf primary;   // Treffer bzw. misslungener Rettungswurf
+    Pmf secondary; // Krit bzw. gelungener Rettungswurf
+    double primary_mean = 0.0;
+    double secondary_mean = 0.0;
+
+    // Gewichte (primary, secondary) gegen ein Ziel, der Rest ist 0 Schaden
+    std::pair<double, double> weights(int ac, int save_bonus) const {
+        if (is_save) {
+            const double fail = std::clamp(dc - save_bonus - 1, 0, 20) / 20.0;
+            return {fail, 1.0 - fail};
+        }
+        const int needed = ac - attack_bonus;
+        const int normal_hits = std::max(0, 19 - std::max(2, needed) + 1); // Augen 2..19, die treffen
+        return {normal_hits / 20.0, 1.0 / 20.0};
+    }
+
+    double expected(int ac, int save_bonus) const {
+        const auto [w1, w2] = weights(ac, save_bonus);
+        return w1 * primary_mean + w2 * secondary_mean;
+    }
+
+    Pmf distribution(int ac, int save_bonus) const {
+        const auto [w1, w2] = weights(ac, save_bonus);
+        const Pmf zero = Pmf::point(0);
+        return mix({{w1, &primary}, {w2, &secondary}, {std::max(0.0, 1.0 - w1 - w2), &zero}});
+    }
+
+    double availability() const { return recharge_min > 0 ? (7 - recharge_min) / 6.0 : 1.0; }
+};
+
+std::vector<ActionModel> actions_from_statblock(const json& statblock) {
+    std::vector<ActionModel> models;
+    const json actions = statblock.value("actions", json::object());
+    for (const auto& data : actions.value("attackRoll", json::array())) {
+        if (!data.is_object()) continue;
+        ActionModel model;
+        model.name = data.value("name", "Attack");
+        model.attack_bonus = number_or(data, "attackMod", 0);
+        try {
+            model.damage = compile_dice(data.value("damage", json::array()));
+        } catch (const std::invalid_argument&) {
+            continue; // Ungültige Würfel: Aktion überspringen
+        }
+        model.primary = clamp_non_negative(expression_pmf(model.damage));
+        model.secondary = clamp_non_negative(expression_pmf(model.damage, true));
+        models.push_back(std::move(model));
+    }
+    for (const auto& data : actions.value("savingThrow", json::array())) {
+        if (!data.is_object()) continue;
+        ActionModel model;
+        model.is_save = true;
+        model.name = data.value("name", "Saving Throw");
+        const json dc = data.value("safeDC", json::object());
+        model.dc = dc.is_object() && dc.contains("overrideValue") && dc["overrideValue"].is_number() ? dc["overrideValue"].get<int>() : number_or(dc, "defaultValue", 10);
+        model.save_stat = data.value("saveStat", "");
+        model.recharge_min = recharge_threshold(data.value("recharge", json()));
+        try {
+            model.damage = compile_dice(data.value("damage", json::array()));
+        } catch (const std::invalid_argument&) {
+            continue;
+        }
+        model.primary = clamp_non_negative(expression_pmf(model.damage));
+        model.secondary = halve(model.primary);
+        models.push_back(std::move(model));
+    }
+    for (ActionModel& model : models) {
+        model.primary_mean = model.primary.mean();
+        model.secondary_mean = model.secondary.mean();
+    }
+    return models;
+}
+
+// Beste Aktion ohne Recharge und beste Recharge-Aktion (nach Erwartungswert) gegen ein Ziel, -1 = keine
+std::pair<int, int> best_actions(const std::vector<ActionModel>& models, int ac, int save_bonus) {
+    int normal = -1, recharge = -1;
+    for (std::size_t i = 0; i < models.size(); ++i) {
+        int& slot = models[i].recharge_min > 0 ? recharge : normal;
+        if (slot < 0 || models[i].expected(ac, save_bonus) > models[slot].expected(ac, save_bonus)) slot = static_cast<int>(i);
+    }
+    // Recharge nur, wenn sie besser ist als die normale Aktion
+    if (recharge >= 0 && normal >= 0 && models[recharge].expected(ac, save_bonus) <= models[normal].expected(ac, save_bonus)) recharge = -1;
+    return {normal, recharge};
+}
+
+double round_expected(const std::vector<ActionModel>& models, int ac, int save_bonus) {
+    const auto [normal, recharge] = best_actions(models, ac, save_bonus);
+    const double normal_value = normal >= 0 ? models[normal].expected(ac, save_bonus) : 0.0;
+    if (recharge < 0) return normal_value;
+    const double p = models[recharge].availability();
+    return p * models[recharge].expected(ac, save_bonus) + (1.0 - p) * normal_value;
+}
+
+Pmf round_distribution(const std::vector<ActionModel>& models, int ac, int save_bonus) {
+    const auto [normal, recharge] = best_actions(models, ac, save_bonus);
+    const Pmf normal_pmf = normal >= 0 ? models[normal].distribution(ac, save_bonus) : Pmf::point(0);
+    if (recharge < 0) return normal_pmf;
+    const double p = models[recharge].availability();
+    const Pmf recharge_pmf = models[recharge].distribution(ac, save_bonus);
+    return mix({{p, &recharge_pmf}, {1.0 - p, &normal_pmf}});
+}
+
+json describe(const Pmf& pmf, bool include_pmf) {
+    json out = {{"expected", pmf.mean()},
+                {"p10", pmf.percentile(0.1)},
+                {"p50", pmf.percentile(0.5)},
+                {"p90", pmf.percentile(0.9)},
+                {"max", pmf.max_value()}};
+    if (include_pmf && pmf.max_value() >= max_pmf_values) {
+        out["pmf_omitted"] = true; // Zu viele Werte für eine dichte Liste
+    } else if (include_pmf) {
+        // Schaden ist >= 0: Index = Schaden
+        std::vector<double> dense(static_cast<std::size_t>(std::max(0, pmf.max_value()) + 1), 0.0);
+        for (std::size_t i = 0; i < pmf.probs.size(); ++i) {
+            const int value = pmf.offset + static_cast<int>(i);
+            if (value >= 0) dense[static_cast<std::size_t>(value)] += pmf.probs[i];
+        }
+        out["pmf"] = std::move(dense);
+    }
+    return out;
+}
+
+} // namespace
+
+double Pmf::mean() const {
+    double total = 0.0;
+    for (std::size_t i = 0; i < probs.size(); ++i) total += probs[i] * (offset + static_cast<double>(i));
+    return total;
+}
+
+int Pmf::percentile(double q) const {
+    double cumulative = 0.0;
+    for (std::size_t i = 0; i < probs.size(); ++i) {
+        cumulative += probs[i];
+        if (cumulative >= q - 1e-12) return offset + static_cast<int>(i);
+    }
+    return max_value();
+}
+
+Pmf convolve(const Pmf& a, const Pmf& b) {
+    if (a.probs.empty() || b.probs.empty()) return {};
+    Pmf out;
+    out.offset = a.offset + b.offset;
+    out.probs = std::min(a.probs.size(), b.probs.size()) > fft_threshold ? convolve_fft(a.probs, b.probs) : convolve_direct(a.probs, b.probs);
+    return out;
+}
+
+Pmf mix(const std::vector<std::pair<double, const Pmf*>>& parts) {
+    int low = 0, high = 0;
+    bool first = true;
+    for (const auto& [weight, pmf] : parts) {
+        if (weight <= 0.0 || pmf->probs.empty()) continue;
+        low = first ? pmf->min_value() : std::min(low, pmf->min_value());
+        high = first ? pmf->max_value() : std::max(high, pmf->max_value());
+        first = false;
+    }
+    if (first) return Pmf::point(0);
+
+    Pmf out;
+    out.offset = low;
+    out.probs.assign(static_cast<std::size_t>(high - low + 1), 0.0);
+    for (const auto& [weight, pmf] : parts) {
+        if (weight <= 0.0) continue;
+        for (std::size_t i = 0; i < pmf->probs.size(); ++i) {
+            out.probs[static_cast<std::size_t>(pmf->offset - low) + i] += weight * pmf->probs[i];
+        }
+    }
+    return out;
+}
+
+Pmf clamp_non_negative(const Pmf& pmf) {
+    if (pmf.offset >= 0 || pmf.probs.empty()) return pmf;
+    if (pmf.max_value() <= 0) return Pmf::point(0);
+    Pmf out;
+    out.offset = 0;
+    const std::size_t zero_index = static_cast<std::size_t>(-pmf.offset);
+    out.probs.assign(pmf.probs.begin() + static_cast<std::ptrdiff_t>(zero_index), pmf.probs.end());
+    for (std::size_t i = 0; i < zero_index; ++i) out.probs[0] += pmf.probs[i];
+    return out;
+}
+
+Pmf halve(const Pmf& pmf) {
+    if (pmf.probs.empty()) return pmf;
+    auto floor_half = [](int value) { return value >= 0 ? value / 2 : -((-value + 1) / 2); };
+    Pmf out;
+    out.offset = floor_half(pmf.min_value());
+    out.probs.assign(static_cast<std::size_t>(floor_half(pmf.max_value()) - out.offset + 1), 0.0);
+    for (std::size_t i = 0; i < pmf.probs.size(); ++i) {
+        out.probs[static_cast<std::size_t>(floor_half(pmf.offset + static_cast<int>(i)) - out.offset)] += pmf.probs[i];
+    }
+    return out;
+}
+
+std::shared_ptr<const Pmf> dice_sum_pmf(int count, int size) {
+    // LRU mit Byte-Budget: vorne = zuletzt benutzt
+    using Node = std::pair<std::uint64_t, std::shared_ptr<const Pmf>>;
+    static std::mutex mutex;
+    static std::list<Node> lru;
+    static std::unordered_map<std::uint64_t, std::list<Node>::iterator> memo;
+    static std::size_t bytes = 0;
+    const std::uint64_t key = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(count)) << 32) | static_cast<std::uint32_t>(size);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = memo.find(key);
+        if (it != memo.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            return it->second->second;
+        }
+    }
+
+    // Ohne Lock berechnen (rekursiv über Quadrieren), doppelte Arbeit bei Gleichzeitigkeit ist harmlos
+    Pmf result;
+    if (count <= 0 || size <= 0) {
+        result = Pmf::point(0);
+    } else if (count == 1) {
+        result.offset = 1;
+        result.probs.assign(static_cast<std::size_t>(size), 1.0 / size);
+    } else {
+        std::shared_ptr<const Pmf> half = dice_sum_pmf(count / 2, size);
+        result = convolve(*half, *half);
+        if (count % 2 == 1) result = convolve(result, *dice_sum_pmf(1, size));
+    }
+
+    auto pmf = std::make_shared<const Pmf>(std::move(result));
+    const std::size_t pmf_bytes = pmf->probs.size() * sizeof(double);
+    if (pmf_bytes > dice_sum_budget_bytes / 4) {
+        return pmf; // Einzelne Riesentabellen würden den Rest verdrängen
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = memo.find(key);
+    if (it != memo.end()) {
+        return it->second->second; // Gleichzeitig berechnet
+    }
+    lru.emplace_front(key, pmf);
+    memo.emplace(key, lru.begin());
+    bytes += pmf_bytes;
+    while (bytes > dice_sum_budget_bytes) {
+        bytes -= lru.back().second->probs.size() * sizeof(double);
+        memo.erase(lru.back().first);
+        lru.pop_back();
+    }
+    return pmf;
+}
+
+Pmf expression_pmf(const DiceExpression& expr, bool crit) {
+    Pmf result = Pmf::point(expr.modifier);
+    for (const DiceExpression::Dice& group : expr.dice) {
+        std::shared_ptr<const Pmf> sum = dice_sum_pmf(std::abs(group.count) * (crit ? 2 : 1), group.size);
+        result = convolve(result, group.count < 0 ? reflect(*sum) : *sum);
+    }
+    return result;
+}
+
+Pmf attack_damage_pmf(const DiceExpression& damage, int attack_bonus, int ac) {
+    ActionModel model;
+    model.attack_bonus = attack_bonus;
+    model.primary = clamp_non_negative(expression_pmf(damage));
+    model.secondary = clamp_non_negative(expression_pmf(damage, true));
+    return model.distribution(ac, 0);
+}
+
+Pmf save_damage_pmf(const DiceExpression& damage, int dc, int save_bonus, bool half_on_success) {
+    ActionModel model;
+    model.is_save = true;
+    model.dc = dc;
+    model.primary = clamp_non_negative(expression_pmf(damage));
+    model.secondary = half_on_success ? halve(model.primary) : Pmf::point(0);
+    return model.distribution(0, save_bonus);
+}
+
+json monster_dpr_json(const json& statblock, const DprTargets& targets) {
+    const std::vector<ActionModel> models = actions_from_statblock(statblock);
+
+    json actions = json::array();
+    for (const ActionModel& model : models) {
+        json action = {{"name", model.name}, {"kind", model.is_save ? "save" : "attack"}, {"damage", model.damage.to_string()}};
+        json rows = json::array();
+        if (model.is_save) {
+            action["dc"] = model.dc;
+            action["saveStat"] = model.save_stat;
+            if (model.recharge_min > 0) {
+                action["recharge"] = "(" + std::to_string(model.recharge_min) + "-6)";
+                action["availability"] = model.availability();
+            }
+            for (int save_bonus : targets.save_bonuses) {
+                json row = describe(model.distribution(0, save_bonus), targets.include_pmf);
+                row["saveBonus"] = save_bonus;
+                row["failChance"] = model.weights(0, save_bonus).first;
+                rows.push_back(std::move(row));
+            }
+        } else {
+            action["attackBonus"] = model.attack_bonus;
+            for (int ac : targets.armor_classes) {
+                const auto [hit, crit] = model.weights(ac, 0);
+                json row = describe(model.distribution(ac, 0), targets.include_pmf);
+                row["ac"] = ac;
+                row["hitChance"] = hit + crit;
+                row["critChance"] = crit;
+                rows.push_back(std::move(row));
+            }
+        }
+        action["targets"] = std::move(rows);
+        actions.push_back(std::move(action));
+    }
+
+    json rounds = json::array();
+    for (int ac : targets.armor_classes) {
+        for (int save_bonus : targets.save_bonuses) {
+            json row = describe(round_distribution(models, ac, save_bonus), targets.include_pmf);
+            row["ac"] = ac;
+            row["saveBonus"] = save_bonus;
+            rounds.push_back(std::move(row));
+        }
+    }
+
+    const json basics = statblock.value("basics", json::object());
+    return {{"id", basics.value("id", "")}, {"name", basics.value("name", "")}, {"actions", std::move(actions)}, {"rounds", std::move(rounds)}};
+}
+
+std::vector<double> monster_expected_dpr(const json& statblock, const std::vector<int>& armor_classes, int save_bonus) {
+    const std::vector<ActionModel> models = actions_from_statblock(statblock);
+    std::vector<double> expected;
+    expected.reserve(armor_classes.size());
+    for (int ac : armor_classes) expected.push_back(round_expected(models, ac, save_bonus));
+    return expected;
+}
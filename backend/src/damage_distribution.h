@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "dice.h"
+#include "nlohmann/json.hpp"
+
+// --- Exakte Schadensverteilungen (PMF-Faltung) ---
+// Würfelsummen werden als Wahrscheinlichkeitsfunktion gefaltet, Trefferchance und Krit-Verdopplung
+// werden als Mischung eingerechnet. Summen-Tabellen pro (Anzahl, Größe) werden gemerkt, große
+// Faltungen (z.B. 20d6 Odem) laufen über eine FFT statt der direkten O(n*m)-Schleife.
+
+// probs[i] = P(X = offset + i)
+struct Pmf {
+    int offset = 0;
+    std::vector<double> probs;
+
+    static Pmf point(int value) { return {value, {1.0}}; }
+
+    int min_value() const { return offset; }
+    int max_value() const { return offset + static_cast<int>(probs.size()) - 1; }
+    double mean() const;
+    int percentile(double q) const; // Kleinster Wert mit P(X <= v) >= q
+};
+
+Pmf convolve(const Pmf& a, const Pmf& b);
+// Gewichtete Mischung, Gewichte summieren sich zu 1
+Pmf mix(const std::vector<std::pair<double, const Pmf*>>& parts);
+// Negative Werte zu 0 zusammenfassen (Schaden ist nie negativ)
+Pmf clamp_non_negative(const Pmf& pmf);
+// floor(X / 2) (halber Schaden bei gelungenem Rettungswurf)
+Pmf halve(const Pmf& pmf);
+
+// Summe von count Würfeln der Größe size (gemerkt mit begrenztem Speicher, thread-sicher)
+std::shared_ptr<const Pmf> dice_sum_pmf(int count, int size);
+// Verteilung eines Würfel-Ausdrucks; crit verdoppelt die Würfel, nicht die Konstante
+Pmf expression_pmf(const DiceExpression& expr, bool crit = false);
+
+// Schaden einer Angriffsaktion gegen eine AC (natürliche 1 verfehlt, natürliche 20 ist kritisch)
+Pmf attack_damage_pmf(const DiceExpression& damage, int attack_bonus, int ac);
+// Schaden einer Rettungswurf-Aktion gegen einen Rettungswurf-Bonus
+Pmf save_damage_pmf(const DiceExpression& damage, int dc, int save_bonus, bool half_on_success = true);
+
+// Größter Schaden, bis zu dem monster_dpr_json die dichte Verteilung ausgibt (sonst "pmf_omitted": true)
+constexpr int max_pmf_values = 10000;
+
+struct DprTargets {
+    std::vector<int> armor_classes;
+    std::vector<int> save_bonuses;
+    bool include_pmf = false;
+};
+
+// Verteilungen aller attackRoll/savingThrow-Aktionen eines Statblocks plus Verteilung pro Runde
+// (beste Aktion, Recharge-Fähigkeit gewichtet mit ihrer Verfügbarkeit) für jede AC x Rettungswurf-Bonus
+nlohmann::json monster_dpr_json(const nlohmann::json& statblock, const DprTargets& targets);
+// Nur der Erwartungswert pro Runde (für die Katalog-Tabelle), gleiche Reihenfolge wie armor_classes
+std::vector<double> monster_expected_dpr(const nlohmann::json& statblock, const std::vector<int>& armor_classes, int save_bonus);
+// --- Ende Schadensverteilungen ---
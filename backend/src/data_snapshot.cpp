@@ -0,0 +1,446 @@
+#include "data_snapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "catalog_pack.h"
+#include "logger.h"
+#include "metrics.h"
+#include "parallel.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+std::shared_ptr<const SnapshotEntry> make_entry(json document) {
+    return std::make_shared<const SnapshotEntry>(std::move(document));
+}
+
+// Liest und parst eine Datei; nullptr wenn sie fehlt oder kein gültiges JSON ist
+std::shared_ptr<const SnapshotEntry> load_entry(const std::filesystem::path& path, std::size_t* size) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return nullptr;
+    }
+    try {
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        const std::string raw = buffer.str();
+        if (size) *size = raw.size();
+        metrics().io().file_opens.add();
+        metrics().io().bytes_read.add(raw.size());
+        json document;
+        {
+            auto timer = metrics().time_json_parse();
+            document = json::parse(raw);
+        }
+        return make_entry(std::move(document));
+    } catch (const std::exception& e) {
+        log_error("Fehler beim Vorladen", {{"path", path.string()}, {"error", e.what()}});
+        return nullptr;
+    }
+}
+
+// Schlüssel aus Routen dürfen das Kategorie-Verzeichnis nicht verlassen
+bool is_safe_key(const std::string& key) {
+    const std::filesystem::path path = std::filesystem::path(key).lexically_normal();
+    return !key.empty() && path.is_relative() && !path.empty() && *path.begin() != "..";
+}
+
+} // namespace
+
+SnapshotEntry::SnapshotEntry(json document) {
+    {
+        auto timer = metrics().time_json_dump();
+        owned_body_ = document.dump();
+    }
+    body_ = owned_body_;
+    document_ = std::move(document);
+    std::call_once(parsed_, []() {});
+}
+
+SnapshotEntry::SnapshotEntry(std::shared_ptr<const CatalogPack> pack, std::string_view body)
+    : pack_(std::move(pack)), body_(body) {}
+
+const json& SnapshotEntry::document() const {
+    std::call_once(parsed_, [this]() {
+        auto timer = metrics().time_json_parse();
+        document_ = json::parse(body_); // Vom Packer validiert
+    });
+    return document_;
+}
+
+std::shared_ptr<const SnapshotEntry> DataSnapshot::find(const std::string& category_name, const std::string& key) const {
+    const SnapshotCategory* entries = category(category_name);
+    if (!entries) {
+        return nullptr;
+    }
+    auto it = entries->find(key);
+    return it != entries->end() ? it->second : nullptr;
+}
+
+const SnapshotCategory* DataSnapshot::category(const std::string& name) const {
+    auto it = categories.find(name);
+    return it != categories.end() ? it->second.get() : nullptr;
+}
+
+DataSnapshotStore::DataSnapshotStore(std::filesystem::path data_dir, std::vector<std::string> categories)
+    : data_dir_(std::move(data_dir)),
+      category_names_(std::move(categories)),
+      snapshot_(std::make_shared<const DataSnapshot>()) {}
+
+DataSnapshotStore::~DataSnapshotStore() {
+    stop_revalidation();
+}
+
+std::shared_ptr<const DataSnapshot> DataSnapshotStore::current() const {
+    return std::atomic_load(&snapshot_);
+}
+
+void DataSnapshotStore::add_warmup_step(std::string name, std::function<std::size_t()> step) {
+    warmup_steps_.emplace_back(std::move(name), std::move(step));
+}
+
+void DataSnapshotStore::warm_up() {
+    std::lock_guard rebuild(rebuild_mutex_);
+    {
+        std::lock_guard lock(update_mutex_);
+        rebuilding_ = true;
+        updates_during_rebuild_.clear();
+    }
+
+    auto fresh = std::make_shared<DataSnapshot>();
+    std::vector<WarmupStats> stats;
+    std::map<std::string, std::map<std::string, SourceStamp>> stamps;
+
+    for (const std::string& category_name : category_names_) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::filesystem::path category_dir = data_dir_ / category_name;
+
+        std::vector<std::filesystem::path> files;
+        std::vector<SourceStamp> file_stamps;
+        try {
+            if (std::filesystem::is_directory(category_dir)) {
+                for (const auto& entry : std::filesystem::recursive_directory_iterator(category_dir)) {
+                    if (entry.is_regular_file() && entry.path().extension() == ".json") {
+                        std::error_code ec;
+                        SourceStamp stamp{entry.last_write_time(ec), 0};
+                        stamp.size = entry.file_size(ec);
+                        files.push_back(entry.path());
+                        file_stamps.push_back(stamp);
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            log_error("Fehler beim Auflisten", {{"path", category_dir.string()}, {"error", e.what()}});
+        }
+
+        // Parsen und Serialisieren parallel über alle Kerne; unveränderte Dateien aus dem Catalog-Pack
+        // brauchen nur einen stat-Aufruf
+        std::vector<std::shared_ptr<const SnapshotEntry>> loaded(files.size());
+        std::vector<std::size_t> sizes(files.size(), 0);
+        std::vector<char> packed(files.size(), 0);
+        parallel_for(files.size(), [&](std::size_t i) {
+            if (pack_) {
+                const std::string key = files[i].lexically_relative(category_dir).generic_string();
+                if (std::optional<CatalogPack::Record> record = pack_->find_fresh(category_name, key, files[i])) {
+                    loaded[i] = std::make_shared<const SnapshotEntry>(pack_, record->body);
+                    sizes[i] = record->source_size;
+                    packed[i] = 1;
+                    return;
+                }
+            }
+            loaded[i] = load_entry(files[i], &sizes[i]);
+        }, 1);
+
+        auto entries = std::make_shared<SnapshotCategory>();
+        auto& category_stamps = stamps[category_name];
+        WarmupStats category_stats;
+        category_stats.category = category_name;
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            if (!loaded[i]) {
+                ++category_stats.errors;
+                continue;
+            }
+            const std::string key = files[i].lexically_relative(category_dir).generic_string();
+            entries->emplace(key, std::move(loaded[i]));
+            category_stamps[key] = file_stamps[i];
+            ++category_stats.files;
+            category_stats.from_pack += packed[i];
+            category_stats.bytes += sizes[i];
+        }
+        fresh->categories[category_name] = std::move(entries);
+
+        category_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.push_back(category_stats);
+    }
+
+    for (const auto& [name, step] : warmup_steps_) {
+        const auto start = std::chrono::steady_clock::now();
+        WarmupStats step_stats;
+        step_stats.category = name;
+        try {
+            step_stats.files = step();
+        } catch (const std::exception& e) {
+            ++step_stats.errors;
+            log_error("Fehler im Warm-Start-Schritt", {{"step", name}, {"error", e.what()}});
+        }
+        step_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.push_back(step_stats);
+    }
+
+    for (const auto& s : stats) {
+        log_info("Warm-Start", {{"category", s.category}, {"files", s.files}, {"from_pack", s.from_pack}, {"kb", s.bytes / 1024}, {"errors", s.errors}, {"ms", s.milliseconds}});
+    }
+
+    {
+        std::lock_guard guard(misses_mutex_);
+        misses_.clear();
+    }
+
+    std::lock_guard lock(update_mutex_);
+    std::atomic_store(&snapshot_, std::shared_ptr<const DataSnapshot>(std::move(fresh)));
+    stamps_ = std::move(stamps);
+    // Schreibzugriffe, die während des Aufbaus passiert sind, auf den neuen Snapshot anwenden
+    rebuilding_ = false;
+    apply_locked(updates_during_rebuild_);
+    for (const auto& update : updates_during_rebuild_) {
+        note_write_locked(update.category, update.key);
+    }
+    updates_during_rebuild_.clear();
+    stats_ = std::move(stats);
+    warm_ = true;
+}
+
+std::vector<WarmupStats> DataSnapshotStore::warmup_stats() const {
+    std::lock_guard lock(update_mutex_);
+    return stats_;
+}
+
+void DataSnapshotStore::put(const std::string& category, const std::string& key, const json& document) {
+    PendingUpdate update{category, key, make_entry(document)};
+    std::lock_guard lock(update_mutex_);
+    apply_locked({update});
+    note_write_locked(category, key);
+    if (rebuilding_) {
+        updates_during_rebuild_.push_back(std::move(update));
+    }
+}
+
+void DataSnapshotStore::erase(const std::string& category, const std::string& key) {
+    PendingUpdate update{category, key, nullptr};
+    std::lock_guard lock(update_mutex_);
+    apply_locked({update});
+    note_write_locked(category, key);
+    if (rebuilding_) {
+        updates_during_rebuild_.push_back(std::move(update));
+    }
+}
+
+void DataSnapshotStore::note_write_locked(const std::string& category, const std::string& key) {
+    // Dateistand unbekannt, bis das Journal die Änderung übertragen hat (revalidate() übernimmt ihn dann)
+    auto it = stamps_.find(category);
+    if (it != stamps_.end()) {
+        it->second.erase(key);
+    }
+    if (revalidating_) {
+        written_during_revalidation_.emplace_back(category, key);
+    }
+}
+
+std::shared_ptr<const SnapshotEntry> DataSnapshotStore::find(const std::string& category, const std::string& key) {
+    if (!warm_.load()) {
+        return nullptr;
+    }
+    if (std::shared_ptr<const SnapshotEntry> entry = current()->find(category, key)) {
+        return entry;
+    }
+
+    // Nicht im Snapshot: von außen angelegt und noch nicht abgeglichen? Ausstehende Journal-Änderungen
+    // (Löschung) sind schon im Snapshot enthalten, die Platte ist dann veraltet.
+    if (!is_safe_key(key)) {
+        return nullptr;
+    }
+    auto miss = std::make_pair(category, key);
+    {
+        std::lock_guard guard(misses_mutex_);
+        if (misses_.count(miss)) return nullptr;
+    }
+    const std::filesystem::path path = data_dir_ / category / key;
+    std::error_code ec;
+    std::shared_ptr<const SnapshotEntry> entry;
+    SourceStamp stamp;
+    if (std::filesystem::is_regular_file(path, ec) && !pending(path)) {
+        stamp = SourceStamp{std::filesystem::last_write_time(path, ec), 0};
+        stamp.size = std::filesystem::file_size(path, ec);
+        entry = load_entry(path, nullptr);
+    }
+    if (!entry) {
+        std::lock_guard guard(misses_mutex_);
+        misses_.insert(std::move(miss));
+        return nullptr;
+    }
+
+    std::lock_guard lock(update_mutex_);
+    if (std::shared_ptr<const SnapshotEntry> existing = current()->find(category, key)) {
+        return existing; // Inzwischen von put() oder einem anderen Leser eingetragen
+    }
+    apply_locked({PendingUpdate{category, key, entry}});
+    stamps_[category][key] = stamp;
+    log_debug("Snapshot nachgeladen", {{"category", category}, {"key", key}});
+    return entry;
+}
+
+void DataSnapshotStore::start_revalidation() {
+    std::lock_guard lock(revalidation_mutex_);
+    if (revalidation_thread_.joinable()) return;
+    stop_revalidation_ = false;
+    revalidation_thread_ = std::thread([this]() { revalidation_loop(); });
+}
+
+void DataSnapshotStore::stop_revalidation() {
+    {
+        std::lock_guard lock(revalidation_mutex_);
+        stop_revalidation_ = true;
+    }
+    revalidation_cv_.notify_all();
+    if (revalidation_thread_.joinable()) revalidation_thread_.join();
+}
+
+void DataSnapshotStore::revalidation_loop() {
+    std::unique_lock lock(revalidation_mutex_);
+    while (!revalidation_cv_.wait_for(lock, revalidate_interval, [this]() { return stop_revalidation_; })) {
+        lock.unlock();
+        if (warm_.load()) revalidate();
+        lock.lock();
+    }
+}
+
+void DataSnapshotStore::revalidate() {
+    std::lock_guard rebuild(rebuild_mutex_);
+    std::map<std::string, std::map<std::string, SourceStamp>> known;
+    {
+        std::lock_guard lock(update_mutex_);
+        known = stamps_;
+        revalidating_ = true;
+        written_during_revalidation_.clear();
+    }
+    std::shared_ptr<const DataSnapshot> snapshot = current();
+    static const SnapshotCategory no_entries;
+
+    struct Change {
+        std::string category;
+        std::string key;
+        std::shared_ptr<const SnapshotEntry> entry; // nullptr = löschen
+        SourceStamp stamp;
+    };
+    std::vector<Change> changes;
+    for (const std::string& category : category_names_) {
+        const std::filesystem::path category_dir = data_dir_ / category;
+        std::error_code ec;
+        if (!std::filesystem::is_directory(category_dir, ec)) {
+            continue;
+        }
+        const SnapshotCategory* entries = snapshot->category(category);
+        if (!entries) entries = &no_entries;
+        const std::map<std::string, SourceStamp>& category_stamps = known[category];
+        const std::size_t first_change = changes.size();
+        std::set<std::string> seen;
+        try {
+            for (const auto& file : std::filesystem::recursive_directory_iterator(category_dir)) {
+                if (!file.is_regular_file() || file.path().extension() != ".json") {
+                    continue;
+                }
+                const std::string key = file.path().lexically_relative(category_dir).generic_string();
+                seen.insert(key);
+                if (pending(file.path())) {
+                    continue; // Journal überträgt gerade eine Server-Änderung, der Snapshot ist aktueller als die Datei
+                }
+                SourceStamp stamp{file.last_write_time(ec), 0};
+                stamp.size = file.file_size(ec);
+
+                auto entry_it = entries->find(key);
+                auto stamp_it = category_stamps.find(key);
+                if (entry_it != entries->end() && stamp_it == category_stamps.end()) {
+                    // Vom Server geschrieben und inzwischen übertragen: Stand übernehmen statt neu zu lesen
+                    changes.push_back({category, key, entry_it->second, stamp});
+                    continue;
+                }
+                if (entry_it != entries->end() && stamp_it->second.mtime == stamp.mtime && stamp_it->second.size == stamp.size) {
+                    continue;
+                }
+                if (std::shared_ptr<const SnapshotEntry> entry = load_entry(file.path(), nullptr)) {
+                    changes.push_back({category, key, std::move(entry), stamp});
+                }
+            }
+        } catch (const std::exception& e) {
+            log_error("Fehler beim Auflisten", {{"path", category_dir.string()}, {"error", e.what()}});
+            changes.resize(first_change); // Ohne vollständige Liste nichts löschen
+            continue;
+        }
+        for (const auto& [key, entry] : *entries) {
+            if (!seen.count(key) && !pending(category_dir / key)) {
+                changes.push_back({category, key, nullptr, SourceStamp{}});
+            }
+        }
+    }
+
+    {
+        std::lock_guard lock(update_mutex_);
+        revalidating_ = false;
+        std::vector<PendingUpdate> updates;
+        for (Change& change : changes) {
+            const bool written = std::find(written_during_revalidation_.begin(), written_during_revalidation_.end(),
+                                           std::make_pair(change.category, change.key)) != written_during_revalidation_.end();
+            if (written) {
+                continue; // put()/erase() während des Abgleichs ist neuer als unser Dateistand
+            }
+            if (change.entry) {
+                stamps_[change.category][change.key] = change.stamp;
+            } else {
+                stamps_[change.category].erase(change.key);
+            }
+            if (change.entry != snapshot->find(change.category, change.key)) {
+                log_debug("Snapshot abgeglichen", {{"category", change.category}, {"key", change.key}});
+                updates.push_back(PendingUpdate{std::move(change.category), std::move(change.key), std::move(change.entry)});
+            }
+        }
+        written_during_revalidation_.clear();
+        apply_locked(updates);
+    }
+
+    std::lock_guard guard(misses_mutex_);
+    misses_.clear(); // Neu angelegte Dateien sind jetzt im Snapshot, alles andere darf neu geprüft werden
+}
+
+void DataSnapshotStore::apply_locked(const std::vector<PendingUpdate>& updates) {
+    if (updates.empty()) {
+        return;
+    }
+    std::shared_ptr<const DataSnapshot> old_snapshot = std::atomic_load(&snapshot_);
+    auto next = std::make_shared<DataSnapshot>(*old_snapshot); // Kopiert nur die Kategorie-Zeiger
+
+    std::map<std::string, std::shared_ptr<SnapshotCategory>> copies; // Pro Kategorie nur eine Kopie
+    for (const PendingUpdate& update : updates) {
+        std::shared_ptr<SnapshotCategory>& entries = copies[update.category];
+        if (!entries) {
+            entries = std::make_shared<SnapshotCategory>();
+            if (const SnapshotCategory* old_entries = old_snapshot->category(update.category)) {
+                *entries = *old_entries;
+            }
+        }
+        if (update.entry) {
+            (*entries)[update.key] = update.entry;
+        } else {
+            entries->erase(update.key);
+        }
+    }
+    for (auto& [category, entries] : copies) {
+        next->categories[category] = std::move(entries);
+    }
+
+    std::atomic_store(&snapshot_, std::shared_ptr<const DataSnapshot>(std::move(next)));
+}
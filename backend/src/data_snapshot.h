@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+class CatalogPack;
+
+// --- Unveränderlicher Snapshot aller Referenzdaten ---
+// Beim Start werden alle Dateien unter data/ (DnDData, spells, templates, classes, ...)
+// parallel geparst und als ein Snapshot veröffentlicht. Lesende Routen holen sich den
+// aktuellen Snapshot (shared_ptr, atomar getauscht) und greifen ohne Locks darauf zu.
+// Schreib-Routen erzeugen eine Kopie mit der Änderung und tauschen sie aus (copy-on-write).
+// Mit Catalog-Pack (set_pack) kommen unveränderte Dateien ohne Parsen aus dem Mapping.
+// Änderungen von außen: ein Hintergrund-Thread (start_revalidation) gleicht alle revalidate_interval jede
+// Kategorie per mtime/Größe mit dem Dateibaum ab (wie ManifestIndex) und tauscht alle Änderungen eines
+// Durchlaufs mit einem neuen Snapshot ein. find() liest fehlende Schlüssel einmal von der Platte nach und
+// merkt sich Fehlanzeigen bis zum nächsten Abgleich. Dateien mit ausstehender Journal-Änderung
+// (set_pending_check) stammen vom Server und bleiben dabei unberührt.
+
+class SnapshotEntry {
+public:
+    // Serialisiert document sofort
+    explicit SnapshotEntry(nlohmann::json document);
+    // Body direkt aus dem Catalog-Pack (hält das Mapping am Leben); der json-Baum wird erst beim ersten document() geparst
+    SnapshotEntry(std::shared_ptr<const CatalogPack> pack, std::string_view body);
+
+    SnapshotEntry(const SnapshotEntry&) = delete;
+    SnapshotEntry& operator=(const SnapshotEntry&) = delete;
+
+    const nlohmann::json& document() const;
+    // Serialisiertes JSON (kompakt), direkt als Response-Body nutzbar
+    std::string_view body() const { return body_; }
+
+private:
+    std::shared_ptr<const CatalogPack> pack_;
+    std::string owned_body_;
+    std::string_view body_;
+    mutable std::once_flag parsed_;
+    mutable nlohmann::json document_;
+};
+
+using SnapshotCategory = std::map<std::string, std::shared_ptr<const SnapshotEntry>>;
+
+struct DataSnapshot {
+    // Kategorie (Verzeichnisname, z.B. "DnDData") -> relativer Pfad (z.B. "crData.json") -> Eintrag
+    std::map<std::string, std::shared_ptr<const SnapshotCategory>> categories;
+
+    std::shared_ptr<const SnapshotEntry> find(const std::string& category, const std::string& key) const;
+    const SnapshotCategory* category(const std::string& name) const;
+};
+
+struct WarmupStats {
+    std::string category;
+    std::size_t files = 0;
+    std::size_t bytes = 0;
+    std::size_t errors = 0;
+    std::size_t from_pack = 0; // Davon unverändert aus dem Catalog-Pack (ohne Parsen)
+    double milliseconds = 0.0;
+};
+
+class DataSnapshotStore {
+public:
+    static constexpr std::chrono::seconds revalidate_interval{5};
+
+    DataSnapshotStore(std::filesystem::path data_dir, std::vector<std::string> categories);
+    ~DataSnapshotStore();
+
+    // Aktueller Snapshot (nie nullptr, vor dem Warm-Start leer)
+    std::shared_ptr<const DataSnapshot> current() const;
+
+    // Eintrag aus dem Snapshot; fehlt er dort, wird die Datei (einmal bis zum nächsten Abgleich) nachgelesen.
+    // nullptr vor dem Warm-Start und wenn die Datei fehlt oder ungültig ist
+    std::shared_ptr<const SnapshotEntry> find(const std::string& category, const std::string& key);
+
+    // Catalog-Pack für warm_up(), nur vor dem Warm-Start setzen (nullptr = alles aus dem JSON-Baum)
+    void set_pack(std::shared_ptr<const CatalogPack> pack) { pack_ = std::move(pack); }
+    // true = Datei hat eine noch nicht übertragene Journal-Änderung; nur vor dem Warm-Start setzen
+    void set_pending_check(std::function<bool(const std::filesystem::path&)> check) { pending_check_ = std::move(check); }
+
+    // Zusätzlicher Schritt der Warm-Start-Phase (z.B. Monster-Katalog), gibt die Anzahl geladener Einträge zurück
+    void add_warmup_step(std::string name, std::function<std::size_t()> step);
+
+    // Lädt alle Kategorien parallel neu und veröffentlicht den neuen Snapshot
+    void warm_up();
+    bool is_warm() const { return warm_.load(); }
+    std::vector<WarmupStats> warmup_stats() const;
+
+    // Hintergrund-Abgleich mit dem Dateibaum (läuft erst nach dem Warm-Start los)
+    void start_revalidation();
+    void stop_revalidation();
+
+    // Copy-on-write Änderung einzelner Einträge (von Schreib-Routen aufgerufen)
+    void put(const std::string& category, const std::string& key, const nlohmann::json& document);
+    void erase(const std::string& category, const std::string& key);
+
+private:
+    struct PendingUpdate {
+        std::string category;
+        std::string key;
+        std::shared_ptr<const SnapshotEntry> entry; // nullptr = löschen
+    };
+
+    struct SourceStamp {
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t size = 0;
+    };
+
+    // Kopiert jede betroffene Kategorie einmal und veröffentlicht einen neuen Snapshot
+    void apply_locked(const std::vector<PendingUpdate>& updates);
+    void note_write_locked(const std::string& category, const std::string& key);
+    void revalidation_loop();
+    void revalidate();
+    bool pending(const std::filesystem::path& file) const { return pending_check_ && pending_check_(file); }
+
+    std::filesystem::path data_dir_;
+    std::vector<std::string> category_names_;
+    std::shared_ptr<const CatalogPack> pack_;
+    std::function<bool(const std::filesystem::path&)> pending_check_;
+    std::vector<std::pair<std::string, std::function<std::size_t()>>> warmup_steps_;
+
+    std::shared_ptr<const DataSnapshot> snapshot_;
+    std::atomic<bool> warm_{false};
+
+    mutable std::mutex update_mutex_; // Serialisiert Schreiber untereinander
+    bool rebuilding_ = false;
+    std::vector<PendingUpdate> updates_during_rebuild_; // Wird nach dem Neuaufbau nachgespielt
+    std::vector<WarmupStats> stats_;
+
+    // Kategorie -> Schlüssel -> Dateistand beim Laden; fehlt bei Einträgen aus put() (wird beim Abgleich übernommen)
+    std::map<std::string, std::map<std::string, SourceStamp>> stamps_;
+    bool revalidating_ = false;
+    std::vector<std::pair<std::string, std::string>> written_during_revalidation_; // Nicht vom Abgleich überschreiben
+
+    std::mutex rebuild_mutex_; // Abgleich und warm_up() nie gleichzeitig
+
+    std::mutex misses_mutex_;
+    std::set<std::pair<std::string, std::string>> misses_; // (Kategorie, Schlüssel) ohne Datei, bis zum nächsten Abgleich
+
+    std::mutex revalidation_mutex_;
+    std::condition_variable revalidation_cv_;
+    bool stop_revalidation_ = false;
+    std::thread revalidation_thread_;
+};
+// --- Ende Snapshot ---
@@ -0,0 +1,288 @@
+#include "dice.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr int max_modifier = 1000000;
+constexpr std::size_t max_dice_groups = 32;
+constexpr std::size_t max_cache_entries = 4096;
+
+void check_dice(long long count, long long size) {
+    if (count > max_dice_per_term) {
+        throw std::invalid_argument("Too many dice (max " + std::to_string(max_dice_per_term) + " per term).");
+    }
+    if (size < 1 || size > max_die_size) {
+        throw std::invalid_argument("Invalid die size (1-" + std::to_string(max_die_size) + ").");
+    }
+}
+
+void add_modifier(DiceExpression& expr, long long value) {
+    const long long sum = static_cast<long long>(expr.modifier) + value;
+    if (sum > max_modifier || sum < -max_modifier) {
+        throw std::invalid_argument("Dice modifier out of range.");
+    }
+    expr.modifier = static_cast<int>(sum);
+}
+
+void add_dice(DiceExpression& expr, long long count, long long size) {
+    if (count == 0) return;
+    check_dice(std::llabs(count), size);
+    if (size == 1) { // d1 ist eine Konstante
+        add_modifier(expr, count);
+        return;
+    }
+    expr.dice.push_back({static_cast<int>(count), static_cast<int>(size)});
+}
+
+// Gleiche Größe und gleiches Vorzeichen zusammenfassen (2d6+1d6 = 3d6, aber 2d6-1d6 bleibt)
+void normalize(DiceExpression& expr) {
+    std::sort(expr.dice.begin(), expr.dice.end(), [](const DiceExpression::Dice& a, const DiceExpression::Dice& b) {
+        if (a.size != b.size) return a.size > b.size;
+        return a.count > b.count;
+    });
+    std::vector<DiceExpression::Dice> merged;
+    for (const DiceExpression::Dice& group : expr.dice) {
+        if (!merged.empty() && merged.back().size == group.size && (merged.back().count > 0) == (group.count > 0)) {
+            merged.back().count += group.count;
+            check_dice(std::abs(merged.back().count), group.size);
+        } else {
+            merged.push_back(group);
+        }
+    }
+    if (merged.size() > max_dice_groups) {
+        throw std::invalid_argument("Dice expression has too many terms.");
+    }
+    expr.dice = std::move(merged);
+}
+
+// Liest eine Dezimalzahl ab pos, -1 wenn dort keine Ziffer steht
+long long read_number(const std::string& text, std::size_t& pos) {
+    if (pos >= text.size() || !std::isdigit(static_cast<unsigned char>(text[pos]))) return -1;
+    long long value = 0;
+    while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+        value = value * 10 + (text[pos++] - '0');
+        if (value > max_modifier) {
+            throw std::invalid_argument("Number in dice expression too large.");
+        }
+    }
+    return value;
+}
+
+// "(5-6)" bzw. "(6)" -> 1d6 mit Zielwert
+DiceExpression parse_recharge(const std::string& text) {
+    std::size_t pos = 1;
+    const long long low = read_number(text, pos);
+    long long high = low;
+    if (pos < text.size() && text[pos] == '-') {
+        ++pos;
+        high = read_number(text, pos);
+    }
+    if (low < 1 || high != 6 || low > 6 || pos + 1 != text.size() || text[pos] != ')') {
+        throw std::invalid_argument("Invalid recharge (expected e.g. \"(5-6)\").");
+    }
+    DiceExpression expr;
+    expr.dice.push_back({1, 6});
+    expr.target = static_cast<int>(low);
+    return expr;
+}
+
+int number_field(const json& data, const char* key) {
+    return data.contains(key) && data[key].is_number() ? data[key].get<int>() : 0;
+}
+
+void append(DiceExpression& into, const DiceExpression& part) {
+    if (part.target > 0) {
+        throw std::invalid_argument("Recharge values cannot be combined with other dice.");
+    }
+    for (const DiceExpression::Dice& group : part.dice) into.dice.push_back(group);
+    add_modifier(into, part.modifier);
+}
+
+} // namespace
+
+int DiceExpression::min() const {
+    long long total = modifier;
+    for (const Dice& group : dice) total += group.count > 0 ? group.count : static_cast<long long>(group.count) * group.size;
+    return static_cast<int>(total);
+}
+
+int DiceExpression::max() const {
+    long long total = modifier;
+    for (const Dice& group : dice) total += group.count > 0 ? static_cast<long long>(group.count) * group.size : group.count;
+    return static_cast<int>(total);
+}
+
+double DiceExpression::mean() const {
+    double total = modifier;
+    for (const Dice& group : dice) total += group.count * (group.size + 1) / 2.0;
+    return total;
+}
+
+std::size_t DiceExpression::dice_count() const {
+    std::size_t total = 0;
+    for (const Dice& group : dice) total += static_cast<std::size_t>(std::abs(group.count));
+    return total;
+}
+
+int DiceExpression::roll(PhiloxStream& rng, bool crit) const {
+    int total = 0;
+    roll_many(rng, &total, 1, crit);
+    return total;
+}
+
+void DiceExpression::roll_many(PhiloxStream& rng, int* totals, std::size_t n, bool crit) const {
+    std::fill_n(totals, n, modifier);
+    std::array<std::uint32_t, 4096> buffer;
+    for (const Dice& group : dice) {
+        const std::size_t per_roll = static_cast<std::size_t>(std::abs(group.count)) * (crit ? 2 : 1);
+        const int sign = group.count < 0 ? -1 : 1;
+        const std::uint64_t sides = static_cast<std::uint64_t>(group.size);
+        const std::size_t rolls_per_chunk = std::max<std::size_t>(1, buffer.size() / per_roll);
+
+        for (std::size_t start = 0; start < n; start += rolls_per_chunk) {
+            const std::size_t chunk = std::min(rolls_per_chunk, n - start);
+            rng.fill(buffer.data(), chunk * per_roll);
+            for (std::size_t r = 0; r < chunk; ++r) {
+                // Multiply-Shift wie PhiloxStream::roll, +1 pro Würfel nach der Schleife
+                const std::uint32_t* values = buffer.data() + r * per_roll;
+                std::uint64_t sum = 0;
+                for (std::size_t k = 0; k < per_roll; ++k) sum += (static_cast<std::uint64_t>(values[k]) * sides) >> 32;
+                totals[start + r] += sign * static_cast<int>(sum + per_roll);
+            }
+        }
+    }
+}
+
+std::string DiceExpression::to_string() const {
+    if (target > 0 && dice.size() == 1 && dice[0].count == 1 && dice[0].size == 6 && modifier == 0) {
+        return "(" + std::to_string(target) + "-6)";
+    }
+    std::string out;
+    for (const Dice& group : dice) {
+        if (group.count < 0) out += "-";
+        else if (!out.empty()) out += "+";
+        out += std::to_string(std::abs(group.count)) + "d" + std::to_string(group.size);
+    }
+    if (modifier != 0 || out.empty()) {
+        if (modifier >= 0 && !out.empty()) out += "+";
+        out += std::to_string(modifier);
+    }
+    if (target > 0) out += ">=" + std::to_string(target);
+    return out;
+}
+
+DiceExpression parse_dice(const std::string& text) {
+    std::string compact;
+    for (char c : text) {
+        if (!std::isspace(static_cast<unsigned char>(c))) compact += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (compact.empty()) {
+        throw std::invalid_argument("Empty dice expression.");
+    }
+    if (compact.front() == '(') {
+        return parse_recharge(compact);
+    }
+
+    DiceExpression expr;
+    std::size_t pos = 0;
+    while (pos < compact.size()) {
+        int sign = 1;
+        if (compact[pos] == '+' || compact[pos] == '-') {
+            sign = compact[pos] == '-' ? -1 : 1;
+            ++pos;
+        } else if (pos != 0) {
+            throw std::invalid_argument("Unexpected '" + std::string(1, compact[pos]) + "' in dice expression.");
+        }
+
+        long long count = read_number(compact, pos);
+        if (pos < compact.size() && compact[pos] == 'd') {
+            ++pos;
+            long long size;
+            if (pos < compact.size() && compact[pos] == '%') {
+                size = 100;
+                ++pos;
+            } else {
+                size = read_number(compact, pos);
+            }
+            if (size < 0) {
+                throw std::invalid_argument("Missing die size in dice expression.");
+            }
+            add_dice(expr, sign * (count < 0 ? 1 : count), size);
+        } else if (count >= 0) {
+            add_modifier(expr, sign * count);
+        } else {
+            throw std::invalid_argument("Invalid dice expression.");
+        }
+    }
+    normalize(expr);
+    return expr;
+}
+
+DiceExpression compile_dice(const json& data) {
+    DiceExpression expr;
+    if (data.is_string()) {
+        return parse_dice(data.get<std::string>());
+    } else if (data.is_number_integer()) {
+        add_modifier(expr, data.get<long long>());
+    } else if (data.is_array()) {
+        for (const auto& part : data) append(expr, compile_dice(part));
+    } else if (data.is_object()) {
+        if (data.contains("count") || data.contains("size")) {
+            // damage-Eintrag eines Statblocks
+            add_dice(expr, number_field(data, "count"), std::max(1, number_field(data, "size")));
+            add_modifier(expr, number_field(data, "modifier"));
+        } else if (data.contains("diceCount") || data.contains("diceValue")) {
+            // Waffen-Items
+            add_dice(expr, number_field(data, "diceCount"), std::max(1, number_field(data, "diceValue")));
+            add_modifier(expr, number_field(data, "modifier"));
+        } else if (data.contains("HDAmount")) {
+            // basics.HP eines Statblocks
+            const int die = data.contains("overrideDie") && data["overrideDie"].is_number() ? data["overrideDie"].get<int>() : number_field(data, "defaultDie");
+            add_dice(expr, number_field(data, "HDAmount"), std::max(1, die));
+            add_modifier(expr, number_field(data, "HPmodifier"));
+        } else {
+            throw std::invalid_argument("Unknown dice object.");
+        }
+    } else {
+        throw std::invalid_argument("Dice must be a string, number, object or array.");
+    }
+    normalize(expr);
+    return expr;
+}
+
+int recharge_threshold(const json& value) {
+    if (!value.is_string() || value.get<std::string>().empty()) return 0;
+    try {
+        return compile_dice(value).target;
+    } catch (const std::invalid_argument&) {
+        return 0;
+    }
+}
+
+std::shared_ptr<const DiceExpression> compile_dice_cached(const std::string& text) {
+    static std::shared_mutex mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const DiceExpression>> cache;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = cache.find(text);
+        if (it != cache.end()) return it->second;
+    }
+
+    auto compiled = std::make_shared<const DiceExpression>(parse_dice(text)); // Wirft vor dem Einfügen
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (cache.size() >= max_cache_entries) {
+        cache.clear(); // Grob begrenzt, typische Anfragen nutzen nur wenige verschiedene Ausdrücke
+    }
+    return cache.emplace(text, std::move(compiled)).first->second;
+}
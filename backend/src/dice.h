@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "rng.h"
+
+// --- Würfel-Ausdrücke ---
+// Alle Würfel-Formen der Daten werden in dieselbe kompakte Form übersetzt: Summe von ±NdM plus
+// Konstante, optional mit Zielwert (Recharge "(5-6)" = 1d6, Erfolg bei >= 5).
+// Unterstützt: "2d6+3", "d20", "1d8 - 1d4 + 2", "d%", "(5-6)", {count, size, modifier},
+// {diceCount, diceValue}, {HDAmount, defaultDie, overrideDie, HPmodifier} und Arrays davon.
+
+struct DiceExpression {
+    struct Dice {
+        int count = 0; // < 0: abgezogene Würfel
+        int size = 0;
+    };
+
+    std::vector<Dice> dice; // Nach Größe absteigend, gleiche Vorzeichen/Größen zusammengefasst
+    int modifier = 0;
+    int target = 0;         // > 0: Erfolg bei Ergebnis >= target
+
+    int min() const;
+    int max() const;
+    double mean() const;
+    std::size_t dice_count() const; // Anzahl Würfel pro Wurf (für Limits)
+
+    int roll(PhiloxStream& rng, bool crit = false) const;
+    // n Würfe am Stück: Zufallszahlen werden blockweise erzeugt, pro Würfel-Gruppe eine flache Schleife
+    void roll_many(PhiloxStream& rng, int* totals, std::size_t n, bool crit = false) const;
+
+    std::string to_string() const; // Normalisierte Schreibweise, z.B. "3d6+1d4+2"
+};
+
+inline constexpr int max_dice_per_term = 1000;
+inline constexpr int max_die_size = 1000;
+
+// Wirft std::invalid_argument bei ungültigen Ausdrücken
+DiceExpression parse_dice(const std::string& text);
+DiceExpression compile_dice(const nlohmann::json& data);
+// Recharge-String ("(5-6)") -> kleinstes Ergebnis, das auflädt; leer/ungültig -> 0
+int recharge_threshold(const nlohmann::json& value);
+
+// Wie parse_dice, aber mit Cache (kompilierte Ausdrücke werden zwischen Anfragen geteilt)
+std::shared_ptr<const DiceExpression> compile_dice_cached(const std::string& text);
+// --- Ende Würfel-Ausdrücke ---
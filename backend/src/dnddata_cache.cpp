@@ -0,0 +1,110 @@
+#include "dnddata_cache.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+#include "logger.h"
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+DnDDataCache::DnDDataCache(std::filesystem::path base_dir)
+    : base_dir_(std::move(base_dir)), counters_(metrics().cache("dnddata")) {}
+
+DnDDataCache::Shard& DnDDataCache::shard_for(const std::string& filename) {
+    return shards_[std::hash<std::string>{}(filename) % shard_count];
+}
+
+DnDDataCache::Result DnDDataCache::get(const std::string& filename) {
+    Shard& shard = shard_for(filename);
+
+    // --- Schneller Pfad: nur lesen ---
+    BodyFuture pending;
+    {
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.entries.find(filename);
+        if (it != shard.entries.end()) {
+            pending = it->second;
+        }
+    }
+    if (pending.valid()) {
+        bool ready = pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        (ready ? counters_.hits : counters_.misses).add();
+        return {pending.get(), ready}; // Wartet ggf. auf den laufenden Ladevorgang
+    }
+
+    // --- Ladevorgang anmelden (nur einer pro Datei) ---
+    std::promise<std::shared_ptr<const std::string>> promise;
+    {
+        std::unique_lock lock(shard.mutex);
+        auto it = shard.entries.find(filename);
+        if (it != shard.entries.end()) {
+            pending = it->second; // Ein anderer Thread war schneller
+        } else {
+            shard.entries.emplace(filename, promise.get_future().share());
+        }
+    }
+    counters_.misses.add();
+    if (pending.valid()) {
+        return {pending.get(), false};
+    }
+
+    try {
+        std::shared_ptr<const std::string> body = load_from_disk(filename);
+        promise.set_value(body);
+        return {body, false};
+    } catch (...) {
+        // Fehler nicht cachen: Wartende bekommen die Exception, der nächste Zugriff versucht es erneut
+        {
+            std::unique_lock lock(shard.mutex);
+            shard.entries.erase(filename);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+void DnDDataCache::invalidate(const std::string& filename) {
+    Shard& shard = shard_for(filename);
+    std::unique_lock lock(shard.mutex);
+    shard.entries.erase(filename);
+}
+
+std::shared_ptr<const std::string> DnDDataCache::load_from_disk(const std::string& filename) const {
+    std::filesystem::path file_path;
+    try {
+        file_path = std::filesystem::absolute(base_dir_ / filename).lexically_normal();
+
+        if (!std::filesystem::exists(file_path) || !std::filesystem::is_regular_file(file_path)) {
+            log_error("DnDData-Datei nicht gefunden", {{"path", file_path.string()}});
+            throw std::runtime_error("Requested DnD data file not found.");
+        }
+
+        std::ifstream data_file(file_path);
+        if (!data_file.is_open()) {
+            log_error("DnDData-Datei konnte nicht geöffnet werden", {{"path", file_path.string()}});
+            throw std::runtime_error("Could not open DnD data file.");
+        }
+
+        metrics().record_file_read(file_path);
+
+        json data_content;
+        {
+            auto timer = metrics().time_json_parse();
+            data_file >> data_content; // Einmal parsen (validiert den Inhalt), danach nur noch Bytes ausliefern
+        }
+        auto timer = metrics().time_json_dump();
+        return std::make_shared<const std::string>(data_content.dump());
+
+    } catch (const json::parse_error& e) {
+        log_error("Fehler beim Parsen der DnDData-Datei", {{"path", file_path.string()}, {"error", e.what()}});
+        throw std::runtime_error("Error reading DnD data content.");
+    } catch (const std::runtime_error&) {
+        throw;
+    } catch (const std::exception& e) {
+        log_error("Fehler beim Laden der DnDData-Datei", {{"file", filename}, {"path", file_path.string()}, {"error", e.what()}});
+        throw std::runtime_error("Internal server error loading DnD data.");
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "metrics.h"
+
+// --- Thread-sicherer Cache für DnDData-Dateien ---
+// Sharded, damit sich parallele Crow-Worker selten gegenseitig blockieren. Pro Datei läuft
+// höchstens ein Ladevorgang ("single flight"), gleichzeitige Anfragen warten auf dessen
+// Ergebnis statt ein 202 zu bekommen. Gespeichert wird direkt der serialisierte Response-Body.
+
+class DnDDataCache {
+public:
+    struct Result {
+        std::shared_ptr<const std::string> body;
+        bool from_cache = false; // false = in dieser Anfrage (oder einer parallelen) von Platte geladen
+    };
+
+    explicit DnDDataCache(std::filesystem::path base_dir);
+
+    // Wirft std::runtime_error mit den bisherigen Fehlermeldungen
+    // ("Requested DnD data file not found.", "Could not open DnD data file.", "Error reading DnD data content.")
+    Result get(const std::string& filename);
+
+    // Entfernt einen Eintrag, damit er beim nächsten Zugriff neu geladen wird
+    void invalidate(const std::string& filename);
+
+private:
+    using BodyFuture = std::shared_future<std::shared_ptr<const std::string>>;
+
+    struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<std::string, BodyFuture> entries;
+    };
+
+    static constexpr std::size_t shard_count = 16;
+
+    Shard& shard_for(const std::string& filename);
+    std::shared_ptr<const std::string> load_from_disk(const std::string& filename) const;
+
+    std::filesystem::path base_dir_;
+    CacheCounters& counters_;
+    std::array<Shard, shard_count> shards_;
+};
+// --- Ende DnDData-Cache ---
@@ -0,0 +1,195 @@
+#include "encounter_difficulty.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+// DMG 2014 S. 82: XP-Schwellen pro Charakter (easy, medium, hard, deadly), Stufe 1-20
+constexpr std::array<std::array<long long, 4>, 20> thresholds_2014 = {{
+    {25, 50, 75, 100},         {50, 100, 150, 200},       {75, 150, 225, 400},       {125, 250, 375, 500},
+    {250, 500, 750, 1100},     {300, 600, 900, 1400},     {350, 750, 1100, 1700},    {450, 900, 1400, 2100},
+    {550, 1100, 1600, 2400},   {600, 1200, 1900, 2800},   {800, 1600, 2400, 3600},   {1000, 2000, 3000, 4500},
+    {1100, 2200, 3400, 5100},  {1250, 2500, 3800, 5700},  {1400, 2800, 4300, 6400},  {1600, 3200, 4800, 7200},
+    {2000, 3900, 5900, 8800},  {2100, 4200, 6300, 9500},  {2400, 4900, 7300, 10900}, {2800, 5700, 8500, 12700},
+}};
+
+// DMG 2024: XP-Budget pro Charakter (low, moderate, high), Stufe 1-20
+constexpr std::array<std::array<long long, 3>, 20> thresholds_2024 = {{
+    {50, 75, 100},       {100, 150, 200},     {150, 225, 400},     {250, 375, 500},
+    {500, 750, 1100},    {600, 1000, 1400},   {750, 1300, 1700},   {1000, 1700, 2100},
+    {1300, 2000, 2600},  {1600, 2300, 3100},  {1900, 2900, 4100},  {2200, 3700, 4700},
+    {2600, 4200, 5400},  {2900, 4900, 6200},  {3300, 5400, 7800},  {3800, 6100, 9800},
+    {4500, 7200, 11700}, {5000, 8700, 14200}, {5500, 10700, 17200}, {6400, 13200, 22000},
+}};
+
+// DMG 2014 S. 82: Multiplikatoren inkl. der Stufen für sehr kleine/große Gruppen
+constexpr std::array<double, 8> multipliers_2014 = {0.5, 1.0, 1.5, 2.0, 2.5, 3.0, 4.0, 5.0};
+
+int multiplier_index_2014(int monster_count, std::size_t party_size) {
+    int index;
+    if (monster_count <= 1) index = 1;
+    else if (monster_count == 2) index = 2;
+    else if (monster_count <= 6) index = 3;
+    else if (monster_count <= 10) index = 4;
+    else if (monster_count <= 14) index = 5;
+    else index = 6;
+
+    if (party_size < 3) ++index;       // Kleine Gruppe: nächsthöherer Multiplikator
+    else if (party_size >= 6) --index; // Große Gruppe: nächstniedrigerer Multiplikator
+    return std::clamp(index, 0, static_cast<int>(multipliers_2014.size()) - 1);
+}
+
+// Wie bei /api/encounters/<id>/simulate: mehr Exemplare pro Eintrag ändern die Stufe ohnehin nicht mehr
+constexpr long long max_count_per_entry = 100;
+
+std::size_t level_index(int level) {
+    return static_cast<std::size_t>(std::clamp(level, 1, 20) - 1);
+}
+
+} // namespace
+
+DifficultyRules parse_difficulty_rules(const std::string& value) {
+    if (value.empty() || value == "2014") return DifficultyRules::Dmg2014;
+    if (value == "2024") return DifficultyRules::Dmg2024;
+    throw std::invalid_argument("Invalid rules (2014 or 2024).");
+}
+
+DifficultyEngine::DifficultyEngine(const json& cr_data) {
+    if (cr_data.is_array()) {
+        for (const auto& row : cr_data) {
+            if (row.is_object() && row.contains("numeric") && row["numeric"].is_number()) {
+                cr_xp_.emplace_back(row["numeric"].get<double>(), row.value("xp", 0LL));
+            }
+        }
+    }
+    std::sort(cr_xp_.begin(), cr_xp_.end());
+}
+
+long long DifficultyEngine::xp_for_cr(double cr) const {
+    if (cr_xp_.empty()) return 0;
+    // Größter Tabellen-CR <= cr (mit etwas Toleranz für 0.125 etc.)
+    auto it = std::upper_bound(cr_xp_.begin(), cr_xp_.end(), cr + 1e-9,
+                               [](double value, const std::pair<double, long long>& row) { return value < row.first; });
+    if (it == cr_xp_.begin()) return cr_xp_.front().second;
+    return std::prev(it)->second;
+}
+
+DifficultyResult DifficultyEngine::evaluate(const std::vector<EncounterMonster>& monsters, const EncounterParty& party, DifficultyRules rules) const {
+    DifficultyResult result;
+    result.rules = rules;
+    long long monster_count = 0;
+    for (const EncounterMonster& monster : monsters) {
+        if (monster.count <= 0) continue;
+        const long long count = std::min<long long>(monster.count, max_count_per_entry);
+        result.total_xp += xp_for_cr(monster.cr) * count;
+        monster_count += count;
+    }
+    result.monster_count = static_cast<int>(std::min<long long>(monster_count, std::numeric_limits<int>::max()));
+
+    if (rules == DifficultyRules::Dmg2014) {
+        std::array<long long, 4> sums{};
+        for (int level : party.levels) {
+            const auto& row = thresholds_2014[level_index(level)];
+            for (std::size_t i = 0; i < sums.size(); ++i) sums[i] += row[i];
+        }
+        result.thresholds = {{"easy", sums[0]}, {"medium", sums[1]}, {"hard", sums[2]}, {"deadly", sums[3]}};
+        result.multiplier = result.monster_count > 0 ? multipliers_2014[multiplier_index_2014(result.monster_count, party.levels.size())] : 1.0;
+    } else {
+        std::array<long long, 3> sums{};
+        for (int level : party.levels) {
+            const auto& row = thresholds_2024[level_index(level)];
+            for (std::size_t i = 0; i < sums.size(); ++i) sums[i] += row[i];
+        }
+        result.thresholds = {{"low", sums[0]}, {"moderate", sums[1]}, {"high", sums[2]}};
+        result.multiplier = 1.0; // 2024 kennt keinen Gruppen-Multiplikator
+    }
+    result.adjusted_xp = static_cast<double>(result.total_xp) * result.multiplier;
+
+    // Höchste erreichte Stufe, Fortschritt wie im EncounterCreator (zwischen vorheriger und nächster Schwelle)
+    static const char* labels_2014[] = {"Easy", "Medium", "Hard", "Deadly"};
+    static const char* labels_2024[] = {"Low", "Moderate", "High"};
+    const char* const* labels = rules == DifficultyRules::Dmg2014 ? labels_2014 : labels_2024;
+
+    int reached = -1;
+    for (std::size_t i = 0; i < result.thresholds.size(); ++i) {
+        if (result.thresholds[i].second > 0 && result.adjusted_xp >= static_cast<double>(result.thresholds[i].second)) {
+            reached = static_cast<int>(i);
+        }
+    }
+    result.difficulty = reached < 0 ? "Trivial" : labels[reached];
+
+    const bool at_top = reached == static_cast<int>(result.thresholds.size()) - 1;
+    if (at_top) {
+        result.progress = 100.0;
+    } else {
+        const double previous = reached < 0 ? 0.0 : static_cast<double>(result.thresholds[reached].second);
+        const double next = static_cast<double>(result.thresholds[reached + 1].second);
+        result.progress = next > previous ? (result.adjusted_xp - previous) / (next - previous) * 100.0 : 0.0;
+    }
+    result.progress = std::clamp(result.progress, 0.0, 100.0);
+    return result;
+}
+
+json DifficultyEngine::evaluate_json(const json& encounter, DifficultyRules default_rules) const {
+    if (!encounter.is_object()) {
+        throw std::invalid_argument("Encounter must be an object.");
+    }
+    DifficultyRules rules = default_rules;
+    if (encounter.contains("rules")) {
+        rules = parse_difficulty_rules(encounter["rules"].is_string() ? encounter["rules"].get<std::string>() : encounter["rules"].dump());
+    }
+
+    // --- Party: explizite Stufen oder averageLevel x playerCount ---
+    EncounterParty party;
+    const json party_data = encounter.value("party", json::object());
+    if (party_data.contains("levels") && party_data["levels"].is_array()) {
+        for (const auto& level : party_data["levels"]) {
+            if (level.is_number()) party.levels.push_back(level.get<int>());
+        }
+    } else {
+        int average_level = party_data.value("averageLevel", 1);
+        int player_count = party_data.value("playerCount", 0);
+        if (player_count < 0 || player_count > 1000) {
+            throw std::invalid_argument("Invalid party.playerCount.");
+        }
+        party.levels.assign(static_cast<std::size_t>(player_count), average_level);
+    }
+    if (party.levels.empty()) {
+        throw std::invalid_argument("Party is empty (party.playerCount or party.levels required).");
+    }
+
+    // --- Monster: CR (Encounter-Format) oder cr (Summary-Format), count ---
+    std::vector<EncounterMonster> monsters;
+    if (encounter.contains("monsters") && encounter["monsters"].is_array()) {
+        for (const auto& monster_data : encounter["monsters"]) {
+            if (!monster_data.is_object()) continue;
+            EncounterMonster monster;
+            if (monster_data.contains("CR") && monster_data["CR"].is_number()) monster.cr = monster_data["CR"].get<double>();
+            else if (monster_data.contains("cr") && monster_data["cr"].is_number()) monster.cr = monster_data["cr"].get<double>();
+            monster.count = static_cast<int>(std::clamp(monster_data.value("count", 1LL), 0LL, max_count_per_entry));
+            monsters.push_back(monster);
+        }
+    }
+
+    DifficultyResult result = evaluate(monsters, party, rules);
+    json thresholds = json::object();
+    for (const auto& [name, value] : result.thresholds) {
+        thresholds[name] = value;
+    }
+    json out;
+    if (encounter.contains("id")) out["id"] = encounter["id"];
+    out["rules"] = rules == DifficultyRules::Dmg2014 ? "2014" : "2024";
+    out["difficulty"] = result.difficulty;
+    out["totalXP"] = result.total_xp;
+    out["adjustedXP"] = result.adjusted_xp;
+    out["multiplier"] = result.multiplier;
+    out["monsterCount"] = result.monster_count;
+    out["thresholds"] = thresholds;
+    out["progress"] = result.progress;
+    return out;
+}
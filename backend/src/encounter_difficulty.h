@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+// --- Encounter-Schwierigkeit (2014 DMG und 2024 DMG) ---
+// XP pro CR kommen aus DnDData/crData.json, die Schwellenwerte pro Charakterstufe sind fest
+// (DMG 2014 S. 82, DMG 2024 "XP Budget per Character"). Die Tabellen werden einmal aufgebaut,
+// danach ist jede Bewertung nur noch ein paar Lookups.
+
+enum class DifficultyRules { Dmg2014, Dmg2024 };
+
+struct EncounterMonster {
+    double cr = 0.0;
+    int count = 1;
+};
+
+struct EncounterParty {
+    std::vector<int> levels; // Eine Stufe pro Charakter
+};
+
+struct DifficultyResult {
+    DifficultyRules rules = DifficultyRules::Dmg2014;
+    std::string difficulty;
+    long long total_xp = 0;
+    double adjusted_xp = 0.0;   // Bei 2014 mit Multiplikator, bei 2024 gleich total_xp
+    double multiplier = 1.0;
+    int monster_count = 0;
+    std::vector<std::pair<std::string, long long>> thresholds; // Aufsteigend, z.B. easy..deadly
+    double progress = 0.0;      // 0-100 zwischen aktueller und nächster Stufe (wie im EncounterCreator)
+};
+
+class DifficultyEngine {
+public:
+    // crData: Array aus {"cr", "numeric", "xp", ...}
+    explicit DifficultyEngine(const nlohmann::json& cr_data);
+
+    long long xp_for_cr(double cr) const;
+    DifficultyResult evaluate(const std::vector<EncounterMonster>& monsters, const EncounterParty& party, DifficultyRules rules) const;
+
+    // Liest Monster/Party aus dem Encounter-Format (monsters[].CR/count, party.averageLevel/playerCount bzw. party.levels)
+    // und gibt das Ergebnis als JSON zurück. Wirft std::invalid_argument bei unbrauchbarer Eingabe.
+    nlohmann::json evaluate_json(const nlohmann::json& encounter, DifficultyRules default_rules) const;
+
+private:
+    std::vector<std::pair<double, long long>> cr_xp_; // Nach CR sortiert
+};
+
+// "2014" / "2024" -> Regeln, sonst std::invalid_argument
+DifficultyRules parse_difficulty_rules(const std::string& value);
+// --- Ende Encounter-Schwierigkeit ---
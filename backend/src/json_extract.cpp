@@ -0,0 +1,268 @@
+#include "json_extract.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+struct ScanError {};
+
+// Array-Index aus einem Pointer-Token (nur Ziffern, ohne führende Null wie bei json_pointer)
+bool parse_index(const std::string& token, std::size_t& index) {
+    if (token.empty() || token.size() > 18 || (token.size() > 1 && token[0] == '0')) return false;
+    index = 0;
+    for (char c : token) {
+        if (c < '0' || c > '9') return false;
+        index = index * 10 + static_cast<std::size_t>(c - '0');
+    }
+    return true;
+}
+
+// Kopiert den Wert an target aus document nach result und legt dabei dieselben Containertypen an
+void copy_pointer(const json& document, const JsonFieldExtractor::Target& target, json& result) {
+    std::vector<const json*> sources{&document};
+    for (const std::string& token : target.tokens) {
+        const json& source = *sources.back();
+        std::size_t index = 0;
+        if (source.is_object() && source.contains(token)) {
+            sources.push_back(&source[token]);
+        } else if (source.is_array() && parse_index(token, index) && index < source.size()) {
+            sources.push_back(&source[index]);
+        } else {
+            return; // Nicht vorhanden
+        }
+    }
+    json* dest = &result;
+    for (std::size_t i = 0; i < target.tokens.size(); ++i) {
+        if (sources[i]->is_object()) {
+            if (!dest->is_object()) *dest = json::object();
+            dest = &(*dest)[target.tokens[i]];
+        } else {
+            if (!dest->is_array()) *dest = json::array();
+            std::size_t index = 0;
+            parse_index(target.tokens[i], index);
+            dest = &(*dest)[index];
+        }
+    }
+    *dest = *sources.back();
+}
+
+// Läuft über den Text, steigt nur in Container auf dem Weg zu gesuchten Pointern ab und überspringt den Rest
+// (Strings bis zum schließenden Anführungszeichen, Container per Klammerzählung). Gefundene Werte werden
+// als Ausschnitt an json::parse übergeben.
+class Scanner {
+public:
+    Scanner(std::string_view text, const std::vector<JsonFieldExtractor::Target>& targets)
+        : p_(text.data()), end_(text.data() + text.size()), targets_(targets), found_(targets.size(), false), remaining_(targets.size()) {}
+
+    json run() {
+        skip_whitespace();
+        if (p_ < end_ && (*p_ == '{' || *p_ == '[')) {
+            std::vector<std::uint16_t> candidates(targets_.size());
+            for (std::size_t i = 0; i < candidates.size(); ++i) candidates[i] = static_cast<std::uint16_t>(i);
+            visit_container(0, candidates, result_);
+        } else {
+            skip_value(); // Skalare Wurzel: nichts zu finden
+        }
+        if (!done()) {
+            // Wie json::parse: nach dem Dokument darf nur noch Leerraum folgen
+            skip_whitespace();
+            if (p_ != end_) throw ScanError{};
+        }
+        return std::move(result_);
+    }
+
+private:
+    bool done() const { return remaining_ == 0; }
+
+    void skip_whitespace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t')) ++p_;
+    }
+
+    void expect(char c) {
+        skip_whitespace();
+        if (p_ >= end_ || *p_ != c) throw ScanError{};
+        ++p_;
+    }
+
+    // p_ steht auf dem öffnenden Anführungszeichen; liefert den Inhalt ohne Anführungszeichen (noch escaped)
+    std::string_view raw_string(bool& escaped) {
+        const char* begin = ++p_;
+        escaped = false;
+        for (;;) {
+            const char* quote = static_cast<const char*>(std::memchr(p_, '"', static_cast<std::size_t>(end_ - p_)));
+            if (!quote) throw ScanError{};
+            std::size_t backslashes = 0;
+            for (const char* q = quote; q > begin && q[-1] == '\\'; --q) ++backslashes;
+            if (backslashes > 0) escaped = true;
+            p_ = quote + 1;
+            if (backslashes % 2 == 0) return std::string_view(begin, static_cast<std::size_t>(quote - begin));
+        }
+    }
+
+    void skip_value() {
+        skip_whitespace();
+        if (p_ >= end_) throw ScanError{};
+        bool escaped = false;
+        switch (*p_) {
+            case '"':
+                raw_string(escaped);
+                return;
+            case '{':
+            case '[': {
+                std::size_t depth = 0;
+                while (p_ < end_) {
+                    const char c = *p_;
+                    if (c == '"') {
+                        raw_string(escaped);
+                        continue;
+                    }
+                    ++p_;
+                    if (c == '{' || c == '[') {
+                        ++depth;
+                    } else if (c == '}' || c == ']') {
+                        if (--depth == 0) return;
+                    }
+                }
+                throw ScanError{};
+            }
+            default: {
+                // Zahl oder Literal: bis zum nächsten Trennzeichen
+                const char* begin = p_;
+                while (p_ < end_ && !std::strchr(",}] \n\r\t", *p_)) ++p_;
+                if (p_ == begin) throw ScanError{};
+                return;
+            }
+        }
+    }
+
+    // Wert an der aktuellen Position vollständig übernehmen
+    void capture(std::uint16_t target, json& slot) {
+        skip_whitespace();
+        const char* begin = p_;
+        skip_value();
+        if (p_ == end_) throw ScanError{}; // Innerhalb eines Containers: Dokument abgeschnitten (z.B. mitten in einer Zahl)
+        slot = json::parse(begin, p_);
+        found_[target] = true;
+        --remaining_;
+    }
+
+    // Nächster Pfad-Schritt: passende Kandidaten für token an Position depth. slot() legt den Platz
+    // des Kindes im Ergebnis an (erst bei Bedarf, übersprungene Kinder hinterlassen nichts).
+    template <typename TokenEquals, typename Slot>
+    void visit_child(std::size_t depth, const std::vector<std::uint16_t>& candidates, TokenEquals&& equals, Slot&& slot) {
+        std::vector<std::uint16_t> next;
+        for (std::uint16_t i : candidates) {
+            if (!found_[i] && equals(targets_[i].tokens[depth])) {
+                if (targets_[i].tokens.size() == depth + 1) {
+                    capture(i, slot()); // Doppelte Treffer (gleicher Pointer mehrfach angefragt) sind ausgeschlossen
+                    return;
+                }
+                next.push_back(i);
+            }
+        }
+        skip_whitespace();
+        if (!next.empty() && p_ < end_ && (*p_ == '{' || *p_ == '[')) {
+            visit_container(depth + 1, next, slot());
+        } else {
+            skip_value();
+        }
+    }
+
+    // p_ steht vor einem Objekt oder Array, dessen Pfad Präfix aller candidates ist; node ist sein Platz im Ergebnis
+    void visit_container(std::size_t depth, const std::vector<std::uint16_t>& candidates, json& node) {
+        skip_whitespace();
+        const bool is_object = *p_ == '{';
+        if (!(is_object ? node.is_object() : node.is_array())) node = is_object ? json::object() : json::array();
+        ++p_;
+        skip_whitespace();
+        if (p_ < end_ && *p_ == (is_object ? '}' : ']')) {
+            ++p_;
+            return;
+        }
+        for (std::size_t index = 0;; ++index) {
+            if (is_object) {
+                skip_whitespace();
+                if (p_ >= end_ || *p_ != '"') throw ScanError{};
+                bool escaped = false;
+                const std::string_view raw_key = raw_string(escaped);
+                const std::string key = escaped ? json::parse("\"" + std::string(raw_key) + "\"").get<std::string>() : std::string();
+                const std::string_view name = escaped ? std::string_view(key) : raw_key;
+                expect(':');
+                visit_child(depth, candidates, [&](const std::string& token) { return token == name; },
+                            [&]() -> json& { return node[std::string(name)]; });
+            } else {
+                const std::string token_index = std::to_string(index);
+                visit_child(depth, candidates, [&](const std::string& token) { return token == token_index; },
+                            [&]() -> json& { return node[index]; });
+            }
+            if (done()) return; // Rest des Dokuments nicht mehr lesen
+            skip_whitespace();
+            if (p_ >= end_) throw ScanError{};
+            if (*p_ == ',') {
+                ++p_;
+                continue;
+            }
+            if (*p_ != (is_object ? '}' : ']')) throw ScanError{};
+            ++p_;
+            return;
+        }
+    }
+
+    const char* p_;
+    const char* end_;
+    const std::vector<JsonFieldExtractor::Target>& targets_;
+    std::vector<bool> found_;
+    std::size_t remaining_;
+    json result_;
+};
+
+} // namespace
+
+JsonFieldExtractor::JsonFieldExtractor(const std::vector<std::string>& pointers) : pointers_(pointers) {
+    if (pointers_.size() > UINT16_MAX) {
+        throw std::invalid_argument("Too many JSON pointers.");
+    }
+    for (const std::string& text : pointers_) {
+        json::json_pointer pointer;
+        try {
+            pointer = json::json_pointer(text);
+        } catch (const json::exception& e) {
+            throw std::invalid_argument("Invalid JSON pointer '" + text + "': " + e.what());
+        }
+        if (pointer.empty()) {
+            throw std::invalid_argument("JSON pointer must not be empty.");
+        }
+        Target target;
+        for (json::json_pointer rest = pointer; !rest.empty(); rest = rest.parent_pointer()) {
+            target.tokens.push_back(rest.back());
+        }
+        std::reverse(target.tokens.begin(), target.tokens.end());
+        targets_.push_back(std::move(target));
+    }
+}
+
+json JsonFieldExtractor::extract(std::string_view text) const {
+    try {
+        return Scanner(text, targets_).run();
+    } catch (const ScanError&) {
+    } catch (const json::parse_error&) {
+    }
+    // Syntaxfehler (oder ein Fall, den der Scanner nicht abdeckt): ganzes Dokument parsen. Wirft die übliche
+    // parse_error-Meldung mit korrekter Position; ist das Dokument doch gültig, kommen die Felder von dort.
+    const json document = json::parse(text.begin(), text.end());
+    json result = document.is_object() ? json::object() : document.is_array() ? json::array() : json();
+    for (const Target& target : targets_) {
+        copy_pointer(document, target, result);
+    }
+    return result;
+}
+
+json JsonFieldExtractor::extract(std::istream& stream) const {
+    const std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    return extract(text);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+// --- Gezieltes Auslesen einzelner Felder aus JSON-Dokumenten ---
+// Listen- und Scan-Pfade (Monster-Zusammenfassung, Encounter- und Template-Manifest) brauchen nur wenige
+// Felder eines Dokuments. JsonFieldExtractor ist ein eigener Scanner über den Rohtext (nicht die SAX-Schnittstelle
+// von nlohmann::json): er folgt nur den Schlüsseln auf dem Weg zu den angefragten JSON-Pointern und übergibt nur die
+// gefundenen Werte an json::parse. Alle anderen Teilbäume (z.B. große actions-Arrays) werden übersprungen, indem
+// Klammern und Strings gezählt werden, ohne Knoten anzulegen. Sobald alle Pointer gefunden sind, endet das Lesen.
+//
+// Ergebnis ist ein dünnbesetztes Dokument mit denselben Pfaden wie das Original, bestehende Auswertungen
+// (data.value("basics", ...), data.contains("id")) funktionieren darauf unverändert.
+//
+// Preis dafür: übersprungene Teilbäume und alles nach dem letzten Fund werden nicht validiert. Eine Datei mit
+// Syntaxfehler außerhalb der gelesenen Felder (z.B. fehlendes Komma in actions) taucht daher in Listen und
+// Manifesten auf und scheitert erst beim vollständigen Laden (GET liefert dann den Parse-Fehler). Nur wenn der
+// Scanner selbst ins Stolpern kommt (unausgeglichene Klammern, abgeschnittene Datei), wird das ganze Dokument
+// geparst und der Fehler sofort gemeldet.
+
+class JsonFieldExtractor {
+public:
+    // pointers: z.B. {"/basics/name", "/speeds"}; ein Pointer auf einen Container liefert ihn vollständig.
+    // Wirft std::invalid_argument bei leeren oder ungültigen Pointern.
+    explicit JsonFieldExtractor(const std::vector<std::string>& pointers);
+
+    // Wurzel hat den Typ der Dokument-Wurzel (Objekt/Array, null bei skalarer Wurzel) und enthält nur gefundene Pointer.
+    // Wirft nlohmann::json::parse_error bei Syntaxfehlern in gelesenen Werten und bei strukturellen Fehlern (siehe oben).
+    nlohmann::json extract(std::string_view text) const;
+    nlohmann::json extract(std::istream& stream) const;
+
+    const std::vector<std::string>& pointers() const { return pointers_; }
+
+    struct Target {
+        std::vector<std::string> tokens; // Entschlüsselte Referenz-Tokens des Pointers ("~1" -> "/")
+    };
+
+private:
+    std::vector<std::string> pointers_;
+    std::vector<Target> targets_;
+};
+// --- Ende Feld-Extraktion ---
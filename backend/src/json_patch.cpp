@@ -0,0 +1,56 @@
+#include "json_patch.h"
+
+#include <algorithm>
+#include <cctype>
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string media_type(const std::string& content_type) {
+    std::string type = content_type.substr(0, content_type.find(';'));
+    type.erase(0, type.find_first_not_of(" \t"));
+    type.erase(type.find_last_not_of(" \t") + 1);
+    std::transform(type.begin(), type.end(), type.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return type;
+}
+
+} // namespace
+
+json parse_patch(const std::string& body, const std::string& content_type) {
+    const std::string type = media_type(content_type);
+    if (!type.empty() && type != "application/json" && type != "application/json-patch+json" && type != "application/merge-patch+json") {
+        throw PatchError(415, "Unsupported patch type, use application/json-patch+json or application/merge-patch+json.");
+    }
+    json patch = json::parse(body, nullptr, false);
+    if (patch.is_discarded()) {
+        throw PatchError(400, "Invalid JSON body.");
+    }
+    if (type == "application/json-patch+json" && !patch.is_array()) {
+        throw PatchError(400, "JSON Patch must be an array of operations.");
+    }
+    if (type == "application/merge-patch+json" && !patch.is_object()) {
+        throw PatchError(400, "Merge patch must be a JSON object.");
+    }
+    if (!patch.is_array() && !patch.is_object()) {
+        throw PatchError(400, "Patch must be a JSON Patch array or a merge patch object.");
+    }
+    return patch;
+}
+
+json apply_patch(const json& document, const json& patch) {
+    if (patch.is_object()) {
+        json result = document;
+        result.merge_patch(patch);
+        return result;
+    }
+    try {
+        return document.patch(patch);
+    } catch (const json::parse_error& e) {
+        // Operation ohne op/path/value bzw. ungültiger JSON Pointer
+        throw PatchError(400, std::string("Invalid JSON Patch: ") + e.what());
+    } catch (const json::exception& e) {
+        // Pfad fehlt, Index außerhalb, "test" fehlgeschlagen
+        throw PatchError(409, std::string("JSON Patch does not apply: ") + e.what());
+    }
+}
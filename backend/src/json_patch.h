@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+#include "nlohmann/json.hpp"
+
+// --- Teil-Updates per JSON Patch (RFC 6902) und JSON Merge Patch (RFC 7396) ---
+// PATCH-Routen (Monster, Templates) wenden den Patch auf das aktuelle Dokument an. Ins Journal geht nur der
+// Patch statt des ganzen Dokuments (WriteJournal::Operation::Kind::patch).
+//
+// Format laut Content-Type: application/json-patch+json = Array von Operationen, application/merge-patch+json =
+// Objekt. Bei application/json (oder ohne Content-Type) entscheidet der Typ: Array = JSON Patch, Objekt = Merge Patch.
+
+// Fehler mit passendem HTTP-Status: 400 ungültiger Patch, 409 Patch passt nicht zum aktuellen Dokument
+// (Pfad fehlt, "test" fehlgeschlagen), 415 nicht unterstützter Content-Type; PATCH-Routen werfen zusätzlich
+// 412 (If-Match veraltet) und 422 (Ergebnis verletzt die Mindestanforderungen)
+class PatchError : public std::runtime_error {
+public:
+    PatchError(int status, const std::string& message) : std::runtime_error(message), status_(status) {}
+    int status() const { return status_; }
+
+private:
+    int status_;
+};
+
+// Liest den Request-Body: Array (JSON Patch) oder Objekt (Merge Patch). Wirft PatchError.
+nlohmann::json parse_patch(const std::string& body, const std::string& content_type);
+// Wendet einen Patch aus parse_patch an, document bleibt unverändert. Wirft PatchError.
+nlohmann::json apply_patch(const nlohmann::json& document, const nlohmann::json& patch);
+// --- Ende JSON Patch ---
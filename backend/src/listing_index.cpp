@@ -0,0 +1,141 @@
+#include "listing_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+json sort_key(const json& value) {
+    if (!value.is_string()) {
+        return value;
+    }
+    std::string lowered = value.get<std::string>();
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return lowered;
+}
+
+// Cursor als Hex-String (URL-sicher, ohne Escaping)
+std::string encode_cursor(const json& payload) {
+    static const char digits[] = "0123456789abcdef";
+    const std::string raw = payload.dump();
+    std::string out;
+    out.reserve(raw.size() * 2);
+    for (unsigned char c : raw) {
+        out += digits[c >> 4];
+        out += digits[c & 15];
+    }
+    return out;
+}
+
+json decode_cursor(const std::string& cursor) {
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    };
+    if (cursor.size() % 2 != 0) {
+        throw std::invalid_argument("Invalid cursor.");
+    }
+    std::string raw;
+    raw.reserve(cursor.size() / 2);
+    for (std::size_t i = 0; i < cursor.size(); i += 2) {
+        const int high = nibble(cursor[i]);
+        const int low = nibble(cursor[i + 1]);
+        if (high < 0 || low < 0) throw std::invalid_argument("Invalid cursor.");
+        raw += static_cast<char>(high * 16 + low);
+    }
+    json payload = json::parse(raw, nullptr, false);
+    if (!payload.is_array() || payload.size() != 3 || !payload[0].is_string() || !payload[2].is_string()) {
+        throw std::invalid_argument("Invalid cursor.");
+    }
+    return payload;
+}
+
+} // namespace
+
+ListingIndex::ListingIndex(std::vector<json> rows, const std::vector<std::string>& sort_keys) : rows_(std::move(rows)) {
+    ids_.reserve(rows_.size());
+    serialized_.reserve(rows_.size());
+    for (const json& row : rows_) {
+        ids_.push_back(row.value("id", ""));
+        serialized_.push_back(row.dump());
+    }
+    for (const std::string& name : sort_keys) {
+        Order& order = orders_[name];
+        order.keys.reserve(rows_.size());
+        for (const json& row : rows_) {
+            order.keys.push_back(sort_key(row.value(name, json())));
+        }
+        order.positions.resize(rows_.size());
+        std::iota(order.positions.begin(), order.positions.end(), 0u);
+        std::sort(order.positions.begin(), order.positions.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return order.keys[a] != order.keys[b] ? order.keys[a] < order.keys[b] : ids_[a] < ids_[b];
+        });
+    }
+}
+
+bool ListingIndex::row_less(const Order& order, std::uint32_t row, const json& key, const std::string& id) const {
+    return order.keys[row] != key ? order.keys[row] < key : ids_[row] < id;
+}
+
+bool ListingIndex::cursor_less(const Order& order, std::uint32_t row, const json& key, const std::string& id) const {
+    return order.keys[row] != key ? key < order.keys[row] : id < ids_[row];
+}
+
+std::string ListingIndex::page(const PageQuery& query, const std::string& collection) const {
+    auto order_it = orders_.find(query.sort);
+    if (order_it == orders_.end()) {
+        throw std::invalid_argument("Invalid sort '" + query.sort + "'.");
+    }
+    const Order& order = order_it->second;
+    const std::vector<std::uint32_t>& positions = order.positions;
+    const std::size_t limit = std::min(query.limit, max_limit);
+
+    // Aufsteigend: erster Eintrag > Cursor; absteigend: letzter Eintrag < Cursor (rückwärts laufen)
+    std::size_t begin = query.descending ? positions.size() : 0;
+    if (!query.cursor.empty()) {
+        const json cursor = decode_cursor(query.cursor);
+        if (cursor[0] != query.sort) {
+            throw std::invalid_argument("Cursor belongs to a different sort order.");
+        }
+        const json& key = cursor[1];
+        const std::string id = cursor[2].get<std::string>();
+        // Zeilen vor dem Cursor (absteigend) bzw. bis einschließlich Cursor (aufsteigend) liegen vorne
+        auto split = std::partition_point(positions.begin(), positions.end(), [&](std::uint32_t row) {
+            return query.descending ? row_less(order, row, key, id) : !cursor_less(order, row, key, id);
+        });
+        begin = static_cast<std::size_t>(split - positions.begin());
+    }
+
+    std::string out = "{\"total\":" + std::to_string(rows_.size()) + ",\"" + collection + "\":[";
+    std::size_t emitted = 0;
+    std::uint32_t last_row = 0;
+    const std::size_t available = query.descending ? begin : positions.size() - begin;
+    for (; emitted < limit && emitted < available; ++emitted) {
+        const std::uint32_t row = query.descending ? positions[begin - 1 - emitted] : positions[begin + emitted];
+        if (emitted > 0) out += ',';
+        if (query.fields.empty()) {
+            out += serialized_[row];
+        } else {
+            json projected = json::object();
+            projected["id"] = ids_[row];
+            for (const std::string& field : query.fields) {
+                if (rows_[row].contains(field)) projected[field] = rows_[row][field];
+            }
+            out += projected.dump();
+        }
+        last_row = row;
+    }
+    out += "],\"nextCursor\":";
+    if (emitted > 0 && emitted < available) {
+        out += '"' + encode_cursor(json::array({query.sort, order.keys[last_row], ids_[last_row]})) + '"';
+    } else {
+        out += "null";
+    }
+    out += '}';
+    return out;
+}
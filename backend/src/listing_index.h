@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+// --- Seitenweise Listen (Monster-Zusammenfassungen, Encounter, Templates) ---
+// Die Einträge werden einmal pro Sortierschlüssel vorsortiert (Schlüssel, dann ID) und vorab
+// serialisiert. Eine Seite kostet dadurch eine Binärsuche plus O(Seitengröße).
+//
+// Keyset-Cursor: nextCursor kodiert Sortierung, Schlüssel und ID des letzten Eintrags einer Seite.
+// Die nächste Seite beginnt direkt danach, auch wenn zwischendurch Einträge dazukommen oder wegfallen.
+
+struct PageQuery {
+    std::string sort = "name";
+    bool descending = false;
+    std::vector<std::string> fields; // Leer = alle Felder, "id" ist immer enthalten
+    std::size_t limit = 100;
+    std::string cursor;              // Leer = erste Seite
+};
+
+class ListingIndex {
+public:
+    static constexpr std::size_t max_limit = 1000;
+
+    // rows: Objekte mit "id"; sort_keys: erlaubte Werte für sort (Feldnamen in rows)
+    ListingIndex(std::vector<nlohmann::json> rows, const std::vector<std::string>& sort_keys);
+
+    // Serialisiert {"total": n, "<collection>": [...], "nextCursor": "..."|null}
+    // Wirft std::invalid_argument bei unbekanntem sort oder ungültigem Cursor
+    std::string page(const PageQuery& query, const std::string& collection) const;
+
+    std::size_t size() const { return rows_.size(); }
+
+private:
+    struct Order {
+        std::vector<nlohmann::json> keys;      // Pro Zeile (Strings klein geschrieben)
+        std::vector<std::uint32_t> positions; // Zeilen in Sortierreihenfolge
+    };
+
+    // (Schlüssel, ID) der Zeile < Cursor bzw. Cursor < Zeile
+    bool row_less(const Order& order, std::uint32_t row, const nlohmann::json& key, const std::string& id) const;
+    bool cursor_less(const Order& order, std::uint32_t row, const nlohmann::json& key, const std::string& id) const;
+
+    std::vector<std::string> ids_;
+    std::vector<nlohmann::json> rows_;
+    std::vector<std::string> serialized_;
+    std::map<std::string, Order> orders_;
+};
+// --- Ende seitenweise Listen ---
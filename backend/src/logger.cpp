@@ -0,0 +1,226 @@
+#include "logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+const char* level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warn: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        default: return "OFF";
+    }
+}
+
+void append_timestamp(std::int64_t time_ns, std::string& out) {
+    const std::time_t seconds = static_cast<std::time_t>(time_ns / 1000000000);
+    std::tm utc{};
+    gmtime_r(&seconds, &utc);
+    char buffer[80]; // Platz für den schlimmsten Fall aller int-Felder (sonst -Wformat-truncation), real 24 Zeichen
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", utc.tm_year + 1900, utc.tm_mon + 1, utc.tm_mday,
+                  utc.tm_hour, utc.tm_min, utc.tm_sec, static_cast<int>((time_ns / 1000000) % 1000));
+    out += buffer;
+}
+
+// logfmt: Werte mit Leerzeichen, '=' oder '"' werden in Anführungszeichen gesetzt
+void append_value(const char* text, std::size_t length, std::string& out) {
+    bool quote = length == 0;
+    for (std::size_t i = 0; i < length && !quote; ++i) {
+        quote = text[i] == ' ' || text[i] == '=' || text[i] == '"' || text[i] == '\n';
+    }
+    if (!quote) {
+        out.append(text, length);
+        return;
+    }
+    out += '"';
+    for (std::size_t i = 0; i < length; ++i) {
+        if (text[i] == '"' || text[i] == '\\') out += '\\';
+        out += text[i] == '\n' ? ' ' : text[i];
+    }
+    out += '"';
+}
+
+} // namespace
+
+LogLevel parse_log_level(const std::string& value) {
+    if (value == "debug") return LogLevel::Debug;
+    if (value == "info") return LogLevel::Info;
+    if (value == "warn") return LogLevel::Warn;
+    if (value == "error") return LogLevel::Error;
+    if (value == "off") return LogLevel::Off;
+    throw std::invalid_argument("Unknown log level '" + value + "' (debug, info, warn, error, off).");
+}
+
+Logger::Logger() {
+    drain_thread_ = std::thread([this]() { drain_loop(); });
+}
+
+Logger::ThreadBuffer& Logger::local_buffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffer->thread_index = next_thread_index_++;
+        buffers_.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Logger::fill(Record& record, LogLevel level, const char* message, std::initializer_list<LogField> fields, std::uint32_t thread_index) {
+    record.time_ns = now_ns();
+    record.level = level;
+    record.thread_index = thread_index;
+    record.message = message;
+    record.field_count = 0;
+    std::size_t used = 0;
+    for (const LogField& field : fields) {
+        if (record.field_count == max_fields) break;
+        StoredField& stored = record.fields[record.field_count++];
+        stored.key = field.key;
+        stored.kind = field.kind;
+        stored.int_value = field.int_value;
+        stored.double_value = field.double_value;
+        stored.text_offset = static_cast<std::uint16_t>(used);
+        stored.text_length = 0;
+        if (field.kind == LogField::Kind::Text) {
+            const std::size_t length = std::min(field.text_length, text_capacity - used);
+            std::memcpy(record.text + used, field.text, length);
+            stored.text_length = static_cast<std::uint16_t>(length);
+            used += length;
+        }
+    }
+}
+
+void Logger::log(LogLevel level, const char* message, std::initializer_list<LogField> fields) {
+    if (!enabled(level)) return;
+
+    if (!running_.load(std::memory_order_acquire)) {
+        // Nach shutdown(): synchron schreiben
+        Record record;
+        fill(record, level, message, fields, 0);
+        std::string line;
+        format(record, line);
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        (level >= LogLevel::Warn ? std::cerr : std::cout) << line << std::flush;
+        return;
+    }
+
+    ThreadBuffer& buffer = local_buffer();
+    const std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= ring_capacity) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    fill(buffer.records[head & (ring_capacity - 1)], level, message, fields, buffer.thread_index);
+    buffer.head.store(head + 1, std::memory_order_release);
+    if (level >= LogLevel::Error) {
+        wake_.notify_one(); // Fehler möglichst zeitnah ausgeben
+    }
+}
+
+void Logger::format(const Record& record, std::string& out) {
+    append_timestamp(record.time_ns, out);
+    out += ' ';
+    out += level_name(record.level);
+    out += " msg=";
+    append_value(record.message, std::strlen(record.message), out);
+    for (std::uint8_t i = 0; i < record.field_count; ++i) {
+        const StoredField& field = record.fields[i];
+        out += ' ';
+        out += field.key;
+        out += '=';
+        switch (field.kind) {
+            case LogField::Kind::Int: out += std::to_string(field.int_value); break;
+            case LogField::Kind::Double: {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "%.3f", field.double_value);
+                out += buffer;
+                break;
+            }
+            case LogField::Kind::Text: append_value(record.text + field.text_offset, field.text_length, out); break;
+        }
+    }
+    out += " thread=" + std::to_string(record.thread_index) + "\n";
+}
+
+std::size_t Logger::drain_once() {
+    struct Pending {
+        std::int64_t time_ns;
+        bool to_stderr;
+        std::string line;
+    };
+    std::vector<Pending> pending;
+
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        for (auto it = buffers_.begin(); it != buffers_.end();) {
+            ThreadBuffer& buffer = **it;
+            const std::uint64_t head = buffer.head.load(std::memory_order_acquire);
+            std::uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+            for (; tail != head; ++tail) {
+                const Record& record = buffer.records[tail & (ring_capacity - 1)];
+                Pending entry{record.time_ns, record.level >= LogLevel::Warn, {}};
+                format(record, entry.line);
+                pending.push_back(std::move(entry));
+            }
+            buffer.tail.store(tail, std::memory_order_release);
+            // Thread beendet und alles geschrieben: Puffer freigeben
+            if (it->use_count() == 1) it = buffers_.erase(it);
+            else ++it;
+        }
+    }
+
+    static std::uint64_t reported_drops = 0; // Nur vom Drain-Thread bzw. shutdown() benutzt
+    const std::uint64_t drops = dropped();
+    if (drops != reported_drops) {
+        Record record;
+        const std::uint64_t new_drops = drops - reported_drops;
+        fill(record, LogLevel::Warn, "Log-Einträge verworfen (Puffer voll)", {{"count", new_drops}}, 0);
+        Pending entry{record.time_ns, true, {}};
+        format(record, entry.line);
+        pending.push_back(std::move(entry));
+        reported_drops = drops;
+    }
+
+    if (pending.empty()) return 0;
+    std::stable_sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) { return a.time_ns < b.time_ns; });
+    std::string out_batch, err_batch;
+    for (const Pending& entry : pending) (entry.to_stderr ? err_batch : out_batch) += entry.line;
+
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    if (!out_batch.empty()) std::cout << out_batch << std::flush;
+    if (!err_batch.empty()) std::cerr << err_batch << std::flush;
+    return pending.size();
+}
+
+void Logger::drain_loop() {
+    while (running_.load(std::memory_order_acquire)) {
+        drain_once();
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait_for(lock, std::chrono::milliseconds(20));
+    }
+}
+
+void Logger::shutdown() {
+    if (!running_.exchange(false)) return;
+    wake_.notify_one();
+    if (drain_thread_.joinable()) drain_thread_.join();
+    drain_once(); // Rest, der nach dem letzten Durchlauf noch geschrieben wurde
+}
+
+Logger& logger() {
+    static Logger* instance = new Logger(); // Absichtlich nie zerstört
+    return *instance;
+}
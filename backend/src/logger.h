@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Asynchrones, strukturiertes Logging ---
+// Request-Threads schreiben in einen eigenen Ringpuffer (Single-Producer/Single-Consumer, ohne Lock),
+// ein Hintergrund-Thread formatiert die Einträge (logfmt: key=value) und schreibt sie gesammelt nach
+// stdout (debug/info) bzw. stderr (warn/error). Ist ein Puffer voll, wird der Eintrag verworfen und gezählt.
+//
+// Nachrichten und Schlüssel müssen String-Literale sein (es wird nur der Zeiger gespeichert),
+// Text-Werte werden kopiert (gekürzt, falls sie nicht in den Eintrag passen).
+
+enum class LogLevel : std::uint8_t { Debug, Info, Warn, Error, Off };
+
+// Wirft std::invalid_argument bei unbekannten Namen ("debug", "info", "warn", "error", "off")
+LogLevel parse_log_level(const std::string& value);
+
+struct LogField {
+    enum class Kind : std::uint8_t { Int, Double, Text };
+
+    LogField(const char* key, long long value) : key(key), kind(Kind::Int), int_value(value) {}
+    LogField(const char* key, int value) : LogField(key, static_cast<long long>(value)) {}
+    LogField(const char* key, long value) : LogField(key, static_cast<long long>(value)) {}
+    LogField(const char* key, unsigned long value) : LogField(key, static_cast<long long>(value)) {}
+    LogField(const char* key, unsigned long long value) : LogField(key, static_cast<long long>(value)) {}
+    LogField(const char* key, double value) : key(key), kind(Kind::Double), double_value(value) {}
+    LogField(const char* key, const char* value) : key(key), kind(Kind::Text), text(value ? value : ""), text_length(value ? std::char_traits<char>::length(value) : 0) {}
+    // Der String muss nur bis zum Ende des log-Aufrufs leben (Temporaries wie path.string() sind ok)
+    LogField(const char* key, const std::string& value) : key(key), kind(Kind::Text), text(value.data()), text_length(value.size()) {}
+
+    const char* key;
+    Kind kind;
+    long long int_value = 0;
+    double double_value = 0.0;
+    const char* text = nullptr;
+    std::size_t text_length = 0;
+};
+
+class Logger {
+public:
+    static constexpr std::size_t max_fields = 6;
+    static constexpr std::size_t text_capacity = 384; // Platz für alle Text-Werte eines Eintrags
+    static constexpr std::size_t ring_capacity = 512; // Einträge pro Thread (Zweierpotenz)
+
+    Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    bool enabled(LogLevel level) const { return level >= min_level_.load(std::memory_order_relaxed); }
+    void set_min_level(LogLevel level) { min_level_.store(level, std::memory_order_relaxed); }
+
+    void log(LogLevel level, const char* message, std::initializer_list<LogField> fields = {});
+
+    // Schreibt alle gepufferten Einträge und beendet den Hintergrund-Thread; danach wird synchron geloggt
+    void shutdown();
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct StoredField {
+        const char* key;
+        LogField::Kind kind;
+        std::uint16_t text_offset;
+        std::uint16_t text_length;
+        long long int_value;
+        double double_value;
+    };
+
+    struct Record {
+        std::int64_t time_ns;
+        LogLevel level;
+        std::uint8_t field_count;
+        std::uint32_t thread_index;
+        const char* message;
+        StoredField fields[max_fields];
+        char text[text_capacity];
+    };
+
+    struct ThreadBuffer {
+        std::uint32_t thread_index = 0;
+        std::atomic<std::uint64_t> head{0}; // Nur der eigene Thread schreibt
+        std::atomic<std::uint64_t> tail{0}; // Nur der Drain-Thread schreibt
+        std::unique_ptr<Record[]> records{new Record[ring_capacity]};
+    };
+
+    ThreadBuffer& local_buffer();
+    static void fill(Record& record, LogLevel level, const char* message, std::initializer_list<LogField> fields, std::uint32_t thread_index);
+    static void format(const Record& record, std::string& out);
+    void drain_loop();
+    std::size_t drain_once();
+
+    std::atomic<LogLevel> min_level_{LogLevel::Info};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<bool> running_{true};
+
+    std::mutex buffers_mutex_; // Nur beim Anmelden eines Threads und im Drain-Thread
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    std::uint32_t next_thread_index_ = 0;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::mutex output_mutex_; // Drain-Thread bzw. synchrones Logging nach shutdown()
+    std::thread drain_thread_;
+};
+
+// Prozessweite Instanz (wird nie zerstört, damit auch Destruktoren globaler Objekte loggen können)
+Logger& logger();
+
+inline void log_debug(const char* message, std::initializer_list<LogField> fields = {}) { logger().log(LogLevel::Debug, message, fields); }
+inline void log_info(const char* message, std::initializer_list<LogField> fields = {}) { logger().log(LogLevel::Info, message, fields); }
+inline void log_warn(const char* message, std::initializer_list<LogField> fields = {}) { logger().log(LogLevel::Warn, message, fields); }
+inline void log_error(const char* message, std::initializer_list<LogField> fields = {}) { logger().log(LogLevel::Error, message, fields); }
+// --- Ende Logging ---
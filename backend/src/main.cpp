@@ -9,33 +9,42 @@
 #include <iomanip>    // Für std::setw (im dump für pretty print)
 #include <algorithm>  // Für std::transform, std::replace_if, std::find, std::unique
 #include <cctype>     // Für ::tolower, ::isalnum
-#include <set>        // Für std::set (zum Verfolgen laufender Ladevorgänge)
 #include <map>        // Für Benutzerdaten
+#include <thread>     // Für den Warm-Start im Hintergrund
+#include <optional>   // Für optionale Query-Parameter
+#include <random>     // Für ungeseedete Würfe (/api/roll)
+#include <chrono>     // Für Latenzmessung (/api/metrics)
+#include <unordered_set> // Für das Deduplizieren von Monster-IDs (Batch-Laden)
+#include <array>      // Für die Schreib-Sperren pro Dokument
+#include <mutex>      // Für die Schreib-Sperren pro Dokument
+#include <tuple>      // Für std::tie (Monster-Dateipfade)
 
 // Crow Header
 #include "crow.h"
 // nlohmann/json Header
 #include "nlohmann/json.hpp"
 
-// Deine CorsMiddleware (wie gehabt)
-struct CorsMiddleware {
-     struct context {};
-    void before_handle(crow::request& req, crow::response& res, context& /*ctx*/) {
-
-        if (req.method == "OPTIONS"_method) {
-            res.add_header("Access-Control-Allow-Origin", "http://localhost:5173");
-            res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-            res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
-            res.code = 204;
-            res.end();
-        }
-    }
-    void after_handle(crow::request& /*req*/, crow::response& res, context& /*ctx*/) {
-        res.set_header("Access-Control-Allow-Origin", "http://localhost:5173");
-        res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
-    }
-};
+#include "catalog_pack.h"
+#include "combat_simulator.h"
+#include "damage_distribution.h"
+#include "data_snapshot.h"
+#include "dice.h"
+#include "dnddata_cache.h"
+#include "encounter_difficulty.h"
+#include "json_patch.h"
+#include "listing_index.h"
+#include "logger.h"
+#include "manifest_index.h"
+#include "metrics.h"
+#include "monster_catalog.h"
+#include "monster_query.h"
+#include "parallel.h"
+#include "response_cache.h"
+#include "source_bound.h"
+#include "spell_index.h"
+#include "server.h"
+#include "statblock_cache.h"
+#include "write_journal.h"
 
 using json = nlohmann::json;
 
@@ -57,36 +66,70 @@ void load_users() {
                 user_file >> user_data_json;
                 if (user_data_json.is_object()) {
                     users_db = user_data_json.get<std::map<std::string, json>>();
-                    std::cout << "Benutzerdaten geladen aus " << user_data_file << std::endl;
+                    log_info("Benutzerdaten geladen", {{"path", user_data_file}});
                 } else {
-                     std::cerr << "Warnung: users.json enthält kein gültiges JSON-Objekt." << std::endl;
+                     log_warn("users.json enthält kein gültiges JSON-Objekt");
                 }
             } else {
-                std::cerr << "Warnung: Konnte users.json nicht öffnen." << std::endl;
+                log_warn("Konnte users.json nicht öffnen");
             }
         } else {
-             std::cerr << "Warnung: users.json nicht gefunden. Verwende leere Benutzerdatenbank." << std::endl;
+             log_warn("users.json nicht gefunden, verwende leere Benutzerdatenbank");
              // Optional: Standardbenutzer erstellen, wenn keine Datei da ist
              // users_db["dm"] = {{"password", "dm_password"}, {"role", "DM"}};
              // users_db["player"] = {{"password", "player_password"}, {"role", "Player"}};
         }
     } catch (const std::exception& e) {
-        std::cerr << "Fehler beim Laden der Benutzerdaten: " << e.what() << std::endl;
+        log_error("Fehler beim Laden der Benutzerdaten", {{"error", e.what()}});
     }
 }
 // --- Ende Benutzerdaten ---
 
 // --- Globale Konstanten und Caches ---
+const std::string data_base_dir = "../data";
 const std::string encounters_base_dir = "../data/encounters";
 const std::string monsters_base_dir = "../data/monsters";
 const std::string dnddata_base_dir = "../data/DnDData";
 const std::string templates_base_dir = "../data/templates";
 const std::vector<std::string> valid_template_types = {"trait", "attackRoll", "savingThrow", "other"}; // Liste der erlaubten Template-Typen
 
-// Simpler In-Memory Cache für DnDData
-std::map<std::string, json> dndDataCache;
-// Set zum Verfolgen, welche DnDData Dateien gerade geladen werden
-std::set<std::string> currently_loading_dnd_data;
+// Thread-sicherer In-Memory Cache für DnDData (lädt jede Datei nur einmal, auch bei parallelen Anfragen)
+DnDDataCache dndDataCache(dnddata_base_dir);
+// Zusammenfassungen aller Monster (für /api/monsters/summary)
+MonsterCatalog monster_catalog(monsters_base_dir);
+// Zuletzt benutzte Monster-Statblöcke (Budget per --statblock-cache-mb, Standard 64 MB)
+StatblockCache statblock_cache(64ull * 1024 * 1024, false);
+// Unveränderlicher Snapshot der Referenzdaten, wird beim Start parallel vorgeladen
+DataSnapshotStore data_snapshot(data_base_dir, {"DnDData", "spells", "templates", "classes", "subclasses", "features", "items"});
+// Vorkompilierter Datenbaum (DnDApp_pack); wird in start_services() gemappt, nullptr = nur JSON-Dateien
+std::string catalog_pack_file = "dndapp.pack";
+std::shared_ptr<const CatalogPack> catalog_pack;
+// Schreibende Routen (Monster, Templates) committen über das Journal (--no-journal: direkt schreiben)
+WriteJournal write_journal(data_base_dir, std::filesystem::path(data_base_dir) / "journal.wal");
+// Änderung committet, aber noch nicht in den Dateibaum übertragen (Snapshot und Manifeste sind dann aktueller als die Platte)
+bool journal_pending(const std::filesystem::path& file) {
+    return write_journal.pending(file) != WriteJournal::PendingState::none;
+}
+// Serialisiert Lesen-Prüfen-Schreiben pro Dokument (PUT/PATCH/DELETE), damit ein PATCH auf genau dem Stand aufsetzt,
+// dessen ETag er gegen If-Match geprüft hat
+std::mutex& document_write_lock(const std::string& key) {
+    static std::array<std::mutex, 64> locks;
+    return locks[fnv1a64(key) % locks.size()];
+}
+// Vorbereitete Antwort (ETag + gzip/deflate) für /api/spells
+SourceResponseCache spells_response_cache("spells_response");
+// Invertierte Indizes für gefilterte Spell-Anfragen
+SpellIndexCache spell_index_cache;
+// Lookup-Tabellen für die Encounter-Schwierigkeit (aus crData.json)
+SourceBound<DifficultyEngine> difficulty_engine_cache("difficulty_engine");
+// Bitmap-Index über die Monster-Zusammenfassungen für GET /api/monsters/query
+SourceBound<MonsterQueryIndex> monster_query_cache("monster_query_index");
+// Manifest (ID, Name, mtime, Größe, Hash) für GET /api/encounters
+ManifestIndex encounter_manifest(encounters_base_dir, [](const std::filesystem::path&, const json& data) -> std::optional<ManifestIndex::Fields> {
+    if (!data.is_object() || !data.contains("id") || !data.contains("name")) return std::nullopt; // Wie bisher: nur vollständige Encounter
+    auto as_text = [](const json& value) { return value.is_string() ? value.get<std::string>() : value.dump(); };
+    return ManifestIndex::Fields{as_text(data["id"]), as_text(data["name"])};
+}, "encounter_manifest", {"/id", "/name"});
 // --- Ende Globale Konstanten und Caches ---
 
 
@@ -111,43 +154,36 @@ std::filesystem::path get_template_filepath(const std::string& type, const std::
     return std::filesystem::absolute(file_path).lexically_normal();
 }
 
-// Listet Templates eines Typs auf (gibt nur ID und Name zurück)
-json list_templates_by_type(const std::string& type) {
-    if (!is_valid_template_type(type)) {
+// Manifest der Templates eines Typs, nullptr bei ungültigem Typ
+ManifestIndex* template_manifest(const std::string& type) {
+    static const std::map<std::string, std::unique_ptr<ManifestIndex>> manifests = []() {
+        std::map<std::string, std::unique_ptr<ManifestIndex>> result;
+        for (const std::string& template_type : valid_template_types) {
+            result[template_type] = std::make_unique<ManifestIndex>(
+                std::filesystem::path(templates_base_dir) / template_type,
+                [](const std::filesystem::path& file, const json& data) -> std::optional<ManifestIndex::Fields> {
+                    // Sicherer Zugriff auf den Namen, Fallback wenn fehlt
+                    return ManifestIndex::Fields{file.stem().string(), data.is_object() ? data.value("name", "Unknown Template") : "Unknown Template"};
+                },
+                "template_manifest", std::vector<std::string>{"/name"});
+            result[template_type]->set_pending_check(journal_pending);
+        }
+        return result;
+    }();
+    auto it = manifests.find(type);
+    return it != manifests.end() ? it->second.get() : nullptr;
+}
+
+// Listet Templates eines Typs auf (gibt nur ID und Name zurück), optional nur Namen mit name_prefix.
+// Kommt aus dem Manifest, Dateien werden nur nach Änderungen neu gelesen.
+json list_templates_by_type(const std::string& type, const std::string& name_prefix) {
+    ManifestIndex* manifest = template_manifest(type);
+    if (!manifest) {
          return json::array(); // Ungültiger Typ -> leeres Array
      }
     json template_list = json::array();
-    std::filesystem::path template_dir = std::filesystem::path(templates_base_dir) / type;
-
-    try {
-        // Stelle sicher, dass das Verzeichnis existiert
-        if (!std::filesystem::exists(template_dir) || !std::filesystem::is_directory(template_dir)) {
-            std::filesystem::create_directories(template_dir); // Erstelle es, wenn es fehlt
-            return template_list; // Gib leere Liste zurück, wenn es gerade erst erstellt wurde
-        }
-
-        for (const auto& entry : std::filesystem::directory_iterator(template_dir)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".json") {
-                std::ifstream file(entry.path());
-                if (file.is_open()) {
-                    try {
-                        json data;
-                        file >> data;
-                        json item;
-                        item["id"] = entry.path().stem().string();
-                        // Sicherer Zugriff auf den Namen, Fallback wenn fehlt
-                        item["name"] = data.value("name", "Unknown Template");
-                        template_list.push_back(item);
-                    } catch (const std::exception& e) {
-                        std::cerr << "Fehler beim Verarbeiten von Template " << entry.path() << ": " << e.what() << std::endl;
-                    }
-                }
-            }
-        }
-    } catch (const std::exception& e) {
-        std::cerr << "Fehler beim Auflisten von Templates (" << type << "): " << e.what() << std::endl;
-        // Fehler beim Auflisten sollte 500 sein, wird vom Handler behandelt
-        throw; // Exception weiterwerfen
+    for (const ManifestEntry& entry : manifest->list(name_prefix)) {
+        template_list.push_back({{"id", entry.id}, {"name", entry.name}});
     }
     return template_list;
 }
@@ -157,6 +193,20 @@ json get_template_by_type(const std::string& type, const std::string& id) {
     try {
          std::filesystem::path file_path = get_template_filepath(type, id);
 
+         if (data_snapshot.is_warm()) {
+             std::shared_ptr<const SnapshotEntry> entry = data_snapshot.find("templates", type + "/" + id + ".json");
+             if (!entry) {
+                 throw std::runtime_error("Template not found.");
+             }
+             return entry->document();
+         }
+
+         std::string pending_content;
+         switch (write_journal.pending(file_path, &pending_content)) {
+             case WriteJournal::PendingState::written: return json::parse(pending_content);
+             case WriteJournal::PendingState::removed: throw std::runtime_error("Template not found.");
+             default: break;
+         }
          if (!std::filesystem::exists(file_path) || !std::filesystem::is_regular_file(file_path)) {
             throw std::runtime_error("Template not found."); // Eigene Meldung für 404
          }
@@ -168,13 +218,13 @@ json get_template_by_type(const std::string& type, const std::string& id) {
          return template_data;
 
     } catch (const json::parse_error& e) {
-        std::cerr << "Fehler beim Parsen von Template " << type << "/" << id << ": " << e.what() << std::endl;
+        log_error("Fehler beim Parsen von Template", {{"type", type}, {"id", id}, {"error", e.what()}});
         throw std::runtime_error("Error reading template content."); // Eigene Meldung für 500
     } catch (const std::runtime_error& e) {
         // Propagiert Fehler von get_template_filepath oder "Template not found"
         throw;
     } catch (const std::exception& e) {
-        std::cerr << "Fehler beim Laden von Template " << type << "/" << id << ": " << e.what() << std::endl;
+        log_error("Fehler beim Laden von Template", {{"type", type}, {"id", id}, {"error", e.what()}});
         throw std::runtime_error("Internal server error loading template."); // Generische 500 Meldung
     }
 }
@@ -219,18 +269,22 @@ json save_template_by_type(const std::string& type, const json& incoming_data) {
     try {
         file_path = get_template_filepath(type, template_id); // Nutze generierte ID im Pfad
 
-        // Prüfen, ob Template mit dieser ID schon existiert
-        if (std::filesystem::exists(file_path)) {
+        // Prüfen und Schreiben unter demselben Lock wie PATCH/DELETE, sonst bestehen zwei gleichnamige POSTs beide die Prüfung
+        std::lock_guard write_lock(document_write_lock("template/" + type + "/" + template_id));
+        // Prüfen, ob Template mit dieser ID schon existiert (auch noch nicht übertragene Journal-Einträge)
+        if (write_journal.exists(file_path)) {
             throw std::runtime_error("A template with this ID already exists."); // Eigene Meldung für 409
         }
 
-        // Stelle sicher, dass das Verzeichnis existiert
-        std::filesystem::create_directories(file_path.parent_path());
-
-        std::ofstream output_file(file_path);
-        if (!output_file.is_open()) { throw std::runtime_error("Could not save template file."); }
-        output_file << incoming_data.dump(4); // Schreibe die empfangenen Daten (mit 4 Spaces Einrückung)
-        output_file.close();
+        const std::string content = incoming_data.dump(4); // Schreibe die empfangenen Daten (mit 4 Spaces Einrückung)
+        try {
+            write_journal.commit({{WriteJournal::Operation::Kind::write, file_path, content}});
+        } catch (const std::exception& e) {
+            log_error("Template konnte nicht gespeichert werden", {{"path", file_path.string()}, {"error", e.what()}});
+            throw std::runtime_error("Could not save template file.");
+        }
+        data_snapshot.put("templates", type + "/" + template_id + ".json", incoming_data);
+        template_manifest(type)->put(file_path, incoming_data, content);
 
         json response_data = incoming_data;
         response_data["id"] = template_id; // Füge die generierte ID zur Antwort hinzu
@@ -241,7 +295,7 @@ json save_template_by_type(const std::string& type, const json& incoming_data) {
         throw;
     }
     catch (const std::exception& e) {
-        std::cerr << "Fehler beim Speichern von Template (" << type << ", ID: " << template_id << "): " << e.what() << std::endl;
+        log_error("Fehler beim Speichern von Template", {{"type", type}, {"id", template_id}, {"error", e.what()}});
         throw std::runtime_error("Internal server error saving template.");
     }
 }
@@ -251,82 +305,488 @@ void delete_template_by_type(const std::string& type, const std::string& id) {
     try {
          std::filesystem::path file_path = get_template_filepath(type, id);
 
-         if (!std::filesystem::exists(file_path)) {
+         if (!write_journal.exists(file_path)) {
              throw std::runtime_error("Template not found for deletion."); // Eigene Meldung für 404
          }
-         if (!std::filesystem::is_regular_file(file_path)) {
+         if (write_journal.pending(file_path) == WriteJournal::PendingState::none && !std::filesystem::is_regular_file(file_path)) {
               throw std::runtime_error("Path exists but is not a regular file."); // Eigene Meldung für 404
          }
 
-         if (std::filesystem::remove(file_path)) {
-             // Erfolg, 204 No Content wird im Handler gesendet
-         } else {
-              throw std::runtime_error("Could not delete template file."); // Eigene Meldung für 500
+         try {
+             write_journal.commit({{WriteJournal::Operation::Kind::remove, file_path, ""}});
+         } catch (const std::exception& e) {
+             log_error("Template konnte nicht gelöscht werden", {{"path", file_path.string()}, {"error", e.what()}});
+             throw std::runtime_error("Could not delete template file."); // Eigene Meldung für 500
          }
+         // Erfolg, 204 No Content wird im Handler gesendet
+         data_snapshot.erase("templates", type + "/" + id + ".json");
+         template_manifest(type)->erase(file_path);
      } catch (const std::runtime_error& e) {
          // Propagiert Fehler von get_template_filepath oder "Template not found" oder "Could not delete"
         throw;
      }
     catch (const std::exception& e) {
-        std::cerr << "Fehler beim Löschen von Template (" << type << ", ID: " << id << "): " << e.what() << std::endl;
+        log_error("Fehler beim Löschen von Template", {{"type", type}, {"id", id}, {"error", e.what()}});
         throw std::runtime_error("Internal server error deleting template.");
     }
 }
 
-// --- Hilfsfunktion zum Laden eines Monster-Statblocks (geringfügig angepasst) ---
-// Sucht jetzt in completed und uncompleted Ordnern
+// Wendet einen Patch (siehe json_patch.h) auf ein Template an und speichert es; die ID bleibt, auch wenn sich der Name ändert.
+// Wirft PatchError (412 bei veraltetem If-Match, 422 ohne Namen) sowie std::runtime_error wie get_template_by_type.
+// Aufrufer hält document_write_lock für das Template.
+json patch_template_by_type(const std::string& type, const std::string& id, const json& patch, const std::string& if_match) {
+    const json current = get_template_by_type(type, id);
+    if (!if_match.empty() && !if_match_satisfied(if_match, make_etag(current.dump()))) {
+        throw PatchError(412, "Template was modified, reload and retry.");
+    }
+    json patched = apply_patch(current, patch);
+    if (!patched.is_object() || !patched.contains("name") || !patched["name"].is_string() || patched["name"].get<std::string>().empty()) {
+        throw PatchError(422, "Missing or empty 'name' field for template.");
+    }
+
+    const std::filesystem::path file_path = get_template_filepath(type, id);
+    const std::string content = patched.dump(4);
+    try {
+        // Ins Journal geht nur der Patch, der Dateibaum bekommt wie bei POST das ganze Dokument
+        write_journal.commit({{WriteJournal::Operation::Kind::patch, file_path, content, patch.dump()}});
+    } catch (const std::exception& e) {
+        log_error("Template konnte nicht gespeichert werden", {{"path", file_path.string()}, {"error", e.what()}});
+        throw std::runtime_error("Could not save template file.");
+    }
+    data_snapshot.put("templates", type + "/" + id + ".json", patched);
+    template_manifest(type)->put(file_path, patched, content);
+    return patched;
+}
+
+// Body einer Datei unter data/ direkt aus dem Catalog-Pack. nullopt ohne Pack, bei ausstehender Journal-Änderung
+// oder wenn die Datei seit dem Packen geändert wurde (dann wie bisher aus dem JSON-Baum lesen).
+std::optional<std::string_view> packed_body(const std::filesystem::path& file) {
+    if (!catalog_pack || write_journal.pending(file) != WriteJournal::PendingState::none) {
+        return std::nullopt;
+    }
+    static const std::filesystem::path data_dir = std::filesystem::absolute(data_base_dir).lexically_normal();
+    const std::filesystem::path absolute_file = std::filesystem::absolute(file).lexically_normal();
+    if (std::optional<CatalogPack::Record> record = catalog_pack->find_fresh(absolute_file.lexically_relative(data_dir), absolute_file)) {
+        return record->body;
+    }
+    return std::nullopt;
+}
+
+// --- Hilfsfunktion zum Laden eines Monster-Statblocks ---
+// Sucht in completed und uncompleted (completed zuerst). Der Ort kommt aus dem Index des
+// Monster-Katalogs, ein Lookup kostet daher keine stat-Aufrufe und höchstens ein open.
 json load_monster_statblock(const std::string& monster_id) {
-     std::filesystem::path monster_file_path;
-     bool file_found = false;
+     const std::vector<std::filesystem::path> locations = monster_catalog.locate(monster_id);
+     if (locations.empty()) {
+         log_debug("Monster nicht in completed oder uncompleted gefunden", {{"id", monster_id}});
+         return nullptr; // Signalisiert 404
+     }
+     const std::filesystem::path& monster_file_path = locations.front();
 
      try {
-         std::vector<std::string> potential_subdirs = {"completed", "uncompleted"};
-         for(const auto& subdir : potential_subdirs) {
-              std::filesystem::path current_path;
-              try {
-                 current_path = std::filesystem::absolute(std::filesystem::path(monsters_base_dir) / subdir / (monster_id + ".json")).lexically_normal();
-                 if (std::filesystem::exists(current_path) && std::filesystem::is_regular_file(current_path)) {
-                     monster_file_path = current_path;
-                     file_found = true;
-                     break; // Datei gefunden, Schleife beenden
-                 }
-              } catch(const std::exception& e) {
-                   std::cerr << "Fehler beim Suchen nach Monster " << monster_id << " in " << subdir << ": " << e.what() << std::endl;
-              }
+         // Gespeichert, aber vom Journal noch nicht in den Dateibaum übertragen
+         std::string pending_content;
+         switch (write_journal.pending(monster_file_path, &pending_content)) {
+             case WriteJournal::PendingState::written: {
+                 auto timer = metrics().time_json_parse();
+                 return json::parse(pending_content);
+             }
+             case WriteJournal::PendingState::removed: return nullptr;
+             default: break;
          }
 
-          if (!file_found) {
-              std::cerr << "Monster " << monster_id << " nicht in completed oder uncompleted gefunden." << std::endl;
-              return nullptr; // Signalisiert 404
-          }
+         if (std::optional<std::string_view> body = packed_body(monster_file_path)) {
+             auto timer = metrics().time_json_parse();
+             return json::parse(*body);
+         }
 
-         std::ifstream monster_file(monster_file_path);
+         std::ifstream monster_file(monster_file_path, std::ios::binary);
          if (!monster_file.is_open()) {
-             std::cerr << "Fehler: Monster-Datei konnte nicht geöffnet werden: " << monster_file_path << std::endl;
-              return nullptr; // Signalisiert 500
+             // Datei wurde gelöscht, bevor der Watcher den Index aktualisiert hat
+             log_warn("Monster-Datei konnte nicht geöffnet werden", {{"path", monster_file_path.string()}});
+             monster_catalog.forget_file(monster_file_path);
+             return nullptr;
          }
 
-         json monster_data;
-         monster_file >> monster_data; // Parse JSON
-         return monster_data;
+         std::string content;
+         monster_file.seekg(0, std::ios::end);
+         content.resize(static_cast<std::size_t>(std::max<std::streamoff>(0, monster_file.tellg())));
+         monster_file.seekg(0, std::ios::beg);
+         monster_file.read(content.data(), static_cast<std::streamsize>(content.size()));
+         metrics().record_file_read(content.size());
+
+         auto timer = metrics().time_json_parse();
+         return json::parse(content);
 
      } catch (const json::parse_error& e) {
-         std::cerr << "Fehler beim Parsen der Monster-JSON-Datei " << monster_file_path << ": " << e.what() << std::endl;
+         log_error("Fehler beim Parsen der Monster-JSON-Datei", {{"path", monster_file_path.string()}, {"error", e.what()}});
          return nullptr; // Signalisiert 500
      } catch (const std::exception& e) {
-         std::cerr << "Fehler beim Laden der Monster-Datei " << monster_file_path << ": " << e.what() << std::endl;
+         log_error("Fehler beim Laden der Monster-Datei", {{"path", monster_file_path.string()}, {"error", e.what()}});
          return nullptr; // Signalisiert 500
      }
 }
 // --- Ende Hilfsfunktion Monster Laden ---
 
+// Statblock aus dem LRU-Cache, bei einem Fehlgriff von Platte (und danach gecacht).
+// need_document = true liefert auch den json-Baum. nullopt, wenn das Monster fehlt oder unlesbar ist.
+std::optional<StatblockCache::Entry> get_monster_statblock(const std::string& monster_id, bool need_document) {
+    if (std::optional<StatblockCache::Entry> cached = statblock_cache.find(monster_id, need_document)) {
+        return cached;
+    }
+    if (!need_document) {
+        // Unveränderte Statblöcke kommen ohne Parsen direkt aus dem Catalog-Pack
+        const std::vector<std::filesystem::path> locations = monster_catalog.locate(monster_id);
+        if (!locations.empty()) {
+            if (std::optional<std::string_view> body = packed_body(locations.front())) {
+                return StatblockCache::Entry{std::make_shared<const std::string>(*body), nullptr, nullptr};
+            }
+        }
+    }
+    const std::uint64_t generation = statblock_cache.generation(monster_id);
+    json monster_data = load_monster_statblock(monster_id);
+    if (monster_data == nullptr) {
+        return std::nullopt;
+    }
+    return statblock_cache.insert(monster_id, generation, std::move(monster_data));
+}
+
+// Mindestanforderungen an einen gespeicherten Statblock (PUT, PATCH); Fehlermeldung oder nullopt
+std::optional<std::string> monster_validation_error(const json& data) {
+    if (!data.is_object() || !data.contains("basics") || !data["basics"].is_object()) { return "Missing or invalid 'basics' object."; }
+    const json& basics_data = data["basics"];
+    if (!basics_data.contains("name") || !basics_data["name"].is_string() || basics_data["name"].get<std::string>().empty()) { return "Missing or empty 'basics.name' field."; }
+    if (!basics_data.contains("CR") || !basics_data["CR"].is_number()) { return "Missing or invalid 'basics.CR' field (must be a number)."; }
+    if (data.contains("complete") && !data["complete"].is_boolean()) { return "'complete' must be a boolean."; }
+    return std::nullopt;
+}
+
+// Zieldatei eines Monsters nach "complete" (completed/uncompleted) und dieselbe ID im anderen Ordner, beide absolut.
+// Legt beide Ordner an; wirft std::filesystem::filesystem_error.
+std::pair<std::filesystem::path, std::filesystem::path> monster_file_paths(const std::string& monster_id, bool complete) {
+    const std::filesystem::path target_dir_path = std::filesystem::path(monsters_base_dir) / (complete ? "completed" : "uncompleted");
+    const std::filesystem::path other_dir_path = std::filesystem::path(monsters_base_dir) / (complete ? "uncompleted" : "completed");
+    std::filesystem::create_directories(target_dir_path);
+    std::filesystem::create_directories(other_dir_path); // Stelle sicher, dass auch der andere Ordner existiert
+    return {std::filesystem::absolute(target_dir_path / (monster_id + ".json")).lexically_normal(),
+            std::filesystem::absolute(other_dir_path / (monster_id + ".json")).lexically_normal()};
+}
+
+// --- Mehrere Statblöcke auf einmal (Batch-Route und ?hydrate=true) ---
+// Doppelte IDs werden nur einmal geladen, Laden und Serialisieren laufen parallel.
+// bodies[i] ist der fertige JSON-Text zu ids[i], nullptr wenn das Monster fehlt.
+struct StatblockBatch {
+    std::vector<std::string> ids;
+    std::vector<std::shared_ptr<const std::string>> bodies;
+};
+
+StatblockBatch load_monster_statblocks(const std::vector<std::string>& requested_ids) {
+    StatblockBatch batch;
+    std::unordered_set<std::string> seen;
+    for (const std::string& id : requested_ids) {
+        if (!id.empty() && seen.insert(id).second) batch.ids.push_back(id);
+    }
+    batch.bodies.resize(batch.ids.size());
+    // Überwiegend Dateizugriffe: schon ab zwei IDs pro Thread lohnt sich ein weiterer Thread
+    parallel_for(batch.ids.size(), [&](std::size_t i) {
+        if (std::optional<StatblockCache::Entry> statblock = get_monster_statblock(batch.ids[i], false)) {
+            batch.bodies[i] = statblock->body;
+        }
+    }, 2);
+    return batch;
+}
+
+// Hängt {"id": {...}, ...} an out an, ohne die Statblöcke noch einmal als json-Baum zusammenzusetzen
+void append_statblock_map(const StatblockBatch& batch, std::string& out) {
+    out += '{';
+    bool first = true;
+    for (std::size_t i = 0; i < batch.ids.size(); ++i) {
+        if (!batch.bodies[i]) continue;
+        if (!first) out += ',';
+        first = false;
+        out += json(batch.ids[i]).dump();
+        out += ':';
+        out += *batch.bodies[i];
+    }
+    out += '}';
+}
+
+json missing_statblock_ids(const StatblockBatch& batch) {
+    json missing = json::array();
+    for (std::size_t i = 0; i < batch.ids.size(); ++i) {
+        if (!batch.bodies[i]) missing.push_back(batch.ids[i]);
+    }
+    return missing;
+}
+// --- Ende Batch-Laden ---
+
+
+// --- Encounter-Schwierigkeit ---
+
+// Engine aus crData.json, wird pro Snapshot-Eintrag nur einmal aufgebaut
+std::shared_ptr<const DifficultyEngine> get_difficulty_engine() {
+    if (std::shared_ptr<const SnapshotEntry> entry = data_snapshot.find("DnDData", "crData.json")) {
+        return difficulty_engine_cache.get(entry, [&]() { return std::make_shared<const DifficultyEngine>(entry->document()); });
+    }
+    // Vor dem Warm-Start über den DnDData-Cache (Body ist bereits validiertes JSON)
+    DnDDataCache::Result cached = dndDataCache.get("crData.json");
+    return difficulty_engine_cache.get(cached.body, [&]() { return std::make_shared<const DifficultyEngine>(json::parse(*cached.body)); });
+}
+// --- Ende Encounter-Schwierigkeit ---
+
+
+// --- Monster-Abfrage ---
+
+// DnDData-Datei als JSON (Snapshot, sonst DnDData-Cache); fehlende Datei -> leeres JSON
+json load_dnddata_json(const std::string& filename) {
+    if (std::shared_ptr<const SnapshotEntry> entry = data_snapshot.find("DnDData", filename)) {
+        return entry->document();
+    }
+    try {
+        return json::parse(*dndDataCache.get(filename).body);
+    } catch (const std::exception& e) {
+        log_warn("DnDData-Datei für Monster-Abfrage nicht lesbar", {{"file", filename}, {"error", e.what()}});
+        return json();
+    }
+}
+
+MonsterVocabularies load_monster_vocabularies() {
+    auto strings = [](const json& data) {
+        std::vector<std::string> values;
+        if (!data.is_array()) return values;
+        for (const json& value : data) {
+            if (value.is_string()) values.push_back(value.get<std::string>());
+        }
+        return values;
+    };
+    MonsterVocabularies vocabularies;
+    vocabularies.sizes = strings(load_dnddata_json("sizes.json").value("creatureSizes", json::array()));
+    vocabularies.types = strings(load_dnddata_json("monsterTypes.json"));
+    vocabularies.alignments = strings(load_dnddata_json("alignments.json"));
+    vocabularies.movement = strings(load_dnddata_json("movementTypes.json"));
+    vocabularies.damage_types = strings(load_dnddata_json("damageResImuVul.json"));
+    vocabularies.conditions = strings(load_dnddata_json("conditionResImuVul.json"));
+    return vocabularies;
+}
+
+// Index wird nur neu gebaut, wenn sich der Monster-Katalog geändert hat
+std::shared_ptr<const MonsterQueryIndex> get_monster_query_index() {
+    std::shared_ptr<const std::vector<MonsterSummary>> monsters = monster_catalog.snapshot();
+    return monster_query_cache.get(monsters, [&]() {
+        return std::make_shared<const MonsterQueryIndex>(*monsters, load_monster_vocabularies());
+    });
+}
+// --- Ende Monster-Abfrage ---
+
+
+// --- Hilfsfunktionen für Query-Parameter ---
+
+// Liest einen Query-Parameter, leerer String wenn er fehlt
+std::string get_query_param(const crow::request& req, const std::string& name) {
+    const char* value = req.url_params.get(name);
+    return value ? std::string(value) : std::string();
+}
+
+// "true"/"1" bzw. "false"/"0", fehlender Parameter -> std::nullopt, sonst std::invalid_argument
+std::optional<bool> parse_bool_param(const crow::request& req, const std::string& name) {
+    std::string value = get_query_param(req, name);
+    if (value.empty()) return std::nullopt;
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    if (value == "true" || value == "1") return true;
+    if (value == "false" || value == "0") return false;
+    throw std::invalid_argument("Invalid boolean for '" + name + "'.");
+}
+
+// Ganzzahl-Parameter mit Default, ungültige Werte -> std::invalid_argument
+long long parse_int_param(const crow::request& req, const std::string& name, long long default_value) {
+    std::string value = get_query_param(req, name);
+    if (value.empty()) return default_value;
+    std::size_t consumed = 0;
+    long long parsed = 0;
+    try {
+        parsed = std::stoll(value, &consumed);
+    } catch (const std::exception&) {
+        consumed = 0;
+    }
+    if (consumed != value.size()) {
+        throw std::invalid_argument("Invalid number for '" + name + "'.");
+    }
+    return parsed;
+}
+
+// Komma-getrennte Liste ("a,b,c"), zusätzlich wiederholte Parameter (name=a&name=b)
+std::vector<std::string> parse_list_param(const crow::request& req, const std::string& name) {
+    std::vector<std::string> items;
+    std::vector<char*> values = req.url_params.get_list(name, false);
+    if (values.empty()) {
+        if (const char* single = req.url_params.get(name)) values.push_back(const_cast<char*>(single));
+    }
+    for (const char* raw : values) {
+        std::stringstream stream(raw);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) items.push_back(item);
+        }
+    }
+    return items;
+}
+// Challenge Rating als Zahl ("2", "0.5" oder "1/4"), fehlender Parameter -> std::nullopt
+std::optional<double> parse_cr_param(const crow::request& req, const std::string& name) {
+    const std::string value = get_query_param(req, name);
+    if (value.empty()) return std::nullopt;
+    try {
+        std::size_t consumed = 0;
+        const std::size_t slash = value.find('/');
+        if (slash == std::string::npos) {
+            const double parsed = std::stod(value, &consumed);
+            if (consumed == value.size()) return parsed;
+        } else {
+            const double numerator = std::stod(value.substr(0, slash), &consumed);
+            std::size_t denominator_consumed = 0;
+            const double denominator = std::stod(value.substr(slash + 1), &denominator_consumed);
+            if (consumed == slash && denominator_consumed == value.size() - slash - 1 && denominator != 0) return numerator / denominator;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Invalid challenge rating for '" + name + "'.");
+}
+// Liste ganzer Zahlen: name=12,15 oder name_min/name_max als Bereich (max. 41 Werte)
+std::vector<int> parse_int_range_param(const crow::request& req, const std::string& name, int default_min, int default_max) {
+    std::vector<int> values;
+    for (const std::string& item : parse_list_param(req, name)) {
+        try {
+            std::size_t consumed = 0;
+            values.push_back(std::stoi(item, &consumed));
+            if (consumed != item.size()) throw std::invalid_argument(item);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Invalid number in '" + name + "'.");
+        }
+    }
+    if (values.empty()) {
+        const long long low = parse_int_param(req, name + "_min", default_min);
+        const long long high = parse_int_param(req, name + "_max", default_max);
+        if (low > high || high - low > 40) {
+            throw std::invalid_argument("Invalid range for '" + name + "' (max 41 values).");
+        }
+        for (long long value = low; value <= high; ++value) values.push_back(static_cast<int>(value));
+    }
+    if (values.size() > 41) {
+        throw std::invalid_argument("Too many values for '" + name + "' (max 41).");
+    }
+    return values;
+}
+// Seitenweise Abfrage (?limit=50&cursor=...&sort=cr&order=desc&fields=name,cr), nullopt wenn keiner der
+// Parameter gesetzt ist (dann bleibt die bisherige Antwort als vollständiges Array)
+std::optional<PageQuery> parse_page_query(const crow::request& req) {
+    static const std::vector<std::string> page_params = {"limit", "cursor", "sort", "order", "fields"};
+    if (std::none_of(page_params.begin(), page_params.end(), [&](const std::string& name) { return req.url_params.get(name) != nullptr; })) {
+        return std::nullopt;
+    }
+    PageQuery query;
+    if (!get_query_param(req, "sort").empty()) query.sort = get_query_param(req, "sort");
+    const std::string order = get_query_param(req, "order");
+    if (!order.empty() && order != "asc" && order != "desc") {
+        throw std::invalid_argument("Invalid order (asc, desc).");
+    }
+    query.descending = order == "desc";
+    query.fields = parse_list_param(req, "fields");
+    const long long limit = parse_int_param(req, "limit", static_cast<long long>(query.limit));
+    if (limit < 1 || limit > static_cast<long long>(ListingIndex::max_limit)) {
+        throw std::invalid_argument("limit must be between 1 and " + std::to_string(ListingIndex::max_limit) + ".");
+    }
+    query.limit = static_cast<std::size_t>(limit);
+    query.cursor = get_query_param(req, "cursor");
+    return query;
+}
+
+// Seite aus einem Listen-Index als Antwort (400 bei ungültigem sort/cursor)
+crow::response page_response(const ListingIndex& index, const PageQuery& query, const std::string& collection) {
+    try {
+        crow::response res(index.page(query, collection));
+        res.set_header("Content-Type", "application/json");
+        return res;
+    } catch (const std::invalid_argument& e) {
+        return crow::response(400, json{{"error", e.what()}}.dump());
+    }
+}
 
-int main() {
-    crow::App<CorsMiddleware> app;
-    // Globale Konstanten und Caches sind bereits deklariert
+// Listen-Index für eine gefilterte Manifest-Liste (nur für ?prefix= zusammen mit Seitenparametern)
+ListingIndex manifest_entries_listing(const std::vector<ManifestEntry>& entries) {
+    std::vector<json> rows;
+    rows.reserve(entries.size());
+    for (const ManifestEntry& entry : entries) {
+        rows.push_back({{"id", entry.id}, {"name", entry.name}});
+    }
+    return ListingIndex(std::move(rows), {"name", "id"});
+}
+// --- Ende Hilfsfunktionen für Query-Parameter ---
+
+
+// --- Start und Routen ---
+
+std::thread warmup_thread;
+
+void start_services() {
+    // PUT/DELETE und der Watcher melden Änderungen über den Katalog
+    monster_catalog.set_change_listener([](const std::string& id) { statblock_cache.invalidate(id); });
 
     load_users();
 
+    // Nach einem Absturz noch nicht übertragene Änderungen einspielen, bevor Katalog und Snapshot laden
+    try {
+        write_journal.recover();
+    } catch (const std::exception& e) {
+        log_error("Journal nicht verfügbar, schreibe direkt", {{"error", e.what()}});
+        write_journal.set_enabled(false);
+    }
+
+    // Catalog-Pack mappen (nach dem Journal, dessen Änderungen machen betroffene Datensätze veraltet)
+    if (!catalog_pack_file.empty() && std::filesystem::exists(catalog_pack_file)) {
+        try {
+            catalog_pack = CatalogPack::open(catalog_pack_file);
+            data_snapshot.set_pack(catalog_pack);
+            monster_catalog.set_pack(catalog_pack);
+            log_info("Catalog-Pack gemappt", {{"path", catalog_pack_file}, {"records", catalog_pack->size()}, {"kb", catalog_pack->mapped_bytes() / 1024}});
+        } catch (const std::exception& e) {
+            log_warn("Catalog-Pack nicht benutzbar, lade JSON-Dateien", {{"path", catalog_pack_file}, {"error", e.what()}});
+        }
+    }
+
+    // --- Warm-Start: Referenzdaten und Monster-Katalog parallel im Hintergrund vorladen ---
+    // Bis der Snapshot fertig ist, lesen die Routen wie bisher direkt von der Platte.
+    data_snapshot.set_pending_check(journal_pending);
+    encounter_manifest.set_pending_check(journal_pending);
+    data_snapshot.add_warmup_step("monsters", []() {
+        monster_catalog.ensure_built();
+        monster_catalog.start_watcher();
+        return monster_catalog.size();
+    });
+    warmup_thread = std::thread([]() { data_snapshot.warm_up(); });
+    data_snapshot.start_revalidation();
+}
+
+void stop_services() {
+    if (warmup_thread.joinable()) warmup_thread.join();
+    data_snapshot.stop_revalidation();
+    write_journal.stop();
+    monster_catalog.stop_watcher();
+}
+
+const std::vector<std::string>& route_patterns() {
+    // Bei neuen CROW_ROUTEs hier ergänzen, sonst zählen sie in /api/metrics unter "other"
+    static const std::vector<std::string> patterns = {
+        "/api/login", "/api/users/list", "/api/status", "/api/metrics", "/api/roll",
+        "/api/encounters", "/api/encounters/evaluate", "/api/encounters/<string>", "/api/encounters/<string>/simulate",
+        "/api/monsters/summary", "/api/monsters/query", "/api/monsters/batch", "/api/monsters/dpr", "/api/monsters/<string>", "/api/monsters/<string>/dpr",
+        "/api/spells", "/api/dnddata/<string>", "/api/templates/<string>", "/api/templates/<string>/<string>"};
+    return patterns;
+}
+
+void register_routes(DnDServer& app, bool block_until_warm) {
+    for (const std::string& pattern : route_patterns()) {
+        metrics().add_route(pattern);
+    }
+
     // --- NEUE Route: POST /api/login ---
     CROW_ROUTE(app, "/api/login").methods("POST"_method)
     ([&](const crow::request& req) {
@@ -355,14 +815,14 @@ int main() {
                 response_data["username"] = username;
                 response_data["role"] = user_data.value("role", "Player"); // Default "Player", falls Rolle fehlt
                 // Hier könnte man einen Session Token/JWT generieren und zurückgeben
-                std::cout << "Login erfolgreich für Benutzer: " << username << " mit Rolle: " << response_data["role"] << std::endl;
+                log_info("Login erfolgreich", {{"user", username}, {"role", response_data["role"].dump()}});
                 return crow::response(200, response_data.dump());
             }
             // === ENDE UNSICHERER VERGLEICH ===
         }
 
         // Benutzer nicht gefunden oder Passwort falsch
-        std::cerr << "Login fehlgeschlagen für Benutzer: " << username << std::endl;
+        log_warn("Login fehlgeschlagen", {{"user", username}});
         return crow::response(401, "{\"error\": \"Invalid username or password.\"}"); // 401 Unauthorized
     });
 
@@ -395,47 +855,245 @@ int main() {
     });
 
     // --- GET /api/status ---
-    CROW_ROUTE(app, "/api/status")([]() {
+    CROW_ROUTE(app, "/api/status")([block_until_warm]() {
         json response;
-        response["status"] = "OK";
-        response["message"] = "DnD Backend ist bereit!";
-        crow::response res(response.dump());
+        bool warm = data_snapshot.is_warm();
+        int status_code = 200;
+        if (block_until_warm && !warm) {
+            response["status"] = "Loading";
+            response["message"] = "Daten werden vorgeladen...";
+            status_code = 503; // Service Unavailable, bis der Snapshot warm ist
+        } else {
+            response["status"] = "OK";
+            response["message"] = "DnD Backend ist bereit!";
+        }
+        response["warm"] = warm;
+        json warmup = json::array();
+        for (const WarmupStats& stats : data_snapshot.warmup_stats()) {
+            warmup.push_back({{"category", stats.category}, {"files", stats.files}, {"fromPack", stats.from_pack}, {"bytes", stats.bytes},
+                              {"errors", stats.errors}, {"ms", stats.milliseconds}});
+        }
+        response["warmup"] = warmup;
+        const WriteJournal::Stats journal = write_journal.stats();
+        response["journal"] = {{"enabled", write_journal.enabled()}, {"commits", journal.commits}, {"syncs", journal.syncs},
+                               {"bytes", journal.bytes}, {"patches", journal.patches}, {"applied", journal.applied}, {"superseded", journal.superseded},
+                               {"pending", journal.pending}, {"checkpoints", journal.checkpoints}, {"apply_errors", journal.apply_errors},
+                               {"retrying", journal.retrying}};
+        if (catalog_pack) {
+            const CatalogPack::Stats pack = catalog_pack->stats();
+            response["pack"] = {{"file", catalog_pack->file().string()}, {"records", catalog_pack->size()}, {"monsters", catalog_pack->monster_count()},
+                                {"bytes", catalog_pack->mapped_bytes()}, {"created", catalog_pack->created_unix()},
+                                {"hits", pack.hits}, {"stale", pack.stale}, {"missing", pack.missing}};
+        } else {
+            response["pack"] = nullptr;
+        }
+        crow::response res(status_code, response.dump());
         res.set_header("Content-Type", "application/json");
         return res;
      });
 
+    // --- GET /api/metrics (Prometheus-Textformat) ---
+    CROW_ROUTE(app, "/api/metrics")([&]() {
+        crow::response res(metrics().render_prometheus());
+        res.set_header("Content-Type", "text/plain; version=0.0.4");
+        return res;
+    });
+
     // --- GET /api/encounters ---
-    CROW_ROUTE(app, "/api/encounters")([&]() {
-        json encounter_list = json::array();
+    // Aus dem Manifest (kein Parsen pro Anfrage); ?prefix=gob listet nur Encounter, deren Name so beginnt.
+    // Mit limit/cursor/sort=name|id/order/fields seitenweise: {"total", "encounters", "nextCursor"}
+    CROW_ROUTE(app, "/api/encounters")([&](const crow::request& req) {
         try {
-            for (const auto& entry : std::filesystem::directory_iterator(encounters_base_dir)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".json") {
-                    std::ifstream file(entry.path());
-                    if (file.is_open()) {
-                        try {
-                            json data;
-                            file >> data;
-                            if (data.contains("id") && data.contains("name")) {
-                                encounter_list.push_back({{"id", data["id"]}, {"name", data["name"]}});
-                            }
-                        } catch (const std::exception& e) {
-                             std::cerr << "Fehler beim Verarbeiten von " << entry.path() << ": " << e.what() << std::endl;
-                        }
-                    }
-                }
+            const std::string name_prefix = get_query_param(req, "prefix");
+            if (std::optional<PageQuery> page = parse_page_query(req)) {
+                return name_prefix.empty() ? page_response(*encounter_manifest.listing_index(), *page, "encounters")
+                                           : page_response(manifest_entries_listing(encounter_manifest.list(name_prefix)), *page, "encounters");
+            }
+            if (name_prefix.empty()) {
+                return send_cached_response(req, *encounter_manifest.listing());
             }
+            json encounter_list = json::array();
+            for (const ManifestEntry& entry : encounter_manifest.list(name_prefix)) {
+                encounter_list.push_back({{"id", entry.id}, {"name", entry.name}});
+            }
+            crow::response res(encounter_list.dump());
+            res.set_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::invalid_argument& e) {
+            return crow::response(400, json{{"error", e.what()}}.dump());
         } catch (const std::exception& e) {
-            std::cerr << "Fehler beim Auflisten von Encountern in " << encounters_base_dir << ": " << e.what() << std::endl;
+            log_error("Fehler beim Auflisten von Encountern", {{"path", encounters_base_dir}, {"error", e.what()}});
             return crow::response(500, "{\"error\": \"Serverfehler beim Auflisten der Encounter.\"}");
         }
-        crow::response res(encounter_list.dump());
+    });
+
+    // --- POST /api/encounters/evaluate ---
+    // Body: einzelner Encounter, Array von Encountern oder {"rules": "2014"|"2024", "encounters": [...]}
+    CROW_ROUTE(app, "/api/encounters/evaluate").methods("POST"_method)
+    ([&](const crow::request& req) {
+        json request_body;
+        try {
+            request_body = json::parse(req.body);
+        } catch (const json::parse_error& e) {
+            return crow::response(400, "{\"error\": \"Invalid JSON body.\"}");
+        }
+
+        std::shared_ptr<const DifficultyEngine> engine;
+        try {
+            engine = get_difficulty_engine();
+        } catch (const std::exception& e) {
+            log_error("Fehler beim Laden der CR-Daten für die Schwierigkeitsberechnung", {{"error", e.what()}});
+            return crow::response(500, "{\"error\": \"Could not load CR data.\"}");
+        }
+
+        DifficultyRules default_rules = DifficultyRules::Dmg2014;
+        try {
+            if (request_body.is_object() && request_body.contains("rules") && request_body["rules"].is_string()) {
+                default_rules = parse_difficulty_rules(request_body["rules"].get<std::string>());
+            }
+        } catch (const std::invalid_argument& e) {
+            return crow::response(400, "{\"error\": \"" + std::string(e.what()) + "\"}");
+        }
+
+        const json* batch = nullptr;
+        if (request_body.is_array()) {
+            batch = &request_body;
+        } else if (request_body.is_object() && request_body.contains("encounters") && request_body["encounters"].is_array()) {
+            batch = &request_body["encounters"];
+        }
+
+        if (!batch) {
+            // Einzelner Encounter
+            try {
+                crow::response res(engine->evaluate_json(request_body, default_rules).dump());
+                res.set_header("Content-Type", "application/json");
+                return res;
+            } catch (const std::exception& e) {
+                return crow::response(400, "{\"error\": \"" + std::string(e.what()) + "\"}");
+            }
+        }
+
+        // Batch: jede Variante einzeln bewerten, Fehler pro Eintrag statt für die ganze Anfrage
+        std::vector<json> results(batch->size());
+        parallel_for(batch->size(), [&](std::size_t i) {
+            try {
+                results[i] = engine->evaluate_json((*batch)[i], default_rules);
+            } catch (const std::exception& e) {
+                results[i] = {{"error", e.what()}};
+            }
+        }, 256);
+
+        json response_data;
+        response_data["results"] = std::move(results);
+        crow::response res(response_data.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // --- POST /api/encounters/{id}/simulate ---
+    // Monte-Carlo-Simulation: Party gegen die Monster des Encounters.
+    // Body (optional): {"trials": 10000, "seed": 0, "maxRounds": 20, "party": {...}}
+    CROW_ROUTE(app, "/api/encounters/<string>/simulate").methods("POST"_method)
+    ([&](const crow::request& req, const std::string& encounter_id) {
+        json options_data = json::object();
+        if (!req.body.empty()) {
+            try {
+                options_data = json::parse(req.body);
+            } catch (const json::parse_error& e) {
+                return crow::response(400, "{\"error\": \"Invalid JSON body.\"}");
+            }
+            if (!options_data.is_object()) {
+                return crow::response(400, "{\"error\": \"Body must be an object.\"}");
+            }
+        }
+
+        SimulationOptions options;
+        try {
+            const long long trials = options_data.value("trials", 10000LL);
+            const int max_rounds = options_data.value("maxRounds", 20);
+            if (trials < 1 || trials > 200000) {
+                return crow::response(400, "{\"error\": \"trials must be between 1 and 200000.\"}");
+            }
+            if (max_rounds < 1 || max_rounds > 100) {
+                return crow::response(400, "{\"error\": \"maxRounds must be between 1 and 100.\"}");
+            }
+            options.trials = static_cast<std::size_t>(trials);
+            options.max_rounds = max_rounds;
+            options.seed = options_data.value("seed", 0ULL);
+        } catch (const json::type_error& e) {
+            return crow::response(400, "{\"error\": \"Invalid simulation options.\"}");
+        }
+
+        json encounter_data;
+        try {
+            std::filesystem::path encounter_file_path = std::filesystem::absolute(std::filesystem::path(encounters_base_dir) / (encounter_id + ".json")).lexically_normal();
+            if (!std::filesystem::exists(encounter_file_path) || !std::filesystem::is_regular_file(encounter_file_path)) {
+                return crow::response(404, "{\"error\": \"Encounter nicht gefunden.\"}");
+            }
+            std::ifstream file(encounter_file_path);
+            if (!file.is_open()) {
+                return crow::response(500, "{\"error\": \"Encounter-Datei konnte nicht geöffnet werden.\"}");
+            }
+            file >> encounter_data;
+        } catch (const std::exception& e) {
+            log_error("Fehler beim Laden des Encounters für die Simulation", {{"id", encounter_id}, {"error", e.what()}});
+            return crow::response(500, "{\"error\": \"Fehler beim Lesen der Encounter-Daten.\"}");
+        }
+
+        // Party aus dem Body, sonst die des Encounters
+        std::vector<SimCombatant> combatants;
+        try {
+            combatants = party_from_json(options_data.contains("party") ? options_data["party"] : encounter_data.value("party", json::object()));
+        } catch (const json::type_error& e) {
+            return crow::response(400, "{\"error\": \"Invalid party.\"}");
+        }
+        if (combatants.size() > max_party_size) {
+            return crow::response(400, "{\"error\": \"Party too large (max " + std::to_string(max_party_size) + " members).\"}");
+        }
+
+        // Monster: Statblock wenn vorhanden, sonst Schätzung aus dem Encounter-Eintrag
+        json monster_sources = json::array();
+        for (const auto& entry : encounter_data.value("monsters", json::array())) {
+            if (!entry.is_object()) continue;
+            const int count = std::clamp(entry.value("count", 1), 0, 100);
+            const std::string monster_id = entry.value("monsterId", "");
+            std::optional<StatblockCache::Entry> cached = monster_id.empty() ? std::nullopt : get_monster_statblock(monster_id, true);
+            json statblock = cached ? *cached->document : json(nullptr);
+            SimCombatant monster;
+            try {
+                monster = statblock.is_object() ? combatant_from_statblock(statblock) : combatant_from_encounter_entry(entry);
+            } catch (const json::exception& e) {
+                log_warn("Statblock für die Simulation unbrauchbar", {{"id", monster_id}, {"error", e.what()}});
+                statblock = nullptr;
+                monster = combatant_from_encounter_entry(entry);
+            }
+            monster_sources.push_back({{"monsterId", monster_id}, {"count", count}, {"source", statblock.is_object() ? "statblock" : "estimated"}});
+            for (int i = 0; i < count; ++i) {
+                combatants.push_back(monster);
+            }
+        }
+
+        json response_data = simulate_combat(combatants, options).to_json();
+        response_data["id"] = encounter_id;
+        response_data["seed"] = options.seed;
+        response_data["monsters"] = std::move(monster_sources);
+        crow::response res(response_data.dump());
         res.set_header("Content-Type", "application/json");
         return res;
     });
 
     // --- GET /api/encounters/{id} ---
+    // ?hydrate=true hängt die vollständigen Statblöcke aller monsterIds an ("statblocks": {id: {...}},
+    // "missingStatblocks": [...]), damit der Combat Tracker nicht jedes Monster einzeln abfragen muss
      CROW_ROUTE(app, "/api/encounters/<string>")
-        ([&](const crow::request& /*req*/, const std::string& encounter_id) {
+        ([&](const crow::request& req, const std::string& encounter_id) {
+        bool hydrate = false;
+        try {
+            hydrate = parse_bool_param(req, "hydrate").value_or(false);
+        } catch (const std::invalid_argument& e) {
+            return crow::response(400, "{\"error\": \"" + std::string(e.what()) + "\"}");
+        }
+
         std::filesystem::path encounter_file_path;
         try {
             encounter_file_path = std::filesystem::path(encounters_base_dir) / (encounter_id + ".json");
@@ -450,85 +1108,244 @@ int main() {
                  return crow::response(500, "{\"error\": \"Encounter-Datei konnte nicht geöffnet werden.\"}");
             }
 
+            metrics().record_file_read(encounter_file_path);
             json encounter_data;
-            file >> encounter_data;
+            {
+                auto timer = metrics().time_json_parse();
+                file >> encounter_data;
+            }
 
-            crow::response res(encounter_data.dump());
+            std::string body;
+            {
+                auto timer = metrics().time_json_dump();
+                body = encounter_data.dump();
+            }
+            if (hydrate && encounter_data.is_object()) {
+                std::vector<std::string> monster_ids;
+                for (const auto& entry : encounter_data.value("monsters", json::array())) {
+                    if (entry.is_object() && entry.contains("monsterId") && entry["monsterId"].is_string()) {
+                        monster_ids.push_back(entry["monsterId"].get<std::string>());
+                    }
+                }
+                const StatblockBatch batch = load_monster_statblocks(monster_ids);
+                // Schließende Klammer des Encounters durch die zusätzlichen Felder ersetzen
+                body.pop_back();
+                if (!encounter_data.empty()) body += ',';
+                body += "\"statblocks\":";
+                append_statblock_map(batch, body);
+                body += ",\"missingStatblocks\":" + missing_statblock_ids(batch).dump() + "}";
+            }
+
+            crow::response res(std::move(body));
             res.set_header("Content-Type", "application/json");
             return res;
 
         } catch (const json::parse_error& e) {
-            std::cerr << "Fehler beim Parsen der Encounter-Datei " << encounter_file_path << ": " << e.what() << std::endl;
+            log_error("Fehler beim Parsen der Encounter-Datei", {{"path", encounter_file_path.string()}, {"error", e.what()}});
             return crow::response(500, "{\"error\": \"Fehler beim Lesen der Encounter-Daten.\"}");
         } catch (const std::exception& e) {
-            std::cerr << "Allgemeiner Fehler beim Holen des Encounters " << encounter_id << ": " << e.what() << std::endl;
+            log_error("Allgemeiner Fehler beim Holen des Encounters", {{"id", encounter_id}, {"error", e.what()}});
             return crow::response(500, "{\"error\": \"Interner Serverfehler.\"}");
         }
     });
 
      // --- GET /api/monsters/summary ---
-     CROW_ROUTE(app, "/api/monsters/summary")([&]() {
-        json monster_summary_list = json::array();
+     // ?limit/cursor/sort=name|cr|type|id/order/fields liefern {"total", "monsters", "nextCursor"} seitenweise
+     CROW_ROUTE(app, "/api/monsters/summary")([&](const crow::request& req) {
+        std::optional<PageQuery> page;
         try {
-             for (const auto& entry : std::filesystem::recursive_directory_iterator(monsters_base_dir)) {
-                 if (entry.is_regular_file() && entry.path().extension() == ".json") {
-                     std::ifstream file(entry.path());
-                     if (file.is_open()) {
-                         try {
-                             json data;
-                             file >> data;
-                             json summary_item;
-                             summary_item["id"] = entry.path().stem().string();
-                             summary_item["name"] = data.value("basics", json::object()).value("name", "Unknown");
-                             summary_item["cr"] = data.value("basics", json::object()).value("CR", 0.0);
-                             summary_item["size"] = data.value("basics", json::object()).value("size", "Medium");
-                             summary_item["type"] = data.value("basics", json::object()).value("type", "unknown");
-                             summary_item["complete"] = data.value("complete", false);
-                             monster_summary_list.push_back(summary_item);
-                         } catch (const std::exception& e) {
-                             std::cerr << "Fehler beim Verarbeiten der Monster-Datei " << entry.path() << ": " << e.what() << std::endl;
-                         }
-                     }
-                 }
-             }
-        } catch (const std::exception& e) {
-            std::cerr << "Fehler beim Auflisten der Monster in " << monsters_base_dir << ": " << e.what() << std::endl;
-            return crow::response(500, "{\"error\": \"Serverfehler beim Auflisten der Monster.\"}");
+            page = parse_page_query(req);
+        } catch (const std::invalid_argument& e) {
+            return crow::response(400, json{{"error", e.what()}}.dump());
+        }
+        if (page) {
+            return page_response(*monster_catalog.listing_index(), *page, "monsters");
+        }
+
+        // Wird aus dem Monster-Katalog im Speicher bedient (kein Dateizugriff)
+        std::shared_ptr<const std::string> summary_body = monster_catalog.summary_body();
+        crow::response res(*summary_body);
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+
+    // --- GET /api/monsters/query ---
+    // Facettensuche über den Bitmap-Index: ?cr_min=1/2&cr_max=5&size=Large,Huge&type=dragon&resist=fire&movement=flying
+    // size/type/alignment: einer der Werte; movement/language/resist/immune/vulnerable/condition_immune: alle Werte
+    CROW_ROUTE(app, "/api/monsters/query")([&](const crow::request& req) {
+        MonsterQuery query;
+        try {
+            query.cr_min = parse_cr_param(req, "cr_min");
+            query.cr_max = parse_cr_param(req, "cr_max");
+            query.sizes = parse_list_param(req, "size");
+            query.types = parse_list_param(req, "type");
+            query.alignments = parse_list_param(req, "alignment");
+            query.movement = parse_list_param(req, "movement");
+            query.languages = parse_list_param(req, "language");
+            query.resistances = parse_list_param(req, "resist");
+            query.immunities = parse_list_param(req, "immune");
+            query.vulnerabilities = parse_list_param(req, "vulnerable");
+            query.condition_immunities = parse_list_param(req, "condition_immune");
+            const long long offset = parse_int_param(req, "offset", 0);
+            const long long limit = parse_int_param(req, "limit", static_cast<long long>(query.limit));
+            if (offset < 0) throw std::invalid_argument("offset must not be negative.");
+            if (limit < 1 || limit > static_cast<long long>(ListingIndex::max_limit)) {
+                throw std::invalid_argument("limit must be between 1 and " + std::to_string(ListingIndex::max_limit) + ".");
+            }
+            query.offset = static_cast<std::size_t>(offset);
+            query.limit = static_cast<std::size_t>(limit);
+
+            std::shared_ptr<const MonsterQueryIndex> index = get_monster_query_index();
+            crow::response res(index->render(index->run(query), query));
+            res.set_header("Content-Type", "application/json");
+            return res;
+        } catch (const std::invalid_argument& e) {
+            return crow::response(400, json{{"error", e.what()}}.dump());
         }
-        crow::response res(monster_summary_list.dump());
+    });
+
+    // --- GET /api/monsters/dpr ---
+    // Katalogweite Tabelle: erwarteter Schaden pro Runde je Monster und AC (?ac=12,15 oder ac_min/ac_max, save=3)
+    CROW_ROUTE(app, "/api/monsters/dpr")([&](const crow::request& req) {
+        std::vector<int> armor_classes;
+        int save_bonus = 0;
+        try {
+            armor_classes = parse_int_range_param(req, "ac", 10, 20);
+            save_bonus = static_cast<int>(parse_int_param(req, "save", 3));
+        } catch (const std::invalid_argument& e) {
+            return crow::response(400, "{\"error\": \"" + std::string(e.what()) + "\"}");
+        }
+
+        monster_catalog.ensure_built();
+        const std::vector<MonsterSummary> monsters = monster_catalog.entries();
+        std::vector<json> rows(monsters.size());
+        parallel_for(monsters.size(), [&](std::size_t i) {
+            const MonsterSummary& summary = monsters[i];
+            json row = {{"id", summary.id}, {"name", summary.name}, {"cr", summary.cr}};
+            try {
+                json statblock;
+                std::string pending_content;
+                if (write_journal.pending(summary.path, &pending_content) == WriteJournal::PendingState::written) {
+                    statblock = json::parse(pending_content);
+                } else if (std::optional<std::string_view> body = packed_body(summary.path)) {
+                    statblock = json::parse(*body);
+                } else {
+                    std::ifstream file(summary.path);
+                    file >> statblock;
+                }
+                row["expected"] = monster_expected_dpr(statblock, armor_classes, save_bonus);
+            } catch (const std::exception& e) {
+                row["error"] = e.what();
+            }
+            rows[i] = std::move(row);
+        });
+
+        json response_data;
+        response_data["ac"] = armor_classes;
+        response_data["saveBonus"] = save_bonus;
+        response_data["monsters"] = std::move(rows);
+        crow::response res(response_data.dump());
         res.set_header("Content-Type", "application/json");
         return res;
     });
 
     // --- GET /api/spells ---
-    CROW_ROUTE(app, "/api/spells")([&]() {
+    CROW_ROUTE(app, "/api/spells")([&](const crow::request& req) {
          const std::string spells_file_path_str = "../data/spells/spells.json";
         std::filesystem::path spells_file_path;
 
+        // --- Gefilterte Anfrage (z.B. ?class=Wizard&level_max=3&damage=true&fields=name,level) ---
+        static const std::vector<std::string> spell_query_params = {"class", "level", "level_min", "level_max", "damage", "multitarget",
+                                                                    "srd", "custom", "sort", "order", "fields", "offset", "limit"};
+        bool is_query = std::any_of(spell_query_params.begin(), spell_query_params.end(),
+                                    [&](const std::string& name) { return req.url_params.get(name) != nullptr; });
+        if (is_query) {
+            SpellQuery query;
+            try {
+                query.classes = parse_list_param(req, "class");
+                if (req.url_params.get("level")) {
+                    query.level_min = query.level_max = static_cast<int>(parse_int_param(req, "level", 0));
+                }
+                query.level_min = static_cast<int>(parse_int_param(req, "level_min", query.level_min));
+                query.level_max = static_cast<int>(parse_int_param(req, "level_max", query.level_max));
+                query.has_damage = parse_bool_param(req, "damage");
+                query.multitarget = parse_bool_param(req, "multitarget");
+                query.srd = parse_bool_param(req, "srd");
+                query.custom = parse_bool_param(req, "custom");
+                query.sort = get_query_param(req, "sort").empty() ? "name" : get_query_param(req, "sort");
+                const std::string order = get_query_param(req, "order");
+                if (!order.empty() && order != "asc" && order != "desc") {
+                    throw std::invalid_argument("Invalid order (asc, desc).");
+                }
+                query.descending = order == "desc";
+                query.fields = parse_list_param(req, "fields");
+                const long long offset = parse_int_param(req, "offset", 0);
+                if (offset < 0) throw std::invalid_argument("offset must not be negative.");
+                query.offset = static_cast<std::size_t>(offset);
+                if (req.url_params.get("limit")) {
+                    const long long limit = parse_int_param(req, "limit", 0);
+                    if (limit < 0) throw std::invalid_argument("limit must not be negative.");
+                    query.limit = static_cast<std::size_t>(limit);
+                }
+            } catch (const std::invalid_argument& e) {
+                return crow::response(400, "{\"error\": \"" + std::string(e.what()) + "\"}");
+            }
+            if (query.sort != "name" && query.sort != "level" && query.sort != "damage") {
+                return crow::response(400, "{\"error\": \"Invalid sort (name, level or damage).\"}");
+            }
+
+            std::shared_ptr<const SpellIndex> index;
+            if (std::shared_ptr<const SnapshotEntry> entry = data_snapshot.find("spells", "spells.json")) {
+                index = spell_index_cache.get(entry, entry->document());
+            } else {
+                // Vor dem Warm-Start: Index einmalig aus der Datei bauen
+                try {
+                    std::ifstream spells_file(std::filesystem::absolute(spells_file_path_str).lexically_normal());
+                    if (!spells_file.is_open()) {
+                        return crow::response(404, "{\"error\": \"Spell data file not found.\"}");
+                    }
+                    json spells_data;
+                    spells_file >> spells_data;
+                    index = std::make_shared<const SpellIndex>(spells_data);
+                } catch (const std::exception& e) {
+                    log_error("Fehler beim Laden der Spells-Datei für den Index", {{"error", e.what()}});
+                    return crow::response(500, "{\"error\": \"Internal server error loading spell data.\"}");
+                }
+            }
+
+            crow::response res(200, index->render(index->run(query), query));
+            res.set_header("Content-Type", "application/json");
+            return res;
+        }
+
+        if (std::shared_ptr<const SnapshotEntry> entry = data_snapshot.find("spells", "spells.json")) {
+            // Body, ETag und komprimierte Varianten werden nur einmal pro Snapshot-Eintrag erzeugt
+            std::shared_ptr<const CachedResponse> cached = spells_response_cache.get(entry, entry->body());
+            return send_cached_response(req, *cached);
+        }
+
         try {
             spells_file_path = std::filesystem::absolute(spells_file_path_str).lexically_normal();
 
             if (!std::filesystem::exists(spells_file_path) || !std::filesystem::is_regular_file(spells_file_path)) {
-                std::cerr << "Fehler: Spells-Datei nicht gefunden: " << spells_file_path << std::endl;
+                log_error("Spells-Datei nicht gefunden", {{"path", spells_file_path.string()}});
                 return crow::response(404, "{\"error\": \"Spell data file not found.\"}");
             }
 
             std::ifstream spells_file(spells_file_path);
             if (!spells_file.is_open()) {
-                    std::cerr << "Fehler: Spells-Datei konnte nicht geöffnet werden: " << spells_file_path << std::endl;
+                    log_error("Spells-Datei konnte nicht geöffnet werden", {{"path", spells_file_path.string()}});
                     return crow::response(500, "{\"error\": \"Could not open spell data file.\"}");
             }
 
             std::stringstream buffer;
             buffer << spells_file.rdbuf();
-            std::string spells_content = buffer.str();
 
-            crow::response res(200, spells_content);
-            res.set_header("Content-Type", "application/json");
-            return res;
+            // Vor dem Warm-Start: unkomprimiert, aber mit ETag, damit Clients revalidieren können
+            return send_cached_response(req, *make_cached_response(buffer.str(), "application/json", false));
 
         } catch (const std::exception& e) {
-            std::cerr << "Fehler beim Laden der Spells-Datei (" << spells_file_path << "): " << e.what() << std::endl;
+            log_error("Fehler beim Laden der Spells-Datei", {{"path", spells_file_path.string()}, {"error", e.what()}});
             return crow::response(500, "{\"error\": \"Internal server error loading spell data.\"}");
         }
     });
@@ -543,78 +1360,144 @@ int main() {
 
         const std::string filename = requested_filename;
 
-        // --- Cache Check ---
-        if (dndDataCache.count(filename)) {
-            crow::response res(dndDataCache[filename].dump());
+        if (std::shared_ptr<const SnapshotEntry> entry = data_snapshot.find("DnDData", filename)) {
+            crow::response res(std::string(entry->body()));
             res.set_header("Content-Type", "application/json");
-            res.add_header("X-Data-Source", "Cache");
+            res.add_header("X-Data-Source", "Snapshot");
             return res;
         }
 
-        // --- Check if loading ---
-        if (currently_loading_dnd_data.count(filename)) {
-             // Data is already being loaded, inform client (202 Accepted)
-             return crow::response(202, "{\"status\": \"Loading\", \"message\": \"Data is currently being loaded.\"}");
+        try {
+            // Dateien, die nicht im Snapshot sind (oder vor dem Warm-Start): Cache, parallele Erstzugriffe warten auf denselben Ladevorgang
+            DnDDataCache::Result cached = dndDataCache.get(filename);
+            crow::response res(*cached.body);
+            res.set_header("Content-Type", "application/json");
+            res.add_header("X-Data-Source", cached.from_cache ? "Cache" : "File");
+            return res;
+        } catch (const std::runtime_error& e) {
+            std::string error_msg = e.what();
+            if (error_msg.find("not found") != std::string::npos) {
+                return crow::response(404, "{\"error\": \"" + error_msg + "\"}");
+            }
+            return crow::response(500, "{\"error\": \"" + error_msg + "\"}");
+        } catch (const std::exception& e) {
+            log_error("Fehler beim Laden der DnDData-Datei", {{"file", filename}, {"error", e.what()}});
+            return crow::response(500, "{\"error\": \"Internal server error loading DnD data.\"}");
         }
+    });
 
-        // --- Start Loading ---
-        currently_loading_dnd_data.insert(filename); // Markiere als laufenden Ladevorgang
 
-        std::filesystem::path file_path;
+    // --- POST /api/roll ---
+    // Batch-Würfeln: {"seed": 42 (optional), "rolls": ["1d20+2", {"expr": "2d6+3", "times": 10, "crit": false}, ...]}
+    // expr darf auch eine Würfel-Form aus den Daten sein ({count, size, modifier}, {diceCount, diceValue}, HP, "(5-6)").
+    // Jeder Eintrag würfelt mit eigenem Philox-Strom (seed, index) -> gleiches Ergebnis bei gleichem Seed.
+    CROW_ROUTE(app, "/api/roll").methods("POST"_method)
+    ([&](const crow::request& req) {
+        json request_body;
         try {
-            file_path = std::filesystem::path(dnddata_base_dir) / filename;
-            file_path = std::filesystem::absolute(file_path).lexically_normal();
-
-            if (!std::filesystem::exists(file_path) || !std::filesystem::is_regular_file(file_path)) {
-                std::cerr << "Fehler: DnDData-Datei nicht gefunden: " << file_path << std::endl;
-                 currently_loading_dnd_data.erase(filename); // Entferne aus Ladeliste bei Fehler
-                return crow::response(404, "{\"error\": \"Requested DnD data file not found.\"}");
-            }
+            request_body = json::parse(req.body);
+        } catch (const json::parse_error& e) {
+            return crow::response(400, "{\"error\": \"Invalid JSON body.\"}");
+        }
+        const json* roll_list = request_body.is_array() ? &request_body : nullptr;
+        if (request_body.is_object() && request_body.contains("rolls") && request_body["rolls"].is_array()) {
+            roll_list = &request_body["rolls"];
+        }
+        if (!roll_list) {
+            return crow::response(400, "{\"error\": \"Body must contain a 'rolls' array.\"}");
+        }
+        if (roll_list->size() > 10000) {
+            return crow::response(400, "{\"error\": \"Too many rolls (max 10000 entries).\"}");
+        }
 
-            std::ifstream data_file(file_path);
-            if (!data_file.is_open()) {
-                 std::cerr << "Fehler: DnDData-Datei konnte nicht geöffnet werden: " << file_path << std::endl;
-                 currently_loading_dnd_data.erase(filename); // Entferne aus Ladeliste bei Fehler
-                 return crow::response(500, "{\"error\": \"Could not open DnD data file.\"}");
+        struct RollRequest {
+            std::shared_ptr<const DiceExpression> expr;
+            std::size_t times = 1;
+            bool crit = false;
+        };
+        std::vector<RollRequest> rolls(roll_list->size());
+        std::size_t total_dice = 0;
+        for (std::size_t i = 0; i < roll_list->size(); ++i) {
+            const json& entry = (*roll_list)[i];
+            const json& expr_data = entry.is_object() && entry.contains("expr") ? entry["expr"] : entry;
+            try {
+                rolls[i].expr = expr_data.is_string() ? compile_dice_cached(expr_data.get<std::string>())
+                                                      : std::make_shared<const DiceExpression>(compile_dice(expr_data));
+                if (entry.is_object()) {
+                    const long long times = entry.value("times", 1LL);
+                    if (times < 1 || times > 100000) throw std::invalid_argument("times must be between 1 and 100000.");
+                    rolls[i].times = static_cast<std::size_t>(times);
+                    rolls[i].crit = entry.value("crit", false);
+                }
+            } catch (const std::exception& e) {
+                return crow::response(400, json({{"error", e.what()}, {"index", i}}).dump());
             }
+            total_dice += std::max<std::size_t>(1, rolls[i].expr->dice_count() * (rolls[i].crit ? 2 : 1)) * rolls[i].times;
+        }
+        if (total_dice > 10000000) {
+            return crow::response(400, "{\"error\": \"Too many dice in one request (max 10000000).\"}");
+        }
 
-            json data_content;
-            data_file >> data_content; // Direkt als JSON parsen
-
-            // --- Zum Cache hinzufügen ---
-            dndDataCache[filename] = data_content;
-            currently_loading_dnd_data.erase(filename); // Entferne aus Ladeliste bei Erfolg
+        // Ein angegebener, aber ungültiger Seed ist ein Fehler (sonst bekäme der Aufrufer still einen zufälligen)
+        const bool has_seed = request_body.is_object() && request_body.contains("seed") && !request_body["seed"].is_null();
+        if (has_seed && !request_body["seed"].is_number_unsigned()) {
+            return crow::response(400, "{\"error\": \"seed must be a non-negative integer.\"}");
+        }
+        std::uint64_t seed;
+        if (has_seed) {
+            seed = request_body["seed"].get<std::uint64_t>();
+        } else {
+            std::random_device device;
+            seed = (static_cast<std::uint64_t>(device()) << 32) | device();
+        }
 
-            crow::response res(data_content.dump());
-            res.set_header("Content-Type", "application/json");
-            res.add_header("X-Data-Source", "File");
-            return res;
+        std::vector<json> results(rolls.size());
+        parallel_for(rolls.size(), [&](std::size_t i) {
+            const DiceExpression& expr = *rolls[i].expr;
+            std::vector<int> totals(rolls[i].times);
+            PhiloxStream rng(seed, i);
+            expr.roll_many(rng, totals.data(), totals.size(), rolls[i].crit);
 
-        } catch (const json::parse_error& e) {
-            std::cerr << "Fehler beim Parsen der DnDData-Datei " << file_path << ": " << e.what() << std::endl;
-            currently_loading_dnd_data.erase(filename); // Entferne aus Ladeliste bei Fehler
-            return crow::response(500, "{\"error\": \"Error reading DnD data content.\"}");
-        } catch (const std::exception& e) {
-            std::cerr << "Fehler beim Laden der DnDData-Datei " << filename << " (" << file_path << "): " << e.what() << std::endl;
-            currently_loading_dnd_data.erase(filename); // Entferne aus Ladeliste bei Fehler
-            return crow::response(500, "{\"error\": \"Internal server error loading DnD data.\"}");
-        }
+            json result = {{"expr", expr.to_string()}, {"min", expr.min()}, {"max", expr.max()}, {"mean", expr.mean()}};
+            if (expr.target > 0) {
+                result["successes"] = std::count_if(totals.begin(), totals.end(), [&](int total) { return total >= expr.target; });
+            }
+            result["totals"] = std::move(totals);
+            results[i] = std::move(result);
+        }, 64);
+
+        json response_data;
+        response_data["seed"] = seed;
+        response_data["results"] = std::move(results);
+        crow::response res(response_data.dump());
+        res.set_header("Content-Type", "application/json");
+        return res;
     });
 
-
     // --- Routen für ALLE Template-Typen (Trait, AttackRoll, SavingThrow, Other) ---
 
-    // GET /api/templates/{type} (Liste aller Templates eines Typs)
+    // GET /api/templates/{type} (Liste aller Templates eines Typs, ?prefix=... filtert nach Namensanfang,
+    // limit/cursor/sort=name|id/order/fields wie bei /api/encounters)
     CROW_ROUTE(app, "/api/templates/<string>").methods("GET"_method)
-        ([&](const std::string& type) {
+        ([&](const crow::request& req, const std::string& type) {
         if (!is_valid_template_type(type)) {
              return crow::response(400, "{\"error\": \"Invalid template type.\"}");
          }
         try {
-            json template_list = list_templates_by_type(type);
+            const std::string name_prefix = get_query_param(req, "prefix");
+            if (std::optional<PageQuery> page = parse_page_query(req)) {
+                return name_prefix.empty() ? page_response(*template_manifest(type)->listing_index(), *page, "templates")
+                                           : page_response(manifest_entries_listing(template_manifest(type)->list(name_prefix)), *page, "templates");
+            }
+            if (name_prefix.empty()) {
+                return send_cached_response(req, *template_manifest(type)->listing());
+            }
+            json template_list = list_templates_by_type(type, name_prefix);
             crow::response res(template_list.dump());
             res.set_header("Content-Type", "application/json");
             return res;
+        } catch (const std::invalid_argument& e) {
+            return crow::response(400, json{{"error", e.what()}}.dump());
         } catch (const std::exception& e) {
             return crow::response(500, "{\"error\": \"Serverfehler beim Auflisten der Templates: " + std::string(e.what()) + "\"}");
         }
@@ -630,6 +1513,7 @@ int main() {
              json template_data = get_template_by_type(type, template_id);
              crow::response res(template_data.dump());
              res.set_header("Content-Type", "application/json");
+             res.set_header("ETag", make_etag(res.body)); // Für If-Match bei PATCH
              return res;
         } catch (const std::runtime_error& e) {
             // Spezifischere Fehlerbehandlung basierend auf Meldung aus Helfer
@@ -682,6 +1566,7 @@ int main() {
              return crow::response(400, "{\"error\": \"Invalid template type.\"}");
          }
          try {
+             std::lock_guard write_lock(document_write_lock("template/" + type + "/" + template_id));
              delete_template_by_type(type, template_id);
              return crow::response(204); // No Content
 
@@ -698,68 +1583,85 @@ int main() {
          }
      });
 
+    // PATCH /api/templates/{type}/{templateId} (JSON Patch oder Merge Patch, If-Match wie bei Monstern; die ID bleibt)
+    CROW_ROUTE(app, "/api/templates/<string>/<string>").methods("PATCH"_method)
+        ([&](const crow::request& req, const std::string& type, const std::string& template_id) {
+        if (!is_valid_template_type(type)) {
+             return crow::response(400, "{\"error\": \"Invalid template type.\"}");
+         }
+        try {
+            const json patch = parse_patch(req.body, req.get_header_value("Content-Type"));
+            std::lock_guard write_lock(document_write_lock("template/" + type + "/" + template_id));
+            const json patched = patch_template_by_type(type, template_id, patch, req.get_header_value("If-Match"));
+            crow::response res(patched.dump());
+            res.set_header("Content-Type", "application/json");
+            res.set_header("ETag", make_etag(res.body));
+            return res;
+        } catch (const PatchError& e) {
+            return crow::response(e.status(), json{{"error", e.what()}}.dump());
+        } catch (const std::runtime_error& e) {
+            std::string error_msg = e.what();
+            if (error_msg.find("Template not found") != std::string::npos || error_msg.find("Invalid characters") != std::string::npos) {
+                 return crow::response(404, json{{"error", error_msg}}.dump());
+            }
+            return crow::response(500, json{{"error", error_msg}}.dump());
+        } catch (const std::exception& e) {
+            return crow::response(500, json{{"error", "Internal server error: " + std::string(e.what())}}.dump());
+        }
+    });
+
     // --- RESTLICHE MONSTER/ENCOUNTER Routen (können bleiben) ---
 
+    // PUT /api/monsters/{id} (Upsert des ganzen Statblocks; If-Match wie bei PATCH, Antwort mit ETag)
     CROW_ROUTE(app, "/api/monsters/<string>").methods("PUT"_method)
         ([&](const crow::request& req, const std::string& monster_id_from_url){
              json incoming_data;
             try { incoming_data = json::parse(req.body); } catch (...) { return crow::response(400, "{\"error\": \"Ungültiges JSON im Request Body.\"}"); }
 
-            if (!incoming_data.contains("basics") || !incoming_data["basics"].is_object()) { return crow::response(400, "{\"error\": \"Missing or invalid 'basics' object.\"}"); }
-            const json& basics_data = incoming_data["basics"];
-            if (!basics_data.contains("name") || !basics_data["name"].is_string() || basics_data["name"].get<std::string>().empty()) { return crow::response(400, "{\"error\": \"Missing or empty 'basics.name' field.\"}"); }
-            if (!basics_data.contains("CR") || !basics_data["CR"].is_number()) { return crow::response(400, "{\"error\": \"Missing or invalid 'basics.CR' field (must be a number).\"}"); }
+            if (std::optional<std::string> error = monster_validation_error(incoming_data)) { return crow::response(400, json{{"error", *error}}.dump()); }
 
             bool is_complete = incoming_data.value("complete", false);
-            std::string target_sub_dir = is_complete ? "completed" : "uncompleted";
-            std::string opposite_sub_dir = is_complete ? "uncompleted" : "completed";
-
-            std::filesystem::path target_dir_path = std::filesystem::path(monsters_base_dir) / target_sub_dir;
             std::filesystem::path target_file_path;
             std::filesystem::path old_file_path;
 
              try {
-                 std::filesystem::create_directories(target_dir_path);
-                 std::filesystem::create_directories(std::filesystem::path(monsters_base_dir) / opposite_sub_dir); // Stelle sicher, dass auch der andere Ordner existiert
-
-                 target_file_path = std::filesystem::absolute(target_dir_path / (monster_id_from_url + ".json")).lexically_normal();
-                 old_file_path = std::filesystem::absolute(std::filesystem::path(monsters_base_dir) / opposite_sub_dir / (monster_id_from_url + ".json")).lexically_normal();
-
+                 std::tie(target_file_path, old_file_path) = monster_file_paths(monster_id_from_url, is_complete);
              } catch (const std::exception& e) {
-                 std::cerr << "Fehler beim Erstellen/Normalisieren der Monster-Dateipfade für '" << monster_id_from_url << "': " << e.what() << std::endl;
+                 log_error("Fehler beim Erstellen/Normalisieren der Monster-Dateipfade", {{"id", monster_id_from_url}, {"error", e.what()}});
                  return crow::response(500, "{\"error\": \"Interner Fehler beim Erstellen des Dateipfads.\"}");
              }
 
-             bool file_existed_in_other_dir = std::filesystem::exists(old_file_path) && std::filesystem::is_regular_file(old_file_path);
-             bool file_existed_in_target_dir = std::filesystem::exists(target_file_path) && std::filesystem::is_regular_file(target_file_path);
+             std::lock_guard write_lock(document_write_lock("monster/" + monster_id_from_url));
+             const std::string& if_match = req.get_header_value("If-Match");
+             if (!if_match.empty()) {
+                 std::optional<StatblockCache::Entry> current = get_monster_statblock(monster_id_from_url, false);
+                 if (!current || !if_match_satisfied(if_match, make_etag(*current->body))) {
+                     return crow::response(412, "{\"error\": \"Monster was modified or deleted, reload and retry.\"}");
+                 }
+             }
+
+             const std::vector<std::filesystem::path> existing = monster_catalog.locate(monster_id_from_url);
+             bool file_existed_in_other_dir = std::find(existing.begin(), existing.end(), old_file_path) != existing.end();
+             bool file_existed_in_target_dir = std::find(existing.begin(), existing.end(), target_file_path) != existing.end();
              bool created_new = !file_existed_in_target_dir && !file_existed_in_other_dir; // Neu, wenn in keinem der beiden Ordner existierte
 
             try {
-                std::ofstream output_file(target_file_path);
-                if (!output_file.is_open()) {
-                     std::cerr << "Fehler: Zieldatei konnte nicht zum Schreiben geöffnet werden: " << target_file_path << std::endl;
-                     return crow::response(500, "{\"error\": \"Monster konnte nicht gespeichert werden (Dateizugriff).\"}");
+                // Neue Datei und Löschen der Datei im anderen Ordner als ein Journal-Eintrag (beides oder nichts)
+                std::vector<WriteJournal::Operation> operations = {{WriteJournal::Operation::Kind::write, target_file_path, incoming_data.dump(4)}};
+                if (file_existed_in_other_dir) {
+                    operations.push_back({WriteJournal::Operation::Kind::remove, old_file_path, ""});
                 }
-                output_file << incoming_data.dump(4);
-                output_file.close();
+                write_journal.commit(std::move(operations));
 
+                monster_catalog.upsert(monster_id_from_url, incoming_data, target_file_path);
                 if (file_existed_in_other_dir) {
-                    try {
-                         if(std::filesystem::remove(old_file_path)) {
-                              std::cout << "Alte Monsterdatei gelöscht: " << old_file_path << std::endl;
-                         } else {
-                              // Das ist eine Warnung, kein kritischer Fehler, da die neue Datei gespeichert wurde.
-                              std::cerr << "Warnung: Konnte alte Monsterdatei nicht löschen: " << old_file_path << std::endl;
-                         }
-                    } catch(const std::exception& e) {
-                         std::cerr << "Warnung: Fehler beim Löschen der alten Monsterdatei " << old_file_path << ": " << e.what() << std::endl;
-                    }
+                    monster_catalog.forget_file(old_file_path);
+                    log_info("Alte Monsterdatei gelöscht", {{"path", old_file_path.string()}});
                 }
-
-                std::cout << "Monster erfolgreich gespeichert/aktualisiert: " << target_file_path << std::endl;
+                log_info("Monster gespeichert/aktualisiert", {{"id", monster_id_from_url}, {"path", target_file_path.string()}});
 
             } catch (const std::exception& e) {
-                 std::cerr << "Fehler beim Schreiben der Monster-Datei " << target_file_path << ": " << e.what() << std::endl;
+                 log_error("Fehler beim Schreiben der Monster-Datei", {{"path", target_file_path.string()}, {"error", e.what()}});
                  return crow::response(500, "{\"error\": \"Interner Fehler beim Speichern des Monsters.\"}");
             }
 
@@ -767,20 +1669,170 @@ int main() {
 
             crow::response res(status_code, incoming_data.dump()); // Gib die gespeicherten Daten zurück
             res.set_header("Content-Type", "application/json");
+            res.set_header("ETag", make_etag(res.body)); // Derselbe Body, den GET danach aus dem Statblock-Cache liefert
             return res;
     });
 
 
+    // PATCH /api/monsters/{id}: JSON Patch (application/json-patch+json) oder Merge Patch (application/merge-patch+json)
+    // auf den aktuellen Statblock, siehe json_patch.h. Mit If-Match (ETag aus GET/PUT/PATCH) gibt es 412, wenn das Monster
+    // inzwischen geändert wurde. Ins Journal geht nur der Patch; verschiebt "complete" das Monster in den anderen Ordner,
+    // wird wie bei PUT die ganze Datei geschrieben.
+    CROW_ROUTE(app, "/api/monsters/<string>").methods("PATCH"_method)
+    ([&](const crow::request& req, const std::string& monster_id) {
+        json patch;
+        try {
+            patch = parse_patch(req.body, req.get_header_value("Content-Type"));
+        } catch (const PatchError& e) {
+            return crow::response(e.status(), json{{"error", e.what()}}.dump());
+        }
+
+        std::lock_guard write_lock(document_write_lock("monster/" + monster_id));
+        const std::vector<std::filesystem::path> existing = monster_catalog.locate(monster_id);
+        std::optional<StatblockCache::Entry> current = existing.empty() ? std::nullopt : get_monster_statblock(monster_id, false);
+        if (!current) {
+            return crow::response(404, "{\"error\": \"Monster not found or could not be loaded.\"}");
+        }
+        const std::string& if_match = req.get_header_value("If-Match");
+        if (!if_match.empty() && !if_match_satisfied(if_match, make_etag(*current->body))) {
+            crow::response res(412, "{\"error\": \"Monster was modified, reload and retry.\"}");
+            res.set_header("ETag", make_etag(*current->body));
+            return res;
+        }
+
+        json patched;
+        try {
+            // Aus dem Body statt aus dem Cache-Modell: der Patch muss auf genau dem gespeicherten Dokument aufsetzen
+            auto timer = metrics().time_json_parse();
+            patched = apply_patch(json::parse(*current->body), patch);
+        } catch (const PatchError& e) {
+            return crow::response(e.status(), json{{"error", e.what()}}.dump());
+        } catch (const json::parse_error& e) {
+            log_error("Gespeicherter Statblock nicht lesbar", {{"id", monster_id}, {"error", e.what()}});
+            return crow::response(500, "{\"error\": \"Stored monster is not valid JSON.\"}");
+        }
+        if (std::optional<std::string> error = monster_validation_error(patched)) {
+            return crow::response(422, json{{"error", *error}}.dump());
+        }
+
+        std::filesystem::path target_file_path;
+        try {
+            target_file_path = monster_file_paths(monster_id, patched.value("complete", false)).first;
+        } catch (const std::exception& e) {
+            log_error("Fehler beim Erstellen/Normalisieren der Monster-Dateipfade", {{"id", monster_id}, {"error", e.what()}});
+            return crow::response(500, "{\"error\": \"Interner Fehler beim Erstellen des Dateipfads.\"}");
+        }
+
+        std::vector<WriteJournal::Operation> operations;
+        if (existing.size() == 1 && existing.front() == target_file_path) {
+            operations.push_back({WriteJournal::Operation::Kind::patch, target_file_path, patched.dump(4), patch.dump()});
+        } else {
+            operations.push_back({WriteJournal::Operation::Kind::write, target_file_path, patched.dump(4)});
+            for (const std::filesystem::path& path : existing) {
+                if (path != target_file_path) operations.push_back({WriteJournal::Operation::Kind::remove, path, ""});
+            }
+        }
+        try {
+            write_journal.commit(operations);
+        } catch (const std::exception& e) {
+            log_error("Fehler beim Schreiben der Monster-Datei", {{"path", target_file_path.string()}, {"error", e.what()}});
+            return crow::response(500, "{\"error\": \"Interner Fehler beim Speichern des Monsters.\"}");
+        }
+
+        monster_catalog.upsert(monster_id, patched, target_file_path);
+        for (const WriteJournal::Operation& operation : operations) {
+            if (operation.kind == WriteJournal::Operation::Kind::remove) monster_catalog.forget_file(operation.path);
+        }
+        log_info("Monster gepatcht", {{"id", monster_id}, {"path", target_file_path.string()}, {"operations", patch.is_array() ? patch.size() : 1}});
+
+        // Neuer Stand gleich in den Statblock-Cache, das nächste GET trifft
+        const StatblockCache::Entry saved = statblock_cache.insert(monster_id, statblock_cache.generation(monster_id), std::move(patched));
+        crow::response res(200, *saved.body);
+        res.set_header("Content-Type", "application/json");
+        res.set_header("ETag", make_etag(*saved.body));
+        return res;
+    });
+
+
+    // --- POST /api/monsters/batch ---
+    // Body: {"ids": ["goblin", "orc", ...]} (oder direkt das Array), max. 500 IDs.
+    // Antwort: {"monsters": {id: statblock, ...}, "missing": [ids ohne Statblock]}
+    CROW_ROUTE(app, "/api/monsters/batch").methods("POST"_method)
+    ([&](const crow::request& req) {
+        json request_body;
+        try {
+            request_body = json::parse(req.body);
+        } catch (const json::parse_error& e) {
+            return crow::response(400, "{\"error\": \"Invalid JSON body.\"}");
+        }
+        const json* id_list = request_body.is_array() ? &request_body : nullptr;
+        if (!id_list && request_body.is_object() && request_body.contains("ids") && request_body["ids"].is_array()) {
+            id_list = &request_body["ids"];
+        }
+        if (!id_list) {
+            return crow::response(400, "{\"error\": \"Body must be an array of ids or {\\\"ids\\\": [...]}.\"}");
+        }
+        if (id_list->size() > 500) {
+            return crow::response(400, "{\"error\": \"At most 500 ids per request.\"}");
+        }
+
+        std::vector<std::string> monster_ids;
+        monster_ids.reserve(id_list->size());
+        for (const auto& id : *id_list) {
+            if (!id.is_string()) {
+                return crow::response(400, "{\"error\": \"ids must be strings.\"}");
+            }
+            monster_ids.push_back(id.get<std::string>());
+        }
+
+        const StatblockBatch batch = load_monster_statblocks(monster_ids);
+        std::string body = "{\"monsters\":";
+        append_statblock_map(batch, body);
+        body += ",\"missing\":" + missing_statblock_ids(batch).dump() + "}";
+        crow::response res(std::move(body));
+        res.set_header("Content-Type", "application/json");
+        return res;
+    });
+
+
     CROW_ROUTE(app, "/api/monsters/<string>").methods("GET"_method)
         ([&](const std::string& monster_id){
-        // Diese Route nutzt jetzt load_monster_statblock, die in beiden Ordnern sucht
-        json monster_data = load_monster_statblock(monster_id);
+        // Populäre Monster kommen fertig serialisiert aus dem LRU-Cache
+        std::optional<StatblockCache::Entry> statblock = get_monster_statblock(monster_id, false);
 
-        if (monster_data == nullptr) { // load_monster_statblock gibt nullptr bei Fehler/Nicht gefunden zurück
+        if (!statblock) { // Fehlt in beiden Ordnern oder konnte nicht geladen werden
             return crow::response(404, "{\"error\": \"Monster not found or could not be loaded.\"}");
         }
 
-        crow::response res(monster_data.dump());
+        crow::response res(*statblock->body);
+        res.set_header("Content-Type", "application/json");
+        res.set_header("ETag", make_etag(res.body)); // Für If-Match bei PUT/PATCH
+        return res;
+    });
+
+
+    // --- GET /api/monsters/{id}/dpr ---
+    // Exakte Schadensverteilungen pro Aktion und pro Runde gegen AC- und Rettungswurf-Bereiche
+    // (?ac_min=10&ac_max=20&save_min=0&save_max=6 oder ac=12,15&save=2,4; pmf=true liefert zusätzlich die Verteilungen)
+    CROW_ROUTE(app, "/api/monsters/<string>/dpr").methods("GET"_method)
+    ([&](const crow::request& req, const std::string& monster_id) {
+        DprTargets targets;
+        try {
+            targets.armor_classes = parse_int_range_param(req, "ac", 10, 20);
+            targets.save_bonuses = parse_int_range_param(req, "save", 0, 6);
+            targets.include_pmf = parse_bool_param(req, "pmf").value_or(false);
+        } catch (const std::invalid_argument& e) {
+            return crow::response(400, "{\"error\": \"" + std::string(e.what()) + "\"}");
+        }
+
+        std::optional<StatblockCache::Entry> statblock = get_monster_statblock(monster_id, true);
+        if (!statblock) {
+            return crow::response(404, "{\"error\": \"Monster not found or could not be loaded.\"}");
+        }
+
+        json response_data = monster_dpr_json(*statblock->document, targets);
+        response_data["id"] = monster_id;
+        crow::response res(response_data.dump());
         res.set_header("Content-Type", "application/json");
         return res;
     });
@@ -788,57 +1840,102 @@ int main() {
 
     CROW_ROUTE(app, "/api/monsters/<string>").methods("DELETE"_method)
     ([&](const std::string& monster_id) {
-     std::filesystem::path path_completed = std::filesystem::absolute(std::filesystem::path(monsters_base_dir) / "completed" / (monster_id + ".json")).lexically_normal();
-     std::filesystem::path path_uncompleted = std::filesystem::absolute(std::filesystem::path(monsters_base_dir) / "uncompleted" / (monster_id + ".json")).lexically_normal();
+     // Löscht die ID in completed und uncompleted (Orte aus dem Katalog-Index)
      bool deleted = false;
-     bool attempted_delete = false; // Flag, um zu sehen, ob überhaupt ein Löschversuch gestartet wurde
+     std::lock_guard write_lock(document_write_lock("monster/" + monster_id));
 
      try {
-         if (std::filesystem::exists(path_completed) && std::filesystem::is_regular_file(path_completed)) {
-              attempted_delete = true;
-              if (std::filesystem::remove(path_completed)) {
-                  deleted = true;
-                  std::cout << "Monster gelöscht: " << path_completed << std::endl;
+         std::vector<WriteJournal::Operation> operations;
+         for (const std::filesystem::path& path : monster_catalog.locate(monster_id)) {
+              if (write_journal.exists(path)) {
+                  operations.push_back({WriteJournal::Operation::Kind::remove, path, ""});
               } else {
-                 std::cerr << "Fehler: Konnte Monsterdatei nicht löschen (completed): " << path_completed << std::endl;
-                 // Wenn wir hier einen Fehler haben und noch nichts gelöscht wurde, senden wir 500
-                 if (!deleted) return crow::response(500, "{\"error\": \"Could not delete monster file (completed).\"}");
+                  monster_catalog.forget_file(path); // Bereits extern gelöscht
               }
          }
-          if (std::filesystem::exists(path_uncompleted) && std::filesystem::is_regular_file(path_uncompleted)) {
-               attempted_delete = true;
-              if (std::filesystem::remove(path_uncompleted)) {
-                  deleted = true; // Setze deleted auf true, auch wenn es nur hier gefunden wurde
-                  std::cout << "Monster gelöscht: " << path_uncompleted << std::endl;
-              } else {
-                 std::cerr << "Fehler: Konnte Monsterdatei nicht löschen (uncompleted): " << path_uncompleted << std::endl;
-                 // Wenn wir hier einen Fehler haben und noch nichts gelöscht wurde, senden wir 500
-                  if (!deleted) return crow::response(500, "{\"error\": \"Could not delete monster file (uncompleted).\"}");
+         if (!operations.empty()) {
+              try {
+                  write_journal.commit(operations);
+              } catch (const std::exception& e) {
+                  log_error("Konnte Monsterdatei nicht löschen", {{"id", monster_id}, {"error", e.what()}});
+                  return crow::response(500, "{\"error\": \"Could not delete monster file.\"}");
+              }
+              deleted = true;
+              for (const WriteJournal::Operation& operation : operations) {
+                  log_info("Monster gelöscht", {{"id", monster_id}, {"path", operation.path.string()}});
               }
          }
 
          if (deleted) {
+              monster_catalog.remove(monster_id);
               return crow::response(204); // No Content
-         } else if (attempted_delete) {
-              // Wir haben versucht zu löschen (Datei existierte als Pfad) aber konnten es nicht als Datei behandeln
-               return crow::response(404, "{\"error\": \"Monster file found but could not be identified as regular file for deletion.\"}");
-         }
-          else {
-               // Weder in completed noch in uncompleted gefunden
-               return crow::response(404, "{\"error\": \"Monster not found in completed or uncompleted folders.\"}");
          }
+         // Weder in completed noch in uncompleted gefunden
+         return crow::response(404, "{\"error\": \"Monster not found in completed or uncompleted folders.\"}");
 
      } catch (const std::exception& e) {
-         std::cerr << "Fehler beim Löschen des Monsters '" << monster_id << "': " << e.what() << std::endl;
+         log_error("Fehler beim Löschen des Monsters", {{"id", monster_id}, {"error", e.what()}});
          return crow::response(500, "{\"error\": \"Internal server error during deletion.\"}");
      }
  });
-
-    
-
+}
+// --- Ende Start und Routen ---
+
+
+#ifndef DNDAPP_NO_MAIN
+int main(int argc, char* argv[]) {
+    DnDServer app;
+
+    // --wait-for-warm: /api/status meldet erst nach dem Warm-Start "OK" (503 solange geladen wird)
+    // --log-level=<debug|info|warn|error|off>: Mindest-Level für das Log (Standard: info)
+    // --statblock-cache-mb=<n>: Speicherbudget des Statblock-Caches (Standard 64, 0 = aus)
+    // --statblock-cache-models: zusätzlich das kompakte Monster-Modell cachen (spart das Neu-Parsen des Bodys bei Simulation/DPR, etwa Body-Größe;
+    //   --statblock-cache-dom wird weiter als Alias akzeptiert)
+    // --no-journal: Änderungen direkt in den Dateibaum schreiben statt über ../data/journal.wal (ohne fsync)
+    // --pack=<datei>: Catalog-Pack von DnDApp_pack (Standard dndapp.pack, falls vorhanden); --no-pack: nur JSON-Dateien
+    bool block_until_warm = false;
+    long long statblock_cache_mb = 64;
+    bool statblock_cache_models = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--wait-for-warm") {
+            block_until_warm = true;
+        } else if (arg.rfind("--log-level=", 0) == 0) {
+            try {
+                logger().set_min_level(parse_log_level(arg.substr(12)));
+            } catch (const std::invalid_argument& e) {
+                log_error("Ungültiges Log-Level", {{"error", e.what()}});
+                return 1;
+            }
+        } else if (arg.rfind("--statblock-cache-mb=", 0) == 0) {
+            try {
+                statblock_cache_mb = std::stoll(arg.substr(21));
+            } catch (const std::exception&) {
+                statblock_cache_mb = -1;
+            }
+            if (statblock_cache_mb < 0 || statblock_cache_mb > 65536) {
+                log_error("Ungültiges Budget für den Statblock-Cache", {{"value", arg.substr(21)}});
+                return 1;
+            }
+        } else if (arg == "--statblock-cache-models" || arg == "--statblock-cache-dom") {
+            statblock_cache_models = true;
+        } else if (arg == "--no-journal") {
+            write_journal.set_enabled(false);
+        } else if (arg.rfind("--pack=", 0) == 0) {
+            catalog_pack_file = arg.substr(7);
+        } else if (arg == "--no-pack") {
+            catalog_pack_file.clear();
+        }
+    }
+    statblock_cache.configure(static_cast<std::size_t>(statblock_cache_mb) * 1024 * 1024, statblock_cache_models);
+    start_services();
+    register_routes(app, block_until_warm);
 
     // --- Server Start ---
     app.port(8080).multithreaded().run();
-    std::cout << "Server wird beendet." << std::endl;
+    stop_services();
+    log_info("Server wird beendet");
+    logger().shutdown();
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,223 @@
+#include "manifest_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+
+#include "logger.h"
+#include "parallel.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+bool starts_with_ignore_case(const std::string& text, const std::string& prefix) {
+    if (prefix.size() > text.size()) return false;
+    for (std::size_t i = 0; i < prefix.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(text[i])) != std::tolower(static_cast<unsigned char>(prefix[i]))) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+ManifestIndex::ManifestIndex(std::filesystem::path dir, Extractor extract, const std::string& metrics_name, const std::vector<std::string>& fields)
+    : dir_(std::move(dir)), extract_(std::move(extract)), counters_(metrics().cache(metrics_name)) {
+    if (!fields.empty()) {
+        fields_.emplace(fields);
+    }
+}
+
+std::optional<ManifestEntry> ManifestIndex::read_entry(const std::filesystem::path& file, std::filesystem::file_time_type mtime, std::uintmax_t size) const {
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream.is_open()) {
+        return std::nullopt;
+    }
+    const std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    metrics().record_file_read(content.size());
+    try {
+        json data;
+        {
+            auto timer = metrics().time_json_parse();
+            data = fields_ ? fields_->extract(content) : json::parse(content);
+        }
+        std::optional<Fields> fields = extract_(file, data);
+        if (!fields) {
+            return std::nullopt;
+        }
+        return ManifestEntry{std::move(fields->id), std::move(fields->name), mtime, size, fnv1a64(content)};
+    } catch (const std::exception& e) {
+        log_error("Fehler beim Verarbeiten der Datei für das Manifest", {{"path", file.string()}, {"error", e.what()}});
+        return std::nullopt;
+    }
+}
+
+void ManifestIndex::rescan_locked() {
+    struct Found {
+        std::string filename;
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t size;
+    };
+    std::vector<Found> found;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir_, ec)) {
+        std::error_code entry_ec;
+        if (!entry.is_regular_file(entry_ec) || entry.path().extension() != ".json") continue;
+        const auto mtime = entry.last_write_time(entry_ec);
+        const auto size = entry.file_size(entry_ec);
+        if (entry_ec) continue; // Zwischenzeitlich gelöscht
+        found.push_back({entry.path().filename().string(), mtime, size});
+    }
+    if (ec && ec != std::errc::no_such_file_or_directory) {
+        log_warn("Verzeichnis für das Manifest nicht lesbar", {{"path", dir_.string()}, {"error", ec.message()}});
+    }
+
+    // Nur neue oder geänderte Dateien parsen (parallel, jeder Index schreibt in seinen eigenen Slot)
+    std::vector<std::size_t> changed;
+    for (std::size_t i = 0; i < found.size(); ++i) {
+        auto it = files_.find(found[i].filename);
+        if (it == files_.end() || it->second.mtime != found[i].mtime || it->second.size != found[i].size) {
+            changed.push_back(i);
+        }
+    }
+    std::vector<std::optional<ManifestEntry>> parsed(changed.size());
+    parallel_for(changed.size(), [&](std::size_t i) {
+        const Found& file = found[changed[i]];
+        parsed[i] = read_entry(dir_ / file.filename, file.mtime, file.size);
+    });
+
+    std::map<std::string, Slot> next;
+    for (const Found& file : found) {
+        auto it = files_.find(file.filename);
+        if (it != files_.end()) next.emplace(file.filename, std::move(it->second));
+    }
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+        const Found& file = found[changed[i]];
+        next[file.filename] = Slot{std::move(parsed[i]), file.mtime, file.size};
+    }
+
+    overlay_pending_locked(next);
+
+    if (!changed.empty() || next.size() != files_.size()) {
+        invalidate_views_locked();
+    }
+    files_ = std::move(next);
+    scanned_ = true;
+    last_scan_ = std::chrono::steady_clock::now();
+}
+
+void ManifestIndex::overlay_pending_locked(std::map<std::string, Slot>& files) {
+    // Noch nicht übertragene Schreibzugriffe sind neuer als das Verzeichnis; übertragene gibt der Abgleich schon richtig wieder
+    for (auto it = overlay_.begin(); it != overlay_.end();) {
+        if (!pending_check_ || !pending_check_(dir_ / it->first)) {
+            it = overlay_.erase(it);
+            continue;
+        }
+        if (it->second) {
+            files[it->first] = *it->second;
+        } else {
+            files.erase(it->first);
+        }
+        ++it;
+    }
+}
+
+void ManifestIndex::revalidate_locked() {
+    std::error_code ec;
+    const auto dir_mtime = std::filesystem::last_write_time(dir_, ec);
+    if (scanned_ && !ec && dir_mtime == dir_mtime_ && std::chrono::steady_clock::now() - last_scan_ < revalidate_interval) {
+        counters_.hits.add();
+        return;
+    }
+    counters_.misses.add();
+    dir_mtime_ = ec ? std::filesystem::file_time_type{} : dir_mtime;
+    rescan_locked();
+}
+
+std::vector<ManifestEntry> ManifestIndex::collect_locked(const std::string& name_prefix) const {
+    std::vector<ManifestEntry> entries;
+    for (const auto& [filename, slot] : files_) {
+        if (slot.entry && starts_with_ignore_case(slot.entry->name, name_prefix)) {
+            entries.push_back(*slot.entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const ManifestEntry& a, const ManifestEntry& b) {
+        return a.name != b.name ? a.name < b.name : a.id < b.id;
+    });
+    return entries;
+}
+
+std::vector<ManifestEntry> ManifestIndex::list(const std::string& name_prefix) {
+    std::lock_guard lock(mutex_);
+    revalidate_locked();
+    return collect_locked(name_prefix);
+}
+
+std::shared_ptr<const CachedResponse> ManifestIndex::listing() {
+    std::lock_guard lock(mutex_);
+    revalidate_locked();
+    if (listing_) {
+        return listing_;
+    }
+    json items = json::array();
+    for (const ManifestEntry& entry : collect_locked("")) {
+        items.push_back({{"id", entry.id}, {"name", entry.name}});
+    }
+    // Listen sind klein, Komprimieren lohnt sich nicht
+    listing_ = make_cached_response(items.dump(), "application/json", false);
+    return listing_;
+}
+
+std::shared_ptr<const ListingIndex> ManifestIndex::listing_index() {
+    std::lock_guard lock(mutex_);
+    revalidate_locked();
+    if (listing_index_) {
+        return listing_index_;
+    }
+    std::vector<json> rows;
+    for (const ManifestEntry& entry : collect_locked("")) {
+        rows.push_back({{"id", entry.id}, {"name", entry.name}});
+    }
+    listing_index_ = std::make_shared<const ListingIndex>(std::move(rows), std::vector<std::string>{"name", "id"});
+    return listing_index_;
+}
+
+void ManifestIndex::invalidate_views_locked() {
+    listing_.reset();
+    listing_index_.reset();
+}
+
+void ManifestIndex::set_pending_check(std::function<bool(const std::filesystem::path&)> check) {
+    std::lock_guard lock(mutex_);
+    pending_check_ = std::move(check);
+}
+
+void ManifestIndex::put(const std::filesystem::path& file, const json& data, const std::string& content) {
+    // Liegt die Änderung noch im Journal, gibt es die Datei so noch nicht: mtime bleibt leer, damit der erste
+    // Abgleich nach dem Übertragen die Datei einmal neu einliest
+    std::filesystem::file_time_type mtime{};
+    std::uintmax_t size = content.size();
+    std::lock_guard lock(mutex_);
+    if (!pending_check_ || !pending_check_(file)) {
+        std::error_code ec;
+        mtime = std::filesystem::last_write_time(file, ec);
+        size = std::filesystem::file_size(file, ec);
+    }
+    std::optional<ManifestEntry> entry;
+    if (std::optional<Fields> fields = extract_(file, data)) {
+        entry = ManifestEntry{std::move(fields->id), std::move(fields->name), mtime, size, fnv1a64(content)};
+    }
+    Slot slot{std::move(entry), mtime, size};
+    overlay_[file.filename().string()] = slot;
+    files_[file.filename().string()] = std::move(slot);
+    invalidate_views_locked();
+}
+
+void ManifestIndex::erase(const std::filesystem::path& file) {
+    std::lock_guard lock(mutex_);
+    overlay_[file.filename().string()] = std::nullopt;
+    if (files_.erase(file.filename().string()) > 0) {
+        invalidate_views_locked();
+    }
+}
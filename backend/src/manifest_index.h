@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "json_extract.h"
+#include "listing_index.h"
+#include "metrics.h"
+#include "response_cache.h"
+
+// --- Manifest einer JSON-Sammlung (Encounter, Templates eines Typs) ---
+// Hält pro Datei ID, Name, mtime, Größe und Inhalts-Hash im Speicher, damit Listen-Routen
+// nicht jedes Mal das Verzeichnis durchgehen und jede Datei parsen müssen.
+//
+// Schreib-Routen melden Änderungen über put()/erase(). Änderungen von außen werden beim Listen
+// erkannt: ändert sich die mtime des Verzeichnisses (Datei angelegt/gelöscht/umbenannt) oder ist
+// der letzte Abgleich älter als revalidate_interval, werden mtime/Größe aller Dateien verglichen
+// und nur geänderte Dateien neu geparst. Dazwischen kostet eine Liste genau einen stat-Aufruf.
+// Mit Write-Journal landet eine Änderung erst später auf der Platte: Einträge aus put()/erase() überdecken den
+// Verzeichnisstand, solange set_pending_check() die Datei als ausstehend meldet, und weichen danach dem Abgleich.
+
+struct ManifestEntry {
+    std::string id;
+    std::string name;
+    std::filesystem::file_time_type mtime;
+    std::uintmax_t size = 0;
+    std::uint64_t content_hash = 0; // FNV-1a über den Dateiinhalt
+};
+
+class ManifestIndex {
+public:
+    // ID und Name aus einer geparsten Datei, nullopt = Datei nicht listen
+    struct Fields {
+        std::string id;
+        std::string name;
+    };
+    using Extractor = std::function<std::optional<Fields>(const std::filesystem::path& file, const nlohmann::json& data)>;
+
+    static constexpr std::chrono::seconds revalidate_interval{5};
+
+    // fields: JSON-Pointer, die extract beim Einlesen braucht (leer = ganzes Dokument parsen). Beim Abgleich werden
+    // dann nur diese Felder ausgelesen, extract sieht ein dünnbesetztes Dokument (siehe JsonFieldExtractor).
+    ManifestIndex(std::filesystem::path dir, Extractor extract, const std::string& metrics_name, const std::vector<std::string>& fields = {});
+
+    ManifestIndex(const ManifestIndex&) = delete;
+    ManifestIndex& operator=(const ManifestIndex&) = delete;
+
+    // Alle Einträge (nach Name, dann ID sortiert); name_prefix filtert ohne Groß-/Kleinschreibung
+    std::vector<ManifestEntry> list(const std::string& name_prefix = "");
+    // Vorbereitete Antwort [{"id", "name"}, ...] mit ETag (wird nur nach Änderungen neu gebaut)
+    std::shared_ptr<const CachedResponse> listing();
+
+    // Vorsortierte Listen für ?limit/cursor/sort/fields (sort=name oder id)
+    std::shared_ptr<const ListingIndex> listing_index();
+
+    // true = Datei hat eine noch nicht übertragene Journal-Änderung (ohne Prüfung gilt die Platte als aktuell)
+    void set_pending_check(std::function<bool(const std::filesystem::path&)> check);
+
+    // Von Schreib-Routen nach dem Schreiben/Löschen (bzw. dem Commit ins Journal) aufrufen (content = Dateiinhalt)
+    void put(const std::filesystem::path& file, const nlohmann::json& data, const std::string& content);
+    void erase(const std::filesystem::path& file);
+
+private:
+    struct Slot {
+        std::optional<ManifestEntry> entry; // nullopt = Datei existiert, wird aber nicht gelistet
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t size = 0;
+    };
+
+    void revalidate_locked();
+    std::vector<ManifestEntry> collect_locked(const std::string& name_prefix) const;
+    void invalidate_views_locked();
+    void rescan_locked();
+    void overlay_pending_locked(std::map<std::string, Slot>& files);
+    std::optional<ManifestEntry> read_entry(const std::filesystem::path& file, std::filesystem::file_time_type mtime, std::uintmax_t size) const;
+
+    std::filesystem::path dir_;
+    Extractor extract_;
+    std::optional<JsonFieldExtractor> fields_;
+    CacheCounters& counters_; // Treffer = Liste ohne Abgleich, Fehlgriff = Verzeichnis neu abgeglichen
+
+    std::mutex mutex_;
+    bool scanned_ = false;
+    std::filesystem::file_time_type dir_mtime_;
+    std::chrono::steady_clock::time_point last_scan_;
+    std::map<std::string, Slot> files_; // Dateiname -> Slot
+    std::function<bool(const std::filesystem::path&)> pending_check_;
+    std::map<std::string, std::optional<Slot>> overlay_; // Aus put()/erase() bis zum Übertragen, nullopt = gelöscht
+    std::shared_ptr<const CachedResponse> listing_; // nullptr = veraltet
+    std::shared_ptr<const ListingIndex> listing_index_;
+};
+// --- Ende Manifest ---
@@ -0,0 +1,273 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <string_view>
+
+namespace {
+
+constexpr std::array<const char*, Metrics::method_count> method_names = {"GET", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", "HEAD", "OTHER"};
+
+std::size_t method_index(std::string_view method) {
+    for (std::size_t i = 0; i + 1 < method_names.size(); ++i) {
+        if (method == method_names[i]) return i;
+    }
+    return method_names.size() - 1;
+}
+
+// Nur beim Registrieren der Routen
+std::vector<std::string> split_path(const std::string& url) {
+    std::vector<std::string> segments;
+    const std::string path = url.substr(0, url.find('?'));
+    std::size_t start = 0;
+    while (start < path.size()) {
+        std::size_t end = path.find('/', start);
+        if (end == std::string::npos) end = path.size();
+        if (end > start) segments.push_back(path.substr(start, end - start));
+        start = end + 1;
+    }
+    return segments;
+}
+
+// Pfad-Segmente als Views in die URL (ohne Query), ohne zu allokieren. Gibt max_segments + 1 zurück, wenn es mehr sind.
+template <std::size_t N>
+std::size_t split_path(std::string_view url, std::array<std::string_view, N>& segments) {
+    const std::string_view path = url.substr(0, url.find('?'));
+    std::size_t count = 0;
+    std::size_t start = 0;
+    while (start < path.size()) {
+        std::size_t end = path.find('/', start);
+        if (end == std::string_view::npos) end = path.size();
+        if (end > start) {
+            if (count == N) return N + 1;
+            segments[count++] = path.substr(start, end - start);
+        }
+        start = end + 1;
+    }
+    return count;
+}
+
+bool is_placeholder(const std::string& segment) {
+    return segment.size() > 2 && segment.front() == '<' && segment.back() == '>';
+}
+
+std::string seconds(std::uint64_t micros) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6f", static_cast<double>(micros) / 1e6);
+    return buffer;
+}
+
+} // namespace
+
+// --- LatencyHistogram ---
+
+int LatencyHistogram::index_for(std::uint64_t micros) {
+    if (micros < sub_buckets) return static_cast<int>(micros); // Unterhalb von 8 µs exakt
+    int exponent = 63;
+    while (!(micros >> exponent)) --exponent;
+    const int sub = static_cast<int>((micros >> (exponent - 3)) & (sub_buckets - 1));
+    return std::min((exponent - 2) * sub_buckets + sub, bucket_count - 1);
+}
+
+std::uint64_t LatencyHistogram::upper_bound(int index) {
+    if (index < sub_buckets) return static_cast<std::uint64_t>(index);
+    const int exponent = index / sub_buckets + 2;
+    const std::uint64_t width = std::uint64_t(1) << (exponent - 3);
+    return (static_cast<std::uint64_t>(sub_buckets + index % sub_buckets) << (exponent - 3)) + width - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t micros) {
+    buckets_[index_for(micros)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(micros, std::memory_order_relaxed);
+    std::uint64_t current = max_.load(std::memory_order_relaxed);
+    while (micros > current && !max_.compare_exchange_weak(current, micros, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t LatencyHistogram::percentile_micros(double q) const {
+    // Zähler können sich während des Lesens ändern, daher über die Buckets selbst summieren
+    std::array<std::uint64_t, bucket_count> snapshot;
+    std::uint64_t total = 0;
+    for (int i = 0; i < bucket_count; ++i) {
+        snapshot[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+    if (total == 0) return 0;
+    const auto wanted = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * static_cast<double>(total) + 0.5));
+    std::uint64_t seen = 0;
+    for (int i = 0; i < bucket_count; ++i) {
+        seen += snapshot[i];
+        if (seen >= wanted) return std::min(upper_bound(i), max_micros());
+    }
+    return max_micros();
+}
+
+// --- Metrics ---
+
+void Metrics::add_route(const std::string& pattern) {
+    for (const Route& route : routes_) {
+        if (route.pattern == pattern) return;
+    }
+    Route route;
+    route.pattern = pattern;
+    route.segments = split_path(pattern);
+    route.literal_segments = static_cast<std::size_t>(std::count_if(route.segments.begin(), route.segments.end(), [](const std::string& s) { return !is_placeholder(s); }));
+    route.stats = std::make_unique<std::array<RouteStats, method_count>>();
+    if (route.segments.size() > max_route_segments) return; // Passt nie, zählt unter "other"
+    routes_by_length_[route.segments.size()].push_back(routes_.size());
+    routes_.push_back(std::move(route));
+}
+
+const Metrics::Route& Metrics::match(std::string_view url) const {
+    // Läuft bei jeder Anfrage: Segmente als Views, nur Muster mit passender Segmentzahl vergleichen
+    std::array<std::string_view, max_route_segments> segments;
+    const std::size_t count = split_path(url, segments);
+    if (count > max_route_segments) return other_;
+    const Route* best = nullptr;
+    for (std::size_t index : routes_by_length_[count]) {
+        const Route& route = routes_[index];
+        bool matches = true;
+        for (std::size_t i = 0; i < count && matches; ++i) {
+            matches = is_placeholder(route.segments[i]) || route.segments[i] == segments[i];
+        }
+        // Bei mehreren Treffern gewinnt das spezifischere Muster (wie bei Crow: /api/monsters/summary vor <string>)
+        if (matches && (!best || route.literal_segments > best->literal_segments)) best = &route;
+    }
+    return best ? *best : other_;
+}
+
+void Metrics::record_request(const std::string& method, const std::string& url, int status, std::size_t bytes_in, std::size_t bytes_out,
+                             std::chrono::steady_clock::duration elapsed) {
+    RouteStats& stats = (*match(url).stats)[method_index(method)];
+    stats.status_classes[static_cast<std::size_t>(std::clamp(status / 100, 1, 5) - 1)].add();
+    stats.bytes_in.add(bytes_in);
+    stats.bytes_out.add(bytes_out);
+    stats.latency.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+}
+
+CacheCounters& Metrics::cache(const std::string& name) {
+    std::lock_guard<std::mutex> lock(caches_mutex_);
+    for (CacheCounters& counters : caches_) {
+        if (counters.name == name) return counters;
+    }
+    caches_.emplace_back();
+    caches_.back().name = name;
+    return caches_.back();
+}
+
+void Metrics::record_file_read(const std::filesystem::path& path) {
+    io_.file_opens.add();
+    std::error_code ec;
+    const std::uintmax_t size = std::filesystem::file_size(path, ec);
+    if (!ec) io_.bytes_read.add(size);
+}
+
+std::string Metrics::render_prometheus() const {
+    std::ostringstream out;
+    std::vector<const Route*> all_routes;
+    for (const Route& route : routes_) all_routes.push_back(&route);
+    all_routes.push_back(&other_);
+
+    auto for_each_series = [&](auto&& fn) {
+        for (const Route* route : all_routes) {
+            for (std::size_t m = 0; m < method_count; ++m) {
+                const RouteStats& stats = (*route->stats)[m];
+                if (stats.latency.count() == 0) continue;
+                fn("route=\"" + route->pattern + "\",method=\"" + method_names[m] + "\"", stats);
+            }
+        }
+    };
+
+    out << "# HELP dndapp_http_requests_total Requests per route, method and status class.\n"
+        << "# TYPE dndapp_http_requests_total counter\n";
+    for_each_series([&](const std::string& labels, const RouteStats& stats) {
+        for (std::size_t c = 0; c < stats.status_classes.size(); ++c) {
+            if (stats.status_classes[c].get() == 0) continue;
+            out << "dndapp_http_requests_total{" << labels << ",status=\"" << (c + 1) << "xx\"} " << stats.status_classes[c].get() << "\n";
+        }
+    });
+
+    out << "# HELP dndapp_http_request_duration_seconds Request latency (log-linear histogram, bucket upper bounds).\n"
+        << "# TYPE dndapp_http_request_duration_seconds summary\n";
+    for_each_series([&](const std::string& labels, const RouteStats& stats) {
+        for (double q : {0.5, 0.9, 0.99}) {
+            out << "dndapp_http_request_duration_seconds{" << labels << ",quantile=\"" << q << "\"} " << seconds(stats.latency.percentile_micros(q)) << "\n";
+        }
+        out << "dndapp_http_request_duration_seconds_sum{" << labels << "} " << seconds(stats.latency.sum_micros()) << "\n";
+        out << "dndapp_http_request_duration_seconds_count{" << labels << "} " << stats.latency.count() << "\n";
+    });
+
+    out << "# HELP dndapp_http_request_duration_max_seconds Slowest request since start.\n"
+        << "# TYPE dndapp_http_request_duration_max_seconds gauge\n";
+    for_each_series([&](const std::string& labels, const RouteStats& stats) {
+        out << "dndapp_http_request_duration_max_seconds{" << labels << "} " << seconds(stats.latency.max_micros()) << "\n";
+    });
+
+    out << "# HELP dndapp_http_request_bytes_total Request body bytes.\n"
+        << "# TYPE dndapp_http_request_bytes_total counter\n";
+    for_each_series([&](const std::string& labels, const RouteStats& stats) {
+        out << "dndapp_http_request_bytes_total{" << labels << "} " << stats.bytes_in.get() << "\n";
+    });
+    out << "# HELP dndapp_http_response_bytes_total Response body bytes.\n"
+        << "# TYPE dndapp_http_response_bytes_total counter\n";
+    for_each_series([&](const std::string& labels, const RouteStats& stats) {
+        out << "dndapp_http_response_bytes_total{" << labels << "} " << stats.bytes_out.get() << "\n";
+    });
+
+    out << "# HELP dndapp_file_opens_total Data files opened for reading.\n"
+        << "# TYPE dndapp_file_opens_total counter\n"
+        << "dndapp_file_opens_total " << io_.file_opens.get() << "\n"
+        << "# HELP dndapp_file_read_bytes_total Bytes read from data files.\n"
+        << "# TYPE dndapp_file_read_bytes_total counter\n"
+        << "dndapp_file_read_bytes_total " << io_.bytes_read.get() << "\n"
+        << "# HELP dndapp_json_parse_total JSON documents parsed.\n"
+        << "# TYPE dndapp_json_parse_total counter\n"
+        << "dndapp_json_parse_total " << io_.json_parse_count.get() << "\n"
+        << "# HELP dndapp_json_parse_seconds_total Time spent parsing JSON.\n"
+        << "# TYPE dndapp_json_parse_seconds_total counter\n"
+        << "dndapp_json_parse_seconds_total " << seconds(io_.json_parse_ns.get() / 1000) << "\n"
+        << "# HELP dndapp_json_dump_total JSON documents serialized.\n"
+        << "# TYPE dndapp_json_dump_total counter\n"
+        << "dndapp_json_dump_total " << io_.json_dump_count.get() << "\n"
+        << "# HELP dndapp_json_dump_seconds_total Time spent in json::dump().\n"
+        << "# TYPE dndapp_json_dump_seconds_total counter\n"
+        << "dndapp_json_dump_seconds_total " << seconds(io_.json_dump_ns.get() / 1000) << "\n";
+
+    std::lock_guard<std::mutex> lock(caches_mutex_);
+    out << "# HELP dndapp_cache_hits_total Cache hits per cache.\n"
+        << "# TYPE dndapp_cache_hits_total counter\n";
+    for (const CacheCounters& counters : caches_) {
+        out << "dndapp_cache_hits_total{cache=\"" << counters.name << "\"} " << counters.hits.get() << "\n";
+    }
+    out << "# HELP dndapp_cache_misses_total Cache misses per cache.\n"
+        << "# TYPE dndapp_cache_misses_total counter\n";
+    for (const CacheCounters& counters : caches_) {
+        out << "dndapp_cache_misses_total{cache=\"" << counters.name << "\"} " << counters.misses.get() << "\n";
+    }
+    out << "# HELP dndapp_cache_hit_ratio Hits / (hits + misses) since start.\n"
+        << "# TYPE dndapp_cache_hit_ratio gauge\n";
+    for (const CacheCounters& counters : caches_) {
+        const std::uint64_t hits = counters.hits.get();
+        const std::uint64_t lookups = hits + counters.misses.get();
+        if (lookups == 0) continue;
+        out << "dndapp_cache_hit_ratio{cache=\"" << counters.name << "\"} " << static_cast<double>(hits) / static_cast<double>(lookups) << "\n";
+    }
+    out << "# HELP dndapp_cache_evictions_total Entries evicted to stay within the memory budget.\n"
+        << "# TYPE dndapp_cache_evictions_total counter\n";
+    for (const CacheCounters& counters : caches_) {
+        out << "dndapp_cache_evictions_total{cache=\"" << counters.name << "\"} " << counters.evictions.get() << "\n";
+    }
+    out << "# HELP dndapp_cache_resident_bytes Estimated memory held by size-accounted caches.\n"
+        << "# TYPE dndapp_cache_resident_bytes gauge\n";
+    for (const CacheCounters& counters : caches_) {
+        out << "dndapp_cache_resident_bytes{cache=\"" << counters.name << "\"} " << counters.resident_bytes.load(std::memory_order_relaxed) << "\n";
+    }
+    return out.str();
+}
+
+Metrics& metrics() {
+    static Metrics instance;
+    return instance;
+}
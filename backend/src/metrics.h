@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --- Metriken für /api/metrics (Prometheus-Textformat) ---
+// Alle Zähler sind relaxed-Atomics, der Request-Pfad nimmt keine Locks. Routen werden vor dem
+// Serverstart registriert (add_route), danach ist die Routentabelle unveränderlich.
+
+struct MetricCounter {
+    std::atomic<std::uint64_t> value{0};
+    void add(std::uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t get() const { return value.load(std::memory_order_relaxed); }
+};
+
+// Log-lineares Histogramm in Mikrosekunden: 8 Unter-Buckets pro Zweierpotenz (max. 12.5 % Fehler), bis ca. 268 s
+class LatencyHistogram {
+public:
+    static constexpr int sub_buckets = 8;
+    static constexpr int bucket_count = sub_buckets * 27;
+
+    void record(std::uint64_t micros);
+    std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    std::uint64_t sum_micros() const { return sum_.load(std::memory_order_relaxed); }
+    std::uint64_t max_micros() const { return max_.load(std::memory_order_relaxed); }
+    // Obere Grenze des Buckets, in dem das q-Quantil liegt (max. max_micros())
+    std::uint64_t percentile_micros(double q) const;
+
+private:
+    static int index_for(std::uint64_t micros);
+    static std::uint64_t upper_bound(int index);
+
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+    std::atomic<std::uint64_t> max_{0};
+};
+
+struct CacheCounters {
+    std::string name;
+    MetricCounter hits;
+    MetricCounter misses;
+    MetricCounter evictions;                     // Nur bei größenbegrenzten Caches
+    std::atomic<std::uint64_t> resident_bytes{0}; // Gauge, vom Cache selbst gepflegt
+};
+
+struct IoCounters {
+    MetricCounter file_opens;
+    MetricCounter bytes_read;
+    MetricCounter json_parse_count;
+    MetricCounter json_parse_ns;
+    MetricCounter json_dump_count;
+    MetricCounter json_dump_ns;
+};
+
+// Misst die Lebensdauer des Objekts (z.B. einen parse- oder dump()-Aufruf)
+class ScopedTimer {
+public:
+    ScopedTimer(MetricCounter& count, MetricCounter& nanoseconds)
+        : count_(count), nanoseconds_(nanoseconds), start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        count_.add();
+        nanoseconds_.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count()));
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    MetricCounter& count_;
+    MetricCounter& nanoseconds_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+class Metrics {
+public:
+    static constexpr std::size_t method_count = 8; // GET, POST, PUT, DELETE, PATCH, OPTIONS, HEAD, andere
+
+    struct RouteStats {
+        std::array<MetricCounter, 5> status_classes; // 1xx..5xx
+        MetricCounter bytes_in;
+        MetricCounter bytes_out;
+        LatencyHistogram latency;
+    };
+
+    // Routen-Muster wie bei CROW_ROUTE ("/api/monsters/<string>"), nur vor dem Serverstart aufrufen
+    void add_route(const std::string& pattern);
+    void record_request(const std::string& method, const std::string& url, int status, std::size_t bytes_in, std::size_t bytes_out,
+                        std::chrono::steady_clock::duration elapsed);
+
+    IoCounters& io() { return io_; }
+    // Zähler für einen benannten Cache (wird beim ersten Aufruf angelegt, Referenz bleibt gültig)
+    CacheCounters& cache(const std::string& name);
+
+    // Datei wurde geöffnet und vollständig gelesen (Größe laut Dateisystem)
+    void record_file_read(const std::filesystem::path& path);
+    // Variante mit bekannter Größe (ohne zusätzlichen stat-Aufruf)
+    void record_file_read(std::uintmax_t bytes) {
+        io_.file_opens.add();
+        io_.bytes_read.add(bytes);
+    }
+    ScopedTimer time_json_parse() { return ScopedTimer(io_.json_parse_count, io_.json_parse_ns); }
+    ScopedTimer time_json_dump() { return ScopedTimer(io_.json_dump_count, io_.json_dump_ns); }
+
+    std::string render_prometheus() const;
+
+private:
+    struct Route {
+        std::string pattern;
+        std::vector<std::string> segments;
+        std::size_t literal_segments = 0;
+        std::unique_ptr<std::array<RouteStats, method_count>> stats;
+    };
+
+    static constexpr std::size_t max_route_segments = 8;
+
+    const Route& match(std::string_view url) const;
+
+    std::vector<Route> routes_;
+    std::array<std::vector<std::size_t>, max_route_segments + 1> routes_by_length_; // Indizes in routes_ nach Segmentzahl
+    Route other_{"other", {}, 0, std::make_unique<std::array<RouteStats, method_count>>()};
+    IoCounters io_;
+    mutable std::mutex caches_mutex_; // Nur beim Anlegen und Rendern
+    std::deque<CacheCounters> caches_;
+};
+
+// Prozessweite Instanz (auch für Caches in anderen Übersetzungseinheiten)
+Metrics& metrics();
+// --- Ende Metriken ---
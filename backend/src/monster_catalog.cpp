@@ -0,0 +1,511 @@
+#include "monster_catalog.h"
+
+#include <fstream>
+#include <optional>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "catalog_pack.h"
+#include "json_extract.h"
+#include "logger.h"
+#include "metrics.h"
+#include "parallel.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// completed vor uncompleted vor allem anderen (gleiche Reihenfolge wie load_monster_statblock)
+int location_rank(const std::filesystem::path& path) {
+    const std::string subdir = path.parent_path().filename().string();
+    if (subdir == "completed") return 0;
+    if (subdir == "uncompleted") return 1;
+    return 2;
+}
+
+bool is_monster_file(const std::filesystem::path& path) {
+    return path.extension() == ".json";
+}
+
+// Alle Felder, die summarize_monster liest; actions, traits usw. werden beim Einlesen übersprungen
+const JsonFieldExtractor& summary_fields() {
+    static const JsonFieldExtractor extractor({"/basics/name", "/basics/CR", "/basics/size", "/basics/type", "/basics/alignment",
+                                               "/basics/languages", "/complete", "/speeds", "/resistances", "/immunities",
+                                               "/vulnerabilities", "/conditionImmunities"});
+    return extractor;
+}
+
+std::optional<MonsterSummary> read_summary(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    metrics().record_file_read(path);
+    try {
+        json data;
+        {
+            auto timer = metrics().time_json_parse();
+            data = summary_fields().extract(file);
+        }
+        return summarize_monster(path.stem().string(), data, path);
+    } catch (const std::exception& e) {
+        log_error("Fehler beim Verarbeiten der Monster-Datei", {{"path", path.string()}, {"error", e.what()}});
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+MonsterSummary summarize_monster(const std::string& id, const json& data, const std::filesystem::path& path) {
+    MonsterSummary summary;
+    const json basics = data.value("basics", json::object());
+    summary.id = id;
+    summary.name = basics.value("name", "Unknown");
+    summary.cr = basics.value("CR", 0.0);
+    summary.size = basics.value("size", "Medium");
+    summary.type = basics.value("type", "unknown");
+    summary.complete = data.value("complete", false);
+    summary.path = path;
+
+    summary.alignment = basics.value("alignment", "");
+    const json languages = basics.value("languages", json());
+    if (languages.is_string()) {
+        std::string current;
+        for (char c : languages.get<std::string>() + ",") {
+            if (c != ',' && c != ';') {
+                current += c;
+                continue;
+            }
+            const std::size_t first = current.find_first_not_of(" \t");
+            if (first != std::string::npos) {
+                summary.languages.push_back(current.substr(first, current.find_last_not_of(" \t") - first + 1));
+            }
+            current.clear();
+        }
+    }
+    for (const json& speed : data.value("speeds", json::array())) {
+        if (speed.is_object() && speed.value("speed", 0) > 0 && speed.contains("type") && speed["type"].is_string()) {
+            summary.movement.push_back(speed["type"].get<std::string>());
+        }
+    }
+    auto string_list = [&](const char* key) {
+        std::vector<std::string> values;
+        for (const json& value : data.value(key, json::array())) {
+            if (value.is_string()) values.push_back(value.get<std::string>());
+        }
+        return values;
+    };
+    summary.resistances = string_list("resistances");
+    summary.immunities = string_list("immunities");
+    summary.vulnerabilities = string_list("vulnerabilities");
+    summary.condition_immunities = string_list("conditionImmunities");
+    return summary;
+}
+
+MonsterCatalog::MonsterCatalog(std::filesystem::path base_dir)
+    : base_dir_(std::move(base_dir)),
+      completed_dir_(std::filesystem::absolute(base_dir_ / "completed").lexically_normal()),
+      uncompleted_dir_(std::filesystem::absolute(base_dir_ / "uncompleted").lexically_normal()),
+      location_counters_(metrics().cache("monster_paths")) {}
+
+MonsterCatalog::~MonsterCatalog() {
+    stop_watcher();
+}
+
+void MonsterCatalog::build() {
+    std::vector<std::filesystem::path> files;
+    try {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(base_dir_)) {
+            if (entry.is_regular_file() && is_monster_file(entry.path())) {
+                files.push_back(std::filesystem::absolute(entry.path()).lexically_normal());
+            }
+        }
+    } catch (const std::exception& e) {
+        log_error("Fehler beim Auflisten der Monster", {{"path", base_dir_.string()}, {"error", e.what()}});
+        throw;
+    }
+
+    // Jeder Worker schreibt nur in die Slots seiner Dateien
+    const std::filesystem::path absolute_base = std::filesystem::absolute(base_dir_).lexically_normal();
+    std::vector<std::optional<MonsterSummary>> results(files.size());
+    parallel_for(files.size(), [&](std::size_t i) {
+        if (pack_) {
+            const std::string key = files[i].lexically_relative(absolute_base).generic_string();
+            if (std::optional<CatalogPack::Record> record = pack_->find_fresh("monsters", key, files[i])) {
+                if ((results[i] = pack_->monster_summary(*record, files[i]))) return;
+            }
+        }
+        results[i] = read_summary(files[i]);
+    });
+
+    std::unique_lock lock(mutex_);
+    entries_.clear();
+    locations_.clear();
+    for (const auto& file : files) {
+        set_location_locked(file, true);
+    }
+    for (auto& result : results) {
+        if (result) {
+            try_insert_locked(std::move(*result));
+        }
+    }
+    invalidate_views_locked();
+    built_ = true;
+}
+
+void MonsterCatalog::ensure_built() {
+    std::call_once(built_once_, [this]() { build(); });
+}
+
+bool MonsterCatalog::try_insert_locked(MonsterSummary summary) {
+    auto it = entries_.find(summary.id);
+    if (it != entries_.end() && it->second.path != summary.path &&
+        location_rank(summary.path) > location_rank(it->second.path)) {
+        return false; // Es gibt bereits eine höher priorisierte Datei für diese ID
+    }
+    entries_[summary.id] = std::move(summary);
+    return true;
+}
+
+std::uint8_t MonsterCatalog::location_bit(const std::filesystem::path& normal_path) const {
+    const std::filesystem::path dir = normal_path.parent_path();
+    if (dir == completed_dir_) return in_completed;
+    if (dir == uncompleted_dir_) return in_uncompleted;
+    return 0;
+}
+
+void MonsterCatalog::set_location_locked(const std::filesystem::path& normal_path, bool present) {
+    const std::uint8_t bit = location_bit(normal_path);
+    if (bit == 0 || !is_monster_file(normal_path)) {
+        return;
+    }
+    std::uint8_t& mask = locations_[normal_path.stem().string()];
+    mask = present ? (mask | bit) : (mask & ~bit);
+}
+
+std::vector<std::filesystem::path> MonsterCatalog::paths_for(const std::string& id, std::uint8_t mask) const {
+    std::vector<std::filesystem::path> paths;
+    if (mask & in_completed) paths.push_back(completed_dir_ / (id + ".json"));
+    if (mask & in_uncompleted) paths.push_back(uncompleted_dir_ / (id + ".json"));
+    return paths;
+}
+
+std::uint8_t MonsterCatalog::probe_locations(const std::string& id) const {
+    std::uint8_t mask = 0;
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(completed_dir_ / (id + ".json"), ec)) mask |= in_completed;
+    if (std::filesystem::is_regular_file(uncompleted_dir_ / (id + ".json"), ec)) mask |= in_uncompleted;
+    return mask;
+}
+
+std::vector<std::filesystem::path> MonsterCatalog::locate(const std::string& id) {
+    // IDs mit Pfadanteilen können nie direkt in einem der beiden Ordner liegen
+    if (id.empty() || id.find_first_of("/\\") != std::string::npos || id == "." || id == "..") {
+        return {};
+    }
+    {
+        std::shared_lock lock(mutex_);
+        auto it = locations_.find(id);
+        if (it != locations_.end()) {
+            location_counters_.hits.add();
+            return paths_for(id, it->second);
+        }
+        // Mit aufgebautem Index und laufendem Watcher ist jede fehlende ID eine echte Fehlanzeige
+        if (built_ && watcher_running_) {
+            location_counters_.hits.add();
+            return {};
+        }
+    }
+
+    location_counters_.misses.add();
+    const std::uint8_t mask = probe_locations(id);
+    if (built_) {
+        // Ohne Watcher als (ggf. negativen) Eintrag merken, die Schreib-Routen halten ihn aktuell
+        std::unique_lock lock(mutex_);
+        locations_.emplace(id, mask);
+    }
+    return paths_for(id, mask);
+}
+
+void MonsterCatalog::set_change_listener(std::function<void(const std::string& id)> listener) {
+    change_listener_ = std::move(listener);
+}
+
+void MonsterCatalog::upsert(const std::string& id, const json& data, const std::filesystem::path& path) {
+    MonsterSummary summary = summarize_monster(id, data, std::filesystem::absolute(path).lexically_normal());
+    {
+        std::unique_lock lock(mutex_);
+        set_location_locked(summary.path, true);
+        entries_[id] = std::move(summary); // Schreib-Routen sind maßgeblich, kein Rang-Vergleich
+        invalidate_views_locked();
+    }
+    if (change_listener_) change_listener_(id);
+}
+
+void MonsterCatalog::remove(const std::string& id) {
+    {
+        std::unique_lock lock(mutex_);
+        auto location = locations_.find(id);
+        if (location != locations_.end()) {
+            location->second = 0;
+        }
+        if (entries_.erase(id) > 0) {
+            invalidate_views_locked();
+        }
+    }
+    if (change_listener_) change_listener_(id);
+}
+
+void MonsterCatalog::refresh_file(const std::filesystem::path& path) {
+    const std::filesystem::path normal = std::filesystem::absolute(path).lexically_normal();
+    std::optional<MonsterSummary> summary = read_summary(normal);
+    {
+        std::unique_lock lock(mutex_);
+        set_location_locked(normal, true); // Auch unlesbare Dateien werden von load_monster_statblock gefunden
+        if (summary && try_insert_locked(std::move(*summary))) {
+            invalidate_views_locked();
+        }
+    }
+    if (change_listener_) change_listener_(normal.stem().string());
+}
+
+void MonsterCatalog::forget_file(const std::filesystem::path& path) {
+    const std::filesystem::path normal = std::filesystem::absolute(path).lexically_normal();
+    const std::string id = normal.stem().string();
+    if (change_listener_) change_listener_(id);
+    std::vector<std::filesystem::path> remaining;
+    {
+        std::unique_lock lock(mutex_);
+        set_location_locked(normal, false);
+        auto it = entries_.find(id);
+        if (it == entries_.end() || it->second.path != normal) {
+            return; // Eintrag stammt aus einer anderen Datei
+        }
+        entries_.erase(it);
+        invalidate_views_locked();
+        auto location = locations_.find(id);
+        if (location != locations_.end()) {
+            remaining = paths_for(id, location->second);
+        }
+    }
+
+    // Falls die ID noch in einem anderen Ordner liegt, diesen Eintrag wiederherstellen
+    if (!remaining.empty()) {
+        refresh_file(remaining.front());
+    }
+}
+
+std::shared_ptr<const std::string> MonsterCatalog::summary_body() {
+    ensure_built();
+    std::shared_lock lock(mutex_);
+    std::shared_ptr<const std::string> body = std::atomic_load(&cached_body_);
+    if (body) {
+        return body;
+    }
+
+    json monster_summary_list = json::array();
+    for (const auto& [id, summary] : entries_) {
+        json summary_item;
+        summary_item["id"] = summary.id;
+        summary_item["name"] = summary.name;
+        summary_item["cr"] = summary.cr;
+        summary_item["size"] = summary.size;
+        summary_item["type"] = summary.type;
+        summary_item["complete"] = summary.complete;
+        monster_summary_list.push_back(std::move(summary_item));
+    }
+    body = std::make_shared<const std::string>(monster_summary_list.dump());
+    // Unter dem Shared-Lock können keine Schreiber dazwischenkommen, parallele Leser erzeugen denselben Inhalt
+    std::atomic_store(&cached_body_, body);
+    return body;
+}
+
+void MonsterCatalog::invalidate_views_locked() {
+    std::atomic_store(&cached_body_, std::shared_ptr<const std::string>());
+    std::atomic_store(&cached_listing_, std::shared_ptr<const ListingIndex>());
+    std::atomic_store(&cached_snapshot_, std::shared_ptr<const std::vector<MonsterSummary>>());
+}
+
+std::shared_ptr<const std::vector<MonsterSummary>> MonsterCatalog::snapshot() {
+    ensure_built();
+    std::shared_lock lock(mutex_);
+    std::shared_ptr<const std::vector<MonsterSummary>> current = std::atomic_load(&cached_snapshot_);
+    if (current) {
+        return current;
+    }
+    auto copy = std::make_shared<std::vector<MonsterSummary>>();
+    copy->reserve(entries_.size());
+    for (const auto& [id, summary] : entries_) {
+        copy->push_back(summary);
+    }
+    current = std::move(copy);
+    // Parallele Leser unter dem Shared-Lock erzeugen denselben Inhalt; gewinnt einer, bleibt der Zeiger stabil
+    std::shared_ptr<const std::vector<MonsterSummary>> expected;
+    if (!std::atomic_compare_exchange_strong(&cached_snapshot_, &expected, current)) {
+        return expected;
+    }
+    return current;
+}
+
+std::shared_ptr<const ListingIndex> MonsterCatalog::listing_index() {
+    ensure_built();
+    std::shared_lock lock(mutex_);
+    std::shared_ptr<const ListingIndex> listing = std::atomic_load(&cached_listing_);
+    if (listing) {
+        return listing;
+    }
+    std::vector<json> rows;
+    rows.reserve(entries_.size());
+    for (const auto& [id, summary] : entries_) {
+        rows.push_back({{"id", summary.id}, {"name", summary.name}, {"cr", summary.cr}, {"size", summary.size},
+                        {"type", summary.type}, {"complete", summary.complete}});
+    }
+    listing = std::make_shared<const ListingIndex>(std::move(rows), std::vector<std::string>{"name", "cr", "type", "id"});
+    // Wie beim Body: unter dem Shared-Lock kann sich der Inhalt nicht ändern
+    std::atomic_store(&cached_listing_, listing);
+    return listing;
+}
+
+std::size_t MonsterCatalog::size() const {
+    std::shared_lock lock(mutex_);
+    return entries_.size();
+}
+
+std::vector<MonsterSummary> MonsterCatalog::entries() const {
+    std::shared_lock lock(mutex_);
+    std::vector<MonsterSummary> out;
+    out.reserve(entries_.size());
+    for (const auto& [id, summary] : entries_) {
+        out.push_back(summary);
+    }
+    return out;
+}
+
+// --- inotify-Watcher ---
+
+#ifdef __linux__
+
+void MonsterCatalog::start_watcher() {
+    if (watcher_running_.exchange(true)) {
+        return;
+    }
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotify_fd_ < 0 || stop_fd_ < 0) {
+        log_warn("inotify nicht verfügbar, Monster-Katalog wird nur über die API aktualisiert");
+        if (inotify_fd_ >= 0) close(inotify_fd_);
+        if (stop_fd_ >= 0) close(stop_fd_);
+        inotify_fd_ = stop_fd_ = -1;
+        watcher_running_ = false;
+        return;
+    }
+    watcher_thread_ = std::thread(&MonsterCatalog::watch_loop, this);
+}
+
+void MonsterCatalog::stop_watcher() {
+    if (!watcher_running_.exchange(false)) {
+        return;
+    }
+    const std::uint64_t one = 1;
+    if (write(stop_fd_, &one, sizeof(one)) < 0) {
+        log_warn("Konnte Monster-Watcher nicht signalisieren");
+    }
+    if (watcher_thread_.joinable()) {
+        watcher_thread_.join();
+    }
+    close(inotify_fd_);
+    close(stop_fd_);
+    inotify_fd_ = stop_fd_ = -1;
+}
+
+void MonsterCatalog::watch_loop() {
+    constexpr std::uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE;
+    std::map<int, std::filesystem::path> watched_dirs;
+
+    auto add_watch = [&](const std::filesystem::path& dir) {
+        int wd = inotify_add_watch(inotify_fd_, dir.c_str(), mask);
+        if (wd >= 0) {
+            watched_dirs[wd] = std::filesystem::absolute(dir).lexically_normal();
+        } else {
+            log_warn("Konnte Verzeichnis nicht überwachen", {{"path", dir.string()}});
+        }
+    };
+
+    try {
+        std::filesystem::create_directories(base_dir_);
+        add_watch(base_dir_);
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(base_dir_)) {
+            if (entry.is_directory()) {
+                add_watch(entry.path());
+            }
+        }
+    } catch (const std::exception& e) {
+        log_error("Fehler beim Einrichten des Monster-Watchers", {{"error", e.what()}});
+    }
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (watcher_running_) {
+        pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            continue; // EINTR
+        }
+        if (fds[1].revents & POLLIN) {
+            break;
+        }
+        ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+        if (length <= 0) {
+            continue;
+        }
+        for (char* ptr = buffer; ptr < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            auto dir_it = watched_dirs.find(event->wd);
+            if (dir_it == watched_dirs.end() || event->len == 0) {
+                continue;
+            }
+            const std::filesystem::path path = dir_it->second / event->name;
+
+            if (event->mask & IN_ISDIR) {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    add_watch(path);
+                    // Dateien, die vor dem Watch im neuen Ordner gelandet sind
+                    std::error_code ec;
+                    for (const auto& entry : std::filesystem::directory_iterator(path, ec)) {
+                        if (entry.is_regular_file() && is_monster_file(entry.path())) {
+                            refresh_file(entry.path());
+                        }
+                    }
+                }
+                continue;
+            }
+            if (!is_monster_file(path)) {
+                continue;
+            }
+            if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                refresh_file(path);
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                forget_file(path);
+            }
+        }
+    }
+}
+
+#else
+
+void MonsterCatalog::start_watcher() {
+    log_info("Monster-Watcher wird nur unter Linux unterstützt");
+}
+
+void MonsterCatalog::stop_watcher() {}
+
+void MonsterCatalog::watch_loop() {}
+
+#endif
+// --- Ende inotify-Watcher ---
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "listing_index.h"
+#include "metrics.h"
+
+class CatalogPack;
+
+// --- Monster-Katalog (Zusammenfassungen aller Statblocks im Speicher) ---
+// Wird beim Start einmal (parallel) aufgebaut und danach von den PUT/DELETE-Handlern
+// sowie einem inotify-Watcher aktuell gehalten. /api/monsters/summary liefert dadurch
+// ohne Dateizugriff aus dem Speicher.
+//
+// Zusätzlich merkt sich der Katalog, in welchen der Ordner completed/ und uncompleted/
+// eine ID liegt (auch für Dateien, die sich nicht parsen lassen). locate() beantwortet
+// Lookups damit ohne stat-Aufrufe, fehlende IDs eingeschlossen.
+
+struct MonsterSummary {
+    std::string id;
+    std::string name;
+    double cr = 0.0;
+    std::string size;
+    std::string type;
+    bool complete = false;
+    std::filesystem::path path; // Datei, aus der der Eintrag stammt
+
+    // Filterbare Attribute für /api/monsters/query (Werte wie im Statblock)
+    std::string alignment;
+    std::vector<std::string> languages; // basics.languages an ',' bzw. ';' getrennt
+    std::vector<std::string> movement;  // speeds[].type mit speed > 0
+    std::vector<std::string> resistances;
+    std::vector<std::string> immunities;
+    std::vector<std::string> vulnerabilities;
+    std::vector<std::string> condition_immunities;
+};
+
+// Baut eine Zusammenfassung aus einem geparsten Statblock (gleiche Defaults wie bisher)
+MonsterSummary summarize_monster(const std::string& id, const nlohmann::json& data, const std::filesystem::path& path);
+
+class MonsterCatalog {
+public:
+    explicit MonsterCatalog(std::filesystem::path base_dir);
+    ~MonsterCatalog();
+
+    MonsterCatalog(const MonsterCatalog&) = delete;
+    MonsterCatalog& operator=(const MonsterCatalog&) = delete;
+
+    // Catalog-Pack für build(): unveränderte Statblocks liefern ihre Zusammenfassung ohne Parsen.
+    // Nur vor dem ersten build() setzen.
+    void set_pack(std::shared_ptr<const CatalogPack> pack) { pack_ = std::move(pack); }
+
+    // Liest alle Statblocks unter base_dir parallel ein und ersetzt den Index
+    void build();
+    // Baut den Index beim ersten Aufruf (Warm-Start oder erste Anfrage, je nachdem was früher kommt)
+    void ensure_built();
+
+    // Aktualisiert/entfernt Einträge (von den Schreib-Routen aufgerufen)
+    void upsert(const std::string& id, const nlohmann::json& data, const std::filesystem::path& path);
+    void remove(const std::string& id);
+
+    // Wird nach jeder Änderung an einer ID aufgerufen (Schreib-Routen und Watcher), z.B. um Caches
+    // zu invalidieren. Nur vor dem Serverstart setzen; läuft ohne gehaltenen Lock.
+    void set_change_listener(std::function<void(const std::string& id)> listener);
+
+    // Liest eine einzelne Datei neu ein bzw. entfernt den Eintrag, der aus ihr stammt
+    void refresh_file(const std::filesystem::path& path);
+    void forget_file(const std::filesystem::path& path);
+
+    // Serialisiertes JSON-Array aller Zusammenfassungen (wird nur nach Änderungen neu erzeugt)
+    std::shared_ptr<const std::string> summary_body();
+
+    // Pfade von <id>.json in completed/ und uncompleted/ (completed zuerst), leer = nicht vorhanden.
+    // Nach dem Aufbau aus dem Index ohne Dateisystemzugriff; vorher (oder ohne Watcher bei
+    // unbekannten IDs) wird einmal nachgesehen und das Ergebnis gemerkt.
+    std::vector<std::filesystem::path> locate(const std::string& id);
+
+    // Vorsortierte Listen für ?limit/cursor/sort/fields (wird nur nach Änderungen neu aufgebaut)
+    std::shared_ptr<const ListingIndex> listing_index();
+
+    std::size_t size() const;
+    // Kopie aller Einträge (nach ID sortiert), z.B. für katalogweite Auswertungen
+    std::vector<MonsterSummary> entries() const;
+    // Wie entries(), aber geteilt und nur nach Änderungen neu erzeugt. Ein neuer Zeiger bedeutet
+    // geänderten Inhalt (geeignet als Quelle für SourceBound)
+    std::shared_ptr<const std::vector<MonsterSummary>> snapshot();
+
+    // Dateisystem-Watcher (inotify, nur Linux)
+    void start_watcher();
+    void stop_watcher();
+
+private:
+    static constexpr std::uint8_t in_completed = 1;
+    static constexpr std::uint8_t in_uncompleted = 2;
+
+    bool try_insert_locked(MonsterSummary summary);
+    void invalidate_views_locked(); // Body und Listen-Index verwerfen
+    // Ordner-Bit für eine Datei direkt in completed/ bzw. uncompleted/, sonst 0
+    std::uint8_t location_bit(const std::filesystem::path& normal_path) const;
+    void set_location_locked(const std::filesystem::path& normal_path, bool present);
+    std::vector<std::filesystem::path> paths_for(const std::string& id, std::uint8_t mask) const;
+    std::uint8_t probe_locations(const std::string& id) const;
+    void watch_loop();
+
+    std::filesystem::path base_dir_;
+    std::filesystem::path completed_dir_;   // absolut und normalisiert
+    std::filesystem::path uncompleted_dir_;
+    std::shared_ptr<const CatalogPack> pack_;
+    std::once_flag built_once_;
+    std::atomic<bool> built_{false};
+
+    mutable std::shared_mutex mutex_;
+    std::map<std::string, MonsterSummary> entries_;
+    mutable std::shared_ptr<const std::string> cached_body_; // nullptr = veraltet
+    mutable std::shared_ptr<const ListingIndex> cached_listing_;
+    mutable std::shared_ptr<const std::vector<MonsterSummary>> cached_snapshot_;
+    // ID -> Ordner-Bits; 0 = gemerkte Fehlanzeige (nur ohne Watcher nötig, mit Watcher ist der Index vollständig)
+    std::unordered_map<std::string, std::uint8_t> locations_;
+    CacheCounters& location_counters_;
+    std::function<void(const std::string&)> change_listener_;
+
+    std::thread watcher_thread_;
+    std::atomic<bool> watcher_running_{false};
+    int inotify_fd_ = -1;
+    int stop_fd_ = -1;
+};
+// --- Ende Monster-Katalog ---
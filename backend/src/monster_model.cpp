@@ -0,0 +1,462 @@
+#include "monster_model.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+// --- SymbolTable ---
+
+SymbolTable& SymbolTable::global() {
+    static SymbolTable table;
+    return table;
+}
+
+Symbol SymbolTable::intern(std::string_view text) {
+    {
+        std::shared_lock lock(mutex_);
+        auto it = index_.find(text);
+        if (it != index_.end()) return it->second;
+    }
+    std::unique_lock lock(mutex_);
+    auto it = index_.find(text); // Ein anderer Thread kann inzwischen eingetragen haben
+    if (it != index_.end()) return it->second;
+    const Symbol symbol = static_cast<Symbol>(texts_.size());
+    const std::string& stored = texts_.emplace_back(text);
+    index_.emplace(std::string_view(stored), symbol);
+    return symbol;
+}
+
+std::string_view SymbolTable::text(Symbol symbol) const {
+    std::shared_lock lock(mutex_);
+    return symbol < texts_.size() ? std::string_view(texts_[symbol]) : std::string_view();
+}
+
+std::size_t SymbolTable::size() const {
+    std::shared_lock lock(mutex_);
+    return texts_.size();
+}
+
+// --- Kodierung json -> CompactMonster ---
+// Jedes take_* speichert einen Wert typisiert (true) oder lehnt ihn ab (false); abgelehnte Werte
+// landen unverändert im extra-Objekt der jeweiligen Ebene. Verschachtelte Objekte (HP, Initiative,
+// stats, safeDC, limitedUse) werden nur typisiert, wenn alle ihre Schlüssel passen, sonst komplett
+// als JSON-Text behalten.
+
+class MonsterEncoder {
+public:
+    explicit MonsterEncoder(CompactMonster& monster) : monster_(monster) {}
+
+    void encode(const json& statblock) {
+        json rest = json::object();
+        for (const auto& [key, value] : statblock.items()) {
+            bool stored = false;
+            if (key == "basics" && value.is_object()) {
+                encode_basics(value);
+                monster_.has_basics_ = stored = true;
+            } else if (key == "actions") {
+                stored = encode_group(value, ActionGroup::action);
+            } else if (key == "bonusAction") {
+                stored = encode_group(value, ActionGroup::bonus_action);
+            }
+            if (!stored) rest[key] = value;
+        }
+        monster_.rest_ = store_extra(rest);
+        monster_.actions_.shrink_to_fit();
+        monster_.damage_.shrink_to_fit();
+        monster_.text_.shrink_to_fit();
+    }
+
+private:
+    TextRef store_text(const std::string& text) {
+        TextRef ref{static_cast<std::uint32_t>(monster_.text_.size()), static_cast<std::uint32_t>(text.size())};
+        monster_.text_ += text;
+        return ref;
+    }
+
+    TextRef store_extra(const json& extra) {
+        return extra.empty() ? TextRef{} : store_text(extra.dump());
+    }
+
+    static void mark(FieldMask& fields, unsigned field, bool is_null) {
+        fields.present |= 1u << field;
+        if (is_null) fields.nulls |= 1u << field;
+    }
+
+    template <typename Int>
+    static bool take_int(const json& value, Int& out, FieldMask& fields, unsigned field) {
+        if (value.is_null()) {
+            mark(fields, field, true);
+            return true;
+        }
+        if (value.is_number_unsigned()) {
+            const auto number = value.get<std::uint64_t>();
+            if (number > static_cast<std::uint64_t>(std::numeric_limits<Int>::max())) return false;
+            out = static_cast<Int>(number);
+        } else if (value.is_number_integer()) {
+            const auto number = value.get<std::int64_t>();
+            if (number < std::numeric_limits<Int>::min() || number > std::numeric_limits<Int>::max()) return false;
+            out = static_cast<Int>(number);
+        } else {
+            return false;
+        }
+        mark(fields, field, false);
+        return true;
+    }
+
+    static bool take_bool(const json& value, bool& out, FieldMask& fields, unsigned field) {
+        if (!value.is_boolean() && !value.is_null()) return false;
+        if (value.is_boolean()) out = value.get<bool>();
+        mark(fields, field, value.is_null());
+        return true;
+    }
+
+    static bool take_symbol(const json& value, Symbol& out, FieldMask& fields, unsigned field) {
+        if (!value.is_string() && !value.is_null()) return false;
+        if (value.is_string()) out = SymbolTable::global().intern(value.get_ref<const std::string&>());
+        mark(fields, field, value.is_null());
+        return true;
+    }
+
+    bool take_text(const json& value, TextRef& out, FieldMask& fields, unsigned field) {
+        if (!value.is_string() && !value.is_null()) return false;
+        if (value.is_string()) out = store_text(value.get_ref<const std::string&>());
+        mark(fields, field, value.is_null());
+        return true;
+    }
+
+    // Verschachteltes Objekt: take(key, value) für jeden Schlüssel, bei einem Fehlschlag alles zurück
+    template <typename Take>
+    static bool take_nested(const json& value, FieldMask& fields, unsigned field, Take&& take) {
+        if (!value.is_object()) return false;
+        const FieldMask saved = fields;
+        for (const auto& [key, child] : value.items()) {
+            if (!take(key, child)) {
+                fields = saved;
+                return false;
+            }
+        }
+        mark(fields, field, false);
+        return true;
+    }
+
+    void encode_basics(const json& basics) {
+        CompactMonster& m = monster_;
+        FieldMask& f = m.basics_fields_;
+        json extra = json::object();
+        for (const auto& [key, value] : basics.items()) {
+            bool stored = false;
+            if (key == "name") stored = take_text(value, m.name_, f, CompactMonster::field_name);
+            else if (key == "id") stored = take_text(value, m.id_, f, CompactMonster::field_id);
+            else if (key == "languages") stored = take_text(value, m.languages_, f, CompactMonster::field_languages);
+            else if (key == "ACType") stored = take_text(value, m.ac_type_, f, CompactMonster::field_ac_type);
+            else if (key == "CR") stored = take_cr(value);
+            else if (key == "PB") stored = take_int(value, m.pb_, f, CompactMonster::field_pb);
+            else if (key == "AC") stored = take_int(value, m.ac_, f, CompactMonster::field_ac);
+            else if (key == "size") stored = take_symbol(value, m.size_, f, CompactMonster::field_size);
+            else if (key == "type") stored = take_symbol(value, m.type_, f, CompactMonster::field_type);
+            else if (key == "alignment") stored = take_symbol(value, m.alignment_, f, CompactMonster::field_alignment);
+            else if (key == "HP") {
+                stored = take_nested(value, f, CompactMonster::field_hp, [&](const std::string& k, const json& v) {
+                    if (k == "defaultDie") return take_int(v, m.default_die_, f, CompactMonster::field_hp_default_die);
+                    if (k == "overrideDie") return take_int(v, m.override_die_, f, CompactMonster::field_hp_override_die);
+                    if (k == "HDAmount") return take_int(v, m.hd_amount_, f, CompactMonster::field_hp_amount);
+                    if (k == "HPmodifier") return take_int(v, m.hp_modifier_, f, CompactMonster::field_hp_modifier);
+                    return false;
+                });
+            } else if (key == "Initiative") {
+                stored = take_nested(value, f, CompactMonster::field_initiative, [&](const std::string& k, const json& v) {
+                    if (k == "initDefaultValue") return take_int(v, m.init_default_, f, CompactMonster::field_init_default);
+                    if (k == "initOverrideValue") return take_int(v, m.init_override_, f, CompactMonster::field_init_override);
+                    if (k == "initProficiency") return take_bool(v, m.init_proficiency_, f, CompactMonster::field_init_proficiency);
+                    if (k == "initExpertise") return take_bool(v, m.init_expertise_, f, CompactMonster::field_init_expertise);
+                    return false;
+                });
+            } else if (key == "stats") {
+                stored = take_nested(value, f, CompactMonster::field_stats, [&](const std::string& k, const json& v) {
+                    for (std::size_t i = 0; i < CompactMonster::stat_names.size(); ++i) {
+                        if (k == CompactMonster::stat_names[i]) {
+                            return take_int(v, m.stats_[i], f, CompactMonster::field_stat_first + static_cast<unsigned>(i));
+                        }
+                    }
+                    return false;
+                });
+            }
+            if (!stored) extra[key] = value;
+        }
+        m.basics_extra_ = store_extra(extra);
+    }
+
+    bool take_cr(const json& value) {
+        FieldMask& f = monster_.basics_fields_;
+        if (value.is_null()) {
+            mark(f, CompactMonster::field_cr, true);
+            return true;
+        }
+        if (value.is_number_float()) {
+            monster_.cr_ = value.get<double>();
+        } else if (value.is_number_integer()) {
+            const auto number = value.get<std::int64_t>();
+            constexpr std::int64_t exact = std::int64_t(1) << 53; // Darüber nicht mehr exakt als double
+            if (number < -exact || number > exact || (value.is_number_unsigned() && value.get<std::uint64_t>() > static_cast<std::uint64_t>(exact))) return false;
+            monster_.cr_ = static_cast<double>(number);
+            monster_.cr_integer_ = true;
+        } else {
+            return false;
+        }
+        mark(f, CompactMonster::field_cr, false);
+        return true;
+    }
+
+    // {"attackRoll": [...], "savingThrow": [...], "other": [...]}; false = nicht typisierbar
+    bool encode_group(const json& value, ActionGroup group_id) {
+        if (!value.is_object()) return false;
+        CompactMonster::Group& group = monster_.groups_[static_cast<std::size_t>(group_id)];
+        json extra = json::object();
+        for (const auto& [key, list] : value.items()) {
+            ActionKind kind;
+            if (key == "attackRoll") kind = ActionKind::attack_roll;
+            else if (key == "savingThrow") kind = ActionKind::saving_throw;
+            else if (key == "other") kind = ActionKind::other;
+            else {
+                extra[key] = list;
+                continue;
+            }
+            const bool all_objects = list.is_array() && std::all_of(list.begin(), list.end(), [](const json& item) { return item.is_object(); });
+            if (!all_objects) {
+                extra[key] = list;
+                continue;
+            }
+            CompactMonster::Range& range = group.ranges[static_cast<std::size_t>(kind)];
+            range.first = static_cast<std::uint32_t>(monster_.actions_.size());
+            range.count = static_cast<std::uint32_t>(list.size());
+            for (const json& data : list) {
+                monster_.actions_.push_back(encode_action(data, kind));
+            }
+            group.kinds |= static_cast<std::uint8_t>(1u << static_cast<unsigned>(kind));
+        }
+        group.extra = store_extra(extra);
+        group.present = true;
+        return true;
+    }
+
+    CompactAction encode_action(const json& data, ActionKind kind) {
+        CompactAction action;
+        action.kind = kind;
+        FieldMask& f = action.fields;
+        json extra = json::object();
+        for (const auto& [key, value] : data.items()) {
+            bool stored = false;
+            if (key == "name") stored = take_text(value, action.name, f, CompactAction::field_name);
+            else if (key == "notes") stored = take_text(value, action.notes, f, CompactAction::field_notes);
+            else if (key == "description") stored = take_text(value, action.description, f, CompactAction::field_description);
+            else if (key == "attackMod") stored = take_int(value, action.attack_mod, f, CompactAction::field_attack_mod);
+            else if (key == "reachMelee") stored = take_int(value, action.reach_melee, f, CompactAction::field_reach_melee);
+            else if (key == "reachRanged") stored = take_int(value, action.reach_ranged, f, CompactAction::field_reach_ranged);
+            else if (key == "reachDisadvantage") stored = take_int(value, action.reach_disadvantage, f, CompactAction::field_reach_disadvantage);
+            else if (key == "rangeType") stored = take_symbol(value, action.range_type, f, CompactAction::field_range_type);
+            else if (key == "recharge") stored = take_symbol(value, action.recharge, f, CompactAction::field_recharge);
+            else if (key == "saveStat") stored = take_symbol(value, action.save_stat, f, CompactAction::field_save_stat);
+            else if (key == "damage") stored = take_damage(value, action);
+            else if (key == "safeDC") {
+                stored = take_nested(value, f, CompactAction::field_safe_dc, [&](const std::string& k, const json& v) {
+                    if (k == "defaultValue") return take_int(v, action.dc_default, f, CompactAction::field_dc_default);
+                    if (k == "overrideValue") return take_int(v, action.dc_override, f, CompactAction::field_dc_override);
+                    return false;
+                });
+            } else if (key == "limitedUse") {
+                stored = take_nested(value, f, CompactAction::field_limited_use, [&](const std::string& k, const json& v) {
+                    if (k == "count") return take_int(v, action.limited_count, f, CompactAction::field_limited_count);
+                    if (k == "rate") return take_symbol(v, action.limited_rate, f, CompactAction::field_limited_rate);
+                    return false;
+                });
+            }
+            if (!stored) extra[key] = value;
+        }
+        action.extra = store_extra(extra);
+        return action;
+    }
+
+    bool take_damage(const json& value, CompactAction& action) {
+        if (!value.is_array() || !std::all_of(value.begin(), value.end(), [](const json& item) { return item.is_object(); })) return false;
+        action.first_damage = static_cast<std::uint32_t>(monster_.damage_.size());
+        action.damage_count = static_cast<std::uint32_t>(value.size());
+        for (const json& data : value) {
+            CompactDamage damage;
+            FieldMask& f = damage.fields;
+            json extra = json::object();
+            for (const auto& [key, item] : data.items()) {
+                bool stored = false;
+                if (key == "count") stored = take_int(item, damage.count, f, CompactDamage::field_count);
+                else if (key == "size") stored = take_int(item, damage.size, f, CompactDamage::field_size);
+                else if (key == "modifier") stored = take_int(item, damage.modifier, f, CompactDamage::field_modifier);
+                else if (key == "averageDamage") stored = take_int(item, damage.average, f, CompactDamage::field_average);
+                else if (key == "type") stored = take_symbol(item, damage.type, f, CompactDamage::field_type);
+                if (!stored) extra[key] = item;
+            }
+            damage.extra = store_extra(extra);
+            monster_.damage_.push_back(damage);
+        }
+        mark(action.fields, CompactAction::field_damage, false);
+        return true;
+    }
+
+    CompactMonster& monster_;
+};
+
+// --- Dekodierung CompactMonster -> json ---
+
+class MonsterDecoder {
+public:
+    explicit MonsterDecoder(const CompactMonster& monster) : monster_(monster) {}
+
+    json decode() const {
+        const CompactMonster& m = monster_;
+        json out = extra(m.rest_);
+        if (m.has_basics_) out["basics"] = decode_basics();
+        static const char* group_keys[] = {"actions", "bonusAction"};
+        for (std::size_t g = 0; g < m.groups_.size(); ++g) {
+            if (m.groups_[g].present) out[group_keys[g]] = decode_group(m.groups_[g]);
+        }
+        return out;
+    }
+
+private:
+    json extra(TextRef ref) const {
+        return ref.length == 0 ? json::object() : json::parse(monster_.text(ref));
+    }
+
+    static void put_int(json& out, const char* key, std::int64_t value, const FieldMask& fields, unsigned field) {
+        if (fields.has(field)) out[key] = fields.is_null(field) ? json(nullptr) : json(value);
+    }
+
+    static void put_bool(json& out, const char* key, bool value, const FieldMask& fields, unsigned field) {
+        if (fields.has(field)) out[key] = fields.is_null(field) ? json(nullptr) : json(value);
+    }
+
+    static void put_symbol(json& out, const char* key, Symbol value, const FieldMask& fields, unsigned field) {
+        if (fields.has(field)) out[key] = fields.is_null(field) ? json(nullptr) : json(std::string(SymbolTable::global().text(value)));
+    }
+
+    void put_text(json& out, const char* key, TextRef value, const FieldMask& fields, unsigned field) const {
+        if (fields.has(field)) out[key] = fields.is_null(field) ? json(nullptr) : json(std::string(monster_.text(value)));
+    }
+
+    json decode_basics() const {
+        const CompactMonster& m = monster_;
+        const FieldMask& f = m.basics_fields_;
+        json out = extra(m.basics_extra_);
+        put_text(out, "name", m.name_, f, CompactMonster::field_name);
+        put_text(out, "id", m.id_, f, CompactMonster::field_id);
+        put_text(out, "languages", m.languages_, f, CompactMonster::field_languages);
+        put_text(out, "ACType", m.ac_type_, f, CompactMonster::field_ac_type);
+        if (f.has(CompactMonster::field_cr)) {
+            out["CR"] = f.is_null(CompactMonster::field_cr) ? json(nullptr) : m.cr_integer_ ? json(static_cast<std::int64_t>(m.cr_)) : json(m.cr_);
+        }
+        put_int(out, "PB", m.pb_, f, CompactMonster::field_pb);
+        put_int(out, "AC", m.ac_, f, CompactMonster::field_ac);
+        put_symbol(out, "size", m.size_, f, CompactMonster::field_size);
+        put_symbol(out, "type", m.type_, f, CompactMonster::field_type);
+        put_symbol(out, "alignment", m.alignment_, f, CompactMonster::field_alignment);
+        if (f.has(CompactMonster::field_hp)) {
+            json& hp = out["HP"] = json::object();
+            put_int(hp, "defaultDie", m.default_die_, f, CompactMonster::field_hp_default_die);
+            put_int(hp, "overrideDie", m.override_die_, f, CompactMonster::field_hp_override_die);
+            put_int(hp, "HDAmount", m.hd_amount_, f, CompactMonster::field_hp_amount);
+            put_int(hp, "HPmodifier", m.hp_modifier_, f, CompactMonster::field_hp_modifier);
+        }
+        if (f.has(CompactMonster::field_initiative)) {
+            json& initiative = out["Initiative"] = json::object();
+            put_int(initiative, "initDefaultValue", m.init_default_, f, CompactMonster::field_init_default);
+            put_int(initiative, "initOverrideValue", m.init_override_, f, CompactMonster::field_init_override);
+            put_bool(initiative, "initProficiency", m.init_proficiency_, f, CompactMonster::field_init_proficiency);
+            put_bool(initiative, "initExpertise", m.init_expertise_, f, CompactMonster::field_init_expertise);
+        }
+        if (f.has(CompactMonster::field_stats)) {
+            json& stats = out["stats"] = json::object();
+            for (std::size_t i = 0; i < CompactMonster::stat_names.size(); ++i) {
+                put_int(stats, CompactMonster::stat_names[i], m.stats_[i], f, CompactMonster::field_stat_first + static_cast<unsigned>(i));
+            }
+        }
+        return out;
+    }
+
+    json decode_group(const CompactMonster::Group& group) const {
+        static const char* kind_keys[] = {"attackRoll", "savingThrow", "other"};
+        json out = extra(group.extra);
+        for (std::size_t k = 0; k < group.ranges.size(); ++k) {
+            if (!((group.kinds >> k) & 1u)) continue;
+            json list = json::array();
+            const CompactMonster::Range& range = group.ranges[k];
+            for (std::uint32_t i = range.first; i < range.first + range.count; ++i) {
+                list.push_back(decode_action(monster_.actions_[i]));
+            }
+            out[kind_keys[k]] = std::move(list);
+        }
+        return out;
+    }
+
+    json decode_action(const CompactAction& action) const {
+        const FieldMask& f = action.fields;
+        json out = extra(action.extra);
+        put_text(out, "name", action.name, f, CompactAction::field_name);
+        put_text(out, "notes", action.notes, f, CompactAction::field_notes);
+        put_text(out, "description", action.description, f, CompactAction::field_description);
+        put_int(out, "attackMod", action.attack_mod, f, CompactAction::field_attack_mod);
+        put_int(out, "reachMelee", action.reach_melee, f, CompactAction::field_reach_melee);
+        put_int(out, "reachRanged", action.reach_ranged, f, CompactAction::field_reach_ranged);
+        put_int(out, "reachDisadvantage", action.reach_disadvantage, f, CompactAction::field_reach_disadvantage);
+        put_symbol(out, "rangeType", action.range_type, f, CompactAction::field_range_type);
+        put_symbol(out, "recharge", action.recharge, f, CompactAction::field_recharge);
+        put_symbol(out, "saveStat", action.save_stat, f, CompactAction::field_save_stat);
+        if (f.has(CompactAction::field_safe_dc)) {
+            json& dc = out["safeDC"] = json::object();
+            put_int(dc, "defaultValue", action.dc_default, f, CompactAction::field_dc_default);
+            put_int(dc, "overrideValue", action.dc_override, f, CompactAction::field_dc_override);
+        }
+        if (f.has(CompactAction::field_limited_use)) {
+            json& limited = out["limitedUse"] = json::object();
+            put_int(limited, "count", action.limited_count, f, CompactAction::field_limited_count);
+            put_symbol(limited, "rate", action.limited_rate, f, CompactAction::field_limited_rate);
+        }
+        if (f.has(CompactAction::field_damage)) {
+            json list = json::array();
+            for (std::uint32_t i = action.first_damage; i < action.first_damage + action.damage_count; ++i) {
+                const CompactDamage& damage = monster_.damage_[i];
+                json term = extra(damage.extra);
+                put_int(term, "count", damage.count, damage.fields, CompactDamage::field_count);
+                put_int(term, "size", damage.size, damage.fields, CompactDamage::field_size);
+                put_int(term, "modifier", damage.modifier, damage.fields, CompactDamage::field_modifier);
+                put_int(term, "averageDamage", damage.average, damage.fields, CompactDamage::field_average);
+                put_symbol(term, "type", damage.type, damage.fields, CompactDamage::field_type);
+                list.push_back(std::move(term));
+            }
+            out["damage"] = std::move(list);
+        }
+        return out;
+    }
+
+    const CompactMonster& monster_;
+};
+
+// --- CompactMonster ---
+
+CompactMonster CompactMonster::from_json(const json& statblock) {
+    if (!statblock.is_object()) {
+        throw std::invalid_argument("Statblock must be a JSON object.");
+    }
+    CompactMonster monster;
+    MonsterEncoder(monster).encode(statblock);
+    return monster;
+}
+
+json CompactMonster::to_json() const {
+    return MonsterDecoder(*this).decode();
+}
+
+std::size_t CompactMonster::memory_size() const {
+    const std::size_t text_heap = text_.capacity() > 15 ? text_.capacity() + 1 : 0; // Kurze Strings liegen im Objekt (SSO)
+    return sizeof(CompactMonster) + actions_.capacity() * sizeof(CompactAction) + damage_.capacity() * sizeof(CompactDamage) + text_heap;
+}
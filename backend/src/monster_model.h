@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+// --- Kompaktes, typisiertes Monster-Modell ---
+// Ersatz für einen resident gehaltenen json-Baum (pro Objekt eine std::map, pro Schlüssel ein
+// Heap-String, grob 10x Dateigröße). Typisiert sind basics (inkl. HP, Initiative, stats) sowie
+// actions/bonusAction mit attackRoll/savingThrow/other und deren Schaden:
+//   - wiederkehrendes Vokabular (Schadensarten, Größen, Typen, Attribute, Recharge, ...) als Symbol
+//     aus einer globalen Tabelle (4 Byte statt String),
+//   - die sechs Attributwerte als festes Array,
+//   - alle Aktionen, Schadensterme und Texte eines Monsters in je einem zusammenhängenden Array
+//     (Arena pro Monster, keine Allokation pro Aktion oder String).
+// Alles andere (saves, senses, spellcasting, traits, ...) und jeder Wert, der nicht zum erwarteten
+// Typ passt, bleibt als kompakter JSON-Text erhalten. to_json() liefert dadurch exakt das Dokument,
+// aus dem das Modell gebaut wurde (gleich per json::operator==). Das Modell dient nur als
+// speichersparende Ablage im Statblock-Cache; gelesen wird es ausschließlich über to_json().
+
+using Symbol = std::uint32_t;
+
+class SymbolTable {
+public:
+    static SymbolTable& global();
+
+    Symbol intern(std::string_view text);
+    // Bleibt gültig, solange das Programm läuft (Einträge werden nie entfernt)
+    std::string_view text(Symbol symbol) const;
+    std::size_t size() const;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> texts_; // Stabile Adressen für die string_views im Index
+    std::unordered_map<std::string_view, Symbol> index_;
+};
+
+// Ausschnitt aus dem Text-Array eines Monsters
+struct TextRef {
+    std::uint32_t offset = 0;
+    std::uint32_t length = 0;
+};
+
+// Gesetzte bzw. explizit null gesetzte Felder (Bit = Feld-Enum des jeweiligen Typs)
+struct FieldMask {
+    std::uint32_t present = 0;
+    std::uint32_t nulls = 0;
+
+    bool has(unsigned field) const { return (present >> field) & 1u; }
+    bool is_null(unsigned field) const { return (nulls >> field) & 1u; }
+    bool has_value(unsigned field) const { return has(field) && !is_null(field); }
+};
+
+struct CompactDamage {
+    enum Field : unsigned { field_count, field_size, field_modifier, field_average, field_type };
+
+    std::int32_t count = 0;
+    std::int32_t size = 0;
+    std::int32_t modifier = 0;
+    std::int32_t average = 0; // averageDamage
+    Symbol type = 0;
+    FieldMask fields;
+    TextRef extra; // Nicht typisierte Felder als JSON-Objekt (leer = keine)
+};
+
+enum class ActionKind : std::uint8_t { attack_roll, saving_throw, other };
+enum class ActionGroup : std::uint8_t { action, bonus_action };
+
+struct CompactAction {
+    enum Field : unsigned {
+        field_name, field_notes, field_description, field_attack_mod, field_range_type, field_reach_melee, field_reach_ranged,
+        field_reach_disadvantage, field_recharge, field_save_stat, field_damage, field_safe_dc, field_dc_default, field_dc_override,
+        field_limited_use, field_limited_count, field_limited_rate
+    };
+
+    TextRef name;
+    TextRef notes;
+    TextRef description;
+    std::int32_t attack_mod = 0;
+    std::int32_t reach_melee = 0;
+    std::int32_t reach_ranged = 0;
+    std::int32_t reach_disadvantage = 0;
+    std::int32_t dc_default = 0;     // safeDC.defaultValue
+    std::int32_t dc_override = 0;    // safeDC.overrideValue
+    std::int32_t limited_count = 0;  // limitedUse.count
+    Symbol range_type = 0;
+    Symbol recharge = 0;
+    Symbol save_stat = 0;
+    Symbol limited_rate = 0;         // limitedUse.rate
+    std::uint32_t first_damage = 0;  // Index in die Schadensterme des Monsters
+    std::uint32_t damage_count = 0;
+    ActionKind kind = ActionKind::other;
+    FieldMask fields;
+    TextRef extra;
+};
+
+class CompactMonster {
+public:
+    static constexpr std::array<const char*, 6> stat_names = {"STR", "DEX", "CON", "INT", "WIS", "CHA"};
+
+    enum BasicsField : unsigned {
+        field_name, field_id, field_languages, field_ac_type, field_cr, field_pb, field_ac, field_size, field_type, field_alignment,
+        field_hp, field_hp_default_die, field_hp_override_die, field_hp_amount, field_hp_modifier,
+        field_initiative, field_init_default, field_init_override, field_init_proficiency, field_init_expertise,
+        field_stats, field_stat_first // field_stat_first + i für stat_names[i]
+    };
+
+    // Wirft std::invalid_argument, wenn statblock kein Objekt ist
+    static CompactMonster from_json(const nlohmann::json& statblock);
+    nlohmann::json to_json() const;
+
+    // Heap- plus Objektgröße (für das Budget des Statblock-Caches)
+    std::size_t memory_size() const;
+
+private:
+    std::string_view text(TextRef ref) const { return std::string_view(text_).substr(ref.offset, ref.length); }
+
+    struct Range {
+        std::uint32_t first = 0;
+        std::uint32_t count = 0;
+    };
+    struct Group {
+        bool present = false;       // Schlüssel im Dokument vorhanden und als Objekt typisiert
+        std::uint8_t kinds = 0;     // Bit pro ActionKind: Array vorhanden
+        std::array<Range, 3> ranges; // Index = ActionKind
+        TextRef extra;
+    };
+
+    std::vector<CompactAction> actions_;
+    std::vector<CompactDamage> damage_;
+    std::string text_; // Alle Texte und nicht typisierten JSON-Reste des Monsters
+
+    FieldMask basics_fields_;
+    TextRef name_, id_, languages_, ac_type_;
+    double cr_ = 0.0;
+    bool cr_integer_ = false; // CR stand als Ganzzahl im Dokument (für die exakte Ausgabe)
+    std::int32_t pb_ = 0, ac_ = 0;
+    Symbol size_ = 0, type_ = 0, alignment_ = 0;
+    std::int32_t default_die_ = 0, override_die_ = 0, hd_amount_ = 0, hp_modifier_ = 0;
+    std::int32_t init_default_ = 0, init_override_ = 0;
+    bool init_proficiency_ = false, init_expertise_ = false;
+    std::array<std::int16_t, 6> stats_{};
+    TextRef basics_extra_;
+    bool has_basics_ = false;
+
+    std::array<Group, 2> groups_; // Index = ActionGroup
+    TextRef rest_;                // Übrige Top-Level-Schlüssel als JSON-Objekt
+
+    friend class MonsterEncoder;
+    friend class MonsterDecoder;
+};
+// --- Ende kompaktes Monster-Modell ---
@@ -0,0 +1,251 @@
+#include "monster_query.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string lowercase(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+// Eintrag des Vokabulars zu einem (klein geschriebenen) Wert; nur exakte Treffer, keine Präfixe
+// ("firearm" ist nicht "fire", type=d ist kein Typ)
+std::optional<std::string> match_vocabulary(const std::vector<std::string>& vocabulary, const std::string& lowered) {
+    for (const std::string& entry : vocabulary) {
+        if (entry == lowered) return entry;
+    }
+    return std::nullopt;
+}
+
+constexpr const char* damage_attributes[] = {"resist", "immune", "vulnerable"};
+
+} // namespace
+
+// --- RoaringBitmap ---
+
+void RoaringBitmap::append(std::uint32_t row) {
+    const std::uint32_t key = row >> 16;
+    const auto offset = static_cast<std::uint16_t>(row & 0xFFFF);
+    if (containers_.empty() || containers_.back().key != key) {
+        containers_.push_back(Container{key, {}, {}, 0});
+    }
+    Container& container = containers_.back();
+    if (container.words.empty()) {
+        if (!container.array.empty() && container.array.back() == offset) return;
+        container.array.push_back(offset);
+        ++container.count;
+        if (container.array.size() > array_limit) {
+            // In die dichte Darstellung umwandeln
+            container.words.assign(chunk_words, 0);
+            for (std::uint16_t value : container.array) {
+                container.words[value >> 6] |= std::uint64_t(1) << (value & 63);
+            }
+            container.array.clear();
+            container.array.shrink_to_fit();
+        }
+        return;
+    }
+    std::uint64_t& word = container.words[offset >> 6];
+    const std::uint64_t bit = std::uint64_t(1) << (offset & 63);
+    if (!(word & bit)) {
+        word |= bit;
+        ++container.count;
+    }
+}
+
+std::size_t RoaringBitmap::cardinality() const {
+    std::size_t total = 0;
+    for (const Container& container : containers_) total += container.count;
+    return total;
+}
+
+void RoaringBitmap::or_into(std::vector<std::uint64_t>& dense) const {
+    for (const Container& container : containers_) {
+        const std::size_t base = static_cast<std::size_t>(container.key) * chunk_words;
+        if (base >= dense.size()) break;
+        if (container.words.empty()) {
+            for (std::uint16_t value : container.array) {
+                dense[base + (value >> 6)] |= std::uint64_t(1) << (value & 63);
+            }
+            continue;
+        }
+        const std::size_t count = std::min(chunk_words, dense.size() - base);
+        std::uint64_t* out = dense.data() + base;
+        const std::uint64_t* in = container.words.data();
+        for (std::size_t i = 0; i < count; ++i) out[i] |= in[i];
+    }
+}
+
+void RoaringBitmap::and_into(std::vector<std::uint64_t>& dense) const {
+    std::size_t next_word = 0; // Wörter vor dem aktuellen Container, die keine Bits haben
+    std::uint64_t mask[chunk_words];
+    for (const Container& container : containers_) {
+        const std::size_t base = static_cast<std::size_t>(container.key) * chunk_words;
+        if (base >= dense.size()) break;
+        std::fill(dense.begin() + static_cast<std::ptrdiff_t>(next_word), dense.begin() + static_cast<std::ptrdiff_t>(base), 0);
+        const std::size_t count = std::min(chunk_words, dense.size() - base);
+        const std::uint64_t* in = container.words.data();
+        if (container.words.empty()) {
+            std::fill(mask, mask + count, 0);
+            for (std::uint16_t value : container.array) {
+                mask[value >> 6] |= std::uint64_t(1) << (value & 63);
+            }
+            in = mask;
+        }
+        std::uint64_t* out = dense.data() + base;
+        for (std::size_t i = 0; i < count; ++i) out[i] &= in[i];
+        next_word = base + count;
+    }
+    std::fill(dense.begin() + static_cast<std::ptrdiff_t>(std::min(next_word, dense.size())), dense.end(), 0);
+}
+
+// --- MonsterQueryIndex ---
+
+MonsterQueryIndex::MonsterQueryIndex(const std::vector<MonsterSummary>& monsters, const MonsterVocabularies& vocabularies)
+    : word_count_((monsters.size() + 63) / 64) {
+    auto normalized = [](const std::vector<std::string>& values) {
+        std::vector<std::string> out;
+        for (const std::string& value : values) out.push_back(lowercase(value));
+        return out;
+    };
+    vocabularies_["size"] = normalized(vocabularies.sizes);
+    vocabularies_["type"] = normalized(vocabularies.types);
+    vocabularies_["alignment"] = normalized(vocabularies.alignments);
+    vocabularies_["movement"] = normalized(vocabularies.movement);
+    vocabularies_["condition_immune"] = normalized(vocabularies.conditions);
+    for (const char* attribute : damage_attributes) {
+        vocabularies_[attribute] = normalized(vocabularies.damage_types);
+    }
+
+    // Werte aus den Statblöcken klein geschrieben unter sich selbst ablegen; auch Werte außerhalb des
+    // Vokabulars bekommen ihre eigene Bitmap (abfragbar sind nur Vokabularwerte, siehe resolve)
+    auto add = [&](const std::string& attribute, const std::string& value, std::uint32_t row) {
+        const std::string key = lowercase(value);
+        if (!key.empty()) attributes_[attribute][key].append(row);
+    };
+
+    serialized_.reserve(monsters.size());
+    for (std::uint32_t row = 0; row < monsters.size(); ++row) {
+        const MonsterSummary& monster = monsters[row];
+        serialized_.push_back(json{{"id", monster.id}, {"name", monster.name}, {"cr", monster.cr}, {"size", monster.size},
+                                   {"type", monster.type}, {"complete", monster.complete}}.dump());
+        by_cr_[monster.cr].append(row);
+        add("size", monster.size, row);
+        add("type", monster.type, row);
+        add("alignment", monster.alignment, row);
+        for (const std::string& value : monster.movement) add("movement", value, row);
+        for (const std::string& value : monster.languages) add("language", value, row);
+        for (const std::string& value : monster.resistances) add("resist", value, row);
+        for (const std::string& value : monster.immunities) add("immune", value, row);
+        for (const std::string& value : monster.vulnerabilities) add("vulnerable", value, row);
+        for (const std::string& value : monster.condition_immunities) add("condition_immune", value, row);
+    }
+}
+
+std::vector<std::uint64_t> MonsterQueryIndex::all_rows() const {
+    std::vector<std::uint64_t> rows(word_count_, ~std::uint64_t(0));
+    const std::size_t tail = serialized_.size() % 64;
+    if (tail != 0) rows.back() = (std::uint64_t(1) << tail) - 1;
+    return rows;
+}
+
+std::string MonsterQueryIndex::resolve(const std::string& attribute, const std::string& value) const {
+    const std::string lowered = lowercase(value);
+    auto vocabulary = vocabularies_.find(attribute);
+    if (vocabulary == vocabularies_.end()) {
+        return lowered; // Freie Werte (Sprachen)
+    }
+    if (std::optional<std::string> match = match_vocabulary(vocabulary->second, lowered)) {
+        return *match;
+    }
+    throw std::invalid_argument("Unknown " + attribute + " '" + value + "'.");
+}
+
+void MonsterQueryIndex::apply_any(const std::string& attribute, const std::vector<std::string>& values, std::vector<std::uint64_t>& result) const {
+    if (values.empty()) return;
+    std::vector<std::uint64_t> any = empty_rows();
+    auto bitmaps = attributes_.find(attribute);
+    for (const std::string& value : values) {
+        const std::string key = resolve(attribute, value);
+        if (bitmaps == attributes_.end()) continue;
+        auto bitmap = bitmaps->second.find(key);
+        if (bitmap != bitmaps->second.end()) bitmap->second.or_into(any);
+    }
+    for (std::size_t i = 0; i < result.size(); ++i) result[i] &= any[i];
+}
+
+void MonsterQueryIndex::apply_all(const std::string& attribute, const std::vector<std::string>& values, std::vector<std::uint64_t>& result) const {
+    auto bitmaps = attributes_.find(attribute);
+    // "All" bei Schadensarten deckt jede einzelne Schadensart mit ab
+    const bool is_damage = std::find(std::begin(damage_attributes), std::end(damage_attributes), attribute) != std::end(damage_attributes);
+    for (const std::string& value : values) {
+        const std::string key = resolve(attribute, value);
+        if (bitmaps == attributes_.end()) {
+            std::fill(result.begin(), result.end(), 0);
+            return;
+        }
+        auto bitmap = bitmaps->second.find(key);
+        auto all = is_damage && key != "all" ? bitmaps->second.find("all") : bitmaps->second.end();
+        if (all == bitmaps->second.end()) {
+            if (bitmap == bitmaps->second.end()) {
+                std::fill(result.begin(), result.end(), 0);
+                return;
+            }
+            bitmap->second.and_into(result);
+            continue;
+        }
+        std::vector<std::uint64_t> either = empty_rows();
+        all->second.or_into(either);
+        if (bitmap != bitmaps->second.end()) bitmap->second.or_into(either);
+        for (std::size_t i = 0; i < result.size(); ++i) result[i] &= either[i];
+    }
+}
+
+std::vector<std::uint32_t> MonsterQueryIndex::run(const MonsterQuery& query) const {
+    std::vector<std::uint64_t> result = all_rows();
+
+    if (query.cr_min || query.cr_max) {
+        std::vector<std::uint64_t> in_range = empty_rows();
+        auto begin = query.cr_min ? by_cr_.lower_bound(*query.cr_min) : by_cr_.begin();
+        auto end = query.cr_max ? by_cr_.upper_bound(*query.cr_max) : by_cr_.end();
+        for (auto it = begin; it != end && (!query.cr_max || it->first <= *query.cr_max); ++it) {
+            it->second.or_into(in_range);
+        }
+        for (std::size_t i = 0; i < result.size(); ++i) result[i] &= in_range[i];
+    }
+
+    apply_any("size", query.sizes, result);
+    apply_any("type", query.types, result);
+    apply_any("alignment", query.alignments, result);
+    apply_all("movement", query.movement, result);
+    apply_all("language", query.languages, result);
+    apply_all("resist", query.resistances, result);
+    apply_all("immune", query.immunities, result);
+    apply_all("vulnerable", query.vulnerabilities, result);
+    apply_all("condition_immune", query.condition_immunities, result);
+
+    std::vector<std::uint32_t> rows;
+    for (std::size_t w = 0; w < result.size(); ++w) {
+        for (std::uint64_t word = result[w]; word != 0; word &= word - 1) {
+            rows.push_back(static_cast<std::uint32_t>(w * 64 + static_cast<std::size_t>(__builtin_ctzll(word))));
+        }
+    }
+    return rows;
+}
+
+std::string MonsterQueryIndex::render(const std::vector<std::uint32_t>& rows, const MonsterQuery& query) const {
+    const std::size_t begin = std::min(query.offset, rows.size());
+    const std::size_t end = begin + std::min(query.limit, rows.size() - begin);
+    std::string out = "{\"total\":" + std::to_string(rows.size()) + ",\"monsters\":[";
+    for (std::size_t i = begin; i < end; ++i) {
+        if (i != begin) out += ',';
+        out += serialized_[rows[i]];
+    }
+    out += "]}";
+    return out;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "monster_catalog.h"
+
+// --- Bitmap-Index für /api/monsters/query ---
+// Pro Attributwert (Größe, Typ, Gesinnung, Bewegungsart, Sprache, Resistenz, ...) eine komprimierte
+// Bitmap über die Monster-Zeilen (Zeile = Position im nach ID sortierten Katalog). Wie bei Roaring
+// wird der Zeilenraum in Blöcke zu 65536 geteilt; dünne Blöcke speichern sortierte 16-Bit-Offsets,
+// dichte Blöcke 1024 64-Bit-Wörter. Abfragen rechnen auf einem dichten Ergebnis-Bitset und verknüpfen
+// Wort für Wort (einfache Schleifen, die der Compiler vektorisieren kann).
+
+class RoaringBitmap {
+public:
+    // Zeilen müssen aufsteigend hinzugefügt werden (Index-Aufbau läuft in Zeilenreihenfolge)
+    void append(std::uint32_t row);
+    std::size_t cardinality() const;
+
+    // dense |= this bzw. dense &= this (dense hat ein Bit pro Zeile)
+    void or_into(std::vector<std::uint64_t>& dense) const;
+    void and_into(std::vector<std::uint64_t>& dense) const;
+
+private:
+    static constexpr std::size_t chunk_bits = 65536;
+    static constexpr std::size_t chunk_words = chunk_bits / 64;
+    static constexpr std::size_t array_limit = 4096; // Ab hier ist die Wort-Darstellung kleiner
+
+    struct Container {
+        std::uint32_t key = 0;               // Zeile >> 16
+        std::vector<std::uint16_t> array;    // Dünn: sortierte Offsets
+        std::vector<std::uint64_t> words;    // Dicht: chunk_words Wörter (dann ist array leer)
+        std::size_t count = 0;
+    };
+
+    std::vector<Container> containers_; // Nach key sortiert
+};
+
+// Erlaubte Werte aus DnDData (sizes.json, monsterTypes.json, alignments.json, movementTypes.json,
+// damageResImuVul.json, conditionResImuVul.json); Sprachen sind frei
+struct MonsterVocabularies {
+    std::vector<std::string> sizes;
+    std::vector<std::string> types;
+    std::vector<std::string> alignments;
+    std::vector<std::string> movement;
+    std::vector<std::string> damage_types;
+    std::vector<std::string> conditions;
+};
+
+struct MonsterQuery {
+    std::optional<double> cr_min;
+    std::optional<double> cr_max;
+    // Einwertige Attribute: ODER innerhalb der Liste (size=Large,Huge)
+    std::vector<std::string> sizes;
+    std::vector<std::string> types;
+    std::vector<std::string> alignments;
+    // Mengen-Attribute: alle genannten Werte müssen vorhanden sein (resist=fire,cold)
+    std::vector<std::string> movement;
+    std::vector<std::string> languages;
+    std::vector<std::string> resistances;
+    std::vector<std::string> immunities;
+    std::vector<std::string> vulnerabilities;
+    std::vector<std::string> condition_immunities;
+    std::size_t offset = 0;
+    std::size_t limit = 100;
+};
+
+class MonsterQueryIndex {
+public:
+    MonsterQueryIndex(const std::vector<MonsterSummary>& monsters, const MonsterVocabularies& vocabularies);
+
+    // Wirft std::invalid_argument bei Werten, die nicht im Vokabular stehen
+    std::vector<std::uint32_t> run(const MonsterQuery& query) const;
+    // Serialisiert {"total": n, "monsters": [Zusammenfassungen]} für offset/limit
+    std::string render(const std::vector<std::uint32_t>& rows, const MonsterQuery& query) const;
+
+    std::size_t size() const { return serialized_.size(); }
+
+private:
+    // Attribut -> normalisierter Wert (klein geschrieben) -> Bitmap
+    using Attribute = std::unordered_map<std::string, RoaringBitmap>;
+
+    std::vector<std::uint64_t> all_rows() const;
+    std::vector<std::uint64_t> empty_rows() const { return std::vector<std::uint64_t>(word_count_, 0); }
+    // Normalisiert einen Abfragewert gegen das Vokabular des Attributs, wirft bei unbekannten Werten
+    std::string resolve(const std::string& attribute, const std::string& value) const;
+    void apply_any(const std::string& attribute, const std::vector<std::string>& values, std::vector<std::uint64_t>& result) const;
+    void apply_all(const std::string& attribute, const std::vector<std::string>& values, std::vector<std::uint64_t>& result) const;
+
+    std::size_t word_count_ = 0;
+    std::vector<std::string> serialized_;       // Zusammenfassung pro Zeile, vorab serialisiert
+    std::map<double, RoaringBitmap> by_cr_;     // Für Bereiche über die sortierten CR-Werte
+    std::unordered_map<std::string, Attribute> attributes_;
+    std::unordered_map<std::string, std::vector<std::string>> vocabularies_; // Attribut -> erlaubte Werte (normalisiert)
+};
+// --- Ende Bitmap-Index ---
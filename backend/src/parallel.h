@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --- Kleine Parallelisierungs-Hilfe ---
+// Verteilt die Indizes [0, count) dynamisch auf den aufrufenden Thread und Helfer aus einem gemeinsamen Pool
+// (hardware_concurrency() - 1 Threads für den ganzen Prozess). Pro Aufruf werden also keine Threads gestartet, und
+// viele gleichzeitige Anfragen teilen sich dieselben Helfer, statt hardware_concurrency() Threads pro Anfrage zu erzeugen.
+// Der aufrufende Thread arbeitet immer mit und wartet nur auf Helfer, die schon angefangen haben; ist der Pool
+// ausgelastet (oder ruft ein Pool-Thread selbst parallel_for auf), läuft die Schleife eben im Aufrufer.
+// fn(i) muss für verschiedene i unabhängig sein (jeder Index schreibt nur in seinen eigenen Slot).
+// Wirft fn, werden keine weiteren Indizes mehr vergeben; nach dem Ende aller Helfer wird die erste Ausnahme weitergeworfen.
+
+class WorkerPool {
+public:
+    explicit WorkerPool(std::size_t threads) {
+        threads_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i) {
+            threads_.emplace_back([this]() { loop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread& thread : threads_) {
+            thread.join();
+        }
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    std::size_t size() const { return threads_.size(); }
+
+    // task darf nicht werfen
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    void loop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                cv_.wait(lock, [&]() { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+};
+
+inline WorkerPool& worker_pool() {
+    static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+inline std::size_t worker_count_for(std::size_t count, std::size_t min_items_per_worker = 8) {
+    const std::size_t hw = worker_pool().size() + 1;
+    return std::max<std::size_t>(1, std::min(hw, count / std::max<std::size_t>(1, min_items_per_worker) + 1));
+}
+
+namespace parallel_detail {
+
+// Gemeinsamer Zustand eines parallel_for-Aufrufs; Helfer halten ihn über shared_ptr, auch wenn sie erst nach dem Ende starten
+struct Job {
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::size_t running = 0; // Helfer, die gerade fn aufrufen
+    bool closed = false;     // Aufrufer ist fertig, später startende Helfer rühren fn nicht mehr an
+    std::exception_ptr error;
+};
+
+} // namespace parallel_detail
+
+template <typename Fn>
+void parallel_for(std::size_t count, Fn&& fn, std::size_t min_items_per_worker = 8) {
+    if (count == 0) {
+        return;
+    }
+    const std::size_t workers = worker_count_for(count, min_items_per_worker);
+    if (workers == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    auto job = std::make_shared<parallel_detail::Job>();
+    auto run = [job, count, &fn]() {
+        try {
+            for (std::size_t i = job->next.fetch_add(1); i < count && !job->failed.load(std::memory_order_relaxed); i = job->next.fetch_add(1)) {
+                fn(i);
+            }
+        } catch (...) {
+            std::lock_guard lock(job->mutex);
+            if (!job->error) job->error = std::current_exception();
+            job->failed = true;
+        }
+    };
+    for (std::size_t w = 1; w < workers; ++w) {
+        worker_pool().submit([job, run]() {
+            {
+                std::lock_guard lock(job->mutex);
+                if (job->closed) return;
+                ++job->running;
+            }
+            run();
+            {
+                std::lock_guard lock(job->mutex);
+                --job->running;
+            }
+            job->finished.notify_all();
+        });
+    }
+    run(); // Der aufrufende Thread arbeitet mit
+
+    std::unique_lock lock(job->mutex);
+    job->closed = true;
+    job->finished.wait(lock, [&]() { return job->running == 0; });
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+// --- Ende Parallelisierungs-Hilfe ---
@@ -0,0 +1,184 @@
+#include "response_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include <zlib.h>
+
+#include "content_negotiation.h"
+#include "logger.h"
+
+std::uint64_t fnv1a64(const std::string& data) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+namespace {
+
+// windowBits 15 + 16 = gzip-Header, 15 = zlib-Header (HTTP "deflate")
+std::string compress_body(const std::string& body, int window_bits) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, window_bits, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+    std::string out(deflateBound(&stream, body.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+    stream.avail_in = static_cast<uInt>(body.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        log_warn("Komprimieren der Antwort fehlgeschlagen", {{"zlib", result}});
+        return {};
+    }
+    return out;
+}
+
+std::string trim(const std::string& value) {
+    std::size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) return {};
+    std::size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> split_list(const std::string& header) {
+    std::vector<std::string> items;
+    std::size_t start = 0;
+    while (start <= header.size()) {
+        std::size_t comma = header.find(',', start);
+        if (comma == std::string::npos) comma = header.size();
+        std::string item = trim(header.substr(start, comma - start));
+        if (!item.empty()) items.push_back(item);
+        start = comma + 1;
+    }
+    return items;
+}
+
+bool etag_matches(const std::string& if_none_match, const std::string& etag) {
+    for (std::string candidate : split_list(if_none_match)) {
+        if (candidate == "*") return true;
+        if (candidate.rfind("W/", 0) == 0) candidate.erase(0, 2); // Schwacher Vergleich reicht für GET
+        if (candidate == etag) return true;
+    }
+    return false;
+}
+
+// Gibt true zurück, wenn die Kodierung im Accept-Encoding-Header mit q > 0 erlaubt ist
+bool accepts_encoding(const std::string& accept_encoding, const std::string& encoding) {
+    for (const std::string& item : split_list(accept_encoding)) {
+        std::string name = trim(item.substr(0, item.find(';')));
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name != encoding) continue;
+        std::size_t q_pos = item.find("q=");
+        if (q_pos == std::string::npos) return true;
+        try {
+            return std::stod(item.substr(q_pos + 2)) > 0.0;
+        } catch (const std::exception&) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Starker ETag einer Darstellung ("abc" -> "abc-gzip"); jede Kodierung braucht ihren eigenen
+std::string variant_etag(const std::string& etag, const char* suffix) {
+    if (!*suffix || etag.size() < 2) return etag;
+    return etag.substr(0, etag.size() - 1) + suffix + "\"";
+}
+
+} // namespace
+
+std::string make_etag(const std::string& body) {
+    char etag[24];
+    std::snprintf(etag, sizeof(etag), "\"%016llx\"", static_cast<unsigned long long>(fnv1a64(body)));
+    return etag;
+}
+
+bool if_match_satisfied(const std::string& if_match, const std::string& etag) {
+    for (const std::string& candidate : split_list(if_match)) {
+        if (candidate == "*" || candidate == etag) return true;
+        // ETags der MessagePack-/CBOR- und der komprimierten Darstellungen bezeichnen dieselbe Version
+        for (const char* suffix : {etag_suffix(BodyFormat::msgpack), etag_suffix(BodyFormat::cbor), "-gzip", "-deflate"}) {
+            if (etag.size() >= 2 && candidate == variant_etag(etag, suffix)) return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<const CachedResponse> make_cached_response(std::string body, std::string content_type, bool compress) {
+    auto cached = std::make_shared<CachedResponse>();
+    cached->etag = make_etag(body);
+    cached->content_type = std::move(content_type);
+    if (compress) {
+        cached->gzip = compress_body(body, 15 + 16);
+        cached->deflate = compress_body(body, 15);
+    }
+    cached->body = std::move(body);
+    return cached;
+}
+
+crow::response send_cached_response(const crow::request& req, const CachedResponse& cached) {
+    // MessagePack/CBOR laut Accept: eigene Variante, ohne Komprimierung (binär schon kompakt)
+    const BodyFormat format = cached.content_type == "application/json" ? negotiate_format(req.get_header_value("Accept")) : BodyFormat::json;
+
+    // Jede Darstellung (Format bzw. Content-Encoding) hat ihren eigenen starken ETag
+    const std::string* body = &cached.body;
+    const char* encoding = nullptr;
+    const char* suffix = etag_suffix(format);
+    if (format == BodyFormat::json) {
+        const std::string& accept_encoding = req.get_header_value("Accept-Encoding");
+        if (!cached.gzip.empty() && accepts_encoding(accept_encoding, "gzip")) {
+            body = &cached.gzip;
+            encoding = "gzip";
+            suffix = "-gzip";
+        } else if (!cached.deflate.empty() && accepts_encoding(accept_encoding, "deflate")) {
+            body = &cached.deflate;
+            encoding = "deflate";
+            suffix = "-deflate";
+        }
+    }
+    const std::string etag = variant_etag(cached.etag, suffix);
+
+    const std::string& if_none_match = req.get_header_value("If-None-Match");
+    if (!if_none_match.empty() && etag_matches(if_none_match, etag)) {
+        crow::response res(304); // Not Modified, Client nutzt seine Kopie
+        res.set_header("ETag", etag);
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("Vary", "Accept-Encoding, Accept");
+        return res;
+    }
+
+    if (format != BodyFormat::json) {
+        crow::response res(200, transcode_json(cached.body, format));
+        res.set_header("Content-Type", content_type_of(format));
+        res.set_header("ETag", etag);
+        res.set_header("Cache-Control", "no-cache");
+        res.set_header("Vary", "Accept-Encoding, Accept");
+        return res;
+    }
+
+    // Crow besitzt den Body als std::string, daher bleibt genau eine Kopie aus dem Cache
+    crow::response res(200, *body);
+    res.set_header("Content-Type", cached.content_type);
+    res.set_header("ETag", etag);
+    res.set_header("Cache-Control", "no-cache"); // Browser darf cachen, muss aber per ETag revalidieren
+    res.set_header("Vary", "Accept-Encoding, Accept");
+    if (encoding) {
+        res.set_header("Content-Encoding", encoding);
+    }
+    return res;
+}
+
+std::shared_ptr<const CachedResponse> SourceResponseCache::get(const std::shared_ptr<const void>& source, std::string_view body) {
+    // Quelle hat sich geändert (oder erster Zugriff): einmal hashen und komprimieren
+    return response_.get(source, [&]() { return make_cached_response(std::string(body)); });
+}
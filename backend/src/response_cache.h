@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "crow.h"
+#include "source_bound.h"
+
+// --- Vorserialisierte Antworten mit ETag und vorkomprimierten Varianten ---
+// Der Body wird einmal gehasht und (optional) einmal gzip/deflate-komprimiert. Pro Anfrage
+// wird nur noch die passende Variante ausgewählt; If-None-Match wird mit 304 beantwortet.
+
+struct CachedResponse {
+    std::string content_type;
+    std::string etag;    // Inklusive Anführungszeichen, z.B. "\"3f2a...\""; gzip/deflate: "\"3f2a...-gzip\""
+    std::string body;    // Unkomprimiert
+    std::string gzip;    // Leer, wenn nicht komprimiert wurde
+    std::string deflate; // zlib-Format (HTTP "deflate")
+};
+
+// FNV-1a (64 Bit) reicht für ETags und Inhalts-Hashes, kryptographische Stärke ist nicht nötig
+std::uint64_t fnv1a64(const std::string& data);
+
+// Starkes ETag eines Bodys (FNV-1a als Hex, mit Anführungszeichen)
+std::string make_etag(const std::string& body);
+// If-Match (RFC 9110): starker Vergleich, schwache ETags passen nie, "*" passt auf jede vorhandene Version.
+// Die ETags der binären und der komprimierten Darstellungen gelten als dieselbe Version.
+bool if_match_satisfied(const std::string& if_match, const std::string& etag);
+
+// Erzeugt Hash und (falls compress) die komprimierten Varianten
+std::shared_ptr<const CachedResponse> make_cached_response(std::string body, std::string content_type = "application/json", bool compress = true);
+
+// Baut die Antwort für eine Anfrage: 304 bei passendem If-None-Match, sonst die per Accept-Encoding gewählte Variante.
+// JSON-Antworten gehen bei Accept: application/msgpack bzw. application/cbor binär raus (siehe content_negotiation.h).
+crow::response send_cached_response(const crow::request& req, const CachedResponse& cached);
+
+// Hält die vorbereitete Antwort für genau eine Quelle (z.B. einen Snapshot-Eintrag) und baut sie neu,
+// sobald sich die Quelle ändert
+class SourceResponseCache {
+public:
+    explicit SourceResponseCache(const std::string& metrics_name) : response_(metrics_name) {}
+
+    std::shared_ptr<const CachedResponse> get(const std::shared_ptr<const void>& source, std::string_view body);
+
+private:
+    SourceBound<CachedResponse> response_;
+};
+// --- Ende vorserialisierte Antworten ---
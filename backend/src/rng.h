@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// --- Zählerbasierter Zufallsgenerator (Philox4x32-10) ---
+// Jeder Strom wird durch (seed, stream_id) festgelegt: Ergebnisse hängen nur davon ab,
+// nicht von der Anzahl der Threads oder der Reihenfolge der Abarbeitung.
+
+class PhiloxStream {
+public:
+    PhiloxStream() = default;
+    PhiloxStream(std::uint64_t seed, std::uint64_t stream_id) {
+        key_ = {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+        counter_ = {0, 0, static_cast<std::uint32_t>(stream_id), static_cast<std::uint32_t>(stream_id >> 32)};
+    }
+
+    std::uint32_t next_u32() {
+        if (index_ == 4) {
+            block_ = philox(counter_, key_);
+            if (++counter_[0] == 0) ++counter_[1];
+            index_ = 0;
+        }
+        return block_[index_++];
+    }
+
+    // Füllt out mit n Zufallszahlen (gleiche Folge wie n x next_u32()). Die Philox-Blöcke sind
+    // voneinander unabhängig, die Schleife lässt sich daher vom Compiler vektorisieren.
+    void fill(std::uint32_t* out, std::size_t n) {
+        while (n > 0 && index_ < 4) {
+            *out++ = block_[index_++];
+            --n;
+        }
+        for (; n >= 4; n -= 4, out += 4) {
+            const Block block = philox(counter_, key_);
+            if (++counter_[0] == 0) ++counter_[1];
+            out[0] = block[0];
+            out[1] = block[1];
+            out[2] = block[2];
+            out[3] = block[3];
+        }
+        while (n-- > 0) *out++ = next_u32();
+    }
+
+    // Gleichverteilt in [1, sides] (Multiply-Shift, Bias bei Würfelgrößen vernachlässigbar)
+    int roll(int sides) {
+        if (sides <= 1) return sides;
+        return static_cast<int>((static_cast<std::uint64_t>(next_u32()) * static_cast<std::uint32_t>(sides)) >> 32) + 1;
+    }
+
+private:
+    using Block = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    static Block philox(Block ctr, Key key) {
+        constexpr std::uint32_t m0 = 0xD2511F53, m1 = 0xCD9E8D57;
+        constexpr std::uint32_t w0 = 0x9E3779B9, w1 = 0xBB67AE85;
+        for (int round = 0; round < 10; ++round) {
+            const std::uint64_t p0 = static_cast<std::uint64_t>(m0) * ctr[0];
+            const std::uint64_t p1 = static_cast<std::uint64_t>(m1) * ctr[2];
+            ctr = {static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0], static_cast<std::uint32_t>(p1),
+                   static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1], static_cast<std::uint32_t>(p0)};
+            key[0] += w0;
+            key[1] += w1;
+        }
+        return ctr;
+    }
+
+    Key key_{};
+    Block counter_{};
+    Block block_{};
+    int index_ = 4;
+};
+// --- Ende Zufallsgenerator ---
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "crow.h"
+#include "nlohmann/json.hpp"
+
+#include "content_negotiation.h"
+#include "logger.h"
+#include "metrics.h"
+
+// --- Server: Middlewares, Routen und Hilfsfunktionen aus main.cpp ---
+// Auch von DnDApp_bench und DnDApp_loadgen benutzt (main.cpp wird dort mit DNDAPP_NO_MAIN übersetzt), damit die Routen
+// im selben Prozess gemessen werden können (Bench ohne Socket, Loadgen --inprocess über 127.0.0.1).
+
+// Deine CorsMiddleware (wie gehabt)
+struct CorsMiddleware {
+     struct context {};
+    void before_handle(crow::request& req, crow::response& res, context& /*ctx*/) {
+
+        if (req.method == "OPTIONS"_method) {
+            res.add_header("Access-Control-Allow-Origin", "http://localhost:5173");
+            res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, PATCH, DELETE, OPTIONS");
+            res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization, If-Match");
+            res.code = 204;
+            res.end();
+        }
+    }
+    void after_handle(crow::request& /*req*/, crow::response& res, context& /*ctx*/) {
+        res.set_header("Access-Control-Allow-Origin", "http://localhost:5173");
+        res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, PATCH, DELETE, OPTIONS");
+        res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization, If-Match");
+        res.set_header("Access-Control-Expose-Headers", "ETag"); // Frontend schickt es bei PATCH als If-Match zurück
+    }
+};
+
+// Misst Latenz, Status und Bytes pro Route für /api/metrics und protokolliert die Anfrage (steht vor CorsMiddleware, damit auch
+// die direkt beantworteten OPTIONS-Anfragen gezählt werden)
+struct MetricsMiddleware {
+    struct context {
+        std::chrono::steady_clock::time_point start;
+    };
+    void before_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+        ctx.start = std::chrono::steady_clock::now();
+    }
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        const auto elapsed = std::chrono::steady_clock::now() - ctx.start;
+        const std::string method = crow::method_name(req.method);
+        metrics().record_request(method, req.url, res.code, req.body.size(), res.body.size(), elapsed);
+
+        // Schreibende Anfragen immer protokollieren, lesende nur mit --log-level=debug
+        const LogLevel level = req.method == "GET"_method || req.method == "OPTIONS"_method ? LogLevel::Debug : LogLevel::Info;
+        if (logger().enabled(level)) {
+            logger().log(level, "Anfrage", {{"method", method}, {"url", req.url}, {"status", res.code},
+                                            {"latency_us", static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count())}});
+        }
+    }
+};
+
+// ContentNegotiationMiddleware zuletzt: kodiert die Antwort als Erstes um, Metriken sehen die gesendete Größe
+using DnDServer = crow::App<MetricsMiddleware, CorsMiddleware, ContentNegotiationMiddleware>;
+
+// Änderungs-Listener, Benutzerdaten und Warm-Start im Hintergrund; stop_services() wartet auf den Warm-Start
+void start_services();
+void stop_services();
+// Alle CROW_ROUTEs plus Routen-Muster für /api/metrics
+void register_routes(DnDServer& app, bool block_until_warm);
+// Muster aller CROW_ROUTEs ("/api/monsters/<string>"), z.B. zum Gruppieren von URLs
+const std::vector<std::string>& route_patterns();
+
+// Hilfsfunktionen (Definition in main.cpp)
+nlohmann::json load_monster_statblock(const std::string& monster_id);
+nlohmann::json list_templates_by_type(const std::string& type, const std::string& name_prefix = "");
+nlohmann::json save_template_by_type(const std::string& type, const nlohmann::json& incoming_data);
+void delete_template_by_type(const std::string& type, const std::string& id);
+// --- Ende Server ---
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "metrics.h"
+
+// --- Abgeleitete Daten, die an eine Quelle gebunden sind ---
+// Hält ein aus einem Snapshot-Eintrag abgeleitetes Objekt (Index, vorbereitete Antwort, Lookup-Tabellen)
+// und baut es nur neu, wenn sich die Quelle ändert. Die Quelle wird nur schwach referenziert,
+// alte Snapshots bleiben dadurch nicht am Leben.
+
+template <typename T>
+class SourceBound {
+public:
+    // Name für die Cache-Zähler in /api/metrics (Treffer = Quelle unverändert)
+    explicit SourceBound(const std::string& metrics_name) : counters_(metrics().cache(metrics_name)) {}
+
+    template <typename Factory>
+    std::shared_ptr<const T> get(const std::shared_ptr<const void>& source, Factory&& factory) {
+        std::lock_guard lock(mutex_);
+        std::shared_ptr<const void> current_source = source_.lock();
+        if (value_ && current_source && current_source == source) {
+            counters_.hits.add();
+            return value_;
+        }
+        counters_.misses.add();
+        value_ = factory();
+        source_ = source;
+        return value_;
+    }
+
+private:
+    CacheCounters& counters_;
+    std::mutex mutex_;
+    std::weak_ptr<const void> source_;
+    std::shared_ptr<const T> value_;
+};
+// --- Ende abgeleitete Daten ---
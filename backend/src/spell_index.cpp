@@ -0,0 +1,167 @@
+#include "spell_index.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string to_lower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value;
+}
+
+// Flag eines Zaubers; Homebrew-Einträge mit falschem Typ (z.B. "srd": "yes") zählen als nicht gesetzt
+bool spell_flag(const std::string& name, const json& spell, const char* key) {
+    auto it = spell.find(key);
+    if (it == spell.end() || it->is_null()) return false;
+    if (!it->is_boolean()) {
+        log_warn("Zauber-Feld hat falschen Typ, wird ignoriert", {{"spell", name}, {"field", key}});
+        return false;
+    }
+    return it->get<bool>();
+}
+
+} // namespace
+
+SpellIndex::SpellIndex(const json& spells) {
+    if (!spells.is_object()) {
+        return;
+    }
+    // nlohmann::json-Objekte sind nach Schlüssel sortiert -> IDs in Namensreihenfolge
+    names_.reserve(spells.size());
+    for (const auto& [name, spell] : spells.items()) {
+        if (!spell.is_object()) continue;
+        // Ohne gültiges Level lässt sich der Zauber nicht einordnen: überspringen statt die ganze Route scheitern zu lassen
+        int level = 0;
+        if (auto it = spell.find("level"); it != spell.end() && !it->is_null()) {
+            if (!it->is_number_integer()) {
+                log_warn("Zauber ohne gültiges Level übersprungen", {{"spell", name}});
+                continue;
+            }
+            level = static_cast<int>(std::clamp<std::int64_t>(it->get<std::int64_t>(), 0, level_count - 1));
+        }
+        const auto id = static_cast<std::uint32_t>(names_.size());
+        names_.push_back(name);
+
+        levels_.push_back(level);
+        by_level_[level].push_back(id);
+
+        double damage = spell.contains("damage") && spell["damage"].is_number() ? spell["damage"].get<double>() : 0.0;
+        damage_.push_back(damage);
+
+        if (spell.contains("class") && spell["class"].is_array()) {
+            for (const auto& class_name : spell["class"]) {
+                if (class_name.is_string()) {
+                    auto& ids = by_class_[to_lower(class_name.get<std::string>())];
+                    if (ids.empty() || ids.back() != id) ids.push_back(id);
+                }
+            }
+        }
+
+        serialized_.push_back(spell.dump());
+        documents_.push_back(spell);
+    }
+
+    damage_bits_ = multitarget_bits_ = srd_bits_ = custom_bits_ = make_bitset();
+    for (std::uint32_t id = 0; id < names_.size(); ++id) {
+        const json& spell = documents_[id];
+        if (damage_[id] > 0) set_bit(damage_bits_, id);
+        if (spell_flag(names_[id], spell, "multitarget")) set_bit(multitarget_bits_, id);
+        if (spell_flag(names_[id], spell, "srd")) set_bit(srd_bits_, id);
+        if (spell_flag(names_[id], spell, "custom")) set_bit(custom_bits_, id);
+    }
+}
+
+std::vector<std::uint32_t> SpellIndex::run(const SpellQuery& query) const {
+    const std::size_t count = names_.size();
+    const std::size_t words = (count + 63) / 64;
+
+    // --- Maske aus Level-Bereich und Flag-Bitsets ---
+    const int level_min = std::max(query.level_min, 0);
+    const int level_max = std::min(query.level_max, level_count - 1);
+    Bitset mask;
+    if (level_min == 0 && level_max == level_count - 1) {
+        mask.assign(words, ~std::uint64_t(0));
+        if (count % 64) mask.back() = (std::uint64_t(1) << (count % 64)) - 1;
+    } else {
+        mask = make_bitset();
+        for (int level = level_min; level <= level_max; ++level) {
+            for (std::uint32_t id : by_level_[level]) set_bit(mask, id);
+        }
+    }
+
+    auto apply_flag = [&](const std::optional<bool>& wanted, const Bitset& bits) {
+        if (!wanted) return;
+        for (std::size_t w = 0; w < words; ++w) {
+            mask[w] &= *wanted ? bits[w] : ~bits[w];
+        }
+    };
+    apply_flag(query.has_damage, damage_bits_);
+    apply_flag(query.multitarget, multitarget_bits_);
+    apply_flag(query.srd, srd_bits_);
+    apply_flag(query.custom, custom_bits_);
+
+    // --- Kandidaten: Klassen-Postings (Vereinigung) oder alle gesetzten Bits ---
+    std::vector<std::uint32_t> result;
+    if (!query.classes.empty()) {
+        for (const std::string& class_name : query.classes) {
+            auto it = by_class_.find(to_lower(class_name));
+            if (it == by_class_.end()) continue;
+            for (std::uint32_t id : it->second) {
+                if (mask[id >> 6] & (std::uint64_t(1) << (id & 63))) result.push_back(id);
+            }
+        }
+        if (query.classes.size() > 1) {
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+        }
+    } else {
+        for (std::size_t w = 0; w < words; ++w) {
+            for (std::uint64_t word = mask[w]; word; word &= word - 1) {
+                result.push_back(static_cast<std::uint32_t>(w * 64 + __builtin_ctzll(word)));
+            }
+        }
+    }
+
+    // --- Sortierung (IDs sind bereits nach Namen sortiert, daher stabil sortieren) ---
+    if (query.sort == "level") {
+        std::stable_sort(result.begin(), result.end(), [&](std::uint32_t a, std::uint32_t b) { return levels_[a] < levels_[b]; });
+    } else if (query.sort == "damage") {
+        std::stable_sort(result.begin(), result.end(), [&](std::uint32_t a, std::uint32_t b) { return damage_[a] < damage_[b]; });
+    }
+    if (query.descending) {
+        std::reverse(result.begin(), result.end());
+    }
+    return result;
+}
+
+std::string SpellIndex::render(const std::vector<std::uint32_t>& ids, const SpellQuery& query) const {
+    const std::size_t begin = std::min(query.offset, ids.size());
+    const std::size_t end = begin + std::min(query.limit, ids.size() - begin);
+
+    std::string out = "{\"total\":" + std::to_string(ids.size()) + ",\"spells\":[";
+    for (std::size_t i = begin; i < end; ++i) {
+        if (i != begin) out += ',';
+        const std::uint32_t id = ids[i];
+        if (query.fields.empty()) {
+            out += serialized_[id];
+            continue;
+        }
+        json projected = json::object();
+        projected["name"] = names_[id];
+        for (const std::string& field : query.fields) {
+            if (documents_[id].contains(field)) projected[field] = documents_[id][field];
+        }
+        out += projected.dump();
+    }
+    out += "]}";
+    return out;
+}
+
+std::shared_ptr<const SpellIndex> SpellIndexCache::get(const std::shared_ptr<const void>& source, const json& spells) {
+    return index_.get(source, [&]() { return std::make_shared<const SpellIndex>(spells); });
+}
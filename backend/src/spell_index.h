@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "source_bound.h"
+
+// --- Spell-Index für gefilterte /api/spells-Anfragen ---
+// Aus spells.json (Objekt Name -> Spell) werden einmal invertierte Indizes gebaut:
+// Klasse -> sortierte Spell-IDs, Level-Buckets und Bitsets für damage/multitarget/srd/custom.
+// Spell-IDs sind die Positionen in Namensreihenfolge, Ergebnisse sind daher ohne Sortieren nach Namen geordnet.
+
+struct SpellQuery {
+    std::vector<std::string> classes; // ODER-verknüpft, Groß-/Kleinschreibung egal
+    int level_min = 0;
+    int level_max = 9;
+    std::optional<bool> has_damage;   // damage > 0
+    std::optional<bool> multitarget;
+    std::optional<bool> srd;
+    std::optional<bool> custom;
+    std::string sort = "name";        // name | level | damage
+    bool descending = false;
+    std::vector<std::string> fields;  // Leer = alle Felder
+    std::size_t offset = 0;
+    std::size_t limit = SIZE_MAX;
+};
+
+class SpellIndex {
+public:
+    explicit SpellIndex(const nlohmann::json& spells);
+
+    // Liefert die passenden Spell-IDs in der gewünschten Sortierung (ohne offset/limit)
+    std::vector<std::uint32_t> run(const SpellQuery& query) const;
+
+    // Serialisiert {"total": n, "spells": [...]} für eine Ergebnisseite
+    std::string render(const std::vector<std::uint32_t>& ids, const SpellQuery& query) const;
+
+    std::size_t size() const { return names_.size(); }
+
+private:
+    using Bitset = std::vector<std::uint64_t>;
+    static constexpr int level_count = 10; // Cantrips (0) bis 9. Grad
+
+    Bitset make_bitset() const { return Bitset((names_.size() + 63) / 64, 0); }
+    static void set_bit(Bitset& bits, std::uint32_t id) { bits[id >> 6] |= std::uint64_t(1) << (id & 63); }
+
+    std::vector<std::string> names_;
+    std::vector<int> levels_;
+    std::vector<double> damage_;
+    std::vector<std::string> serialized_;   // Vollständiges Spell-Objekt, vorab serialisiert
+    std::vector<nlohmann::json> documents_; // Für Projektionen (fields=)
+
+    std::unordered_map<std::string, std::vector<std::uint32_t>> by_class_; // Schlüssel klein geschrieben
+    std::vector<std::uint32_t> by_level_[level_count];
+    Bitset damage_bits_, multitarget_bits_, srd_bits_, custom_bits_;
+};
+
+// Hält den Index zur aktuellen spells.json-Quelle und baut ihn nur bei Änderungen neu
+class SpellIndexCache {
+public:
+    SpellIndexCache() : index_("spell_index") {}
+
+    std::shared_ptr<const SpellIndex> get(const std::shared_ptr<const void>& source, const nlohmann::json& spells);
+
+private:
+    SourceBound<SpellIndex> index_;
+};
+// --- Ende Spell-Index ---
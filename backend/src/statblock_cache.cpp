@@ -0,0 +1,134 @@
+#include "statblock_cache.h"
+
+#include <algorithm>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Kurze Strings liegen in libstdc++ im Objekt selbst (SSO), längere auf dem Heap
+std::size_t string_heap_size(const std::string& value) {
+    return value.capacity() > 15 ? value.capacity() + 1 : 0;
+}
+
+// Node im LRU-Shard: Listenknoten, Index-Eintrag und beide Kontrollblöcke der shared_ptr
+constexpr std::size_t node_overhead = 192;
+
+} // namespace
+
+StatblockCache::StatblockCache(std::size_t budget_bytes, bool keep_models)
+    : shard_budget_(budget_bytes / shard_count), keep_models_(keep_models), counters_(metrics().cache("statblocks")) {}
+
+void StatblockCache::configure(std::size_t budget_bytes, bool keep_models) {
+    shard_budget_ = budget_bytes / shard_count;
+    keep_models_ = keep_models;
+    for (Shard& shard : shards_) {
+        std::lock_guard lock(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+        ++shard.generation;
+    }
+    counters_.resident_bytes.store(0, std::memory_order_relaxed);
+}
+
+StatblockCache::Shard& StatblockCache::shard_for(const std::string& id) {
+    return shards_[std::hash<std::string>{}(id) % shard_count];
+}
+
+std::optional<StatblockCache::Entry> StatblockCache::find(const std::string& id, bool need_document) {
+    Entry entry;
+    {
+        Shard& shard = shard_for(id);
+        std::lock_guard lock(shard.mutex);
+        auto it = shard.index.find(id);
+        if (it == shard.index.end() || (need_document && !it->second->entry.model)) {
+            counters_.misses.add();
+            return std::nullopt;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second); // Iteratoren bleiben gültig
+        counters_.hits.add();
+        entry = it->second->entry;
+    }
+    if (need_document) {
+        entry.document = std::make_shared<const json>(entry.model->to_json()); // Außerhalb des Shard-Locks
+    }
+    return entry;
+}
+
+std::uint64_t StatblockCache::generation(const std::string& id) {
+    Shard& shard = shard_for(id);
+    std::lock_guard lock(shard.mutex);
+    return shard.generation;
+}
+
+StatblockCache::Entry StatblockCache::insert(const std::string& id, std::uint64_t generation, json document) {
+    Entry entry;
+    {
+        auto timer = metrics().time_json_dump();
+        entry.body = std::make_shared<const std::string>(document.dump());
+    }
+    entry.document = std::make_shared<const json>(std::move(document));
+
+    Node node;
+    node.id = id;
+    node.bytes = node_overhead + string_heap_size(id) + entry.body->capacity();
+    if (keep_models_) {
+        try {
+            entry.model = std::make_shared<const CompactMonster>(CompactMonster::from_json(*entry.document));
+            node.entry.model = entry.model;
+            node.bytes += entry.model->memory_size();
+        } catch (const std::invalid_argument&) {
+            // Kein Objekt: nur den Body halten, need_document lädt dann neu
+        }
+    }
+    node.entry.body = entry.body;
+
+    Shard& shard = shard_for(id);
+    std::lock_guard lock(shard.mutex);
+    if (shard.generation != generation || node.bytes > shard_budget_) {
+        return entry; // Zwischenzeitlich invalidiert bzw. größer als der ganze Shard
+    }
+    auto existing = shard.index.find(id);
+    if (existing != shard.index.end()) {
+        shard.bytes -= existing->second->bytes;
+        counters_.resident_bytes.fetch_sub(existing->second->bytes, std::memory_order_relaxed);
+        shard.lru.erase(existing->second);
+        shard.index.erase(existing);
+    }
+    shard.bytes += node.bytes;
+    counters_.resident_bytes.fetch_add(node.bytes, std::memory_order_relaxed);
+    shard.lru.push_front(std::move(node));
+    shard.index[id] = shard.lru.begin();
+    evict_locked(shard);
+    return entry;
+}
+
+void StatblockCache::evict_locked(Shard& shard) {
+    while (shard.bytes > shard_budget_ && !shard.lru.empty()) {
+        const Node& victim = shard.lru.back();
+        shard.bytes -= victim.bytes;
+        counters_.resident_bytes.fetch_sub(victim.bytes, std::memory_order_relaxed);
+        counters_.evictions.add();
+        shard.index.erase(victim.id);
+        shard.lru.pop_back();
+    }
+}
+
+void StatblockCache::invalidate(const std::string& id) {
+    Shard& shard = shard_for(id);
+    std::lock_guard lock(shard.mutex);
+    ++shard.generation; // Laufende Ladevorgänge dürfen ihr (evtl. veraltetes) Ergebnis nicht mehr speichern
+    auto it = shard.index.find(id);
+    if (it == shard.index.end()) {
+        return;
+    }
+    shard.bytes -= it->second->bytes;
+    counters_.resident_bytes.fetch_sub(it->second->bytes, std::memory_order_relaxed);
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+}
+
+std::size_t StatblockCache::resident_bytes() const {
+    return static_cast<std::size_t>(counters_.resident_bytes.load(std::memory_order_relaxed));
+}
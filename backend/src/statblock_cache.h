@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include "nlohmann/json.hpp"
+
+#include "metrics.h"
+#include "monster_model.h"
+
+// --- LRU-Cache für Monster-Statblöcke ---
+// Hält den serialisierten Response-Body und optional das kompakte Monster-Modell (statt des
+// json-Baums, der etwa zehnmal so viel Speicher braucht). Der Speicher ist begrenzt (Budget in Bytes,
+// gezählt werden Body und Modell); bei Überschreitung fliegen die am längsten nicht benutzten
+// Einträge raus. Sharded wie der DnDData-Cache.
+//
+// Ablauf beim Fehlgriff: generation(id) merken, Statblock laden, insert(id, generation, ...).
+// Wurde die ID dazwischen invalidiert (PUT/DELETE/Watcher), wird das Ergebnis nicht gespeichert.
+
+class StatblockCache {
+public:
+    struct Entry {
+        std::shared_ptr<const std::string> body;
+        std::shared_ptr<const nlohmann::json> document; // nullptr, wenn nicht angefordert
+        std::shared_ptr<const CompactMonster> model;    // nullptr, wenn keine Modelle gehalten werden
+    };
+
+    StatblockCache(std::size_t budget_bytes, bool keep_models);
+
+    // Nur vor dem Serverstart aufrufen (leert den Cache)
+    void configure(std::size_t budget_bytes, bool keep_models);
+    bool keeps_models() const { return keep_models_; }
+
+    // Treffer nur, wenn der Body (und bei need_document auch das Modell) vorhanden ist;
+    // der json-Baum wird dann aus dem Modell erzeugt, ohne den Body neu zu parsen
+    std::optional<Entry> find(const std::string& id, bool need_document);
+    std::uint64_t generation(const std::string& id);
+    // Serialisiert document und speichert es (sofern seit generation nicht invalidiert); liefert immer Body und Baum
+    Entry insert(const std::string& id, std::uint64_t generation, nlohmann::json document);
+    void invalidate(const std::string& id);
+
+    std::size_t resident_bytes() const;
+
+private:
+    struct Node {
+        std::string id;
+        Entry entry;
+        std::size_t bytes = 0;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Node> lru; // Vorne = zuletzt benutzt
+        std::unordered_map<std::string, std::list<Node>::iterator> index;
+        std::size_t bytes = 0;
+        std::uint64_t generation = 0;
+    };
+
+    static constexpr std::size_t shard_count = 16;
+
+    Shard& shard_for(const std::string& id);
+    void evict_locked(Shard& shard);
+
+    std::size_t shard_budget_;
+    bool keep_models_;
+    CacheCounters& counters_;
+    std::array<Shard, shard_count> shards_;
+};
+// --- Ende Statblock-Cache ---
@@ -0,0 +1,548 @@
+#include "write_journal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "nlohmann/json.hpp"
+
+#include "json_patch.h"
+#include "logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// Rahmen eines Datensatzes: 4 Byte Länge, 4 Byte CRC32 (beide little endian), dann das JSON
+constexpr std::size_t frame_header = 8;
+const std::string temp_suffix = ".journal-tmp.";
+
+void put_u32(std::string& out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+std::uint32_t get_u32(const std::string& in, std::size_t pos) {
+    std::uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<std::uint32_t>(static_cast<unsigned char>(in[pos + i])) << (8 * i);
+    return value;
+}
+
+std::uint32_t checksum(const char* data, std::size_t size) {
+    return static_cast<std::uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size)));
+}
+
+// Eindeutig pro Schreibvorgang: ohne Journal schreiben mehrere Anfragen gleichzeitig in den Dateibaum
+std::filesystem::path temp_path(const std::filesystem::path& target) {
+    static std::atomic<std::uint64_t> counter{0};
+    std::filesystem::path temp = target;
+    temp += temp_suffix + std::to_string(::getpid()) + "." + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+    return temp;
+}
+
+bool write_all(int fd, const std::string& data) {
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        written += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Schreibt alle geänderten Daten des Dateisystems von dir (Dateien aus apply_operation) auf die Platte
+bool sync_filesystem(const std::filesystem::path& dir) {
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return false;
+    const bool ok = ::syncfs(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+WriteJournal::WriteJournal(std::filesystem::path data_dir, std::filesystem::path journal_file)
+    : data_dir_(std::filesystem::absolute(data_dir).lexically_normal()),
+      journal_file_(std::filesystem::absolute(journal_file).lexically_normal()) {}
+
+WriteJournal::~WriteJournal() {
+    stop();
+}
+
+std::filesystem::path WriteJournal::relative(const std::filesystem::path& path) const {
+    const std::filesystem::path relative_path = std::filesystem::absolute(path).lexically_normal().lexically_relative(data_dir_);
+    if (relative_path.empty() || *relative_path.begin() == "..") {
+        throw std::invalid_argument("Path outside of data directory: " + path.string());
+    }
+    return relative_path;
+}
+
+std::string WriteJournal::encode(const Record& record) const {
+    json operations = json::array();
+    for (const Operation& operation : record.operations) {
+        const char* kind = operation.kind == Operation::Kind::write ? "write" : operation.kind == Operation::Kind::patch ? "patch" : "remove";
+        json entry = {{"op", kind}, {"path", operation.path.generic_string()}};
+        if (operation.kind == Operation::Kind::write) entry["content"] = operation.content;
+        if (operation.kind == Operation::Kind::patch) {
+            entry["patch"] = operation.patch;
+            entry["crc"] = checksum(operation.content.data(), operation.content.size());
+        }
+        operations.push_back(std::move(entry));
+    }
+    const std::string payload = json{{"ops", std::move(operations)}}.dump();
+    std::string frame;
+    frame.reserve(frame_header + payload.size());
+    put_u32(frame, static_cast<std::uint32_t>(payload.size()));
+    put_u32(frame, checksum(payload.data(), payload.size()));
+    frame += payload;
+    return frame;
+}
+
+// Wirft std::runtime_error; Pfad relativ zu data_dir
+void WriteJournal::apply_operation(const Operation& operation) const {
+    const std::filesystem::path target = data_dir_ / operation.path;
+    std::error_code ec;
+    if (operation.kind == Operation::Kind::remove) {
+        std::filesystem::remove(target, ec);
+        if (ec) throw std::runtime_error("Could not remove " + target.string() + ": " + ec.message());
+        return;
+    }
+    std::filesystem::create_directories(target.parent_path(), ec);
+    const std::filesystem::path temp = temp_path(target);
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(operation.content.data(), static_cast<std::streamsize>(operation.content.size()));
+        if (!out) throw std::runtime_error("Could not write " + temp.string());
+    }
+    std::filesystem::rename(temp, target, ec);
+    if (ec) {
+        std::filesystem::remove(temp, ec);
+        throw std::runtime_error("Could not move " + temp.string() + " into place");
+    }
+}
+
+// Setzt content einer patch-Operation aus dem Dateistand. false = überspringen, weil die Datei das Ergebnis schon hat
+// oder eine spätere Operation im Journal dieselbe Datei schreibt (Übertragung war beim Absturz schon weiter).
+// Wirft std::runtime_error, wenn der Patch als letzte Operation auf die Datei nicht passt.
+bool WriteJournal::replay_patch(std::vector<Operation>& operations, const std::vector<std::uint32_t>& checksums, std::size_t index) const {
+    Operation& operation = operations[index];
+    std::string current;
+    {
+        std::ifstream in(data_dir_ / operation.path, std::ios::binary);
+        current.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    if (!current.empty() && checksum(current.data(), current.size()) == checksums[index]) {
+        return false;
+    }
+    std::string error;
+    try {
+        std::string result = apply_patch(json::parse(current), json::parse(operation.patch)).dump(4);
+        if (checksum(result.data(), result.size()) == checksums[index]) {
+            operation.content = std::move(result);
+            return true;
+        }
+        error = "result checksum mismatch";
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    for (std::size_t later = index + 1; later < operations.size(); ++later) {
+        if (operations[later].path == operation.path) {
+            log_debug("Journal-Patch übersprungen, Datei ist schon weiter", {{"path", operation.path.string()}, {"error", error}});
+            return false;
+        }
+    }
+    throw std::runtime_error("Patch does not apply: " + error);
+}
+
+std::size_t WriteJournal::recover() {
+    std::error_code ec;
+    std::filesystem::create_directories(journal_file_.parent_path(), ec);
+    fd_ = ::open(journal_file_.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Could not open journal " + journal_file_.string() + ": " + std::strerror(errno));
+    }
+
+    std::string data;
+    {
+        std::ifstream in(journal_file_, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    std::size_t records = 0;
+    std::size_t position = 0;
+    std::vector<Operation> operations;   // Alle Operationen in Journal-Reihenfolge
+    std::vector<std::uint32_t> checksums; // Bei patch: CRC32 des Ergebnisses
+    while (position + frame_header <= data.size()) {
+        const std::uint32_t length = get_u32(data, position);
+        if (position + frame_header + length > data.size() ||
+            checksum(data.data() + position + frame_header, length) != get_u32(data, position + 4)) {
+            break; // Abgeschnittener oder beschädigter Datensatz (Absturz während des Schreibens)
+        }
+        const json payload = json::parse(data.begin() + static_cast<std::ptrdiff_t>(position + frame_header),
+                                         data.begin() + static_cast<std::ptrdiff_t>(position + frame_header + length), nullptr, false);
+        if (!payload.is_object() || !payload.contains("ops") || !payload["ops"].is_array()) break;
+        for (const json& entry : payload["ops"]) {
+            Operation operation;
+            const std::string kind = entry.value("op", "");
+            operation.kind = kind == "remove" ? Operation::Kind::remove : kind == "patch" ? Operation::Kind::patch : Operation::Kind::write;
+            operation.path = entry.value("path", "");
+            operation.content = entry.value("content", "");
+            operation.patch = entry.value("patch", "");
+            operations.push_back(std::move(operation));
+            checksums.push_back(entry.value("crc", 0u));
+        }
+        ++records;
+        position += frame_header + length;
+    }
+    std::vector<Operation> unapplied; // Übertragung gescheitert, wird im Betrieb wiederholt
+    bool rejected = false;            // Mindestens ein Patch passt nicht zum Dateistand
+    for (std::size_t i = 0; i < operations.size(); ++i) {
+        Operation& operation = operations[i];
+        if (operation.kind == Operation::Kind::patch) {
+            try {
+                if (!replay_patch(operations, checksums, i)) continue;
+            } catch (const std::exception& e) {
+                rejected = true;
+                log_error("Journal-Patch passt nicht zum Dateistand", {{"path", operation.path.string()}, {"error", e.what()}});
+                continue;
+            }
+            operation.kind = Operation::Kind::write; // content ist jetzt das Ergebnis
+        }
+        try {
+            apply_operation(operation);
+        } catch (const std::exception& e) {
+            log_error("Journal-Eintrag konnte nicht eingespielt werden", {{"path", operation.path.string()}, {"error", e.what()}});
+            unapplied.push_back(std::move(operation));
+        }
+    }
+    if (position < data.size()) {
+        log_warn("Unvollständigen Journal-Eintrag verworfen", {{"offset", static_cast<unsigned long long>(position)},
+                                                               {"bytes", static_cast<unsigned long long>(data.size() - position)}});
+    }
+    if (rejected) {
+        // Sonst ginge der Patch mit dem nächsten Checkpoint verloren: Journal zur Analyse aufheben
+        std::filesystem::path copy = journal_file_;
+        copy += ".rejected";
+        std::ofstream out(copy, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (out) log_warn("Journal mit nicht einspielbaren Patches aufgehoben", {{"path", copy.string()}});
+        else log_error("Journal konnte nicht aufgehoben werden", {{"path", copy.string()}});
+    }
+
+    // Erst wenn alles übertragen und der Dateibaum gesichert ist, darf das Journal weg; sonst übernimmt das
+    // ein späterer Checkpoint
+    const bool synced = records == 0 || sync_filesystem(data_dir_);
+    const std::uintmax_t keep = synced && unapplied.empty() ? 0 : position;
+    if (keep != data.size()) {
+        if (::ftruncate(fd_, static_cast<off_t>(keep)) != 0 || ::fdatasync(fd_) != 0) {
+            throw std::runtime_error("Could not truncate journal " + journal_file_.string() + ": " + std::strerror(errno));
+        }
+    }
+    if (records > 0) log_info("Journal eingespielt", {{"records", records}, {"path", journal_file_.string()}});
+
+    std::lock_guard lock(mutex_);
+    journal_size_ = keep;
+    if (!unapplied.empty()) {
+        stats_.apply_errors += unapplied.size();
+        for (const Operation& operation : unapplied) {
+            pending_[operation.path.generic_string()] = Pending{0, operation.kind == Operation::Kind::remove, operation.content};
+        }
+        retry_.push_back(Record{0, std::move(unapplied)});
+    }
+    stopping_ = false;
+    if (!apply_thread_.joinable()) apply_thread_ = std::thread([this]() { apply_loop(); });
+    return records;
+}
+
+void WriteJournal::stop() {
+    {
+        std::lock_guard lock(mutex_);
+        if (!apply_thread_.joinable()) return;
+        stopping_ = true;
+    }
+    apply_cv_.notify_all();
+    apply_thread_.join();
+    checkpoint();
+    std::lock_guard lock(mutex_);
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+}
+
+void WriteJournal::commit(std::vector<Operation> operations) {
+    if (operations.empty()) return;
+    Record record;
+    record.operations = std::move(operations);
+    for (Operation& operation : record.operations) operation.path = relative(operation.path);
+
+    if (!enabled_) {
+        for (const Operation& operation : record.operations) apply_operation(operation);
+        return;
+    }
+
+    const std::string frame = encode(record);
+    std::unique_lock lock(mutex_);
+    if (fd_ < 0) throw std::runtime_error("Journal is not open.");
+    const std::uint64_t seq = record.seq = ++next_seq_;
+    buffer_ += frame;
+    buffered_seq_ = seq;
+    for (const Operation& operation : record.operations) {
+        if (operation.kind == Operation::Kind::patch) ++stats_.patches;
+    }
+    to_apply_.push_back(std::move(record)); // Sichtbar und übertragen erst, wenn durable_seq_ die Nummer erreicht
+    ++stats_.commits;
+
+    while (durable_seq_ < seq) {
+        if (flushing_) {
+            durable_cv_.wait(lock);
+            continue;
+        }
+        // Dieser Thread schreibt alles, was sich bis jetzt angesammelt hat
+        flushing_ = true;
+        const std::string batch = std::move(buffer_);
+        buffer_.clear();
+        const std::uint64_t first = durable_seq_ + 1;
+        const std::uint64_t last = buffered_seq_;
+        lock.unlock();
+        const bool ok = write_all(fd_, batch) && ::fdatasync(fd_) == 0;
+        const int error = errno;
+        lock.lock();
+        flushing_ = false;
+        if (ok) {
+            journal_size_ += batch.size();
+            stats_.bytes += batch.size();
+            ++stats_.syncs;
+            // Erst jetzt als ausstehend melden: Lesepfade sehen nie einen Stand, der noch scheitern kann
+            for (const Record& durable : to_apply_) {
+                if (durable.seq < first || durable.seq > last) continue;
+                for (const Operation& operation : durable.operations) {
+                    pending_[operation.path.generic_string()] = Pending{durable.seq, operation.kind == Operation::Kind::remove, operation.content};
+                }
+            }
+        } else {
+            log_error("Journal konnte nicht geschrieben werden", {{"path", journal_file_.string()}, {"error", std::strerror(error)}});
+            if (::ftruncate(fd_, static_cast<off_t>(journal_size_)) != 0) {
+                log_error("Journal konnte nicht zurückgesetzt werden", {{"path", journal_file_.string()}});
+            }
+            // Fehlgeschlagene Datensätze nicht übertragen (in pending_ standen sie noch nicht)
+            for (auto it = to_apply_.begin(); it != to_apply_.end();) {
+                if (it->seq < first || it->seq > last) {
+                    ++it;
+                    continue;
+                }
+                failed_.insert(it->seq);
+                it = to_apply_.erase(it);
+            }
+        }
+        durable_seq_ = last;
+        durable_cv_.notify_all();
+        apply_cv_.notify_one();
+    }
+    if (failed_.erase(seq) > 0) throw std::runtime_error("Could not write journal.");
+}
+
+void WriteJournal::apply_loop() {
+    std::unique_lock lock(mutex_);
+    const auto ready = [&]() { return stopping_ || (!to_apply_.empty() && to_apply_.front().seq <= durable_seq_); };
+    auto next_retry = std::chrono::steady_clock::now() + retry_interval;
+    const auto checkpoint_if_due = [&]() {
+        if (to_apply_.empty() && retry_.empty() && journal_size_ >= checkpoint_bytes) {
+            lock.unlock();
+            checkpoint();
+            lock.lock();
+        }
+    };
+    while (true) {
+        if (!retry_.empty() && std::chrono::steady_clock::now() >= next_retry) {
+            retry_failed(lock);
+            next_retry = std::chrono::steady_clock::now() + retry_interval;
+            checkpoint_if_due();
+            continue;
+        }
+        if (retry_.empty()) {
+            apply_cv_.wait(lock, ready);
+        } else if (!apply_cv_.wait_until(lock, next_retry, ready)) {
+            continue; // Zeit für den nächsten Versuch
+        }
+        if (to_apply_.empty() || to_apply_.front().seq > durable_seq_) {
+            if (stopping_ && !flushing_ && to_apply_.empty()) {
+                if (!retry_.empty()) retry_failed(lock); // Letzter Versuch vor dem Checkpoint in stop()
+                break;
+            }
+            if (stopping_) durable_cv_.wait(lock); // Auf laufenden Group Commit warten
+            continue;
+        }
+        Record record = std::move(to_apply_.front());
+        to_apply_.pop_front();
+        applying_ = true;
+
+        // Schreibt ein neuerer Datensatz dieselbe Datei, genügt dessen Übertragung (Burst auf ein Monster)
+        std::vector<bool> superseded(record.operations.size());
+        for (std::size_t i = 0; i < record.operations.size(); ++i) {
+            auto found = pending_.find(record.operations[i].path.generic_string());
+            superseded[i] = found != pending_.end() && found->second.seq > record.seq;
+        }
+        lock.unlock();
+
+        std::vector<bool> failed(record.operations.size());
+        for (std::size_t i = 0; i < record.operations.size(); ++i) {
+            if (superseded[i]) continue;
+            try {
+                apply_operation(record.operations[i]);
+            } catch (const std::exception& e) {
+                failed[i] = true;
+                log_error("Journal-Eintrag konnte nicht übertragen werden", {{"path", record.operations[i].path.string()}, {"error", e.what()}});
+            }
+        }
+
+        lock.lock();
+        Record retry{record.seq, {}};
+        for (std::size_t i = 0; i < record.operations.size(); ++i) {
+            if (superseded[i]) {
+                ++stats_.superseded;
+                continue;
+            }
+            const std::string path = record.operations[i].path.generic_string();
+            if (failed[i]) {
+                ++stats_.apply_errors; // Bleibt ausstehend und wird später erneut übertragen
+                retry.operations.push_back(std::move(record.operations[i]));
+                continue;
+            }
+            auto found = pending_.find(path);
+            if (found != pending_.end() && found->second.seq == record.seq) pending_.erase(found);
+            resolve_older_failures_locked(path, record.seq);
+        }
+        if (!retry.operations.empty()) {
+            if (retry_.empty()) next_retry = std::chrono::steady_clock::now() + retry_interval;
+            retry_.push_back(std::move(retry));
+        }
+        applying_ = false;
+        ++stats_.applied;
+        checkpoint_if_due();
+    }
+}
+
+// Überträgt fehlgeschlagene Operationen erneut; lock wird währenddessen freigegeben
+void WriteJournal::retry_failed(std::unique_lock<std::mutex>& lock) {
+    std::vector<Record> records = std::move(retry_);
+    retry_.clear();
+    for (Record& record : records) {
+        // Ist inzwischen ein neuerer Stand derselben Datei ausstehend, übernimmt dessen Übertragung
+        auto& operations = record.operations;
+        operations.erase(std::remove_if(operations.begin(), operations.end(), [&](const Operation& operation) {
+            auto found = pending_.find(operation.path.generic_string());
+            return found != pending_.end() && found->second.seq > record.seq;
+        }), operations.end());
+    }
+    applying_ = true;
+    lock.unlock();
+
+    std::vector<std::vector<bool>> failed(records.size());
+    for (std::size_t r = 0; r < records.size(); ++r) {
+        failed[r].resize(records[r].operations.size());
+        for (std::size_t i = 0; i < records[r].operations.size(); ++i) {
+            try {
+                apply_operation(records[r].operations[i]);
+            } catch (const std::exception& e) {
+                failed[r][i] = true;
+                log_warn("Journal-Eintrag weiterhin nicht übertragbar", {{"path", records[r].operations[i].path.string()}, {"error", e.what()}});
+            }
+        }
+    }
+
+    lock.lock();
+    for (std::size_t r = 0; r < records.size(); ++r) {
+        Record retry{records[r].seq, {}};
+        for (std::size_t i = 0; i < records[r].operations.size(); ++i) {
+            Operation& operation = records[r].operations[i];
+            const std::string path = operation.path.generic_string();
+            if (failed[r][i]) {
+                retry.operations.push_back(std::move(operation));
+                continue;
+            }
+            auto found = pending_.find(path);
+            if (found != pending_.end() && found->second.seq == records[r].seq) pending_.erase(found);
+            resolve_older_failures_locked(path, records[r].seq);
+        }
+        if (!retry.operations.empty()) retry_.push_back(std::move(retry));
+    }
+    if (retry_.empty()) log_info("Fehlgeschlagene Journal-Einträge nachträglich übertragen", {{"path", journal_file_.string()}});
+    applying_ = false;
+}
+
+// Ein neuerer Stand von path ist im Dateibaum: ältere fehlgeschlagene Operationen darauf sind erledigt
+void WriteJournal::resolve_older_failures_locked(const std::string& path, std::uint64_t seq) {
+    for (auto it = retry_.begin(); it != retry_.end();) {
+        auto& operations = it->operations;
+        if (it->seq < seq) {
+            operations.erase(std::remove_if(operations.begin(), operations.end(), [&](const Operation& operation) {
+                return operation.path.generic_string() == path;
+            }), operations.end());
+        }
+        it = operations.empty() ? retry_.erase(it) : it + 1;
+    }
+}
+
+// Dateibaum sichern und Journal leeren, wenn alles übertragen ist und inzwischen nichts Neues kam
+void WriteJournal::checkpoint() {
+    std::uint64_t target;
+    {
+        std::lock_guard lock(mutex_);
+        if (fd_ < 0 || journal_size_ == 0 || !retry_.empty() || flushing_ || applying_ || !buffer_.empty() || !to_apply_.empty()) {
+            return;
+        }
+        target = next_seq_;
+    }
+    if (!sync_filesystem(data_dir_)) {
+        log_warn("syncfs für Journal-Checkpoint fehlgeschlagen", {{"path", data_dir_.string()}, {"error", std::strerror(errno)}});
+        return;
+    }
+    std::lock_guard lock(mutex_);
+    if (next_seq_ != target || flushing_) return;
+    if (::ftruncate(fd_, 0) != 0 || ::fdatasync(fd_) != 0) {
+        log_warn("Journal konnte nicht geleert werden", {{"path", journal_file_.string()}, {"error", std::strerror(errno)}});
+        return;
+    }
+    journal_size_ = 0;
+    ++stats_.checkpoints;
+}
+
+WriteJournal::PendingState WriteJournal::pending(const std::filesystem::path& path, std::string* content) const {
+    std::string key;
+    try {
+        key = relative(path).generic_string();
+    } catch (const std::invalid_argument&) {
+        return PendingState::none;
+    }
+    std::lock_guard lock(mutex_);
+    auto found = pending_.find(key);
+    if (found == pending_.end()) return PendingState::none;
+    if (found->second.removed) return PendingState::removed;
+    if (content) *content = found->second.content;
+    return PendingState::written;
+}
+
+bool WriteJournal::exists(const std::filesystem::path& path) const {
+    switch (pending(path)) {
+        case PendingState::written: return true;
+        case PendingState::removed: return false;
+        default: {
+            std::error_code ec;
+            return std::filesystem::exists(path, ec);
+        }
+    }
+}
+
+WriteJournal::Stats WriteJournal::stats() const {
+    std::lock_guard lock(mutex_);
+    Stats result = stats_;
+    result.pending = pending_.size();
+    for (const Record& record : retry_) result.retrying += record.operations.size();
+    return result;
+}
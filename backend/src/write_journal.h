@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- Write-Ahead-Journal für schreibende Routen ---
+// Statt Zieldateien per ofstream zu kürzen und neu zu schreiben, hängen PUT/POST/DELETE ihre Änderung
+// als einen Datensatz (Länge, CRC32, JSON mit allen Operationen der Anfrage) an ein Journal an und
+// warten, bis er per fdatasync dauerhaft ist. Group Commit: während ein Thread schreibt und synct,
+// sammeln sich die Datensätze weiterer Anfragen im Puffer; der nächste Thread schreibt sie alle mit
+// einem write() und einem fdatasync().
+//
+// Ein Hintergrund-Thread überträgt die Datensätze danach in den Dateibaum (temporäre Datei + rename,
+// also nie halb geschriebene Dateien). Ab dem fdatasync bis zur Übertragung liefern pending()/exists()
+// den Stand aus dem Journal; commit() kehrt erst danach zurück, Lesepfade sehen eigene Schreibzugriffe
+// also sofort, fremde aber nie vor dem Sync. Ist alles übertragen, wird der Dateibaum per
+// syncfs gesichert und das Journal geleert (Checkpoint).
+//
+// recover() spielt beim Start alle vollständigen Datensätze erneut ein (Operationen sind idempotent),
+// ein abgeschnittener letzter Datensatz nach einem Absturz wird verworfen.
+//
+// Scheitert die Übertragung einer Operation (ENOSPC, Rechte, ...), bleibt sie ausstehend und wird alle
+// retry_interval erneut versucht, bis sie gelingt oder ein neuerer Stand derselben Datei übertragen ist.
+// Solange das nicht der Fall ist, gibt es keinen Checkpoint; danach geht es normal weiter.
+//
+// PATCH-Routen committen Operationen der Art patch: im Speicher und im Dateibaum wie write, ins Journal
+// gehen aber nur der Patch und die CRC32 des Ergebnisses. recover() wendet den Patch auf den Dateistand an;
+// hat die Datei das Ergebnis schon (oder folgt im Journal noch eine Operation auf dieselbe Datei, die
+// Datei ist also schon weiter), wird er übersprungen.
+
+class WriteJournal {
+public:
+    struct Operation {
+        enum class Kind { write, remove, patch };
+        Kind kind = Kind::write;
+        std::filesystem::path path; // Unterhalb von data_dir
+        std::string content;        // Bei write und patch (dort apply_patch(bisheriger Inhalt).dump(4), siehe json_patch.h)
+        std::string patch{};        // Nur bei patch: JSON Patch bzw. Merge Patch, steht statt content im Journal
+    };
+
+    enum class PendingState { none, written, removed };
+
+    struct Stats {
+        std::uint64_t commits = 0;
+        std::uint64_t syncs = 0;    // fdatasync-Aufrufe (commits / syncs = mittlere Gruppengröße)
+        std::uint64_t bytes = 0;
+        std::uint64_t patches = 0;  // Operationen, die nur als Patch im Journal stehen
+        std::uint64_t applied = 0;
+        std::uint64_t superseded = 0; // Übersprungen, weil ein neuerer Datensatz dieselbe Datei schreibt
+        std::uint64_t checkpoints = 0;
+        std::uint64_t apply_errors = 0;
+        std::size_t pending = 0;      // Dauerhaft, aber noch nicht im Dateibaum
+        std::size_t retrying = 0;     // Fehlgeschlagene Operationen, die erneut übertragen werden
+    };
+
+    static constexpr std::uintmax_t checkpoint_bytes = 4 * 1024 * 1024;
+    static constexpr std::chrono::seconds retry_interval{5};
+
+    WriteJournal(std::filesystem::path data_dir, std::filesystem::path journal_file);
+    ~WriteJournal();
+
+    WriteJournal(const WriteJournal&) = delete;
+    WriteJournal& operator=(const WriteJournal&) = delete;
+
+    // false: kein Journal, commit() schreibt direkt (temporäre Datei + rename, ohne fsync)
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool enabled() const { return enabled_; }
+
+    // Vor dem Warm-Start: Journal einspielen und leeren, danach den Übertragungs-Thread starten.
+    // Gibt die Anzahl eingespielter Datensätze zurück; wirft std::runtime_error, wenn das Journal nicht
+    // geöffnet werden kann.
+    std::size_t recover();
+    // Überträgt alles Ausstehende, macht einen Checkpoint und beendet den Thread
+    void stop();
+
+    // Blockiert, bis die Operationen dauerhaft sind (bzw. ohne Journal: geschrieben).
+    // Wirft std::invalid_argument für Pfade außerhalb von data_dir, std::runtime_error bei I/O-Fehlern
+    // (dann ist nichts übernommen).
+    void commit(std::vector<Operation> operations);
+
+    // Stand einer Datei mit noch nicht übertragener Änderung (content wird bei written gesetzt)
+    PendingState pending(const std::filesystem::path& path, std::string* content = nullptr) const;
+    // Wie std::filesystem::exists, berücksichtigt aber ausstehende Änderungen
+    bool exists(const std::filesystem::path& path) const;
+
+    Stats stats() const;
+
+private:
+    struct Pending {
+        std::uint64_t seq = 0;
+        bool removed = false;
+        std::string content;
+    };
+    struct Record {
+        std::uint64_t seq = 0;
+        std::vector<Operation> operations; // Pfade relativ zu data_dir
+    };
+
+    std::filesystem::path relative(const std::filesystem::path& path) const;
+    std::string encode(const Record& record) const;
+    void apply_operation(const Operation& operation) const;
+    bool replay_patch(std::vector<Operation>& operations, const std::vector<std::uint32_t>& checksums, std::size_t index) const;
+    void apply_loop();
+    void retry_failed(std::unique_lock<std::mutex>& lock);
+    void resolve_older_failures_locked(const std::string& path, std::uint64_t seq);
+    void checkpoint();
+
+    std::filesystem::path data_dir_; // absolut
+    std::filesystem::path journal_file_;
+    bool enabled_ = true;
+    int fd_ = -1;
+
+    mutable std::mutex mutex_;
+    std::condition_variable durable_cv_;
+    std::condition_variable apply_cv_;
+    std::string buffer_;            // Kodierte, noch nicht geschriebene Datensätze
+    std::uint64_t next_seq_ = 0;    // Zuletzt vergebene Nummer
+    std::uint64_t buffered_seq_ = 0; // Höchste Nummer im Puffer
+    std::uint64_t durable_seq_ = 0; // Alles bis hier geschrieben (oder fehlgeschlagen, siehe failed_)
+    bool flushing_ = false;
+    std::set<std::uint64_t> failed_; // Nummern aus fehlgeschlagenen Schreibvorgängen (vom wartenden commit() entfernt)
+    std::uintmax_t journal_size_ = 0;
+
+    std::map<std::string, Pending> pending_; // Relativer Pfad -> neuester dauerhafter, noch nicht übertragener Stand
+    std::deque<Record> to_apply_;
+    std::vector<Record> retry_;     // Nur die fehlgeschlagenen Operationen je Datensatz (aus recover(): seq 0)
+    bool applying_ = false;
+    bool stopping_ = false;
+    std::thread apply_thread_;
+
+    Stats stats_;
+};
+// --- Ende Write-Ahead-Journal ---
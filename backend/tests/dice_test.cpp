@@ -0,0 +1,120 @@
+// Tests für PhiloxStream und DiceExpression: gleiche Folgen pro (seed, stream), Parser-Grenzfälle.
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "dice.h"
+#include "rng.h"
+#include "test_support.h"
+
+using json = nlohmann::json;
+
+TEST_CASE(dice_philox_is_deterministic_per_seed_and_stream) {
+    PhiloxStream first(42, 7);
+    PhiloxStream second(42, 7);
+    PhiloxStream other_stream(42, 8);
+    PhiloxStream other_seed(43, 7);
+    int differences_stream = 0;
+    int differences_seed = 0;
+    for (int i = 0; i < 1000; ++i) {
+        const std::uint32_t value = first.next_u32();
+        CHECK_EQ(second.next_u32(), value);
+        differences_stream += other_stream.next_u32() != value;
+        differences_seed += other_seed.next_u32() != value;
+    }
+    CHECK(differences_stream > 990);
+    CHECK(differences_seed > 990);
+}
+
+TEST_CASE(dice_philox_fill_matches_next_u32) {
+    // fill() muss auch mitten in einem Block dieselbe Folge liefern wie einzelne next_u32()
+    PhiloxStream single(7, 3);
+    PhiloxStream bulk(7, 3);
+    std::vector<std::uint32_t> expected(103);
+    for (std::uint32_t& value : expected) value = single.next_u32();
+    std::vector<std::uint32_t> actual(103);
+    actual[0] = bulk.next_u32();
+    bulk.fill(actual.data() + 1, 1);
+    bulk.fill(actual.data() + 2, 101);
+    CHECK(actual == expected);
+}
+
+TEST_CASE(dice_rolls_repeat_for_fixed_seed) {
+    const DiceExpression expression = parse_dice("3d6+1d4+2");
+    std::vector<int> first(500);
+    std::vector<int> second(500);
+    PhiloxStream rng_a(2024, 1);
+    PhiloxStream rng_b(2024, 1);
+    expression.roll_many(rng_a, first.data(), first.size());
+    expression.roll_many(rng_b, second.data(), second.size());
+    CHECK(first == second);
+    for (int total : first) {
+        CHECK(total >= expression.min() && total <= expression.max());
+    }
+
+    PhiloxStream rng_c(2024, 1);
+    PhiloxStream rng_d(2024, 1);
+    for (int i = 0; i < 100; ++i) {
+        CHECK_EQ(expression.roll(rng_c), expression.roll(rng_d));
+    }
+}
+
+TEST_CASE(dice_crit_doubles_dice_not_modifier) {
+    const DiceExpression expression = parse_dice("2d6+3");
+    PhiloxStream rng(5, 0);
+    int highest = 0;
+    for (int i = 0; i < 2000; ++i) {
+        const int total = expression.roll(rng, true);
+        CHECK(total >= 4 + 3 && total <= 24 + 3);
+        highest = std::max(highest, total);
+    }
+    CHECK(highest > expression.max()); // Mit vier Würfeln über dem normalen Maximum
+}
+
+TEST_CASE(dice_parses_supported_forms) {
+    CHECK_EQ(parse_dice("2d6+3").to_string(), "2d6+3");
+    CHECK_EQ(parse_dice("d20").to_string(), "1d20");
+    CHECK_EQ(parse_dice("2D6").to_string(), "2d6");
+    CHECK_EQ(parse_dice("d%").to_string(), "1d100");
+    CHECK_EQ(parse_dice("3d6+1d4+2+1d6").to_string(), "4d6+1d4+2"); // Gleiche Größen zusammengefasst
+
+    const DiceExpression mixed = parse_dice("1d8 - 1d4 + 2");
+    CHECK_EQ(mixed.min(), -1);
+    CHECK_EQ(mixed.max(), 9);
+    CHECK_EQ(mixed.mean(), 4.0);
+
+    const DiceExpression constant = parse_dice("-3");
+    CHECK_EQ(constant.min(), -3);
+    CHECK_EQ(constant.max(), -3);
+    CHECK(constant.dice.empty());
+
+    const DiceExpression recharge = parse_dice("(5-6)");
+    CHECK_EQ(recharge.target, 5);
+    CHECK_EQ(recharge.max(), 6);
+    CHECK_EQ(recharge_threshold("(5-6)"), 5);
+    CHECK_EQ(recharge_threshold(""), 0);
+    CHECK_EQ(recharge_threshold(nullptr), 0);
+}
+
+TEST_CASE(dice_rejects_invalid_expressions) {
+    CHECK_THROWS_AS(parse_dice(""), std::invalid_argument);
+    CHECK_THROWS_AS(parse_dice("2d"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_dice("2d6+"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_dice("abc"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_dice("d0"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_dice("1d1001"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_dice("1001d6"), std::invalid_argument);
+    CHECK_THROWS_AS(parse_dice("1000d6+1000d6"), std::invalid_argument); // Limit gilt nach dem Zusammenfassen
+}
+
+TEST_CASE(dice_compiles_statblock_objects) {
+    CHECK_EQ(compile_dice(json{{"count", 2}, {"size", 6}, {"modifier", 1}}).to_string(), "2d6+1");
+    CHECK_EQ(compile_dice(json{{"diceCount", 3}, {"diceValue", 8}}).to_string(), "3d8");
+    CHECK_EQ(compile_dice(json{{"HDAmount", 2}, {"defaultDie", 8}, {"HPmodifier", 3}}).to_string(), "2d8+3");
+    CHECK_EQ(compile_dice(json::array({{{"count", 1}, {"size", 6}}, {{"count", 1}, {"size", 6}, {"modifier", 2}}})).to_string(), "2d6+2");
+}
@@ -0,0 +1,84 @@
+// Tests für JSON Patch (RFC 6902) und Merge Patch (RFC 7396): Fehlerpfade von test/move/remove mit ihrem
+// HTTP-Status, Atomarität und Content-Type-Erkennung.
+
+#include <string>
+
+#include "nlohmann/json.hpp"
+
+#include "json_patch.h"
+#include "test_support.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+const json goblin = {{"name", "Goblin"}, {"hp", 7}, {"tags", {"small", "sneaky"}}, {"senses", {{"darkvision", 60}}}};
+
+// Status der PatchError aus apply_patch, 0 wenn der Patch angewendet wurde
+int patch_status(const json& patch) {
+    try {
+        apply_patch(goblin, patch);
+    } catch (const PatchError& e) {
+        return e.status();
+    }
+    return 0;
+}
+
+int parse_status(const std::string& body, const std::string& content_type) {
+    try {
+        parse_patch(body, content_type);
+    } catch (const PatchError& e) {
+        return e.status();
+    }
+    return 0;
+}
+
+} // namespace
+
+TEST_CASE(patch_test_op_failures_conflict) {
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "test", "path": "/hp", "value": 8}])")), 409);
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "test", "path": "/missing", "value": 8}])")), 409);
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "test", "path": "/hp", "value": 7}])")), 0);
+}
+
+TEST_CASE(patch_move_error_paths) {
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "move", "from": "/missing", "path": "/x"}])")), 409);
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "move", "from": "/hp", "path": "/stats/hp"}])")), 409); // Ziel-Elternteil fehlt
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "move", "from": "/senses", "path": "/senses/inner"}])")), 409); // In eigenes Kind
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "move", "path": "/x"}])")), 400); // Ohne from
+
+    const json moved = apply_patch(goblin, json::parse(R"([{"op": "move", "from": "/hp", "path": "/hitPoints"}])"));
+    CHECK_EQ(moved["hitPoints"], 7);
+    CHECK(!moved.contains("hp"));
+}
+
+TEST_CASE(patch_remove_error_paths) {
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "remove", "path": "/missing"}])")), 409);
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "remove", "path": "/tags/5"}])")), 409);
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "remove"}])")), 400);
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "remove", "path": "hp"}])")), 400); // Kein JSON Pointer
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "frobnicate", "path": "/hp"}])")), 400);
+}
+
+TEST_CASE(patch_failure_leaves_document_unchanged) {
+    const json before = goblin;
+    CHECK_EQ(patch_status(json::parse(R"([{"op": "replace", "path": "/hp", "value": 9}, {"op": "test", "path": "/hp", "value": 7}])")), 409);
+    CHECK_EQ(goblin, before);
+}
+
+TEST_CASE(patch_merge_patch_removes_nulls) {
+    const json merged = apply_patch(goblin, json::parse(R"({"hp": null, "name": "Orc", "senses": {"darkvision": 120}})"));
+    CHECK(!merged.contains("hp"));
+    CHECK_EQ(merged["name"], "Orc");
+    CHECK_EQ(merged["senses"]["darkvision"], 120);
+}
+
+TEST_CASE(patch_content_types) {
+    CHECK_EQ(parse_status("[]", "text/plain"), 415);
+    CHECK_EQ(parse_status("{}", "application/json-patch+json"), 400);
+    CHECK_EQ(parse_status("[]", "application/merge-patch+json"), 400);
+    CHECK_EQ(parse_status("5", "application/json"), 400);
+    CHECK_EQ(parse_status("{", "application/json"), 400);
+    CHECK_EQ(parse_status("[]", "Application/JSON-Patch+JSON; charset=utf-8"), 0);
+    CHECK_EQ(parse_status("{}", ""), 0);
+}
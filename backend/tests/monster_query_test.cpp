@@ -0,0 +1,129 @@
+// Tests für RoaringBitmap (UND/ODER über dünne und dichte Container, auch an der Umstellungsgrenze) und
+// die Vokabular-Auflösung von MonsterQueryIndex.
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "monster_query.h"
+#include "test_support.h"
+
+namespace {
+
+constexpr std::uint32_t row_count = 3 * 65536 + 1000; // Vier Container, der letzte unvollständig
+constexpr std::size_t array_limit = 4096;              // Wie RoaringBitmap::array_limit
+
+struct RowSet {
+    RoaringBitmap bitmap;
+    std::vector<bool> rows = std::vector<bool>(row_count, false);
+};
+
+RowSet make_rows(const std::function<bool(std::uint32_t)>& contains) {
+    RowSet set;
+    for (std::uint32_t row = 0; row < row_count; ++row) {
+        if (contains(row)) {
+            set.bitmap.append(row);
+            set.rows[row] = true;
+        }
+    }
+    return set;
+}
+
+std::vector<std::uint64_t> dense_from(const std::vector<bool>& rows) {
+    std::vector<std::uint64_t> dense((row_count + 63) / 64, 0);
+    for (std::uint32_t row = 0; row < row_count; ++row) {
+        if (rows[row]) dense[row / 64] |= std::uint64_t(1) << (row % 64);
+    }
+    return dense;
+}
+
+// Verschiedene Container-Formen: dünn, dicht, genau an und knapp über der Grenze, mit Lücke
+std::vector<RowSet> sample_sets() {
+    std::vector<RowSet> sets;
+    sets.push_back(make_rows([](std::uint32_t row) { return row % 37 == 0; }));                 // Nur dünne Container
+    sets.push_back(make_rows([](std::uint32_t row) { return row % 3 == 0; }));                  // Nur dichte Container
+    sets.push_back(make_rows([](std::uint32_t row) { return row < array_limit; }));             // Genau array_limit: bleibt dünn
+    sets.push_back(make_rows([](std::uint32_t row) { return row <= array_limit; }));            // array_limit + 1: wird dicht
+    sets.push_back(make_rows([](std::uint32_t row) { return row >= 2 * 65536 && row % 2 == 1; })); // Erst ab dem dritten Container
+    sets.push_back(make_rows([](std::uint32_t row) { return row < 65536 ? row % 5 == 0 : row >= 2 * 65536 && row % 101 == 0; })); // Lücke
+    return sets;
+}
+
+} // namespace
+
+TEST_CASE(bitmap_cardinality_counts_each_row_once) {
+    RoaringBitmap bitmap;
+    for (std::uint32_t row = 0; row <= array_limit; ++row) {
+        bitmap.append(row);
+        bitmap.append(row); // Doppelte Zeilen zählen nicht
+    }
+    bitmap.append(70000);
+    CHECK_EQ(bitmap.cardinality(), array_limit + 2);
+}
+
+TEST_CASE(bitmap_or_matches_reference) {
+    const std::vector<RowSet> sets = sample_sets();
+    for (const RowSet& left : sets) {
+        for (const RowSet& right : sets) {
+            std::vector<std::uint64_t> dense = dense_from(left.rows);
+            right.bitmap.or_into(dense);
+            std::vector<bool> expected(row_count);
+            for (std::uint32_t row = 0; row < row_count; ++row) expected[row] = left.rows[row] || right.rows[row];
+            CHECK(dense == dense_from(expected));
+        }
+    }
+}
+
+TEST_CASE(bitmap_and_matches_reference) {
+    const std::vector<RowSet> sets = sample_sets();
+    for (const RowSet& left : sets) {
+        for (const RowSet& right : sets) {
+            std::vector<std::uint64_t> dense = dense_from(left.rows);
+            right.bitmap.and_into(dense);
+            std::vector<bool> expected(row_count);
+            for (std::uint32_t row = 0; row < row_count; ++row) expected[row] = left.rows[row] && right.rows[row];
+            CHECK(dense == dense_from(expected));
+        }
+    }
+}
+
+TEST_CASE(bitmap_and_clears_rows_without_container) {
+    RoaringBitmap bitmap; // Nur im dritten Container belegt
+    bitmap.append(2 * 65536 + 5);
+    std::vector<std::uint64_t> dense((row_count + 63) / 64, ~std::uint64_t(0));
+    bitmap.and_into(dense);
+    std::vector<bool> expected(row_count, false);
+    expected[2 * 65536 + 5] = true;
+    CHECK(dense == dense_from(expected));
+}
+
+TEST_CASE(bitmap_query_matches_vocabulary_exactly) {
+    MonsterVocabularies vocabularies;
+    vocabularies.types = {"Dragon", "Demon"};
+    vocabularies.damage_types = {"Fire", "Cold"};
+    std::vector<MonsterSummary> monsters(3);
+    monsters[0].id = "red-dragon";
+    monsters[0].type = "dragon";
+    monsters[0].resistances = {"Fire"};
+    monsters[1].id = "gunner";
+    monsters[1].type = "humanoid"; // Nicht im Vokabular, aber als eigener Wert indiziert
+    monsters[1].resistances = {"firearm"};
+    monsters[2].id = "balor";
+    monsters[2].type = "Demon";
+    const MonsterQueryIndex index(monsters, vocabularies);
+
+    MonsterQuery query;
+    query.types = {"DRAGON"};
+    CHECK(index.run(query) == std::vector<std::uint32_t>({0}));
+
+    query.types = {"d"}; // Kein Präfix-Treffer
+    CHECK_THROWS_AS(index.run(query), std::invalid_argument);
+
+    query.types = {};
+    query.resistances = {"fire"};
+    CHECK(index.run(query) == std::vector<std::uint32_t>({0})); // "firearm" ist nicht "fire"
+
+    query.resistances = {"firearm"};
+    CHECK_THROWS_AS(index.run(query), std::invalid_argument);
+}
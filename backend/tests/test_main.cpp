@@ -0,0 +1,50 @@
+// DnDApp_tests: Unit-Tests für Journal, Würfel, JSON Patch und Bitmap-Index (ohne Server und ohne Crow).
+//
+//   DnDApp_tests [<präfix>]   führt alle Tests aus, deren Name mit präfix beginnt (ohne Präfix: alle)
+//
+// Exit-Code 0, wenn alle ausgewählten Tests bestehen (und mindestens einer ausgewählt wurde).
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "logger.h"
+#include "test_support.h"
+
+std::vector<TestCase>& test_registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+bool register_test(std::string name, std::function<void()> run) {
+    test_registry().push_back({std::move(name), std::move(run)});
+    return true;
+}
+
+std::string test_location(const char* file, int line) {
+    return std::string(file) + ":" + std::to_string(line) + ": ";
+}
+
+int main(int argc, char* argv[]) {
+    const std::string prefix = argc > 1 ? argv[1] : "";
+    logger().set_min_level(LogLevel::Off); // Erwartete Fehler (kaputte Journale, I/O-Fehler) nicht ausgeben
+
+    int passed = 0;
+    int failed = 0;
+    for (const TestCase& test : test_registry()) {
+        if (test.name.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        try {
+            test.run();
+            ++passed;
+            std::cout << "[ OK ] " << test.name << "\n";
+        } catch (const std::exception& e) {
+            ++failed;
+            std::cout << "[FAIL] " << test.name << ": " << e.what() << "\n";
+        }
+    }
+    std::cout << passed << " bestanden, " << failed << " fehlgeschlagen\n";
+    logger().shutdown();
+    return failed == 0 && passed > 0 ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// --- Minimales Test-Gerüst für DnDApp_tests ---
+// TEST_CASE(name) registriert eine Funktion, CHECK* werfen TestFailure mit Datei und Zeile.
+// Die Namen beginnen mit dem Bereich (journal_, dice_, patch_, bitmap_); test_main.cpp filtert per Präfix,
+// CMakeLists.txt legt pro Bereich einen ctest-Eintrag an.
+
+struct TestCase {
+    std::string name;
+    std::function<void()> run;
+};
+
+std::vector<TestCase>& test_registry();
+bool register_test(std::string name, std::function<void()> run);
+
+class TestFailure : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+std::string test_location(const char* file, int line);
+
+#define TEST_CASE(name)                                                              \
+    static void name();                                                              \
+    [[maybe_unused]] static const bool name##_registered = register_test(#name, name); \
+    static void name()
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) throw TestFailure(test_location(__FILE__, __LINE__) + "CHECK(" #condition ")"); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                              \
+    do {                                                                                        \
+        const auto& check_actual = (actual);                                                    \
+        const auto& check_expected = (expected);                                                \
+        if (!(check_actual == check_expected)) {                                                \
+            std::ostringstream check_message;                                                   \
+            check_message << test_location(__FILE__, __LINE__) << "CHECK_EQ(" #actual ", " #expected "): " \
+                          << check_actual << " != " << check_expected;                          \
+            throw TestFailure(check_message.str());                                             \
+        }                                                                                       \
+    } while (0)
+
+#define CHECK_THROWS_AS(expression, exception_type)                                                    \
+    do {                                                                                               \
+        bool check_thrown = false;                                                                     \
+        try {                                                                                          \
+            (void)(expression);                                                                        \
+        } catch (const exception_type&) {                                                              \
+            check_thrown = true;                                                                       \
+        }                                                                                              \
+        if (!check_thrown) throw TestFailure(test_location(__FILE__, __LINE__) + #expression " throws no " #exception_type); \
+    } while (0)
+// --- Ende Test-Gerüst ---
@@ -0,0 +1,184 @@
+// Tests für WriteJournal: Einspielen nach Absturz (abgeschnittener bzw. beschädigter letzter Datensatz,
+// Patch-Operationen) und Wiederaufnahme der Checkpoints nach Übertragungsfehlern.
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+#include <zlib.h>
+
+#include "nlohmann/json.hpp"
+
+#include "test_support.h"
+#include "write_journal.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// Leeres Datenverzeichnis pro Test (unter dem temporären Verzeichnis, nach Prozess getrennt)
+std::filesystem::path fresh_dir(const std::string& name) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / ("dndapp_tests_" + std::to_string(::getpid())) / name;
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+std::string read_file(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+std::uint32_t crc(const std::string& data) {
+    return static_cast<std::uint32_t>(crc32(0L, reinterpret_cast<const Bytef*>(data.data()), static_cast<uInt>(data.size())));
+}
+
+void put_u32(std::string& out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+// Datensatz im Journal-Format: Länge, CRC32 (little endian), {"ops": [...]}
+std::string frame(const json& operations) {
+    const std::string payload = json{{"ops", operations}}.dump();
+    std::string out;
+    put_u32(out, static_cast<std::uint32_t>(payload.size()));
+    put_u32(out, crc(payload));
+    return out + payload;
+}
+
+json write_op(const std::string& path, const std::string& content) {
+    return {{"op", "write"}, {"path", path}, {"content", content}};
+}
+
+json patch_op(const std::string& path, const json& patch, const std::string& result) {
+    return {{"op", "patch"}, {"path", path}, {"patch", patch.dump()}, {"crc", crc(result)}};
+}
+
+} // namespace
+
+TEST_CASE(journal_discards_truncated_tail) {
+    const std::filesystem::path dir = fresh_dir("truncated");
+    std::string data = frame(json::array({write_op("a.json", "{\"v\":1}")})) + frame(json::array({write_op("b.json", "{\"v\":2}")}));
+    const std::string torn = frame(json::array({write_op("c.json", "{\"v\":3}")}));
+    data += torn.substr(0, torn.size() - 5); // Absturz mitten im write()
+    write_file(dir / "journal.wal", data);
+
+    WriteJournal journal(dir, dir / "journal.wal");
+    CHECK_EQ(journal.recover(), 2u);
+    CHECK_EQ(read_file(dir / "a.json"), "{\"v\":1}");
+    CHECK_EQ(read_file(dir / "b.json"), "{\"v\":2}");
+    CHECK(!std::filesystem::exists(dir / "c.json"));
+    CHECK_EQ(std::filesystem::file_size(dir / "journal.wal"), 0u); // Eingespielt und geleert
+    journal.stop();
+}
+
+TEST_CASE(journal_discards_corrupt_tail) {
+    const std::filesystem::path dir = fresh_dir("corrupt");
+    std::string last = frame(json::array({write_op("b.json", "{\"v\":2}")}));
+    last[last.size() - 2] ^= 0x20; // Inhalt passt nicht mehr zur CRC
+    write_file(dir / "journal.wal", frame(json::array({write_op("a.json", "{\"v\":1}")})) + last);
+
+    WriteJournal journal(dir, dir / "journal.wal");
+    CHECK_EQ(journal.recover(), 1u);
+    CHECK_EQ(read_file(dir / "a.json"), "{\"v\":1}");
+    CHECK(!std::filesystem::exists(dir / "b.json"));
+    journal.stop();
+}
+
+TEST_CASE(journal_replays_patch_before_truncated_tail) {
+    const std::filesystem::path dir = fresh_dir("patch");
+    const json base = {{"name", "Goblin"}, {"hp", 7}};
+    const json patch = json::array({{{"op", "replace"}, {"path", "/hp"}, {"value", 9}}});
+    const std::string result = base.patch(patch).dump(4);
+    const std::string torn = frame(json::array({write_op("m.json", "{}")}));
+    write_file(dir / "journal.wal", frame(json::array({write_op("m.json", base.dump(4))})) +
+                                        frame(json::array({patch_op("m.json", patch, result)})) + torn.substr(0, 6));
+
+    WriteJournal journal(dir, dir / "journal.wal");
+    CHECK_EQ(journal.recover(), 2u);
+    CHECK_EQ(read_file(dir / "m.json"), result); // write eingespielt, Patch darauf angewendet, Rest verworfen
+    journal.stop();
+}
+
+TEST_CASE(journal_skips_patch_already_in_file) {
+    const std::filesystem::path dir = fresh_dir("patch_applied");
+    const json base = {{"name", "Goblin"}, {"hp", 7}};
+    const json patch = json::array({{{"op", "add"}, {"path", "/tags"}, {"value", json::array({"small"})}}});
+    const std::string result = base.patch(patch).dump(4);
+    write_file(dir / "m.json", result); // Übertragung war vor dem Absturz schon fertig
+    write_file(dir / "journal.wal", frame(json::array({patch_op("m.json", patch, result)})));
+
+    WriteJournal journal(dir, dir / "journal.wal");
+    CHECK_EQ(journal.recover(), 1u);
+    CHECK_EQ(read_file(dir / "m.json"), result); // "add" auf ein Array wäre nicht idempotent
+    CHECK(!std::filesystem::exists(dir / "journal.wal.rejected"));
+    journal.stop();
+}
+
+TEST_CASE(journal_keeps_unreplayable_patch_for_analysis) {
+    const std::filesystem::path dir = fresh_dir("patch_rejected");
+    const json patch = json::array({{{"op", "replace"}, {"path", "/hp"}, {"value", 9}}});
+    write_file(dir / "m.json", "{\"name\": \"Goblin\"}"); // Kein /hp: Patch passt nicht
+    write_file(dir / "journal.wal", frame(json::array({patch_op("m.json", patch, "{}")})));
+
+    WriteJournal journal(dir, dir / "journal.wal");
+    CHECK_EQ(journal.recover(), 1u);
+    CHECK_EQ(read_file(dir / "m.json"), "{\"name\": \"Goblin\"}");
+    CHECK(std::filesystem::exists(dir / "journal.wal.rejected"));
+    journal.stop();
+}
+
+TEST_CASE(journal_recovers_own_records_after_crash) {
+    // Datensätze aus commit() (write + patch) nach einem simulierten Absturz in einem neuen Verzeichnis einspielen
+    const std::filesystem::path dir = fresh_dir("roundtrip");
+    const std::filesystem::path copy = fresh_dir("roundtrip_copy");
+    const json base = {{"name", "Orc"}, {"hp", 15}};
+    const json patch = json::array({{{"op", "remove"}, {"path", "/hp"}}});
+    const std::string result = base.patch(patch).dump(4);
+    {
+        WriteJournal journal(dir, dir / "journal.wal");
+        journal.recover();
+        journal.commit({{WriteJournal::Operation::Kind::write, dir / "m.json", base.dump(4)}});
+        journal.commit({{WriteJournal::Operation::Kind::patch, dir / "m.json", result, patch.dump()}});
+        write_file(copy / "journal.wal", read_file(dir / "journal.wal") + std::string("\x10\x00", 2)); // Halber Header dahinter
+    }
+    CHECK_EQ(read_file(dir / "m.json"), result);
+
+    WriteJournal journal(copy, copy / "journal.wal");
+    CHECK_EQ(journal.recover(), 2u);
+    CHECK_EQ(read_file(copy / "m.json"), result);
+    journal.stop();
+}
+
+TEST_CASE(journal_resumes_checkpoints_after_apply_failure) {
+    const std::filesystem::path dir = fresh_dir("retry");
+    write_file(dir / "blocker", "x"); // Datei statt Verzeichnis: Übertragung nach blocker/ schlägt fehl
+
+    WriteJournal journal(dir, dir / "journal.wal");
+    journal.recover();
+    journal.commit({{WriteJournal::Operation::Kind::write, dir / "blocker" / "a.json", "{}"}});
+    CHECK(journal.exists(dir / "blocker" / "a.json")); // Bleibt bis zur Übertragung ausstehend
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (journal.stats().retrying == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    CHECK_EQ(journal.stats().retrying, 1u);
+
+    std::filesystem::remove(dir / "blocker");
+    std::this_thread::sleep_for(WriteJournal::retry_interval + std::chrono::milliseconds(500));
+    CHECK_EQ(journal.stats().retrying, 0u);
+    CHECK_EQ(read_file(dir / "blocker" / "a.json"), "{}");
+
+    journal.stop(); // Checkpoint ist wieder möglich
+    CHECK_EQ(std::filesystem::file_size(dir / "journal.wal"), 0u);
+}
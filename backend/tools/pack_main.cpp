@@ -0,0 +1,87 @@
+// DnDApp_pack: Datenbaum in einen Catalog-Pack übersetzen (siehe src/catalog_pack.h).
+//
+//   DnDApp_pack [--data=../data] [--output=dndapp.pack] [--categories=DnDData,spells,...]
+//
+// Das CMake-Target dndapp-pack ruft das Programm mit backend/data und <build>/dndapp.pack auf; DnDApp findet den
+// Pack dort, wenn es wie üblich aus dem Build-Verzeichnis gestartet wird (sonst --pack=<datei>).
+// Ausgabe: Statistik als JSON (Datensätze, Größen, Zeit zum Packen und zum Öffnen).
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+#include "catalog_pack.h"
+#include "logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+std::string option_value(const std::string& arg, const std::string& name) {
+    const std::string prefix = name + "=";
+    return arg.rfind(prefix, 0) == 0 ? arg.substr(prefix.size()) : "";
+}
+
+std::vector<std::string> split_list(const std::string& value) {
+    std::vector<std::string> items;
+    std::string current;
+    for (char c : value + ",") {
+        if (c == ',') {
+            if (!current.empty()) items.push_back(current);
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    return items;
+}
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    logger().set_min_level(LogLevel::Warn);
+    std::string data_dir = "../data";
+    std::string output = "dndapp.pack";
+    std::vector<std::string> categories = default_pack_categories();
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (!option_value(arg, "--data").empty()) data_dir = option_value(arg, "--data");
+        else if (!option_value(arg, "--output").empty()) output = option_value(arg, "--output");
+        else if (!option_value(arg, "--categories").empty()) categories = split_list(option_value(arg, "--categories"));
+        else {
+            std::cerr << "Aufruf: DnDApp_pack [--data=../data] [--output=dndapp.pack] [--categories=a,b,...]\n";
+            logger().shutdown();
+            return 2;
+        }
+    }
+
+    int code = 0;
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        const PackBuildStats stats = write_catalog_pack(data_dir, categories, output);
+        const double pack_ms = elapsed_ms(start);
+
+        // Einmal öffnen: prüft das Ergebnis und zeigt, was der Server beim Start dafür bezahlt
+        const auto open_start = std::chrono::steady_clock::now();
+        const std::shared_ptr<const CatalogPack> pack = CatalogPack::open(output);
+        const double open_ms = elapsed_ms(open_start);
+
+        const json summary = {{"output", output}, {"records", stats.records}, {"monsters", stats.monsters}, {"errors", stats.errors},
+                              {"source_bytes", stats.source_bytes}, {"pack_bytes", stats.pack_bytes}, {"string_bytes", stats.string_bytes},
+                              {"version", CatalogPack::format_version}, {"pack_ms", pack_ms}, {"open_ms", open_ms}};
+        std::cout << summary.dump(2) << "\n";
+        if (stats.errors > 0) code = 1;
+    } catch (const std::exception& e) {
+        std::cerr << "DnDApp_pack: " << e.what() << "\n";
+        code = 1;
+    }
+    logger().shutdown();
+    return code;
+}